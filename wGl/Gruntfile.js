@@ -8,12 +8,16 @@ module.exports = function(grunt) {
                     'src/graphics/core/*.js',
                     'src/graphics/assets/*.js',
 					'src/graphics/assetloader/proxy/*.js',
+					'src/graphics/assetloader/worker/*.js',
+					'src/graphics/assetloader/ktx/reader/*.js',
 					'src/graphics/assetloader/mtl/reader/*.js',
 					'src/graphics/assetloader/mtl/*.js',
 					'src/graphics/assetloader/obj/reader/*.js',
 					'src/graphics/assetloader/obj/*.js',
 					'src/graphics/assetloader/threejs/reader/*.js',
 					'src/graphics/assetloader/threejs/*.js',
+					'src/graphics/assetloader/binary/reader/*.js',
+					'src/graphics/assetloader/binary/*.js',
                     'src/graphics/assetloader/*.js',
                     'src/graphics/scene/interfaces/*.js',
                     'src/graphics/scene/drawordering/*.js',
@@ -31,6 +35,15 @@ module.exports = function(grunt) {
                     'src/*.js'
                 ];
 
+    // decode workers run in their own scope and only need the readers
+    var workerSrcList = [
+                    'src/graphics/core/glmatrix.js',
+                    'src/graphics/assetloader/proxy/*.js',
+                    'src/graphics/assetloader/obj/reader/*.js',
+                    'src/graphics/assetloader/threejs/reader/*.js',
+                    'src/workers/gdecodeworker.js'
+                ];
+
     // Project configuration.
     grunt.initConfig({
         pkg: grunt.file.readJSON('package.json'),
@@ -47,6 +60,10 @@ module.exports = function(grunt) {
             app: {
                 src:srcList,
                 dest:'build/main.concat.js'
+            },
+            worker: {
+                src:workerSrcList,
+                dest:'build/gdecodeworker.js'
             }
         },
         'closure-compiler': {
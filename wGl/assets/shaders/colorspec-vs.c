@@ -19,15 +19,33 @@
 // SOFTWARE.
 
 attribute vec3 aPositionVertex;
+#ifdef QUANTIZED_ATTRIBUTES
+attribute vec2 aNormalVertex;
+uniform mat4 uPositionDecode;
+uniform vec4 uTextureDecode;
+#else
 attribute vec3 aNormalVertex;
+#endif
 attribute vec2 aTextureVertex;
 
 uniform mat4 uPMatrix;
-uniform mat4 uMVMatrix;
+// world matrix of the mesh, the view of the camera is applied on its own
+uniform mat4 uMMatrix;
+uniform mat4 uVMatrix;
 uniform mat4 uNMatrix;
 
+#ifdef INSTANCED
+// transform of each instance in the space of the mesh
+attribute mat4 aInstanceMatrix;
+#endif
+
 #ifdef ARMATURE_SUPPORT
 attribute vec4 aSkinVertex;
+#ifdef QUANTIZED_ATTRIBUTES
+#define SKIN_WEIGHT_SCALE (1.0/255.0)
+#else
+#define SKIN_WEIGHT_SCALE 1.0
+#endif
 uniform mat4 uAMatrix[60]; 
 #endif
 
@@ -43,12 +61,12 @@ void applyArmature()
     int i0   = int( aSkinVertex[0] );
     mat4 m0  = uAMatrix[i0*2];
     mat4 n0  = uAMatrix[i0*2 + 1];
-    float w0 = aSkinVertex[2];
+    float w0 = aSkinVertex[2] * SKIN_WEIGHT_SCALE;
     
     int i1   = int( aSkinVertex[1] );
     mat4 m1  = uAMatrix[i1*2];
     mat4 n1  = uAMatrix[i1*2 + 1];
-    float w1 = aSkinVertex[3];
+    float w1 = aSkinVertex[3] * SKIN_WEIGHT_SCALE;
 	
 	vec4 position0 = m0 * vPosition;
 	vec4 normal0   = n0 * vNormal;
@@ -61,19 +79,46 @@ void applyArmature()
 }
 #endif
 
+#ifdef QUANTIZED_ATTRIBUTES
+// normals are octahedron encoded, the lower half of the octahedron is 
+// unfolded over the corners of the square
+vec3 decodeNormal( vec2 e )
+{
+    vec3 n = vec3( e.xy, 1.0 - abs( e.x ) - abs( e.y ) );
+    float t = max( -n.z, 0.0 );
+    n.x += ( n.x >= 0.0 ) ? -t : t;
+    n.y += ( n.y >= 0.0 ) ? -t : t;
+    return normalize( n );
+}
+#endif
+
 void main(void) 
 {
+#ifdef QUANTIZED_ATTRIBUTES
+    vNormal = vec4(decodeNormal(aNormalVertex), 1.0);
+	vPosition = uPositionDecode * vec4(aPositionVertex, 1.0);
+#else
     vNormal = vec4(aNormalVertex, 1.0);
 	vPosition = vec4(aPositionVertex, 1.0);
+#endif
 	
 #ifdef ARMATURE_SUPPORT	
 	applyArmature();
 #endif
 	
-	vNormal = uNMatrix * vNormal;
-	vPosition = uMVMatrix * vPosition;
+#ifdef INSTANCED
+	vNormal = vec4((aInstanceMatrix * vec4(vNormal.xyz, 0.0)).xyz, 1.0);
+	vPosition = aInstanceMatrix * vPosition;
+#endif
+	
+	vNormal = uVMatrix * vec4((uNMatrix * vNormal).xyz, 0.0);
+	vPosition = uVMatrix * (uMMatrix * vPosition);
 	vpPosition = uPMatrix * vPosition;
 	gl_Position = vpPosition;
+#ifdef QUANTIZED_ATTRIBUTES
+	vKdMapCoord = uTextureDecode.xy * aTextureVertex + uTextureDecode.zw;
+#else
 	vKdMapCoord = aTextureVertex;
+#endif
 }
 
@@ -23,7 +23,8 @@ attribute vec3 aNormalVertex;
 attribute vec2 aTextureVertex;
 
 uniform mat4 uPMatrix;
-uniform mat4 uMVMatrix;
+uniform mat4 uMMatrix;
+uniform mat4 uVMatrix;
 uniform mat4 uNMatrix;
 
 varying vec2 vKdMapCoord;
@@ -37,11 +38,11 @@ varying highp vec4 lightPosition;
 
 void main(void) 
 {
-	vNormal = uNMatrix * vec4(aNormalVertex, 1.0);
-	vPosition = uMVMatrix * vec4(aPositionVertex, 1.0);
+	vNormal = uVMatrix * vec4((uNMatrix * vec4(aNormalVertex, 1.0)).xyz, 0.0);
+	vPosition = uVMatrix * (uMMatrix * vec4(aPositionVertex, 1.0));
 	vpPosition = uPMatrix * vPosition;
 	gl_Position = vpPosition;
-	lightPosition = uMVMatrix * vec4(0, 5, 0, 1.0);	
+	lightPosition = uVMatrix * (uMMatrix * vec4(0, 5, 0, 1.0));	
 	vKdMapCoord = aTextureVertex;
 }
 
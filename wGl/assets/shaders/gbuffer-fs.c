@@ -0,0 +1,56 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Single pass version of normaldepth-fs, position-fs and colorspec-fs.
+// The attachment order has to match GRenderDeferredStrategy.initGBufferMrt
+//   gl_FragData[0]: normal and depth (normaldepth-fs)
+//   gl_FragData[1]: eye space position (position-fs)
+//   gl_FragData[2]: diffuse color and specular (colorspec-fs)
+
+#extension GL_EXT_draw_buffers : require
+
+precision mediump float;
+
+uniform vec4 uKs;
+
+uniform vec4 uKd;
+uniform sampler2D uMapKd;
+uniform vec2 uMapKdScale;
+
+varying vec2 vKdMapCoord;
+
+varying highp vec4 vNormal;
+varying highp vec4 vPosition;
+varying highp vec4 vpPosition;
+
+void main(void)
+{
+    highp float depth = vpPosition.z/vpPosition.w;
+    
+    highp vec3 materialDiffuseColor = mix(texture2D(uMapKd, 
+                                          vec2(vKdMapCoord.s / uMapKdScale.s, 
+                                               vKdMapCoord.t / uMapKdScale.t)), 
+                                          uKd, 
+                                          uKd.a).xyz;
+    
+    gl_FragData[0] = vec4(vNormal.xyz, depth);
+    gl_FragData[1] = vec4(vPosition.xyz, 1);
+    gl_FragData[2] = vec4(materialDiffuseColor, uKs.x);
+}
@@ -154,7 +154,17 @@ LoadState.prototype.enter = function ()
 	
 	this.envLoader = new GObjLoader(this.scene, this.officeGroup);
 	this.envLoader.setObserver(this);
+	this.envLoader.setDecodePool(this.oData.context.getDecodePool());
+	this.envLoader.setJobScheduler(this.oData.context.getJobScheduler());
 	this.envLoader.enableAutoMergeByMaterial();
+	this.envLoader.enableLod();
+	this.envLoader.enableInstancing();
+	this.envLoader.enableOccluders();
+	this.scene.setOcclusionCulling( true );
+	if ( this.oData.context.isUintIndexSupported() )
+	{
+	    this.envLoader.enableUintIndices();
+	}
 
 	var hash = "bluefalcon";
 	
@@ -241,7 +251,7 @@ LoadState.prototype.exit = function ()
  */
 LoadState.prototype.update = function ( time ) 
 {
-    this.envLoader.update(time);
+    // the loaders run on the job scheduler of the context
 };
  
  /**
@@ -273,7 +283,7 @@ LoadState.prototype.onObjLoaderCompleted = function ( loader )
  */
 LoadState.prototype.onObjLoaderProgress = function ( loader, progress ) 
 {
-	var tProgress = this.envLoader.totalProgress ;
+	var tProgress = this.oData.context.getJobScheduler().getProgress();
 	this.ui.pFg.setDrawRec( .7*(tProgress-1), 0, tProgress*.7, .05);
 };
 
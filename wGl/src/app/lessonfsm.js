@@ -190,13 +190,27 @@ LoadState.prototype.enter = function ()
 	
 	this.envLoader = new GObjLoader(this.scene, this.officeGroup);
 	this.envLoader.setObserver(this);
+	this.envLoader.setDecodePool(this.oData.context.getDecodePool());
+	this.envLoader.setJobScheduler(this.oData.context.getJobScheduler());
 	this.envLoader.enableAutoMergeByMaterial();
+	this.envLoader.enableLod();
+	this.envLoader.enableInstancing();
+	this.envLoader.enableOccluders();
+	this.scene.setOcclusionCulling( true );
+	if ( this.oData.context.isUintIndexSupported() )
+	{
+	    this.envLoader.enableUintIndices();
+	}
 	
 	this.penLoader = new GObjLoader(this.scene, this.penGroup);
 	this.penLoader.setObserver(this);
+	this.penLoader.setDecodePool(this.oData.context.getDecodePool());
+	this.penLoader.setJobScheduler(this.oData.context.getJobScheduler());
 	
 	this.tjsLoader = new ThreejsLoader(this.scene, this.humanoidGroup );
 	this.tjsLoader.setObserver(this);
+	this.tjsLoader.setDecodePool(this.oData.context.getDecodePool());
+	this.tjsLoader.setJobScheduler(this.oData.context.getJobScheduler());
     
     
 	this.envLoader.loadObj("assets/3d/office3d/", "object.obj");
@@ -326,9 +340,7 @@ LoadState.prototype.exit = function ()
  */
 LoadState.prototype.update = function ( time ) 
 {
-    this.envLoader.update(time);
-	this.penLoader.update(time);
-	this.tjsLoader.update(time);
+    // the loaders run on the job scheduler of the context
 };
  
  /**
@@ -360,7 +372,7 @@ LoadState.prototype.onObjLoaderCompleted = function ( loader )
  */
 LoadState.prototype.onObjLoaderProgress = function ( loader, progress ) 
 {
-	var tProgress = (this.penLoader.totalProgress + this.envLoader.totalProgress + this.tjsLoader.totalProgress)/3;
+	var tProgress = this.oData.context.getJobScheduler().getProgress();
 	this.ui.pFg.setDrawRec( .7*(tProgress-1), 0, tProgress*.7, .05);
 };
 
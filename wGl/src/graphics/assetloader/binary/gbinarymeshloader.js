@@ -0,0 +1,292 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * @interface
+ */
+function GBinaryMeshLoaderObserver () {}
+
+/**
+ * This function gets called whenever the observed loader completes the loading process
+ * @param {GBinaryMeshLoader} Loader object completing the load operation.
+ */
+GBinaryMeshLoaderObserver.prototype.onBinaryMeshLoaderCompleted = function ( loader ) {};
+
+/**
+ * @param {GBinaryMeshLoader}
+ * @param {number} progress Progress value
+ */
+GBinaryMeshLoaderObserver.prototype.onBinaryMeshLoaderProgress = function ( loader, progress ) {};
+
+/**
+ * @param {ArmatureAnimator} New armature animator connected to a loaded skinned mesh
+ */
+GBinaryMeshLoaderObserver.prototype.onBinaryMeshLoaderArmatureAnimatorLoaded = function ( animator ) {};
+
+/**
+ * Loads the binary mesh containers written by tools/wglmesh.js.  The attribute
+ * streams are uploaded straight from views over the downloaded buffer.
+ * @constructor
+ * @implements {GJob}
+ * @param {GScene} Target scene for this loader
+ * @param {GGroup} Target group for this loader
+ */
+function GBinaryMeshLoader( scene, group )
+{
+	this.scene = scene;
+	this.group = group;
+	this.isDownloadComplete = false;
+	this.isReadComplete = false;
+	this.downloadProgress = 0;
+	this.buffer = undefined;
+	this.observer = undefined;
+	this.container = undefined;
+	this.meshIndex = 0;
+	this.isDownloadFailed = false;
+	this.scheduler = undefined;
+	this.ownsScheduler = false;
+}
+
+/**
+ * Run the loading work on the provided scheduler, usually the one of the
+ * context.  Without one the loader runs its own and has to be updated.
+ * @param {GJobScheduler} scheduler
+ */
+GBinaryMeshLoader.prototype.setJobScheduler = function( scheduler )
+{
+    this.scheduler = scheduler;
+};
+
+/**
+ * This function loads a binary mesh file
+ * @param {string} Path for the mesh file and it's resources
+ * @source {string} Mesh file that needs to be loaded
+ */
+GBinaryMeshLoader.prototype.loadMesh = function ( path, source )
+{
+    this.isDownloadComplete = false;
+    this.isReadComplete = false;
+    this.currentPath = path;
+    
+    if ( undefined === this.scheduler )
+    {
+        this.scheduler = new GJobScheduler();
+        this.ownsScheduler = true;
+    }
+    
+    this.scheduler.addJob( this );
+    
+    this.client = new XMLHttpRequest();
+    this.client.open('GET', path + source);
+    this.client.responseType = "arraybuffer";
+    this.client.onprogress = function(e)
+    {
+        if ( e.lengthComputable )
+        {
+            this.downloadProgress = e.loaded / e.total;
+        }
+    }.bind(this);
+    this.client.onload = function(e)
+    {
+        if ( this.client.status === 200 )
+        {
+            this.buffer = this.client.response;
+            this.downloadProgress = 1;
+            this.isDownloadComplete = true;
+        }
+        else
+        {
+            console.debug( "GBinaryMeshLoader: could not load [" + path + source + "]" );
+            this.isDownloadFailed = true;
+        }
+    }.bind(this);
+    this.client.onerror = function(e)
+    {
+        console.debug( "GBinaryMeshLoader: could not load [" + path + source + "]" );
+        this.isDownloadFailed = true;
+    }.bind(this);
+    this.client.send();
+};
+
+/**
+ * Update this loader, only needed when no scheduler was provided with
+ * setJobScheduler
+ * @param {number} Milliseconds since the last update
+ */
+GBinaryMeshLoader.prototype.update = function ( time )
+{
+    if ( this.ownsScheduler )
+    {
+        this.scheduler.update( time );
+    }
+};
+
+/**
+ * @return {number} Parsing the container first, then uploading its meshes
+ */
+GBinaryMeshLoader.prototype.getPriority = function ()
+{
+    return ( undefined === this.container ) ? GJobScheduler.PRIORITY_PARSE : GJobScheduler.PRIORITY_UPLOAD;
+};
+
+/**
+ * @return {number} Total progress of the loader
+ */
+GBinaryMeshLoader.prototype.getProgress = function ()
+{
+    if ( this.isReadComplete )
+    {
+        return 1;
+    }
+    
+    var meshCount = ( undefined === this.container ) ? 0 : this.container.meshes.length;
+    return this.downloadProgress * 0.9 + ( ( meshCount > 0 ) ? 0.1 * this.meshIndex / meshCount : 0 );
+};
+
+/**
+ * Do the next unit of loading work
+ * @return {number} One of the GJobScheduler.STEP_* values
+ */
+GBinaryMeshLoader.prototype.step = function ()
+{
+    if ( this.isDownloadFailed )
+    {
+        // the file will never arrive, the observer still needs to hear the
+        // loader is done so it does not wait on it
+        this.reportCompleted();
+        return GJobScheduler.STEP_DONE;
+    }
+    
+	if ( this.observer != undefined )
+	{
+		this.observer.onBinaryMeshLoaderProgress( this, this.getProgress() );
+	}
+
+    if ( !this.isDownloadComplete )
+    {
+        return GJobScheduler.STEP_WAITING;
+    }
+    
+    if ( undefined === this.container )
+    {
+        this.container = GBinaryMeshReader.parse( this.buffer );
+        this.buffer = undefined;
+        
+        if ( undefined === this.container )
+        {
+            this.container = { meshes: [] };
+        }
+        else
+        {
+            this.addMtlLibs( this.container );
+        }
+    }
+    else if ( this.meshIndex < this.container.meshes.length )
+    {
+        this.addMesh( this.container, this.meshIndex++ );
+    }
+    else
+    {
+        this.container = undefined;
+        this.reportCompleted();
+        return GJobScheduler.STEP_DONE;
+    }
+    
+    return GJobScheduler.STEP_WORKED;
+};
+
+/**
+ * Mark the load as complete and tell the observer
+ */
+GBinaryMeshLoader.prototype.reportCompleted = function ()
+{
+    this.isReadComplete = true;
+
+    if ( this.observer != undefined )
+    {
+        this.observer.onBinaryMeshLoaderProgress( this, 1 );
+        this.observer.onBinaryMeshLoaderCompleted( this );
+    }
+};
+
+/**
+ * Start loading the material libraries of the parsed container
+ * @param {Object} container Result of GBinaryMeshReader.parse
+ */
+GBinaryMeshLoader.prototype.addMtlLibs = function ( container )
+{
+    var mtlLibs = container.meta['mtlLibs'] || [];
+    
+    for ( var i = 0; i < mtlLibs.length; ++i )
+    {
+        var ldr = new GMtlLoader( this.scene );
+        ldr.setJobScheduler( this.scheduler );
+        ldr.loadMtl( this.currentPath, mtlLibs[i] );
+    }
+};
+
+/**
+ * Create the drawable for one mesh of the parsed container
+ * @param {Object} container Result of GBinaryMeshReader.parse
+ * @param {number} i Index of the mesh
+ */
+GBinaryMeshLoader.prototype.addMesh = function ( container, i )
+{
+    var meta = container.meta;
+    var packed = container.meshes[i];
+    var mesh = new Mesh( packed.verts, packed.tverts, packed.normals, packed.indices, packed.name );
+
+    if ( undefined === packed.skin )
+    {
+        mesh.setMtlName( packed.mtlName );
+        this.group.addChild( mesh );
+        return;
+    }
+
+    // skinned meshes carry their own material, bones and animations
+    var mtlName = this.currentPath + packed.mtlName;
+    mesh.setMtlName( mtlName );
+
+    if ( undefined !== meta['materials'] )
+    {
+        this.scene.addMaterial( ThreejsLoader.createMaterial( mtlName, meta['materials'][0] ) );
+    }
+
+    var armature = new ArmatureMeshDecorator( mesh, new Skin( packed.skin ),
+                                              ThreejsLoader.createBones( meta['bones'] ) );
+    this.group.addChild( armature );
+
+    var animator = ThreejsLoader.createAnimator( meta['animations'] );
+    animator.setTarget( armature );
+
+    if ( this.observer != undefined )
+    {
+        this.observer.onBinaryMeshLoaderArmatureAnimatorLoaded( animator );
+    }
+};
+
+/**
+ * Set the observer for the loader
+ * @param {GBinaryMeshLoaderObserver} observer Observer that receives updates
+ */
+GBinaryMeshLoader.prototype.setObserver = function ( observer )
+{
+    this.observer = observer;
+};
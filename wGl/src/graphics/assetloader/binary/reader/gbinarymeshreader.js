@@ -0,0 +1,200 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Binary mesh container (.wglm), all values little endian
+//
+// header, 8 uint32
+//     0: magic 'WGLM'
+//     1: version
+//     2: mesh count
+//     3: byte offset of the utf-8 json metadata
+//     4: byte length of the json metadata
+//     5-7: reserved
+//
+// mesh records follow the header, 12 uint32 each
+//     0: vertex count
+//     1: index count
+//     2: bytes per index (2 or 4)
+//     3: byte offset of the positions (3 floats per vertex)
+//     4: byte offset of the texture coordinates (2 floats per vertex)
+//     5: byte offset of the normals (3 floats per vertex)
+//     6: byte offset of the indices
+//     7: byte offset of the skin (4 floats per vertex), 0 if there is none
+//     8-11: reserved
+//
+// every stream starts on a 4 byte boundary so it can be viewed in place.  The
+// metadata holds { "meshes": [ { "name", "mtlName" } ], "mtlLibs": [...] } and
+// for skinned meshes the three.js "bones", "animations" and "materials".
+
+/**
+ * @constructor
+ */
+function GBinaryMeshReader() {}
+
+GBinaryMeshReader.MAGIC = 0x4D4C4757;
+GBinaryMeshReader.VERSION = 1;
+GBinaryMeshReader.HEADER_SIZE = 8;
+GBinaryMeshReader.RECORD_SIZE = 12;
+
+/**
+ * Returns true if typed array views can be laid over the little endian data
+ * @return {boolean}
+ */
+GBinaryMeshReader.isHostLittleEndian = function ()
+{
+    return 1 === new Uint8Array( new Uint16Array( [1] ).buffer )[0];
+};
+
+/**
+ * Parse a container, the attribute streams are views over the provided buffer
+ * @param {ArrayBuffer} buffer
+ * @return {Object|undefined} { meshes: [...], meta: {...} } or undefined if
+ *         the buffer is not a valid container
+ */
+GBinaryMeshReader.parse = function ( buffer )
+{
+    if ( !GBinaryMeshReader.isHostLittleEndian() )
+    {
+        console.debug( "GBinaryMeshReader: big endian hosts are not supported" );
+        return undefined;
+    }
+
+    if ( buffer.byteLength < 4 * GBinaryMeshReader.HEADER_SIZE )
+    {
+        console.debug( "GBinaryMeshReader: truncated header" );
+        return undefined;
+    }
+
+    var header = new Uint32Array( buffer, 0, GBinaryMeshReader.HEADER_SIZE );
+
+    if ( GBinaryMeshReader.MAGIC !== header[0] || GBinaryMeshReader.VERSION !== header[1] )
+    {
+        console.debug( "GBinaryMeshReader: unknown container" );
+        return undefined;
+    }
+
+    var meshCount = header[2];
+
+    // a partial download still has a valid header, every section has to be
+    // checked before a view is laid over it
+    if ( !GBinaryMeshReader.isInBuffer( buffer, 4 * GBinaryMeshReader.HEADER_SIZE,
+                                        4 * meshCount * GBinaryMeshReader.RECORD_SIZE ) ||
+         !GBinaryMeshReader.isInBuffer( buffer, header[3], header[4] ) )
+    {
+        console.debug( "GBinaryMeshReader: truncated container" );
+        return undefined;
+    }
+
+    var meta = undefined;
+
+    try
+    {
+        meta = JSON.parse( GBinaryMeshReader.decodeText( new Uint8Array( buffer, header[3], header[4] ) ) );
+    }
+    catch ( e )
+    {
+        console.debug( "GBinaryMeshReader: bad metadata " + e );
+        return undefined;
+    }
+
+    if ( undefined === meta['meshes'] || meta['meshes'].length < meshCount )
+    {
+        console.debug( "GBinaryMeshReader: metadata does not match the mesh records" );
+        return undefined;
+    }
+
+    var records = new Uint32Array( buffer, 4 * GBinaryMeshReader.HEADER_SIZE,
+                                   meshCount * GBinaryMeshReader.RECORD_SIZE );
+    var meshes = [];
+
+    for ( var i = 0; i < meshCount; ++i )
+    {
+        var r = i * GBinaryMeshReader.RECORD_SIZE;
+        var vertCount = records[r];
+        var indexCount = records[r+1];
+        var indexSize = records[r+2];
+
+        if ( ( 2 !== indexSize && 4 !== indexSize ) ||
+             !GBinaryMeshReader.isInBuffer( buffer, records[r+3], 12 * vertCount ) ||
+             !GBinaryMeshReader.isInBuffer( buffer, records[r+4], 8 * vertCount ) ||
+             !GBinaryMeshReader.isInBuffer( buffer, records[r+5], 12 * vertCount ) ||
+             !GBinaryMeshReader.isInBuffer( buffer, records[r+6], indexSize * indexCount ) ||
+             ( 0 !== records[r+7] && 
+               !GBinaryMeshReader.isInBuffer( buffer, records[r+7], 16 * vertCount ) ) )
+        {
+            console.debug( "GBinaryMeshReader: truncated mesh " + i );
+            return undefined;
+        }
+
+        var mesh = 
+        {
+            name: meta['meshes'][i]['name'],
+            mtlName: meta['meshes'][i]['mtlName'],
+            verts: new Float32Array( buffer, records[r+3], 3 * vertCount ),
+            tverts: new Float32Array( buffer, records[r+4], 2 * vertCount ),
+            normals: new Float32Array( buffer, records[r+5], 3 * vertCount ),
+            indices: ( 2 === indexSize ) ? new Uint16Array( buffer, records[r+6], indexCount ) :
+                                              new Uint32Array( buffer, records[r+6], indexCount ),
+            skin: ( 0 !== records[r+7] ) ? new Float32Array( buffer, records[r+7], 4 * vertCount ) : undefined
+        };
+
+        meshes.push( mesh );
+    }
+
+    return { meshes: meshes, meta: meta };
+};
+
+/**
+ * Returns true if a section fits in the buffer and starts on a 4 byte 
+ * boundary, as every section of a valid container does
+ * @param {ArrayBuffer} buffer
+ * @param {number} offset Byte offset of the section
+ * @param {number} length Byte length of the section
+ * @return {boolean}
+ */
+GBinaryMeshReader.isInBuffer = function ( buffer, offset, length )
+{
+    return 0 === offset % 4 && offset + length <= buffer.byteLength;
+};
+
+/**
+ * Decode utf-8 bytes into a string
+ * @param {Uint8Array} bytes
+ * @return {string}
+ */
+GBinaryMeshReader.decodeText = function ( bytes )
+{
+    // The closure compiler has problems accessing members of newer apis
+    // unless they are called like this
+    var decoderType = ( typeof self !== "undefined" ) ? self['TextDecoder'] : undefined;
+
+    if ( undefined !== decoderType )
+    {
+        return new decoderType( "utf-8" )['decode']( bytes );
+    }
+
+    var ret = "";
+    for ( var i = 0; i < bytes.length; i += 8192 )
+    {
+        ret += String.fromCharCode.apply( null, bytes.subarray( i, i + 8192 ) );
+    }
+
+    return decodeURIComponent( escape( ret ) );
+};
@@ -0,0 +1,137 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// KTX 1.1 texture container (https://www.khronos.org/opengles/sdk/tools/KTX/)
+//
+// 12 byte identifier followed by 13 uint32 in the byte order of the writer
+//     0: endianness 0x04030201
+//     1: glType (0 for compressed formats)
+//     2: glTypeSize
+//     3: glFormat (0 for compressed formats)
+//     4: glInternalFormat
+//     5: glBaseInternalFormat
+//     6: pixelWidth
+//     7: pixelHeight
+//     8: pixelDepth (0 for 2d textures)
+//     9: numberOfArrayElements (0)
+//    10: numberOfFaces (1)
+//    11: numberOfMipmapLevels
+//    12: bytesOfKeyValueData
+//
+// the key/value data is skipped, then every mip level is a uint32 byte count
+// followed by the data padded to 4 bytes.  Only 2d textures without array
+// elements or faces are read.
+
+/**
+ * @constructor
+ */
+function GKtxReader() {}
+
+GKtxReader.IDENTIFIER = [ 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A ];
+GKtxReader.HEADER_SIZE = 64;
+GKtxReader.ENDIANNESS = 0x04030201;
+
+/**
+ * Parse a container, the mip levels are views over the provided buffer
+ * @param {ArrayBuffer} buffer
+ * @return {Object|undefined} { internalFormat, format, type, width, height, 
+ *         levels: [ { width, height, data } ] } or undefined if the buffer is
+ *         not a texture this reader understands
+ */
+GKtxReader.parse = function ( buffer )
+{
+    if ( buffer.byteLength < GKtxReader.HEADER_SIZE )
+    {
+        console.debug( "GKtxReader: truncated header" );
+        return undefined;
+    }
+    
+    var bytes = new Uint8Array( buffer );
+    var i = 0;
+    
+    for ( i = 0; i < GKtxReader.IDENTIFIER.length; ++i )
+    {
+        if ( GKtxReader.IDENTIFIER[i] !== bytes[i] )
+        {
+            console.debug( "GKtxReader: unknown container" );
+            return undefined;
+        }
+    }
+    
+    var view = new DataView( buffer );
+    var little = ( GKtxReader.ENDIANNESS === view.getUint32( 12, true ) );
+    var header = [];
+    
+    for ( i = 0; i < 13; ++i )
+    {
+        header.push( view.getUint32( 12 + 4*i, little ) );
+    }
+    
+    if ( GKtxReader.ENDIANNESS !== header[0] )
+    {
+        console.debug( "GKtxReader: bad endianness marker" );
+        return undefined;
+    }
+    
+    if ( header[8] > 1 || header[9] > 1 || header[10] !== 1 )
+    {
+        console.debug( "GKtxReader: only 2d textures are supported" );
+        return undefined;
+    }
+    
+    var texture = 
+    {
+        type: header[1],
+        format: header[3],
+        internalFormat: header[4],
+        width: header[6],
+        height: header[7],
+        levels: []
+    };
+    
+    var levelCount = Math.max( 1, header[11] );
+    var offset = GKtxReader.HEADER_SIZE + header[12];
+    
+    for ( i = 0; i < levelCount; ++i )
+    {
+        if ( offset + 4 > buffer.byteLength )
+        {
+            console.debug( "GKtxReader: truncated mip level " + i );
+            return undefined;
+        }
+        
+        var size = view.getUint32( offset, little );
+        offset += 4;
+        
+        if ( offset + size > buffer.byteLength )
+        {
+            console.debug( "GKtxReader: truncated mip level " + i );
+            return undefined;
+        }
+        
+        texture.levels.push( { width: Math.max( 1, texture.width >> i ),
+                               height: Math.max( 1, texture.height >> i ),
+                               data: new Uint8Array( buffer, offset, size ) } );
+        
+        offset += ( size + 3 ) & ~3;
+    }
+    
+    return texture;
+};
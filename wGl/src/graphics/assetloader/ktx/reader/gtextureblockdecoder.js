@@ -0,0 +1,278 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Decompresses the block compressed texture formats written by 
+ * tools/wgltexture.js into RGBA8 for contexts without the matching 
+ * compressed texture extension.
+ * @constructor
+ */
+function GTextureBlockDecoder() {}
+
+GTextureBlockDecoder.COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1;
+GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+GTextureBlockDecoder.ETC1_RGB8 = 0x8D64;
+
+/**
+ * Modifier tables of ETC1, small and large value of each table
+ */
+GTextureBlockDecoder.ETC1_MODIFIERS = [ [ 2, 8 ], [ 5, 17 ], [ 9, 29 ], [ 13, 42 ], 
+                                        [ 18, 60 ], [ 24, 80 ], [ 33, 106 ], [ 47, 183 ] ];
+
+/**
+ * Returns true if the provided internal format can be decompressed
+ * @param {number} internalFormat
+ * @return {boolean}
+ */
+GTextureBlockDecoder.canDecode = function( internalFormat )
+{
+    return GTextureBlockDecoder.COMPRESSED_RGB_S3TC_DXT1 === internalFormat ||
+           GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT1 === internalFormat ||
+           GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT5 === internalFormat ||
+           GTextureBlockDecoder.ETC1_RGB8 === internalFormat;
+};
+
+/**
+ * Decompress one mip level
+ * @param {number} internalFormat
+ * @param {Uint8Array} data Blocks of the level
+ * @param {number} width
+ * @param {number} height
+ * @return {Uint8Array} width * height RGBA8 pixels
+ */
+GTextureBlockDecoder.decode = function( internalFormat, data, width, height )
+{
+    var out = new Uint8Array( 4 * width * height );
+    var block = new Uint8Array( 64 );
+    var blocksX = ( width + 3 ) >> 2;
+    var blocksY = ( height + 3 ) >> 2;
+    var blockSize = ( GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT5 === internalFormat ) ? 16 : 8;
+    
+    for ( var by = 0; by < blocksY; ++by )
+    {
+        for ( var bx = 0; bx < blocksX; ++bx )
+        {
+            var offset = blockSize * ( by * blocksX + bx );
+            
+            if ( GTextureBlockDecoder.ETC1_RGB8 === internalFormat )
+            {
+                GTextureBlockDecoder.decodeEtc1Block( data, offset, block );
+            }
+            else if ( 16 === blockSize )
+            {
+                GTextureBlockDecoder.decodeDxtColorBlock( data, offset + 8, block, false );
+                GTextureBlockDecoder.decodeDxt5AlphaBlock( data, offset, block );
+            }
+            else
+            {
+                GTextureBlockDecoder.decodeDxtColorBlock( data, offset, block, true );
+            }
+            
+            // copy the part of the block that is inside the level
+            for ( var y = 0; y < 4 && 4*by + y < height; ++y )
+            {
+                for ( var x = 0; x < 4 && 4*bx + x < width; ++x )
+                {
+                    var o = 4 * ( ( 4*by + y ) * width + 4*bx + x );
+                    var p = 4 * ( 4*y + x );
+                    
+                    out[o]   = block[p];
+                    out[o+1] = block[p+1];
+                    out[o+2] = block[p+2];
+                    out[o+3] = block[p+3];
+                }
+            }
+        }
+    }
+    
+    return out;
+};
+
+/**
+ * Decode the color part of a DXT block, two 565 end points followed by 2 bit
+ * indices in row order
+ * @param {Uint8Array} data
+ * @param {number} offset
+ * @param {Uint8Array} block Receives 16 RGBA pixels
+ * @param {boolean} allowTransparent True for DXT1 where color0 <= color1 
+ *                  selects the 3 color mode with transparent black
+ */
+GTextureBlockDecoder.decodeDxtColorBlock = function( data, offset, block, allowTransparent )
+{
+    var c0 = data[offset] | ( data[offset+1] << 8 );
+    var c1 = data[offset+2] | ( data[offset+3] << 8 );
+    var palette = [ GTextureBlockDecoder.expand565( c0 ), GTextureBlockDecoder.expand565( c1 ), [], [] ];
+    var k = 0;
+    
+    if ( c0 > c1 || !allowTransparent )
+    {
+        for ( k = 0; k < 3; ++k )
+        {
+            palette[2][k] = ( 2 * palette[0][k] + palette[1][k] + 1 ) / 3 | 0;
+            palette[3][k] = ( palette[0][k] + 2 * palette[1][k] + 1 ) / 3 | 0;
+        }
+        
+        palette[2][3] = 255;
+        palette[3][3] = 255;
+    }
+    else
+    {
+        for ( k = 0; k < 3; ++k )
+        {
+            palette[2][k] = ( palette[0][k] + palette[1][k] ) >> 1;
+            palette[3][k] = 0;
+        }
+        
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+    
+    for ( var i = 0; i < 16; ++i )
+    {
+        var index = ( data[offset + 4 + (i >> 2)] >> ( 2 * ( i & 3 ) ) ) & 3;
+        
+        block[4*i]   = palette[index][0];
+        block[4*i+1] = palette[index][1];
+        block[4*i+2] = palette[index][2];
+        block[4*i+3] = palette[index][3];
+    }
+};
+
+/**
+ * Decode the alpha part of a DXT5 block, two 8 bit end points followed by 3
+ * bit indices in row order
+ * @param {Uint8Array} data
+ * @param {number} offset
+ * @param {Uint8Array} block Receives the alpha of 16 RGBA pixels
+ */
+GTextureBlockDecoder.decodeDxt5AlphaBlock = function( data, offset, block )
+{
+    var a0 = data[offset];
+    var a1 = data[offset+1];
+    var palette = [ a0, a1 ];
+    var i = 0;
+    
+    if ( a0 > a1 )
+    {
+        for ( i = 1; i < 7; ++i )
+        {
+            palette.push( ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7 | 0 );
+        }
+    }
+    else
+    {
+        for ( i = 1; i < 5; ++i )
+        {
+            palette.push( ( ( 5 - i ) * a0 + i * a1 + 2 ) / 5 | 0 );
+        }
+        
+        palette.push( 0, 255 );
+    }
+    
+    // 48 bits of indices, read as two 24 bit halves to stay in int range
+    for ( var half = 0; half < 2; ++half )
+    {
+        var o = offset + 2 + 3 * half;
+        var bits = data[o] | ( data[o+1] << 8 ) | ( data[o+2] << 16 );
+        
+        for ( i = 0; i < 8; ++i )
+        {
+            block[4 * ( 8*half + i ) + 3] = palette[( bits >> ( 3*i ) ) & 7];
+        }
+    }
+};
+
+/**
+ * Decode an ETC1 block, the 64 bits are big endian and the pixel indices are
+ * stored in column order
+ * @param {Uint8Array} data
+ * @param {number} offset
+ * @param {Uint8Array} block Receives 16 RGBA pixels
+ */
+GTextureBlockDecoder.decodeEtc1Block = function( data, offset, block )
+{
+    var flip = data[offset+3] & 1;
+    var diff = data[offset+3] & 2;
+    var base = [ [], [] ];
+    var k = 0;
+    
+    for ( k = 0; k < 3; ++k )
+    {
+        var b = data[offset+k];
+        
+        if ( diff )
+        {
+            var c = b >> 3;
+            var d = ( b & 4 ) ? ( b & 7 ) - 8 : ( b & 7 );
+            
+            base[0][k] = ( c << 3 ) | ( c >> 2 );
+            base[1][k] = ( ( c + d ) << 3 ) | ( ( c + d ) >> 2 );
+        }
+        else
+        {
+            base[0][k] = ( b & 0xF0 ) | ( b >> 4 );
+            base[1][k] = ( ( b & 0x0F ) << 4 ) | ( b & 0x0F );
+        }
+    }
+    
+    var tables = [ GTextureBlockDecoder.ETC1_MODIFIERS[data[offset+3] >> 5], 
+                   GTextureBlockDecoder.ETC1_MODIFIERS[( data[offset+3] >> 2 ) & 7] ];
+    var msb = ( data[offset+4] << 8 ) | data[offset+5];
+    var lsb = ( data[offset+6] << 8 ) | data[offset+7];
+    
+    for ( var x = 0; x < 4; ++x )
+    {
+        for ( var y = 0; y < 4; ++y )
+        {
+            var i = 4*x + y;
+            var sub = flip ? ( y >> 1 ) : ( x >> 1 );
+            var index = ( ( ( msb >> i ) & 1 ) << 1 ) | ( ( lsb >> i ) & 1 );
+            var modifier = tables[sub][index & 1];
+            
+            if ( index & 2 )
+            {
+                modifier = -modifier;
+            }
+            
+            var p = 4 * ( 4*y + x );
+            for ( k = 0; k < 3; ++k )
+            {
+                block[p+k] = Math.max( 0, Math.min( 255, base[sub][k] + modifier ) );
+            }
+            
+            block[p+3] = 255;
+        }
+    }
+};
+
+/**
+ * Expand a 565 color to 8 bits per channel
+ * @param {number} c
+ * @return {Array.<number>}
+ */
+GTextureBlockDecoder.expand565 = function( c )
+{
+    var r = ( c >> 11 ) & 31;
+    var g = ( c >> 5 ) & 63;
+    var b = c & 31;
+    
+    return [ ( r << 3 ) | ( r >> 2 ), ( g << 2 ) | ( g >> 4 ), ( b << 3 ) | ( b >> 2 ), 255 ];
+};
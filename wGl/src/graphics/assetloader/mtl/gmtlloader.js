@@ -20,40 +20,144 @@
 
 /**
  * @constructor
+ * @implements {GJob}
  * @param {GScene}  Scene object that will receive the loaded GMaterial objects
  */
 function GMtlLoader( scene )
 {
 	this.client = new XMLHttpRequest();
 	this.target = scene;
+	this.scheduler = undefined;
+	this.pendingRequests = 0;
+	this.mtlReader = undefined;
+	this.materials = undefined;
+	this.materialIndex = 0;
 }
+
+/**
+ * Add the materials from the provided scheduler, one per step.  Without one
+ * they are all added as soon as the file is downloaded.
+ * @param {GJobScheduler|undefined} scheduler
+ */
+GMtlLoader.prototype.setJobScheduler = function( scheduler )
+{
+    this.scheduler = scheduler;
+};
 	
 /**
- * Load a new material file using the current bindings
+ * Load a new material file using the current bindings.  The manifest of the
+ * compressed texture variants (<source>.ktx.json) is requested alongside, the
+ * materials are created once both requests are done.
  * @param {string} Path to the material file and it's assets
  * @param {string} Material file that needs to be loaded
  */
 GMtlLoader.prototype.loadMtl = function ( path, source )
 {
+    var manifestClient = new XMLHttpRequest();
+    this.pendingRequests = 2;
+    
+    var onDone = function()
+    {
+        if ( --this.pendingRequests > 0 )
+        {
+            return;
+        }
+        
+        var variants = undefined;
+        
+        if ( 200 === manifestClient.status && manifestClient.responseText.length > 0 )
+        {
+            try
+            {
+                variants = JSON.parse( manifestClient.responseText );
+            }
+            catch ( e )
+            {
+                console.debug( "GMtlLoader: bad texture manifest for " + source );
+            }
+        }
+        
+        var mtlFile = this.client.responseText.split("\n");
+        
+        this.mtlReader = new GMtlReader (mtlFile, path, variants);
+        
+        if ( undefined === this.scheduler )
+        {
+            while ( GJobScheduler.STEP_DONE !== this.step() ) {}
+        }
+    }.bind(this);
+    
+    if ( undefined !== this.scheduler )
+    {
+        this.scheduler.addJob( this );
+    }
+    
+    manifestClient.open('GET', path + source + ".ktx.json");
+    manifestClient.onreadystatechange = function() 
+    {
+        if ( manifestClient.readyState === 4 )
+        {
+            onDone();
+        }
+    };
+    manifestClient.send();
+    
     this.client.open('GET', path + source);
     this.client.onreadystatechange = function() 
     {
         if ( this.client.readyState === 4 )
         {
-            var i = 0;
-            var mtlFile = this.client.responseText.split("\n");
-            
-            var mtlReader = new GMtlReader (mtlFile, path);
-            
-            var mtls = mtlReader.getMaterials();
-            
-            for (var key in mtls)
-            {
-                this.target.addMaterial(mtls[key]);
-            }				
+            onDone();
         }
     }.bind(this);
     this.client.send();
 };
 
+/**
+ * @return {number} Adding materials starts the texture downloads, it goes 
+ *         with the parsing
+ */
+GMtlLoader.prototype.getPriority = function ()
+{
+    return GJobScheduler.PRIORITY_PARSE;
+};
+
+/**
+ * @return {number} Share of the materials added to the scene
+ */
+GMtlLoader.prototype.getProgress = function ()
+{
+    return ( undefined === this.materials || 0 === this.materials.length ) ? 0 : 
+           this.materialIndex / this.materials.length;
+};
 
+/**
+ * Add the next material to the scene
+ * @return {number} One of the GJobScheduler.STEP_* values
+ */
+GMtlLoader.prototype.step = function ()
+{
+    if ( undefined === this.mtlReader )
+    {
+        return GJobScheduler.STEP_WAITING;
+    }
+    
+    if ( undefined === this.materials )
+    {
+        var mtls = this.mtlReader.getMaterials();
+        
+        this.materials = [];
+        for (var key in mtls)
+        {
+            this.materials.push( mtls[key] );
+        }
+    }
+    
+    if ( this.materialIndex < this.materials.length )
+    {
+        this.target.addMaterial( this.materials[this.materialIndex++] );
+        return GJobScheduler.STEP_WORKED;
+    }
+    
+    return GJobScheduler.STEP_DONE;
+};
@@ -22,10 +22,13 @@
  * @constructor
  * @param {Array.<string> Contents of the mtl file.  Each element is a new line
  * @param {string} Path to the location of the mtl resources
+ * @param {Object=} Block compressed variants of the textures hashed by texture
+ *                  name, as written to <mtl>.ktx.json by tools/wgltexture.js
  */
-function GMtlReader( mtlStrA, path )
+function GMtlReader( mtlStrA, path, compressedVariants )
 {
 	this.path = path;
+	this.compressedVariants = compressedVariants || {};
 	this.materials = {};
 	this.currentMtl = undefined;
 	
@@ -164,7 +167,7 @@ GMtlReader.prototype.process_mapKd = function( lineA )
 		texArgs.push(lineA[i]);
 	}
 	
-	var texture = new GTexture(texArgs, this.path);
+	var texture = this.createTexture(texArgs);
 	
 	this.currentMtl.setMapKd(texture);
 };
@@ -182,7 +185,25 @@ GMtlReader.prototype.process_mapBump = function( lineA )
 		texArgs.push(lineA[i]);
 	}
 	
-	var texture = new GTexture(texArgs, this.path);
+	var texture = this.createTexture(texArgs);
 	
 	this.currentMtl.setMapBump(texture);
 };
+
+/**
+ * Create a texture, using the compressed variants when there are some
+ * @param {Array.<string>} Texture arguments of the current line
+ * @return {GTexture}
+ */
+GMtlReader.prototype.createTexture = function( texArgs )
+{
+	var texture = new GTexture(texArgs, this.path);
+	var variants = this.compressedVariants[texture.getName()];
+	
+	if ( undefined !== variants )
+	{
+		texture.setCompressedVariants(variants);
+	}
+	
+	return texture;
+};
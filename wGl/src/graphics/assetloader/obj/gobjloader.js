@@ -38,28 +38,70 @@ GObjLoaderObserver.prototype.onObjLoaderProgress = function ( loader, progress )
 /**
  * @constructor
  * @implements {GObjReaderObserver}
+ * @implements {GDecodeJobObserver}
+ * @implements {GJob}
  * @param {GScene} Target scene for this loader
  * @param {GGroup} Target group for this loader
  */
 function GObjLoader( scene, group )
 {
-	this.client = new XMLHttpRequest();
 	this.scene = scene;
 	this.group = group;
 	this.isDownloadComplete = false;
 	this.isReaderReady = false;
 	this.isReadComplete = false;
+	this.isDownloadFailed = false;
 	this.insertIndex = 0;
-	this.availableTime = 17;
 	this.downloadProgress = 0;
 	this.processProgress = 0;
-	this.objLineCount = 0;
-	this.objLinesProcessed = 0;
+	this.bytesTotal = 0;
+	this.bytesDownloaded = 0;
+	this.chunkQueue = [];
+	this.chunkOffset = 0;
 	this.totalProgress = 0;
 	this.autoMergeByMaterial = false;
-	this.deferredMeshMap = {};
+	this.lodEnabled = false;
+	this.instancingEnabled = false;
+	this.occludersEnabled = false;
+	this.instanceCandidates = [];
+	this.areInstancesResolved = false;
+	this.maxMergeVertCount = GeometryTriMesh.MAX_MERGE_VERT_COUNT;
+	this.mergePlanner = new GMeshMergePlanner();
+	this.decodePool = undefined;
+	this.decodedResult = undefined;
+	this.decodedMeshes = undefined;
+	this.decodedIndex = 0;
+	this.readyMeshes = [];
+	this.lodSimplifier = undefined;
+	this.optimizeQueue = [];
+	this.meshOptimizer = undefined;
+	this.scheduler = undefined;
+	this.ownsScheduler = false;
 }
 
+/**
+ * Number of bytes handed to the reader on each step of the update loop
+ */
+GObjLoader.READ_STEP_SIZE = 16384;
+
+/**
+ * Number of vertices, triangles or edge collapses the simplifier of a level
+ * of detail chain goes through on each step of the update loop
+ */
+GObjLoader.LOD_STEP_SIZE = 256;
+
+/**
+ * Number of vertices, indices, triangles or clusters the optimizer of a mesh
+ * goes through on each step of the update loop
+ */
+GObjLoader.OPTIMIZE_STEP_SIZE = 2048;
+
+/**
+ * Largest number of triangles rasterized for an occluder, denser meshes 
+ * cost more on the CPU than they save on the GPU
+ */
+GObjLoader.MAX_OCCLUDER_TRIANGLES = 4096;
+
 /**
  * Enable auto merging
  */
@@ -69,24 +111,130 @@ GObjLoader.prototype.enableAutoMergeByMaterial = function()
 };
 
 /**
- * This function loads an obj file
+ * Let merged meshes grow past 64K vertices, only to be used when the context
+ * can draw with 32 bit indices
+ */
+GObjLoader.prototype.enableUintIndices = function()
+{
+    this.maxMergeVertCount = GeometryTriMesh.MAX_UINT_MERGE_VERT_COUNT;
+};
+
+/**
+ * Build levels of detail for the larger meshes, these are added as LodMesh
+ * objects that pick their level from the size they have through the scene
+ * camera and are kept out of the merge by material
+ */
+GObjLoader.prototype.enableLod = function()
+{
+    this.lodEnabled = true;
+};
+
+/**
+ * Find the meshes that are translated copies of each other, see 
+ * GInstanceDetector, and add each set as a single InstancedMesh.  The 
+ * copies are kept out of the levels of detail and the merge by material.
+ */
+GObjLoader.prototype.enableInstancing = function()
+{
+    this.instancingEnabled = true;
+};
+
+/**
+ * Make the meshes that are cheap enough to rasterize occluders, see
+ * GScene.setOcclusionCulling.  The levels of detail are rasterized with 
+ * their most detailed level that is cheap enough.
+ */
+GObjLoader.prototype.enableOccluders = function()
+{
+    this.occludersEnabled = true;
+};
+
+/**
+ * Decode the obj file on a worker from the provided pool instead of on the
+ * render thread
+ * @param {GDecodeWorkerPool|undefined} pool
+ */
+GObjLoader.prototype.setDecodePool = function( pool )
+{
+    this.decodePool = pool;
+};
+
+/**
+ * Run the loading work on the provided scheduler, usually the one of the
+ * context.  Without one the loader runs its own and has to be updated.
+ * @param {GJobScheduler} scheduler
+ */
+GObjLoader.prototype.setJobScheduler = function( scheduler )
+{
+    this.scheduler = scheduler;
+};
+
+/**
+ * This function loads an obj file.  The file is streamed so the reader can
+ * parse the chunks that already arrived while the rest is downloading.
  * @param {string} Path for the obj file and it's resources
  * @source {string} Obj file that needs to be loaded
  */
 GObjLoader.prototype.loadObj = function ( path, source )
 {
     this.isDownloadComplete = false;
-    this.client.open('GET', path + source);
+    this.isDownloadFailed = false;
     this.currentPath = path;
-    this.client.onreadystatechange = function(e) 
+    
+    if ( undefined === this.scheduler )
+    {
+        this.scheduler = new GJobScheduler();
+        this.ownsScheduler = true;
+    }
+    
+    this.scheduler.addJob( this );
+
+	this.deferredObjectCount = 0;
+	this.defferedObjectsLeft = 0;
+	this.readyMeshes = [];
+	this.lodSimplifier = undefined;
+	this.optimizeQueue = [];
+	this.meshOptimizer = undefined;
+	this.instanceCandidates = [];
+	this.areInstancesResolved = false;
+	this.mergePlanner = new GMeshMergePlanner( this.maxMergeVertCount );
+
+    if ( undefined !== this.decodePool )
+    {
+        this.loadObjOnWorker( path, source );
+        return;
+    }
+
+    this.reader = new GObjReader( this.currentPath, this.scene, this.group, this );
+    this.isReaderReady = true;
+
+    // The closure compiler has problems accessing members of the fetch api
+    // unless they are called like this
+    if ( undefined !== window['fetch'] && undefined !== window['ReadableStream'] )
     {
-        if ( this.client.readyState === 4 )
+        window['fetch']( path + source ).then( function ( response )
+        {
+            if ( !response['ok'] )
+            {
+                throw new Error( "status " + response['status'] );
+            }
+            
+            // the length of a compressed response says nothing about the 
+            // number of bytes the stream will produce
+            var length = parseInt( response['headers']['get']( "Content-Length" ), 10 );
+            var encoding = response['headers']['get']( "Content-Encoding" );
+            var isEncoded = ( null !== encoding && "identity" !== encoding );
+            this.bytesTotal = ( isNaN( length ) || isEncoded ) ? 0 : length;
+            this.readStream( response['body']['getReader']() );
+        }.bind(this) )['catch']( this.onDownloadFailed.bind(this) );
+    }
+    else
+    {
+        this.client = new XMLHttpRequest();
+        this.client.open('GET', path + source);
+        this.client.responseType = "arraybuffer";
+        this.client.onprogress = function(e)
         {
-            this.isDownloadComplete = true;
-			this.downloadProgress = 1;
-        }
-		else if ( this.client.readyState === 3 )
-		{
 			if ( e.lengthComputable )
 			{
 				this.downloadProgress = e.loaded / e.total;
@@ -95,39 +243,330 @@ GObjLoader.prototype.loadObj = function ( path, source )
 			{
 				this.downloadProgress += (1.0 - this.downloadProgress) / 10.0;
 			}
-		}
+        }.bind(this);
+        this.client.onload = function(e)
+        {
+            if ( !GObjLoader.isStatusOk( this.client.status ) )
+            {
+                this.onDownloadFailed( "status " + this.client.status );
+                return;
+            }
+            
+            var chunk = new Uint8Array( this.client.response );
+            this.bytesTotal = chunk.length;
+            this.onChunkDownloaded( chunk );
+            this.isDownloadComplete = true;
+			this.downloadProgress = 1;
+        }.bind(this);
+        this.client.onerror = function(e)
+        {
+            this.onDownloadFailed( "network error" );
+        }.bind(this);
+        this.client.send();
+    }
+};
+
+/**
+ * Returns true if a finished request holds the file, file:// requests end
+ * with a status of 0
+ * @param {number} status Status of the request
+ * @return {boolean}
+ */
+GObjLoader.isStatusOk = function ( status )
+{
+    return 200 === status || 0 === status;
+};
+
+/**
+ * Download the obj file and hand it to the decode pool
+ * @param {string} Path for the obj file and it's resources
+ * @source {string} Obj file that needs to be loaded
+ */
+GObjLoader.prototype.loadObjOnWorker = function ( path, source )
+{
+    this.client = new XMLHttpRequest();
+    this.client.open('GET', path + source);
+    this.client.responseType = "arraybuffer";
+    this.client.onprogress = function(e)
+    {
+        if ( e.lengthComputable )
+        {
+            this.downloadProgress = e.loaded / e.total;
+        }
+    }.bind(this);
+    this.client.onload = function(e)
+    {
+        if ( !GObjLoader.isStatusOk( this.client.status ) )
+        {
+            this.onDownloadFailed( "status " + this.client.status );
+            return;
+        }
+        
+        this.isDownloadComplete = true;
+        this.downloadProgress = 1;
+        this.decodePool.decode( { 'kind': "obj",
+                                  'buffer': this.client.response,
+                                  'merge': this.autoMergeByMaterial,
+                                  'lod': this.lodEnabled,
+                                  'instancing': this.instancingEnabled,
+                                  'maxMergeVertCount': this.maxMergeVertCount }, this );
+    }.bind(this);
+    this.client.onerror = function(e)
+    {
+        this.onDownloadFailed( "network error" );
     }.bind(this);
     this.client.send();
-	
-	this.deferredObjectCount = 0;
-	this.defferedObjectsLeft = 0;
 };
 
 /**
- * Update this obj loader
- * @param {number} Milliseconds since the last update
+ * This function is called when the decode pool is done with the obj file
+ * @param {Object} result Meshes and material libraries decoded by the worker
  */
-GObjLoader.prototype.update = function ( time )
+GObjLoader.prototype.onDecodeJobCompleted = function ( result )
+{
+    this.decodedResult = result;
+};
+
+/**
+ * Start adding the meshes decoded on the worker to the group, they are added
+ * one per step by addNextDecodedMesh
+ */
+GObjLoader.prototype.addDecodedResult = function ()
+{
+    var result = this.decodedResult;
+
+    this.decodedResult = undefined;
+
+    var mtlLibs = result['mtlLibs'] || [];
+    for ( var i = 0; i < mtlLibs.length; ++i )
+    {
+        this.onMtlLibReferenced( mtlLibs[i] );
+    }
+
+    // merging happened on the worker, the merged meshes are what's left to send
+    var meshes = result['meshes'] || [];
+    this.decodedIndex = 0;
+    this.deferredObjectCount = meshes.length;
+    this.defferedObjectsLeft = meshes.length;
+    this.processProgress = 1;
+
+    // a failed job or an empty file leaves nothing to add
+    if ( 0 === meshes.length )
+    {
+        this.isReadComplete = true;
+        return;
+    }
+
+    this.decodedMeshes = meshes;
+};
+
+/**
+ * Add the next mesh decoded on the worker to the group
+ */
+GObjLoader.prototype.addNextDecodedMesh = function ()
+{
+    var packed = this.decodedMeshes[this.decodedIndex++];
+    var obj = this.createDecodedMesh( packed );
+    var lods = packed['lods'];
+
+    if ( undefined !== lods )
+    {
+        var levels = [ obj ];
+        for ( var j = 0; j < lods.length; ++j )
+        {
+            levels.push( this.createDecodedMesh( lods[j] ) );
+        }
+
+        obj = new LodMesh( levels, this.scene.getCamera() );
+        this.designateOccluder( obj, levels );
+    }
+    else if ( undefined !== packed['instances'] )
+    {
+        obj = this.createInstancedMesh( obj, packed['instances'] );
+    }
+    else
+    {
+        this.designateOccluder( obj );
+    }
+
+    obj.setMtlName( packed['mtlName'] );
+    this.group.addChild( obj );
+    --this.defferedObjectsLeft;
+
+    if ( this.decodedIndex === this.decodedMeshes.length )
+    {
+        this.decodedMeshes = undefined;
+        this.isReadComplete = true;
+    }
+};
+
+/**
+ * Create a mesh from the buffers packed by the decode worker
+ * @param {Object} packed
+ * @return {Mesh}
+ */
+GObjLoader.prototype.createDecodedMesh = function ( packed )
 {
-    var timeStart = new Date().getTime();
+    return new Mesh( packed['verts'],
+                     packed['tverts'],
+                     packed['normals'],
+                     packed['indices'],
+                     packed['name'] );
+};
+
+/**
+ * Create an InstancedMesh with one instance per offset
+ * @param {Mesh} mesh Mesh of the first copy
+ * @param {Float32Array} offsets Translation of every copy, 3 values each
+ * @return {InstancedMesh}
+ */
+GObjLoader.prototype.createInstancedMesh = function ( mesh, offsets )
+{
+    var obj = new InstancedMesh( mesh );
+    var mat = mat4.create();
     
-    var targetTime = 17;
+    for ( var i = 0; i < offsets.length; i += 3 )
+    {
+        mat4.identity( mat );
+        mat[12] = offsets[i];
+        mat[13] = offsets[i+1];
+        mat[14] = offsets[i+2];
+        obj.addInstance( mat );
+    }
     
-    if (time > targetTime)
+    return obj;
+};
+
+/**
+ * Make an object an occluder if occluders are enabled and it has few enough
+ * triangles to rasterize.  A simplified level can bulge past the surface it
+ * replaces and hide objects that are in view, so the levels of detail use
+ * the most detailed level that is cheap enough.
+ * @param {Mesh} obj Mesh or LodMesh added by this loader
+ * @param {Array.<Mesh>=} levels Levels of the LodMesh from the most to the
+ *        least detailed
+ */
+GObjLoader.prototype.designateOccluder = function ( obj, levels )
+{
+    if ( !this.occludersEnabled )
+    {
+        return;
+    }
+    
+    var candidates = ( undefined !== levels ) ? levels : [ obj ];
+    
+    for ( var i = 0; i < candidates.length; ++i )
+    {
+        if ( candidates[i].indxA.length / 3 <= GObjLoader.MAX_OCCLUDER_TRIANGLES )
+        {
+            if ( undefined !== levels )
+            {
+                obj.setOccluderLevel( i );
+            }
+            
+            obj.setOccluder( true );
+            return;
+        }
+    }
+};
+
+/**
+ * Keep pulling chunks from a stream reader until the download is done
+ * @param {Object} streamReader Reader for the response body
+ */
+GObjLoader.prototype.readStream = function ( streamReader )
+{
+    streamReader['read']().then( function ( result )
+    {
+        if ( result['done'] )
+        {
+            this.isDownloadComplete = true;
+            this.downloadProgress = 1;
+            return;
+        }
+
+        this.onChunkDownloaded( result['value'] );
+        this.readStream( streamReader );
+    }.bind(this) )['catch']( this.onDownloadFailed.bind(this) );
+};
+
+/**
+ * This function is called when the request or the stream of the obj file
+ * fails, the loader gives up and reports itself as completed
+ * @param {*} error Reason of the failure
+ */
+GObjLoader.prototype.onDownloadFailed = function ( error )
+{
+    console.debug( "GObjLoader: could not load [" + this.currentPath + "] " + error );
+    this.isDownloadFailed = true;
+};
+
+/**
+ * Queue a downloaded chunk for the reader
+ * @param {Uint8Array} chunk
+ */
+GObjLoader.prototype.onChunkDownloaded = function ( chunk )
+{
+    this.chunkQueue.push( chunk );
+    this.bytesDownloaded += chunk.length;
+
+    if ( this.bytesTotal > 0 )
     {
-        --this.availableTime;
+        this.downloadProgress = Math.min( 1, this.bytesDownloaded / this.bytesTotal );
     }
     else
     {
-        ++this.availableTime;
+        this.downloadProgress += (1.0 - this.downloadProgress) / 10.0;
     }
-	
-	if ( this.availableTime <= 0 )
-	{
-		this.availableTime = 5;
-	}
-	
-	
+};
+
+/**
+ * Hand the next slice of downloaded bytes to the reader
+ * @return {boolean} True if there was anything to read
+ */
+GObjLoader.prototype.readNextSlice = function ()
+{
+    if ( 0 === this.chunkQueue.length )
+    {
+        return false;
+    }
+
+    var chunk = this.chunkQueue[0];
+    var end = Math.min( chunk.length, this.chunkOffset + GObjLoader.READ_STEP_SIZE );
+
+    this.reader.read( chunk.subarray( this.chunkOffset, end ) );
+    this.chunkOffset = end;
+
+    if ( end === chunk.length )
+    {
+        this.chunkQueue.shift();
+        this.chunkOffset = 0;
+    }
+
+    var expected = ( this.bytesTotal > 0 ) ? this.bytesTotal : this.bytesDownloaded;
+    this.processProgress = Math.min( 1, this.reader.getBytesProcessed() / expected );
+
+    return true;
+};
+
+/**
+ * Update this obj loader, only needed when no scheduler was provided with
+ * setJobScheduler
+ * @param {number} Milliseconds since the last update
+ */
+GObjLoader.prototype.update = function ( time )
+{
+    if ( this.ownsScheduler )
+    {
+        this.scheduler.update( time );
+    }
+};
+
+/**
+ * Refresh the total progress and report it to the observer
+ */
+GObjLoader.prototype.updateProgress = function ()
+{
 	var defferedProgress = (this.deferredObjectCount===0)? ((this.autoMergeByMaterial)?0.0:1.0) :((this.deferredObjectCount-this.defferedObjectsLeft)/this.deferredObjectCount);
 	
 	this.totalProgress = (this.downloadProgress + this.processProgress*9.0 + defferedProgress )/11.0;
@@ -136,63 +575,117 @@ GObjLoader.prototype.update = function ( time )
 	{
 		this.observer.onObjLoaderProgress(this, this.totalProgress);
 	}
+};
+
+/**
+ * @return {number} Current priority of the loader, finished meshes are 
+ *         uploads and the merge by material comes after parsing
+ */
+GObjLoader.prototype.getPriority = function ()
+{
+    if ( undefined !== this.decodedResult || undefined !== this.decodedMeshes ||
+         this.optimizeQueue.length > 0 || this.readyMeshes.length > 0 )
+    {
+        return GJobScheduler.PRIORITY_UPLOAD;
+    }
     
-    while ( ( (new Date().getTime()) - timeStart) < this.availableTime )
+    if ( undefined !== this.lodSimplifier || 
+         ( this.isReaderReady && this.reader.isLoadComplete ) )
     {
-		if ( this.isIdleMode )
-		{
-			return;
-		}
-        else if ( this.isReadComplete )
+        return GJobScheduler.PRIORITY_MERGE;
+    }
+    
+    return GJobScheduler.PRIORITY_PARSE;
+};
+
+/**
+ * @return {number} Total progress of the loader
+ */
+GObjLoader.prototype.getProgress = function ()
+{
+    return this.totalProgress;
+};
+
+/**
+ * Do the next unit of loading work
+ * @return {number} One of the GJobScheduler.STEP_* values
+ */
+GObjLoader.prototype.step = function ()
+{
+    this.updateProgress();
+    
+    if ( this.isReadComplete || this.isDownloadFailed )
+    {
+        if (this.observer != undefined)
         {
-			if (this.observer != undefined)
-			{
-				this.observer.onObjLoaderCompleted( this );
-			}
-			
-			this.isIdleMode = true;
-			return;
+            this.observer.onObjLoaderCompleted( this );
         }
-        else if ( this.isReaderReady )
+        
+        return GJobScheduler.STEP_DONE;
+    }
+    
+    if ( undefined !== this.decodedResult )
+    {
+        this.addDecodedResult();
+    }
+    else if ( undefined !== this.decodedMeshes )
+    {
+        this.addNextDecodedMesh();
+    }
+    else if ( this.optimizeQueue.length > 0 )
+    {
+        this.optimizeNextMesh();
+    }
+    else if ( undefined !== this.lodSimplifier )
+    {
+        this.buildLodChain();
+    }
+    else if ( this.readyMeshes.length > 0 )
+    {
+        this.addReadyMesh( this.readyMeshes.shift() );
+    }
+    else if ( !this.isReaderReady )
+    {
+        // waiting on the download or the decode worker
+        return GJobScheduler.STEP_WAITING;
+    }
+    else if ( false === this.reader.isLoadComplete )
+    {
+        if ( this.readNextSlice() )
         {
-            if (false === this.reader.isLoadComplete)
-            {
-                this.reader.update( time );
-				++this.objLinesProcessed;
-				this.processProgress = this.objLinesProcessed / this.objLineCount;
-            }
-            else
-            {
-				// we are done processing, its time to send all deferred meshes to
-				// the scene
-				var keys = Object.keys(this.deferredMeshMap);
-				
-				if ( keys.length === 0 )
-				{
-					this.isReadComplete = true;
-				}
-				else
-				{
-					var thisMeshArray = this.deferredMeshMap[keys[0]];
-					for ( var i in thisMeshArray )
-					{
-						this.sendMeshToGroup( thisMeshArray[i] );
-						--this.defferedObjectsLeft;
-					}
-					
-					delete this.deferredMeshMap[keys[0]];
-				}
-            }
+            return GJobScheduler.STEP_WORKED;
         }
         else if ( this.isDownloadComplete )
-        {    
-            var i = 0;
-            var obj = this.client.responseText.split("\n");
-			this.objLineCount = obj.length;
-			this.reader = new GObjReader (this.currentPath, obj, this.scene, this.group, this);
-			this.isReaderReady = true;
+        {
+            this.reader.finish();
+            this.processProgress = 1;
+        }
+        else
+        {
+            // waiting on the network
+            return GJobScheduler.STEP_WAITING;
+        }
+    }
+    else if ( this.instanceCandidates.length > 0 )
+    {
+        this.resolveInstances();
+    }
+    else if ( !this.mergePlanner.hasPending() )
+    {
+        // we are done processing and every deferred mesh is in the scene
+        this.isReadComplete = true;
+    }
+    else
+    {
+        var thisMeshArray = this.mergePlanner.buildNextMtl();
+        for ( var i = 0; i < thisMeshArray.length; ++i )
+        {
+            this.optimizeAndSend( [ thisMeshArray[i] ], this.sendMeshToGroup.bind( this, thisMeshArray[i] ) );
+            --this.defferedObjectsLeft;
         }
     }
+    
+    return GJobScheduler.STEP_WORKED;
 };
 
 /**
@@ -201,55 +694,139 @@ GObjLoader.prototype.update = function ( time )
  */
 GObjLoader.prototype.onNewMeshAvailable = function ( mesh )
 {
-	if ( this.autoMergeByMaterial )
+    // optimizing a mesh takes far longer than reading a slice, it gets its
+    // own step so the slices stay small
+    this.readyMeshes.push( mesh );
+};
+
+/**
+ * Send a mesh finished by the reader to the group, or keep it for merging
+ * @param {GeometryTriMesh} mesh
+ */
+GObjLoader.prototype.addReadyMesh = function ( mesh )
+{
+	if ( this.instancingEnabled && !this.areInstancesResolved )
+	{
+	    // copies can only be found once every mesh is read
+	    this.instanceCandidates.push( mesh );
+	}
+	else if ( this.lodEnabled && 
+	     mesh.getIndexCount() / 3 >= GMeshSimplifier.MIN_LOD_TRIANGLES )
+	{
+	    // the chain takes far longer than a step, it's built by buildLodChain
+	    this.lodSimplifier = new GMeshSimplifier( mesh );
+	}
+	else if ( this.autoMergeByMaterial )
 	{
 	    this.deferMeshForMerge( mesh );
 	}
 	else
 	{
-	    this.sendMeshToGroup( mesh );
+	    this.optimizeAndSend( [ mesh ], this.sendMeshToGroup.bind( this, mesh ) );
 	}
 };
 
 /**
- * This function is called whenever a new GeometryTriMesh object is 
- * loaded and needs to be merged and optimized before adding to the scene.
- * @param {GeometryTriMesh} New object that was just made available
+ * Queue meshes for the optimizer, they take far longer than a step and are
+ * optimized by optimizeNextMesh
+ * @param {Array.<GeometryTriMesh>} meshes
+ * @param {function()} send Called once every mesh is optimized
  */
-GObjLoader.prototype.deferMeshForMerge = function ( mesh )
+GObjLoader.prototype.optimizeAndSend = function ( meshes, send )
 {
-    var currentMeshArray = this.deferredMeshMap[mesh.getMtlName()];
-    var MAX_INDEX_VALUE = 65535;
+    this.optimizeQueue.push( { meshes: meshes, optimized: 0, send: send } );
+};
+
+/**
+ * Do the next part of the optimization of the queued meshes, their send 
+ * function is called once they are all done
+ */
+GObjLoader.prototype.optimizeNextMesh = function ()
+{
+    var pending = this.optimizeQueue[0];
     
-    if ( undefined === currentMeshArray )
+    if ( undefined === this.meshOptimizer )
     {
-        // this is the first mesh with it's material
-        currentMeshArray = [mesh];
-        this.deferredMeshMap[mesh.getMtlName()] = currentMeshArray;
-		++this.deferredObjectCount;
-		++this.defferedObjectsLeft;
-        return;
+        this.meshOptimizer = new GMeshOptimizer( pending.meshes[pending.optimized] );
     }
     
-    for ( var i in currentMeshArray )
+    if ( this.meshOptimizer.step( GObjLoader.OPTIMIZE_STEP_SIZE ) )
     {
-        if ( currentMeshArray[i].indices.length + mesh.indices.length <=  MAX_INDEX_VALUE )
+        this.meshOptimizer = undefined;
+        
+        if ( ++pending.optimized === pending.meshes.length )
         {
-            // we found a mesh that can receive the new geometry
-            currentMeshArray[i].merge( mesh );
-            return;
+            this.optimizeQueue.shift();
+            pending.send();
         }
     }
+};
+
+/**
+ * Do the next part of the level of detail chain being built and send it to
+ * the group once it's complete
+ */
+GObjLoader.prototype.buildLodChain = function ()
+{
+    if ( this.lodSimplifier.step( GObjLoader.LOD_STEP_SIZE ) )
+    {
+        var levels = this.lodSimplifier.getLevels();
+        
+        this.lodSimplifier = undefined;
+        this.optimizeAndSend( levels, this.sendLodChainToGroup.bind( this, levels ) );
+    }
+};
+
+/**
+ * Send the sets of copies among the meshes read to the group, the other 
+ * meshes go through addReadyMesh again
+ */
+GObjLoader.prototype.resolveInstances = function ()
+{
+    var found = GInstanceDetector.findDuplicates( this.instanceCandidates );
+    
+    this.instanceCandidates = [];
+    this.areInstancesResolved = true;
+    
+    for ( var i = 0; i < found.instances.length; ++i )
+    {
+        var mesh = found.instances[i].mesh;
+        this.optimizeAndSend( [ mesh ], this.sendInstancesToGroup.bind( this, mesh, found.instances[i].offsets ) );
+    }
     
-    // could not find a mesh that can merge the new geometry, save it for later
-	++this.deferredObjectCount;
-	++this.defferedObjectsLeft;
-    currentMeshArray.push( mesh );
+    this.readyMeshes = this.readyMeshes.concat( found.meshes );
+};
+
+/**
+ * This function is called whenever the obj file references a material library
+ * @param {string} name Name of the mtl file relative to the obj file
+ */
+GObjLoader.prototype.onMtlLibReferenced = function ( name )
+{
+	var ldr = new GMtlLoader(this.scene);
+	ldr.setJobScheduler(this.scheduler);
+	ldr.loadMtl(this.currentPath, name);
 };
 
 /**
  * This function is called whenever a new GeometryTriMesh object is 
- * loaded and needs to be sent directly to the scene.
+ * loaded and needs to be merged and optimized before adding to the scene.
+ * @param {GeometryTriMesh} New object that was just made available
+ */
+GObjLoader.prototype.deferMeshForMerge = function ( mesh )
+{
+    // only the sizes are tracked here, the geometry gets copied once all
+    // the meshes are known
+    if ( this.mergePlanner.add( mesh ) )
+    {
+		++this.deferredObjectCount;
+		++this.defferedObjectsLeft;
+    }
+};
+
+/**
+ * This function is called whenever a new GeometryTriMesh object is 
+ * optimized and needs to be sent directly to the scene.
  * @param {GeometryTriMesh} New object that was just made available
  */
 GObjLoader.prototype.sendMeshToGroup = function ( mesh )
@@ -257,13 +834,55 @@ GObjLoader.prototype.sendMeshToGroup = function ( mesh )
    var obj = new Mesh( mesh.getVertBuffer(),
 					   mesh.getTVerBuffer(),
 					   mesh.getNormBuffer(),
-					   mesh.indices,
+					   mesh.getIndexBuffer(),
 					   mesh.getName());
                                       
 	obj.setMtlName(mesh.getMtlName());
+	this.designateOccluder(obj);
 	this.group.addChild(obj); 
 };
 
+/**
+ * This function is called whenever a set of copies is found and optimized 
+ * and needs to be sent to the scene as a single InstancedMesh.
+ * @param {GeometryTriMesh} mesh First copy
+ * @param {Float32Array} offsets Translation of every copy, 3 values each
+ */
+GObjLoader.prototype.sendInstancesToGroup = function ( mesh, offsets )
+{
+    var obj = this.createInstancedMesh( new Mesh( mesh.getVertBuffer(),
+                                                  mesh.getTVerBuffer(),
+                                                  mesh.getNormBuffer(),
+                                                  mesh.getIndexBuffer(),
+                                                  mesh.getName() ), offsets );
+    obj.setMtlName( mesh.getMtlName() );
+    this.group.addChild( obj );
+};
+
+/**
+ * This function is called whenever the levels of detail for a mesh are built
+ * and optimized and need to be sent to the scene.
+ * @param {Array.<GeometryTriMesh>} levels Levels from the most to the least detailed
+ */
+GObjLoader.prototype.sendLodChainToGroup = function ( levels )
+{
+    var meshes = [];
+    
+    for ( var i = 0; i < levels.length; ++i )
+    {
+        meshes.push( new Mesh( levels[i].getVertBuffer(),
+                               levels[i].getTVerBuffer(),
+                               levels[i].getNormBuffer(),
+                               levels[i].getIndexBuffer(),
+                               levels[i].getName() ) );
+    }
+    
+    var obj = new LodMesh( meshes, this.scene.getCamera() );
+    obj.setMtlName( levels[0].getMtlName() );
+    this.designateOccluder( obj, meshes );
+    this.group.addChild( obj );
+};
+
 /**
  * Set the observer for the loader
  * @param {GObjLoaderObserver} observer Observer that receives updates
@@ -0,0 +1,562 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * @interface
+ */
+function GObjTokenizerHandler () {}
+
+/**
+ * @param {number} x
+ * @param {number} y
+ * @param {number} z
+ */
+GObjTokenizerHandler.prototype.onVertex = function ( x, y, z ) {};
+
+/**
+ * @param {number} u
+ * @param {number} v
+ */
+GObjTokenizerHandler.prototype.onTexVertex = function ( u, v ) {};
+
+/**
+ * @param {number} x
+ * @param {number} y
+ * @param {number} z
+ */
+GObjTokenizerHandler.prototype.onNormal = function ( x, y, z ) {};
+
+/**
+ * Called for every face, the index arrays are reused between calls.  Indices
+ * are zero based (relative indices are already resolved) and -1 marks a
+ * missing texture or normal reference.
+ * @param {Int32Array} vertIdxA
+ * @param {Int32Array} textIdxA
+ * @param {Int32Array} normIdxA
+ * @param {number} count Number of corners in this face
+ */
+GObjTokenizerHandler.prototype.onFace = function ( vertIdxA, textIdxA, normIdxA, count ) {};
+
+/**
+ * @param {string} name Name of the group ('o' and 'g' lines)
+ */
+GObjTokenizerHandler.prototype.onGroup = function ( name ) {};
+
+/**
+ * @param {boolean} smooth
+ */
+GObjTokenizerHandler.prototype.onSmooth = function ( smooth ) {};
+
+/**
+ * @param {string} name
+ */
+GObjTokenizerHandler.prototype.onUseMtl = function ( name ) {};
+
+/**
+ * @param {string} name
+ */
+GObjTokenizerHandler.prototype.onMtlLib = function ( name ) {};
+
+/**
+ * Called for the non standard 'invnv' line
+ */
+GObjTokenizerHandler.prototype.onInvertNormals = function () {};
+
+/**
+ * Called once all the input has been consumed
+ */
+GObjTokenizerHandler.prototype.onEndOfFile = function () {};
+
+/**
+ * Streaming obj tokenizer.  Chunks of bytes are consumed as they arrive and
+ * numbers are parsed straight from the bytes, only group and material names
+ * are turned into strings.  Lines split between chunks are carried over to
+ * the next call.
+ * @constructor
+ * @param {GObjTokenizerHandler} handler Receives the parsed statements
+ */
+function GObjTokenizer( handler )
+{
+    this.handler = handler;
+
+    this.carry = new Uint8Array( 256 );
+    this.carryLength = 0;
+    this.isFirstChunk = true;
+
+    this.vertCount = 0;
+    this.texVertCount = 0;
+    this.normalCount = 0;
+
+    this.faceVertIdxA = new Int32Array( 16 );
+    this.faceTextIdxA = new Int32Array( 16 );
+    this.faceNormIdxA = new Int32Array( 16 );
+
+    // cursor state for the line being parsed
+    this.bytes = this.carry;
+    this.pos = 0;
+    this.lineEnd = 0;
+
+    this.bytesProcessed = 0;
+}
+
+GObjTokenizer.NEW_LINE = 10;
+
+/**
+ * Consume the next chunk of the file
+ * @param {Uint8Array} chunk
+ */
+GObjTokenizer.prototype.push = function( chunk )
+{
+    var len = chunk.length;
+    var start = 0;
+    var i = 0;
+
+    if ( this.isFirstChunk && len > 0 )
+    {
+        this.isFirstChunk = false;
+
+        // skip the utf-8 byte order mark
+        if ( len >= 3 && 0xEF === chunk[0] && 0xBB === chunk[1] && 0xBF === chunk[2] )
+        {
+            start = 3;
+        }
+    }
+
+    if ( this.carryLength > 0 )
+    {
+        while ( i < len && GObjTokenizer.NEW_LINE !== chunk[i] )
+        {
+            ++i;
+        }
+
+        this.appendToCarry( chunk, start, i );
+
+        if ( i === len )
+        {
+            this.bytesProcessed += len;
+            return;
+        }
+
+        this.parseLine( this.carry, 0, this.carryLength );
+        this.carryLength = 0;
+        start = i + 1;
+    }
+
+    var lineStart = start;
+    for ( i = start; i < len; ++i )
+    {
+        if ( GObjTokenizer.NEW_LINE === chunk[i] )
+        {
+            if ( i > lineStart )
+            {
+                this.parseLine( chunk, lineStart, i );
+            }
+            lineStart = i + 1;
+        }
+    }
+
+    this.appendToCarry( chunk, lineStart, len );
+    this.bytesProcessed += len;
+};
+
+/**
+ * Consume whatever is left over and notify the handler that the file is done
+ */
+GObjTokenizer.prototype.finish = function()
+{
+    if ( this.carryLength > 0 )
+    {
+        this.parseLine( this.carry, 0, this.carryLength );
+        this.carryLength = 0;
+    }
+
+    this.handler.onEndOfFile();
+};
+
+/**
+ * Save the incomplete line at the end of a chunk
+ * @param {Uint8Array} chunk
+ * @param {number} start
+ * @param {number} end
+ */
+GObjTokenizer.prototype.appendToCarry = function( chunk, start, end )
+{
+    var count = end - start;
+
+    if ( count <= 0 )
+    {
+        return;
+    }
+
+    if ( this.carryLength + count > this.carry.length )
+    {
+        var newCarry = new Uint8Array( Math.max( this.carry.length * 2, this.carryLength + count ) );
+        newCarry.set( this.carry.subarray( 0, this.carryLength ) );
+        this.carry = newCarry;
+    }
+
+    this.carry.set( chunk.subarray( start, end ), this.carryLength );
+    this.carryLength += count;
+};
+
+/**
+ * Dispatch a single line to the handler
+ * @param {Uint8Array} bytes
+ * @param {number} start First byte of the line
+ * @param {number} end One past the last byte of the line
+ */
+GObjTokenizer.prototype.parseLine = function( bytes, start, end )
+{
+    this.bytes = bytes;
+    this.pos = start;
+    this.lineEnd = end;
+
+    this.skipSpaces();
+
+    var kwStart = this.pos;
+    while ( this.pos < end && bytes[this.pos] > 32 )
+    {
+        ++this.pos;
+    }
+
+    var kwLen = this.pos - kwStart;
+    var c0 = bytes[kwStart];
+    var c1 = bytes[kwStart+1];
+
+    if ( 1 === kwLen )
+    {
+        if ( 118 === c0 )       // v
+        {
+            var x = this.readFloat();
+            var y = this.readFloat();
+            this.handler.onVertex( x, y, this.readFloat() );
+            ++this.vertCount;
+        }
+        else if ( 102 === c0 )  // f
+        {
+            this.readFace();
+        }
+        else if ( 103 === c0 || 111 === c0 ) // g o
+        {
+            this.handler.onGroup( this.readRestOfLine() );
+        }
+        else if ( 115 === c0 )  // s
+        {
+            var value = this.readRestOfLine();
+            this.handler.onSmooth( "on" === value || "1" === value );
+        }
+    }
+    else if ( 2 === kwLen && 118 === c0 )
+    {
+        if ( 116 === c1 )       // vt
+        {
+            var u = this.readFloat();
+            this.handler.onTexVertex( u, this.readFloat() );
+            ++this.texVertCount;
+        }
+        else if ( 110 === c1 )  // vn
+        {
+            var nx = this.readFloat();
+            var ny = this.readFloat();
+            this.handler.onNormal( nx, ny, this.readFloat() );
+            ++this.normalCount;
+        }
+    }
+    else if ( 6 === kwLen && this.keywordIs( kwStart, "usemtl" ) )
+    {
+        this.handler.onUseMtl( this.readRestOfLine() );
+    }
+    else if ( 6 === kwLen && this.keywordIs( kwStart, "mtllib" ) )
+    {
+        this.handler.onMtlLib( this.readRestOfLine() );
+    }
+    else if ( 5 === kwLen && this.keywordIs( kwStart, "invnv" ) )
+    {
+        this.handler.onInvertNormals();
+    }
+};
+
+/**
+ * @param {number} start Position of the keyword in the current line
+ * @param {string} keyword Keyword to compare against
+ * @return {boolean} True if the bytes match the keyword
+ */
+GObjTokenizer.prototype.keywordIs = function( start, keyword )
+{
+    for ( var i = 0; i < keyword.length; ++i )
+    {
+        if ( this.bytes[start+i] !== keyword.charCodeAt( i ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+};
+
+/**
+ * Advance the cursor past any white space or control characters
+ */
+GObjTokenizer.prototype.skipSpaces = function()
+{
+    while ( this.pos < this.lineEnd && this.bytes[this.pos] <= 32 )
+    {
+        ++this.pos;
+    }
+};
+
+/**
+ * Parse a decimal number at the cursor
+ * @return {number} The parsed value or NaN if there is no number
+ */
+GObjTokenizer.prototype.readFloat = function()
+{
+    this.skipSpaces();
+
+    var bytes = this.bytes;
+    var end = this.lineEnd;
+    var sign = 1;
+    var value = 0;
+    var digits = 0;
+    var c = bytes[this.pos];
+
+    if ( this.pos < end && ( 45 === c || 43 === c ) ) // - +
+    {
+        sign = ( 45 === c ) ? -1 : 1;
+        c = bytes[++this.pos];
+    }
+
+    while ( this.pos < end && c >= 48 && c <= 57 )
+    {
+        value = value * 10 + (c - 48);
+        ++digits;
+        c = bytes[++this.pos];
+    }
+
+    if ( this.pos < end && 46 === c ) // .
+    {
+        var scale = 1;
+        var fraction = 0;
+        c = bytes[++this.pos];
+
+        while ( this.pos < end && c >= 48 && c <= 57 )
+        {
+            fraction = fraction * 10 + (c - 48);
+            scale *= 10;
+            ++digits;
+            c = bytes[++this.pos];
+        }
+
+        value += fraction / scale;
+    }
+
+    if ( 0 === digits )
+    {
+        this.skipToken();
+        return NaN;
+    }
+
+    if ( this.pos < end && ( 101 === c || 69 === c ) ) // e E
+    {
+        var expSign = 1;
+        var exponent = 0;
+        c = bytes[++this.pos];
+
+        if ( 45 === c || 43 === c )
+        {
+            expSign = ( 45 === c ) ? -1 : 1;
+            c = bytes[++this.pos];
+        }
+
+        while ( this.pos < end && c >= 48 && c <= 57 )
+        {
+            exponent = exponent * 10 + (c - 48);
+            c = bytes[++this.pos];
+        }
+
+        value *= Math.pow( 10, expSign * exponent );
+    }
+
+    return sign * value;
+};
+
+/**
+ * Parse an integer at the cursor without skipping white space
+ * @return {number} The parsed value or 0 if there is no number
+ */
+GObjTokenizer.prototype.readInt = function()
+{
+    var bytes = this.bytes;
+    var end = this.lineEnd;
+    var sign = 1;
+    var value = 0;
+    var c = bytes[this.pos];
+
+    if ( this.pos < end && 45 === c )
+    {
+        sign = -1;
+        c = bytes[++this.pos];
+    }
+
+    while ( this.pos < end && c >= 48 && c <= 57 )
+    {
+        value = value * 10 + (c - 48);
+        c = bytes[++this.pos];
+    }
+
+    return sign * value;
+};
+
+/**
+ * Move the cursor to the next white space
+ */
+GObjTokenizer.prototype.skipToken = function()
+{
+    while ( this.pos < this.lineEnd && this.bytes[this.pos] > 32 )
+    {
+        ++this.pos;
+    }
+};
+
+/**
+ * Convert an obj index into a zero based one
+ * @param {number} idx One based or negative (relative) index, 0 if missing
+ * @param {number} count Number of elements read so far
+ * @return {number} Zero based index or -1 if missing
+ */
+GObjTokenizer.prototype.resolveIndex = function( idx, count )
+{
+    if ( idx > 0 )
+    {
+        return idx - 1;
+    }
+    else if ( idx < 0 )
+    {
+        return count + idx;
+    }
+
+    return -1;
+};
+
+/**
+ * Parse the v/vt/vn triples of a face and pass them to the handler
+ */
+GObjTokenizer.prototype.readFace = function()
+{
+    var count = 0;
+
+    this.skipSpaces();
+    while ( this.pos < this.lineEnd )
+    {
+        if ( count === this.faceVertIdxA.length )
+        {
+            this.growFaceArrays();
+        }
+
+        var v = this.readInt();
+        var t = 0;
+        var n = 0;
+
+        if ( 47 === this.bytes[this.pos] && this.pos < this.lineEnd ) // /
+        {
+            ++this.pos;
+            t = this.readInt();
+
+            if ( 47 === this.bytes[this.pos] && this.pos < this.lineEnd )
+            {
+                ++this.pos;
+                n = this.readInt();
+            }
+        }
+
+        this.skipToken();
+        this.skipSpaces();
+
+        this.faceVertIdxA[count] = this.resolveIndex( v, this.vertCount );
+        this.faceTextIdxA[count] = this.resolveIndex( t, this.texVertCount );
+        this.faceNormIdxA[count] = this.resolveIndex( n, this.normalCount );
+        ++count;
+    }
+
+    if ( count >= 3 )
+    {
+        this.handler.onFace( this.faceVertIdxA, this.faceTextIdxA, this.faceNormIdxA, count );
+    }
+};
+
+/**
+ * Make room for faces with more corners
+ */
+GObjTokenizer.prototype.growFaceArrays = function()
+{
+    var size = this.faceVertIdxA.length * 2;
+    var vertIdxA = new Int32Array( size );
+    var textIdxA = new Int32Array( size );
+    var normIdxA = new Int32Array( size );
+
+    vertIdxA.set( this.faceVertIdxA );
+    textIdxA.set( this.faceTextIdxA );
+    normIdxA.set( this.faceNormIdxA );
+
+    this.faceVertIdxA = vertIdxA;
+    this.faceTextIdxA = textIdxA;
+    this.faceNormIdxA = normIdxA;
+};
+
+/**
+ * Read the remainder of the line as a string, runs of white space are
+ * collapsed into single spaces
+ * @return {string}
+ */
+GObjTokenizer.prototype.readRestOfLine = function()
+{
+    var ret = "";
+    var pendingSpace = false;
+
+    this.skipSpaces();
+    while ( this.pos < this.lineEnd )
+    {
+        var c = this.bytes[this.pos++];
+
+        if ( c <= 32 || 127 === c )
+        {
+            pendingSpace = true;
+        }
+        else
+        {
+            if ( pendingSpace )
+            {
+                ret += " ";
+                pendingSpace = false;
+            }
+            ret += String.fromCharCode( c );
+        }
+    }
+
+    try
+    {
+        // names are utf-8, decode any multi byte sequences
+        return decodeURIComponent( escape( ret ) );
+    }
+    catch ( e )
+    {
+        return ret;
+    }
+};
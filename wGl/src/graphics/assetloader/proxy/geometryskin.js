@@ -19,38 +19,43 @@
 // SOFTWARE.
 
 /**
+ * Skin influences for a GeometryTriMesh, four floats per vertex
+ * [ index, index, weight, weight ]
  * @constructor
+ * @param {number=} vertCapacity Number of vertices to allocate room for
  */
-function GeometrySkin()
+function GeometrySkin( vertCapacity )
 {
-	this.sVerts = [];
+	this.sVerts = new GTypedArrayBuilder( Float32Array, 4*(vertCapacity || 256) );
 }
 
+/**
+ * Add the influences for the next vertex
+ * @param {number} indexA
+ * @param {number} indexB
+ * @param {number} weightA
+ * @param {number} weightB
+ */
+GeometrySkin.prototype.addSkin = function( indexA, indexB, weightA, weightB )
+{
+	this.sVerts.push2( indexA, indexB );
+	this.sVerts.push2( weightA, weightB );
+};
+
+/**
+ * To be called by the reader once the last vertex was added
+ */
+GeometrySkin.prototype.prepareToClose = function()
+{
+	this.sVerts.trim();
+};
+
 /**
  * Returns the skin vertex buffer
- * @return {Array.<number>} Buffer with texture vertex values
+ * @return {Float32Array} View over the skin vertex values
  */
 GeometrySkin.prototype.getSkinBuffer = function()
 {
-	var len = this.sVerts.length;
-	var ret = [];
-	for (var i = 0; i < len; ++i)
-	{
-		var _this = this.sVerts[i];
-		if ( _this != undefined )
-		{
-			for( var j = 0; j < 4; ++j)
-			{
-				ret.push(_this[j]); 
-			}
-		}
-		else
-		{
-			ret.push(0); ret.push(0); ret.push(0); ret.push(0);
-		}
-	}
-	
-	return ret;
+	return this.sVerts.view();
 };
 
- 
@@ -19,38 +19,141 @@
 // SOFTWARE.
 
 /**
+ * Triangle mesh under construction.  Attributes live in flat growable typed
+ * arrays (3 floats per position and normal, 2 per texture vertex) so the
+ * buffers can be handed to the GPU or to another thread without flattening.
  * @constructor
  * @param {string} Name of this geometry instance
+ * @param {number=} vertCapacity Number of vertices to allocate room for
+ * @param {number=} indexCapacity Number of indices to allocate room for
  */
-function GeometryTriMesh(name)
+function GeometryTriMesh(name, vertCapacity, indexCapacity)
 {
 	this.name = name;
 	this.matName = "";
     this.smooth = false;
 	
-	this.gVerts = [];
-	this.nVerts = [];
-	this.tVerts = [];
-	this.indices = [];
+	vertCapacity = vertCapacity || 256;
+	indexCapacity = indexCapacity || 3*256;
+	
+	this.gVerts = new GTypedArrayBuilder( Float32Array, 3*vertCapacity );
+	this.nVerts = new GTypedArrayBuilder( Float32Array, 3*vertCapacity );
+	this.tVerts = new GTypedArrayBuilder( Float32Array, 2*vertCapacity );
+	this.indices = new GTypedArrayBuilder( Uint32Array, indexCapacity );
 }
 
+/**
+ * Largest number of vertices a merged mesh can hold, indices are 16 bit so
+ * it's the vertex count that limits the merge
+ */
+GeometryTriMesh.MAX_MERGE_VERT_COUNT = 65536;
+
+/**
+ * Largest number of vertices a merged mesh can hold when it will be drawn 
+ * with 32 bit indices
+ */
+GeometryTriMesh.MAX_UINT_MERGE_VERT_COUNT = 4294967296;
+
+/**
+ * Returns the number of vertices in this mesh
+ * @return {number}
+ */
+GeometryTriMesh.prototype.getVertCount = function()
+{
+	return this.gVerts.length / 3;
+};
+
+/**
+ * Returns the number of indices in this mesh
+ * @return {number}
+ */
+GeometryTriMesh.prototype.getIndexCount = function()
+{
+	return this.indices.length;
+};
+
+/**
+ * Add a vertex
+ * @param {number} x
+ * @param {number} y
+ * @param {number} z
+ * @param {number} nx
+ * @param {number} ny
+ * @param {number} nz
+ * @param {number} u
+ * @param {number} v
+ * @return {number} Index of the new vertex
+ */
+GeometryTriMesh.prototype.addVertex = function( x, y, z, nx, ny, nz, u, v )
+{
+	this.gVerts.push3( x, y, z );
+	this.nVerts.push3( nx, ny, nz );
+	this.tVerts.push2( u, v );
+
+	return this.gVerts.length / 3 - 1;
+};
+
+/**
+ * Add an index
+ * @param {number} index
+ */
+GeometryTriMesh.prototype.addIndex = function( index )
+{
+	this.indices.push( index );
+};
+
+/**
+ * Returns true if the provided mesh fits in this one
+ * @param {GeometryTriMesh} mesh
+ * @return {boolean}
+ */
+GeometryTriMesh.prototype.canMerge = function( mesh )
+{
+	return this.getVertCount() + mesh.getVertCount() <= GeometryTriMesh.MAX_MERGE_VERT_COUNT;
+};
+
+/**
+ * Merge the meshes that share a material, each mesh goes into the first 
+ * mesh with its material that still has room for it
+ * @param {Array.<GeometryTriMesh>} meshes
+ * @param {number=} maxVertCount Largest number of vertices in a merged mesh
+ * @return {Array.<GeometryTriMesh>} The merged meshes
+ */
+GeometryTriMesh.mergeByMaterial = function( meshes, maxVertCount )
+{
+	var planner = new GMeshMergePlanner( maxVertCount );
+
+	for ( var i = 0; i < meshes.length; ++i )
+	{
+		planner.add( meshes[i] );
+	}
+
+	return planner.buildAll();
+};
+
 /**
  * merge the provided mesh to this merge
  * @param {GeometryTriMesh} the mesh containing the new geometry
  */
 GeometryTriMesh.prototype.merge = function( mesh )
 {
-	var prevIdxLen = this.indices.length;
+	var prevVertLen = this.getVertCount();
 	var newIdxLen = mesh.indices.length;
+	var newIndices = mesh.indices.data;
 	
-	this.gVerts = this.gVerts.concat( mesh.gVerts );
-	this.nVerts = this.nVerts.concat( mesh.nVerts );
-	this.tVerts = this.tVerts.concat( mesh.tVerts );
+	this.gVerts.appendBuilder( mesh.gVerts );
+	this.nVerts.appendBuilder( mesh.nVerts );
+	this.tVerts.appendBuilder( mesh.tVerts );
 	
+	// the new indices need to be rebased to point past our own vertices
+	this.indices.reserve( newIdxLen );
+	var indices = this.indices.data;
+	var offset = this.indices.length;
 	for ( var i = 0; i < newIdxLen; ++i )
 	{
-		this.indices.push( i + prevIdxLen );
+		indices[offset + i] = newIndices[i] + prevVertLen;
 	}
+	this.indices.length += newIdxLen;
 };
 
 /**
@@ -91,69 +194,43 @@ GeometryTriMesh.prototype.getName = function()
 
 /**
  * Returns the texture vertex buffer
- * @return {Array.<number>} Buffer with texture vertex values
+ * @return {Float32Array} View over the texture vertex values
  */
 GeometryTriMesh.prototype.getTVerBuffer = function()
 {
-	var len = this.gVerts.length;
-	var ret = [];
-	for (var i = 0; i < len; ++i)
-	{
-		var _this = this.tVerts[i];
-		if ( _this != undefined )
-		{
-			for( var j = 0; j < 2; ++j)
-			{
-				ret.push(_this[j]); 
-			}
-		}
-		else
-		{
-			ret.push(0);
-		}
-	}
-	
-	return ret;
+	return this.tVerts.view();
 };
 
 /**
  * Returns the vertex buffer
- * @return {Array.<number>} Buffer with vertex values.
+ * @return {Float32Array} View over the vertex values.
  */
 GeometryTriMesh.prototype.getVertBuffer = function()
 {
-	var len = this.gVerts.length;
-	var ret = [];
-	for (var i = 0; i < len; ++i)
-	{
-		var _this = this.gVerts[i];
-		for( var j = 0; j < 3; ++j)
-		{
-			ret.push(_this[j]); 
-		}
-	}
-	
-	return ret;
+	return this.gVerts.view();
 };
 
 /**
  * Returns the normals buffer
- * @return {Array.<number>} Buffer with normal values.
+ * @return {Float32Array} View over the normal values.
  */
 GeometryTriMesh.prototype.getNormBuffer = function()
 {
-	var len = this.nVerts.length;
-	var ret = [];
-	for (var i = 0; i < len; ++i)
+	return this.nVerts.view();
+};
+
+/**
+ * Returns the index buffer, 16 bit when the vertex count allows it
+ * @return {Uint16Array|Uint32Array} Buffer with the index values.
+ */
+GeometryTriMesh.prototype.getIndexBuffer = function()
+{
+	if ( this.getVertCount() <= 65536 )
 	{
-		var _this = this.nVerts[i];
-		for (var j = 0; j < 3; ++j)
-		{
-			ret.push(_this[j]);
-		}
+		return new Uint16Array( this.indices.view() );
 	}
-	
-	return ret;
+
+	return this.indices.view();
 };
 
 /**
@@ -166,58 +243,118 @@ GeometryTriMesh.prototype.prepareToClose = function()
     {
         this.smoothenNormals();
     }
+
+    this.gVerts.trim();
+    this.nVerts.trim();
+    this.tVerts.trim();
+    this.indices.trim();
 };
 
 /**
  * Goes thorugh every vertex and applyies a shared average for all normals sharing
- * the possitoin
+ * the possitoin.  Vertices are bucketed in a spatial hash with cells as wide as
+ * the position tolerance so only the neighboring cells need to be searched.
  */
 GeometryTriMesh.prototype.smoothenNormals = function()
 {
     var sigma = .000005;
     var hyp = 2;
-    var visitedVerts = [];
+    var cellSize = Math.sqrt( sigma );
+    var g = this.gVerts.data;
+    var n = this.nVerts.data;
+    var vertCount = this.getVertCount();
+    var visitedVerts = new Uint8Array( vertCount );
+    var cells = new Int32Array( 3*vertCount );
+    var vertsToVisit = new Int32Array( 64 );
+    var grid = {};
     var i = 0;
     var j = 0;
 
-    var vertCount = this.nVerts.length;
-
     for ( i = 0; i < vertCount; ++i )
     {
-        visitedVerts[i] = false;
+        var cx = Math.floor( g[3*i] / cellSize );
+        var cy = Math.floor( g[3*i+1] / cellSize );
+        var cz = Math.floor( g[3*i+2] / cellSize );
+        var key = cx + "," + cy + "," + cz;
+
+        if ( undefined === grid[key] )
+        {
+            grid[key] = [];
+        }
+
+        grid[key].push( i );
+        cells[3*i] = cx;
+        cells[3*i+1] = cy;
+        cells[3*i+2] = cz;
     }
 
     for ( i = 0; i < vertCount; ++i )
     {
-        if ( false === visitedVerts[i] )
+        if ( 0 !== visitedVerts[i] )
         {
-            var vertsToVisit = [];
-            for ( j = 0; j < vertCount; ++j )
+            continue;
+        }
+
+        var visitCount = 0;
+        var px = g[3*i], py = g[3*i+1], pz = g[3*i+2];
+        var nx = n[3*i], ny = n[3*i+1], nz = n[3*i+2];
+
+        for ( var dx = -1; dx <= 1; ++dx )
+        {
+            for ( var dy = -1; dy <= 1; ++dy )
             {
-                if ( false == visitedVerts[j] &&
-                     vec3.sqrDist(this.gVerts[i], this.gVerts[j]) < sigma &&
-                     vec3.sqrDist(this.nVerts[i], this.nVerts[j]) < hyp )
+                for ( var dz = -1; dz <= 1; ++dz )
                 {
-                    vertsToVisit.push(j);
-                    visitedVerts[j] = true;
+                    var bucket = grid[ (cells[3*i]+dx) + "," + (cells[3*i+1]+dy) + "," + (cells[3*i+2]+dz) ];
+
+                    if ( undefined === bucket )
+                    {
+                        continue;
+                    }
+
+                    var bucketLen = bucket.length;
+                    for ( j = 0; j < bucketLen; ++j )
+                    {
+                        var k = bucket[j];
+                        var ex = g[3*k]-px, ey = g[3*k+1]-py, ez = g[3*k+2]-pz;
+                        var fx = n[3*k]-nx, fy = n[3*k+1]-ny, fz = n[3*k+2]-nz;
+
+                        if ( 0 === visitedVerts[k] &&
+                             ex*ex + ey*ey + ez*ez < sigma &&
+                             fx*fx + fy*fy + fz*fz < hyp )
+                        {
+                            if ( visitCount === vertsToVisit.length )
+                            {
+                                var grown = new Int32Array( 2*visitCount );
+                                grown.set( vertsToVisit );
+                                vertsToVisit = grown;
+                            }
+
+                            vertsToVisit[visitCount++] = k;
+                            visitedVerts[k] = 1;
+                        }
+                    }
                 }
             }
+        }
 
-            var visitCount = vertsToVisit.length;
-            var avgNorm = vec3.create();
-            for ( j = 0; j < visitCount; ++j )
-            {
-                vec3.add( avgNorm, avgNorm, this.nVerts[ vertsToVisit[j] ] );
-            }
+        var ax = 0, ay = 0, az = 0;
+        for ( j = 0; j < visitCount; ++j )
+        {
+            var m = vertsToVisit[j];
+            ax += n[3*m]; ay += n[3*m+1]; az += n[3*m+2];
+        }
 
-            vec3.normalize( avgNorm, avgNorm );
+        var len = Math.sqrt( ax*ax + ay*ay + az*az );
+        if ( len > 0 )
+        {
+            ax /= len; ay /= len; az /= len;
+        }
 
-            for ( j = 0; j < visitCount; ++j )
-            {
-                this.nVerts[ vertsToVisit[j] ] = avgNorm;
-            }
+        for ( j = 0; j < visitCount; ++j )
+        {
+            var o = 3*vertsToVisit[j];
+            n[o] = ax; n[o+1] = ay; n[o+2] = az;
         }
     }
 };
-
-
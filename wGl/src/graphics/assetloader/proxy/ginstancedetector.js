@@ -0,0 +1,210 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Finds the meshes of a file that are copies of each other moved to a 
+ * different place, like the columns or chairs of a building exported as 
+ * separate objects.  The copies are replaced by the first one and the 
+ * offsets of all of them so they can be drawn as a single InstancedMesh.
+ * Two meshes are copies when they have the same material, the same indices,
+ * the same normals and texture vertices, and positions that only differ by
+ * the same translation.
+ * @constructor
+ */
+function GInstanceDetector() {}
+
+/**
+ * Largest difference between the translated positions of two copies, 
+ * relative to the size of the mesh
+ */
+GInstanceDetector.TOLERANCE = 1e-5;
+
+/**
+ * Largest difference between the normals or texture vertices of two copies
+ */
+GInstanceDetector.ATTRIBUTE_TOLERANCE = 1e-4;
+
+/**
+ * Meshes with fewer copies than this stay as they are
+ */
+GInstanceDetector.MIN_INSTANCES = 2;
+
+/**
+ * Split the provided meshes into the ones that stay as they are and the sets
+ * of copies
+ * @param {Array.<GeometryTriMesh>} meshes
+ * @return {Object} meshes, the meshes without copies, and instances, a list 
+ *         of { mesh, offsets } where offsets holds 3 values per copy, the 
+ *         first one being the mesh itself at 0, 0, 0
+ */
+GInstanceDetector.findDuplicates = function( meshes )
+{
+    var setsByKey = {};
+    var sets = [];
+    var i = 0;
+    
+    for ( i = 0; i < meshes.length; ++i )
+    {
+        var mesh = meshes[i];
+        
+        // the full comparison only runs on meshes of the same size
+        var key = mesh.getMtlName() + "|" + mesh.getVertCount() + "|" + mesh.getIndexCount();
+        var candidates = setsByKey[key];
+        
+        if ( undefined === candidates )
+        {
+            candidates = [];
+            setsByKey[key] = candidates;
+        }
+        
+        var offset = [ 0, 0, 0 ];
+        var found = false;
+        
+        for ( var j = 0; j < candidates.length && !found; ++j )
+        {
+            if ( GInstanceDetector.isCopy( candidates[j].mesh, mesh, offset ) )
+            {
+                candidates[j].offsets.push( offset[0], offset[1], offset[2] );
+                found = true;
+            }
+        }
+        
+        if ( !found )
+        {
+            var set = { mesh: mesh, offsets: [ 0, 0, 0 ] };
+            candidates.push( set );
+            sets.push( set );
+        }
+    }
+    
+    var result = { meshes: [], instances: [] };
+    
+    for ( i = 0; i < sets.length; ++i )
+    {
+        if ( sets[i].offsets.length / 3 >= GInstanceDetector.MIN_INSTANCES )
+        {
+            result.instances.push( { mesh: sets[i].mesh, 
+                                     offsets: new Float32Array( sets[i].offsets ) } );
+        }
+        else
+        {
+            result.meshes.push( sets[i].mesh );
+        }
+    }
+    
+    return result;
+};
+
+/**
+ * Compare two meshes of the same size
+ * @param {GeometryTriMesh} a
+ * @param {GeometryTriMesh} b
+ * @param {Array.<number>} outOffset Receives the translation from a to b
+ * @return {boolean} True if b is a translated copy of a
+ */
+GInstanceDetector.isCopy = function( a, b, outOffset )
+{
+    var count = a.getIndexCount();
+    var aIndices = a.indices.data;
+    var bIndices = b.indices.data;
+    var i = 0;
+    
+    for ( i = 0; i < count; ++i )
+    {
+        if ( aIndices[i] !== bIndices[i] )
+        {
+            return false;
+        }
+    }
+    
+    if ( !GInstanceDetector.isClose( a.getNormBuffer(), b.getNormBuffer(), GInstanceDetector.ATTRIBUTE_TOLERANCE ) ||
+         !GInstanceDetector.isClose( a.getTVerBuffer(), b.getTVerBuffer(), GInstanceDetector.ATTRIBUTE_TOLERANCE ) )
+    {
+        return false;
+    }
+    
+    var aVerts = a.getVertBuffer();
+    var bVerts = b.getVertBuffer();
+    
+    if ( 0 === aVerts.length )
+    {
+        return false;
+    }
+    
+    var size = 0;
+    var k = 0;
+    
+    // the first vertex gives the translation and the extent of a scales the
+    // tolerance
+    for ( k = 0; k < 3; ++k )
+    {
+        var min = Infinity;
+        var max = -Infinity;
+        
+        for ( i = k; i < aVerts.length; i += 3 )
+        {
+            min = Math.min( min, aVerts[i] );
+            max = Math.max( max, aVerts[i] );
+        }
+        
+        size = Math.max( size, max - min );
+        outOffset[k] = bVerts[k] - aVerts[k];
+    }
+    
+    var tolerance = GInstanceDetector.TOLERANCE * Math.max( 1, size, 
+                        Math.abs( outOffset[0] ), Math.abs( outOffset[1] ), Math.abs( outOffset[2] ) );
+    
+    for ( i = 0; i < aVerts.length; i += 3 )
+    {
+        for ( k = 0; k < 3; ++k )
+        {
+            if ( Math.abs( bVerts[i+k] - aVerts[i+k] - outOffset[k] ) > tolerance )
+            {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+};
+
+/**
+ * @param {Float32Array} a
+ * @param {Float32Array} b
+ * @param {number} tolerance
+ * @return {boolean} True if every value of a is within tolerance of b
+ */
+GInstanceDetector.isClose = function( a, b, tolerance )
+{
+    if ( a.length !== b.length )
+    {
+        return false;
+    }
+    
+    for ( var i = 0; i < a.length; ++i )
+    {
+        if ( Math.abs( a[i] - b[i] ) > tolerance )
+        {
+            return false;
+        }
+    }
+    
+    return true;
+};
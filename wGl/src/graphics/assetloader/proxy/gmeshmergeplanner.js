@@ -0,0 +1,184 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Plans the merge of meshes that share a material.  Meshes are first
+ * assigned to buckets while only their sizes are tracked, once every mesh is
+ * known each bucket is built into a single exactly sized mesh, so every
+ * source mesh is copied once no matter how many meshes end up in a bucket.
+ * @constructor
+ * @param {number=} maxVertCount Largest number of vertices in a merged mesh
+ */
+function GMeshMergePlanner( maxVertCount )
+{
+    this.maxVertCount = maxVertCount || GeometryTriMesh.MAX_MERGE_VERT_COUNT;
+    this.bucketsByMtl = {};
+    this.mtlNames = [];
+    this.bucketCount = 0;
+}
+
+/**
+ * Add a mesh to the first bucket with its material that still has room for
+ * it, a new bucket is opened if there is none
+ * @param {GeometryTriMesh} mesh
+ * @return {boolean} True if the mesh opened a new bucket
+ */
+GMeshMergePlanner.prototype.add = function( mesh )
+{
+    var mtlName = mesh.getMtlName();
+    var buckets = this.bucketsByMtl[mtlName];
+    var vertCount = mesh.getVertCount();
+
+    if ( undefined === buckets )
+    {
+        buckets = [];
+        this.bucketsByMtl[mtlName] = buckets;
+        this.mtlNames.push( mtlName );
+    }
+
+    for ( var i = 0; i < buckets.length; ++i )
+    {
+        if ( buckets[i].vertCount + vertCount <= this.maxVertCount )
+        {
+            buckets[i].meshes.push( mesh );
+            buckets[i].vertCount += vertCount;
+            buckets[i].indexCount += mesh.getIndexCount();
+            return false;
+        }
+    }
+
+    buckets.push( { meshes: [mesh], 
+                    vertCount: vertCount, 
+                    indexCount: mesh.getIndexCount(), 
+                    order: this.bucketCount } );
+    ++this.bucketCount;
+
+    return true;
+};
+
+/**
+ * Returns true if there are buckets left to build
+ * @return {boolean}
+ */
+GMeshMergePlanner.prototype.hasPending = function()
+{
+    return this.mtlNames.length > 0;
+};
+
+/**
+ * Build the buckets of the oldest material that was not built yet
+ * @return {Array.<GeometryTriMesh>} One mesh per bucket
+ */
+GMeshMergePlanner.prototype.buildNextMtl = function()
+{
+    var mtlName = this.mtlNames.shift();
+    var buckets = this.bucketsByMtl[mtlName];
+    var ret = [];
+
+    delete this.bucketsByMtl[mtlName];
+
+    for ( var i = 0; i < buckets.length; ++i )
+    {
+        ret.push( GMeshMergePlanner.buildBucket( buckets[i] ) );
+    }
+
+    return ret;
+};
+
+/**
+ * Build every bucket that is left
+ * @return {Array.<GeometryTriMesh>} One mesh per bucket in the order the 
+ * buckets were opened
+ */
+GMeshMergePlanner.prototype.buildAll = function()
+{
+    var ret = [];
+
+    while ( this.hasPending() )
+    {
+        var buckets = this.bucketsByMtl[this.mtlNames[0]];
+        var meshes = this.buildNextMtl();
+
+        for ( var i = 0; i < meshes.length; ++i )
+        {
+            ret[buckets[i].order] = meshes[i];
+        }
+    }
+
+    this.bucketCount = 0;
+
+    return ret;
+};
+
+/**
+ * Copy the meshes of a bucket into one mesh
+ * @param {Object} bucket
+ * @return {GeometryTriMesh}
+ */
+GMeshMergePlanner.buildBucket = function( bucket )
+{
+    var meshes = bucket.meshes;
+
+    if ( 1 === meshes.length )
+    {
+        return meshes[0];
+    }
+
+    var ret = new GeometryTriMesh( meshes[0].getName(), bucket.vertCount, bucket.indexCount );
+    ret.setMtlName( meshes[0].getMtlName() );
+
+    // the target is exactly sized, every stream is copied in one block 
+    // straight into its final place and only the indices go one by one
+    var verts = ret.gVerts.data;
+    var normals = ret.nVerts.data;
+    var tverts = ret.tVerts.data;
+    var indices = ret.indices.data;
+    var vertOffset = 0;
+    var tvertOffset = 0;
+    var indexOffset = 0;
+
+    for ( var i = 0; i < meshes.length; ++i )
+    {
+        var mesh = meshes[i];
+        var base = vertOffset / 3;
+        var src = mesh.indices.data;
+        var count = mesh.indices.length;
+
+        mesh.gVerts.copyTo( verts, vertOffset );
+        mesh.nVerts.copyTo( normals, vertOffset );
+        mesh.tVerts.copyTo( tverts, tvertOffset );
+
+        for ( var j = 0; j < count; ++j )
+        {
+            indices[indexOffset + j] = src[j] + base;
+        }
+
+        vertOffset += mesh.gVerts.length;
+        tvertOffset += mesh.tVerts.length;
+        indexOffset += count;
+    }
+
+    ret.gVerts.length = vertOffset;
+    ret.nVerts.length = vertOffset;
+    ret.tVerts.length = tvertOffset;
+    ret.indices.length = indexOffset;
+
+    return ret;
+};
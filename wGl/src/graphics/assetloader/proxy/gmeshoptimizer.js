@@ -0,0 +1,984 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Reorders the triangles and vertices of a GeometryTriMesh for the GPU.  The
+ * vertices that ended up identical (e.g. the face normals that were smoothed
+ * by prepareToClose) are welded first.  The triangles are then put in vertex cache order with Tipsify (Sander, Nehab
+ * and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+ * Overdraw").  The result is cut into clusters wherever the cache order
+ * breaks, or wherever the cache is already warm enough to start over.  The
+ * clusters are sorted so the ones facing away from the center of the mesh
+ * are drawn first, letting the depth test reject the fragments behind them.
+ * Finally the vertices are renumbered in the order they're first used so the
+ * attribute fetches walk the buffers forward.  The work is done by step, a 
+ * bounded amount at a time, so it can run inside the frame budget of a 
+ * GJobScheduler.
+ * @constructor
+ * @param {GeometryTriMesh} mesh Mesh to optimize, its buffers are rewritten
+ *        in place once the last step is done
+ */
+function GMeshOptimizer( mesh )
+{
+    this.mesh = mesh;
+    this.indices = mesh.indices.view();
+    this.vertCount = mesh.getVertCount();
+    this.triCount = this.indices.length / 3;
+    this.cursor = 0;
+    
+    // welding
+    this.weldTable = undefined;
+    this.canonical = undefined;
+    
+    // vertex cache order
+    this.liveCount = undefined;
+    this.adjStart = undefined;
+    this.adjTris = undefined;
+    this.adjFill = undefined;
+    this.cacheTime = undefined;
+    this.emitted = undefined;
+    this.deadEnd = undefined;
+    this.deadEndLength = 0;
+    this.candidates = [];
+    this.cacheOrdered = undefined;
+    this.outLength = 0;
+    this.time = 0;
+    this.fan = 0;
+    this.vertCursor = 0;
+    this.clusters = [];
+    
+    // cache simulation
+    this.simCacheTime = undefined;
+    this.simTime = 0;
+    this.simMisses = 0;
+    this.cacheOrderedAcmr = 0;
+    this.inputAcmr = 0;
+    
+    // clusters
+    this.splitTarget = 0;
+    this.splitClusters = [];
+    this.clusterIndex = 0;
+    this.clusterStart = 0;
+    this.clusterMisses = 0;
+    this.meshCenter = [ 0, 0, 0 ];
+    this.meshArea = 0;
+    this.center = undefined;
+    this.normal = undefined;
+    this.area = 0;
+    this.centers = [];
+    this.normals = [];
+    this.keys = [];
+    this.ordered = undefined;
+    this.orderedLength = 0;
+    
+    // vertex fetch
+    this.remap = undefined;
+    this.newCount = 0;
+    this.attributes = [ mesh.gVerts, mesh.nVerts, mesh.tVerts ];
+    this.attributeSizes = [ 3, 3, 2 ];
+    this.remapped = [];
+    
+    if ( this.indices.length < 6 )
+    {
+        this.phase = GMeshOptimizer.PHASE_DONE;
+    }
+    else
+    {
+        this.startPhase( GMeshOptimizer.PHASE_WELD_TABLE );
+    }
+}
+
+/**
+ * Size of the FIFO vertex cache that is optimized for and simulated
+ */
+GMeshOptimizer.CACHE_SIZE = 16;
+
+/**
+ * A cluster can end once its cache miss ratio is within this factor of the
+ * ratio of the whole mesh
+ */
+GMeshOptimizer.OVERDRAW_THRESHOLD = 1.05;
+
+/**
+ * The phases step goes through, each one but the vertex cache order walks 
+ * the vertices, indices, triangles or clusters of the mesh from the cursor on
+ */
+GMeshOptimizer.PHASE_WELD_TABLE = 0;
+GMeshOptimizer.PHASE_WELD = 1;
+GMeshOptimizer.PHASE_WELD_INDICES = 2;
+GMeshOptimizer.PHASE_COUNT_USES = 3;
+GMeshOptimizer.PHASE_ADJACENCY_START = 4;
+GMeshOptimizer.PHASE_ADJACENCY = 5;
+GMeshOptimizer.PHASE_VERTEX_CACHE = 6;
+GMeshOptimizer.PHASE_ANALYZE_CACHE_ORDER = 7;
+GMeshOptimizer.PHASE_ANALYZE_INPUT = 8;
+GMeshOptimizer.PHASE_SPLIT_CLUSTERS = 9;
+GMeshOptimizer.PHASE_CLUSTER_CENTERS = 10;
+GMeshOptimizer.PHASE_CLUSTER_KEYS = 11;
+GMeshOptimizer.PHASE_CLUSTER_ORDER = 12;
+GMeshOptimizer.PHASE_ANALYZE_ORDERED = 13;
+GMeshOptimizer.PHASE_FETCH_CLEAR = 14;
+GMeshOptimizer.PHASE_FETCH = 15;
+GMeshOptimizer.PHASE_FETCH_ATTRIBUTES = 16;
+GMeshOptimizer.PHASE_DONE = 17;
+
+/**
+ * Run every step on the provided mesh in one go, the buffers are rewritten 
+ * in place
+ * @param {GeometryTriMesh} mesh
+ */
+GMeshOptimizer.optimize = function( mesh )
+{
+    var optimizer = new GMeshOptimizer( mesh );
+    
+    while ( !optimizer.step( Infinity ) ) {}
+};
+
+/**
+ * Do the next part of the work on the mesh
+ * @param {number} budget Largest number of vertices, indices, triangles or 
+ *        clusters to go through
+ * @return {boolean} True once the mesh is optimized
+ */
+GMeshOptimizer.prototype.step = function( budget )
+{
+    if ( GMeshOptimizer.PHASE_VERTEX_CACHE === this.phase )
+    {
+        this.orderForVertexCache( budget );
+    }
+    else if ( GMeshOptimizer.PHASE_DONE !== this.phase )
+    {
+        var length = this.getPhaseLength();
+        var end = Math.min( length, this.cursor + budget );
+        
+        this.runPhase( this.cursor, end );
+        this.cursor = end;
+        
+        if ( end === length )
+        {
+            this.startPhase( this.phase + 1 );
+        }
+    }
+    
+    return GMeshOptimizer.PHASE_DONE === this.phase;
+};
+
+/**
+ * @return {number} Number of items the current phase goes through
+ */
+GMeshOptimizer.prototype.getPhaseLength = function()
+{
+    var phase = this.phase;
+    
+    if ( GMeshOptimizer.PHASE_WELD_TABLE === phase )
+    {
+        return this.weldTable.length;
+    }
+    
+    if ( GMeshOptimizer.PHASE_WELD === phase || GMeshOptimizer.PHASE_ADJACENCY_START === phase ||
+         GMeshOptimizer.PHASE_FETCH_CLEAR === phase || GMeshOptimizer.PHASE_FETCH_ATTRIBUTES === phase )
+    {
+        return this.vertCount;
+    }
+    
+    if ( GMeshOptimizer.PHASE_SPLIT_CLUSTERS === phase || GMeshOptimizer.PHASE_CLUSTER_CENTERS === phase )
+    {
+        return this.triCount;
+    }
+    
+    if ( GMeshOptimizer.PHASE_CLUSTER_KEYS === phase || GMeshOptimizer.PHASE_CLUSTER_ORDER === phase )
+    {
+        return this.clusters.length;
+    }
+    
+    return this.indices.length;
+};
+
+/**
+ * Go through part of the items of the current phase
+ * @param {number} start First item
+ * @param {number} end Item after the last one
+ */
+GMeshOptimizer.prototype.runPhase = function( start, end )
+{
+    var phase = this.phase;
+    
+    if ( GMeshOptimizer.PHASE_WELD_TABLE === phase )
+    {
+        this.clearWeldTable( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_WELD === phase )
+    {
+        this.weldVertices( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_WELD_INDICES === phase )
+    {
+        this.weldIndices( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_COUNT_USES === phase )
+    {
+        this.countUses( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_ADJACENCY_START === phase )
+    {
+        this.buildAdjacencyStart( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_ADJACENCY === phase )
+    {
+        this.buildAdjacency( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_CACHE_ORDER === phase )
+    {
+        this.simulateCache( this.cacheOrdered, start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_INPUT === phase )
+    {
+        this.simulateCache( this.indices, start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_SPLIT_CLUSTERS === phase )
+    {
+        this.splitClustersAt( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_CENTERS === phase )
+    {
+        this.accumulateClusters( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_KEYS === phase )
+    {
+        this.buildClusterKeys( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_ORDER === phase )
+    {
+        this.copySortedClusters( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_ORDERED === phase )
+    {
+        this.simulateCache( this.ordered, start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_FETCH_CLEAR === phase )
+    {
+        this.clearRemap( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_FETCH === phase )
+    {
+        this.remapIndices( start, end );
+    }
+    else if ( GMeshOptimizer.PHASE_FETCH_ATTRIBUTES === phase )
+    {
+        this.remapAttributes( start, end );
+    }
+};
+
+/**
+ * Move on to a phase, wrap up the results of the previous one and allocate 
+ * what the new one needs
+ * @param {number} phase
+ */
+GMeshOptimizer.prototype.startPhase = function( phase )
+{
+    var vertCount = this.vertCount;
+    var i = 0;
+    
+    this.phase = phase;
+    this.cursor = 0;
+    
+    if ( GMeshOptimizer.PHASE_WELD_TABLE === phase )
+    {
+        var tableSize = 1;
+        
+        while ( tableSize < 2 * vertCount )
+        {
+            tableSize *= 2;
+        }
+        
+        this.weldTable = new Int32Array( tableSize );
+        this.canonical = new Uint32Array( vertCount );
+    }
+    else if ( GMeshOptimizer.PHASE_COUNT_USES === phase )
+    {
+        this.weldTable = undefined;
+        this.canonical = undefined;
+        this.liveCount = new Uint32Array( vertCount );
+        this.adjStart = new Uint32Array( vertCount + 1 );
+    }
+    else if ( GMeshOptimizer.PHASE_ADJACENCY === phase )
+    {
+        this.adjTris = new Uint32Array( this.indices.length );
+        this.adjFill = new Uint32Array( this.adjStart.subarray( 0, vertCount ) );
+    }
+    else if ( GMeshOptimizer.PHASE_VERTEX_CACHE === phase )
+    {
+        this.adjFill = undefined;
+        this.cacheTime = new Uint32Array( vertCount );
+        this.emitted = new Uint8Array( this.triCount );
+        this.deadEnd = new Uint32Array( this.indices.length );
+        this.cacheOrdered = new Uint32Array( this.indices.length );
+        this.time = GMeshOptimizer.CACHE_SIZE + 1;
+        this.clusters.push( 0 );
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_CACHE_ORDER === phase )
+    {
+        this.liveCount = undefined;
+        this.adjStart = undefined;
+        this.adjTris = undefined;
+        this.cacheTime = undefined;
+        this.emitted = undefined;
+        this.deadEnd = undefined;
+        this.resetCacheSimulation();
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_INPUT === phase )
+    {
+        this.cacheOrderedAcmr = this.getSimulatedAcmr();
+        this.resetCacheSimulation();
+    }
+    else if ( GMeshOptimizer.PHASE_SPLIT_CLUSTERS === phase )
+    {
+        this.inputAcmr = this.getSimulatedAcmr();
+        this.splitTarget = this.cacheOrderedAcmr * GMeshOptimizer.OVERDRAW_THRESHOLD;
+        this.resetCacheSimulation();
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_CENTERS === phase )
+    {
+        this.clusters = this.splitClusters;
+        this.splitClusters = [];
+        this.clusterIndex = -1;
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_KEYS === phase )
+    {
+        this.closeCluster();
+        
+        for ( i = 0; i < 3; ++i )
+        {
+            this.meshCenter[i] = ( this.meshArea > 0 ) ? this.meshCenter[i] / this.meshArea : 0;
+        }
+    }
+    else if ( GMeshOptimizer.PHASE_CLUSTER_ORDER === phase )
+    {
+        this.keys.sort( function( x, y ) { return ( y.dot - x.dot ) || ( x.cluster - y.cluster ); } );
+        this.ordered = new Uint32Array( this.indices.length );
+    }
+    else if ( GMeshOptimizer.PHASE_ANALYZE_ORDERED === phase )
+    {
+        this.resetCacheSimulation();
+    }
+    else if ( GMeshOptimizer.PHASE_FETCH_CLEAR === phase )
+    {
+        this.applyTriangleOrder();
+        this.remap = new Int32Array( vertCount );
+    }
+    else if ( GMeshOptimizer.PHASE_FETCH_ATTRIBUTES === phase )
+    {
+        for ( i = 0; i < this.attributes.length; ++i )
+        {
+            this.remapped.push( new this.attributes[i].type( this.attributeSizes[i] * this.newCount ) );
+        }
+    }
+    else if ( GMeshOptimizer.PHASE_DONE === phase )
+    {
+        for ( i = 0; i < this.attributes.length; ++i )
+        {
+            this.attributes[i].data = this.remapped[i];
+            this.attributes[i].length = this.remapped[i].length;
+        }
+        
+        this.remap = undefined;
+        this.remapped = [];
+    }
+};
+
+/**
+ * Empty the slots of the hash table used to weld the vertices
+ * @param {number} start First slot
+ * @param {number} end Slot after the last one
+ */
+GMeshOptimizer.prototype.clearWeldTable = function( start, end )
+{
+    for ( var i = start; i < end; ++i )
+    {
+        this.weldTable[i] = -1;
+    }
+};
+
+/**
+ * Find the first of the vertices with the same position, normal and texture
+ * coordinates for each vertex, the ones left unused by weldIndices are 
+ * dropped by the vertex fetch phases
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshOptimizer.prototype.weldVertices = function( start, end )
+{
+    var mesh = this.mesh;
+    var vertCount = this.vertCount;
+    var g = mesh.gVerts.data;
+    var n = mesh.nVerts.data;
+    var t = mesh.tVerts.data;
+    var gBits = new Uint32Array( g.buffer, g.byteOffset, 3*vertCount );
+    var nBits = new Uint32Array( n.buffer, n.byteOffset, 3*vertCount );
+    var tBits = new Uint32Array( t.buffer, t.byteOffset, 2*vertCount );
+    var table = this.weldTable;
+    var tableSize = table.length;
+    var canonical = this.canonical;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var hash = ( gBits[3*i] * 73856093 ) ^ ( gBits[3*i+1] * 19349663 ) ^ ( gBits[3*i+2] * 83492791 ) ^
+                   ( nBits[3*i] * 49979693 ) ^ ( tBits[2*i] * 86028121 ) ^ ( tBits[2*i+1] * 67867967 );
+        var slot = hash & ( tableSize - 1 );
+        
+        canonical[i] = i;
+        
+        while ( -1 !== table[slot] )
+        {
+            var o = table[slot];
+            
+            if ( gBits[3*o] === gBits[3*i] && gBits[3*o+1] === gBits[3*i+1] && gBits[3*o+2] === gBits[3*i+2] &&
+                 nBits[3*o] === nBits[3*i] && nBits[3*o+1] === nBits[3*i+1] && nBits[3*o+2] === nBits[3*i+2] &&
+                 tBits[2*o] === tBits[2*i] && tBits[2*o+1] === tBits[2*i+1] )
+            {
+                canonical[i] = o;
+                break;
+            }
+            
+            slot = ( slot + 1 ) & ( tableSize - 1 );
+        }
+        
+        if ( canonical[i] === i )
+        {
+            table[slot] = i;
+        }
+    }
+};
+
+/**
+ * Point the indices to the first of the identical vertices
+ * @param {number} start First index
+ * @param {number} end Index after the last one
+ */
+GMeshOptimizer.prototype.weldIndices = function( start, end )
+{
+    var indices = this.indices;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        indices[i] = this.canonical[indices[i]];
+    }
+};
+
+/**
+ * Count the triangles that use each vertex
+ * @param {number} start First index
+ * @param {number} end Index after the last one
+ */
+GMeshOptimizer.prototype.countUses = function( start, end )
+{
+    for ( var i = start; i < end; ++i )
+    {
+        ++this.liveCount[this.indices[i]];
+    }
+};
+
+/**
+ * Find where the triangles of each vertex start in the adjacency list
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshOptimizer.prototype.buildAdjacencyStart = function( start, end )
+{
+    for ( var i = start; i < end; ++i )
+    {
+        this.adjStart[i+1] = this.adjStart[i] + this.liveCount[i];
+    }
+};
+
+/**
+ * List the triangles of each vertex
+ * @param {number} start First index
+ * @param {number} end Index after the last one
+ */
+GMeshOptimizer.prototype.buildAdjacency = function( start, end )
+{
+    for ( var i = start; i < end; ++i )
+    {
+        this.adjTris[this.adjFill[this.indices[i]]++] = ( i / 3 ) | 0;
+    }
+};
+
+/**
+ * Reorder the triangles for the FIFO vertex cache, the first triangle of 
+ * every run that starts from an unrelated vertex begins a cluster
+ * @param {number} budget Largest number of triangles to go through
+ */
+GMeshOptimizer.prototype.orderForVertexCache = function( budget )
+{
+    var indices = this.indices;
+    var cacheSize = GMeshOptimizer.CACHE_SIZE;
+    var liveCount = this.liveCount;
+    var adjStart = this.adjStart;
+    var adjTris = this.adjTris;
+    var cacheTime = this.cacheTime;
+    var emitted = this.emitted;
+    var deadEnd = this.deadEnd;
+    var candidates = this.candidates;
+    var output = this.cacheOrdered;
+    var outLength = this.outLength;
+    var deadEndLength = this.deadEndLength;
+    var time = this.time;
+    var cursor = this.vertCursor;
+    var fan = this.fan;
+    var work = 0;
+    var i = 0;
+    var k = 0;
+    
+    while ( fan >= 0 && work < budget )
+    {
+        candidates.length = 0;
+        
+        // emit every triangle left around the fanning vertex
+        for ( i = adjStart[fan]; i < adjStart[fan+1]; ++i )
+        {
+            var tri = adjTris[i];
+            
+            ++work;
+            
+            if ( emitted[tri] )
+            {
+                continue;
+            }
+            
+            for ( k = 0; k < 3; ++k )
+            {
+                var v = indices[3*tri+k];
+                
+                output[outLength++] = v;
+                deadEnd[deadEndLength++] = v;
+                candidates.push( v );
+                --liveCount[v];
+                
+                if ( time - cacheTime[v] > cacheSize )
+                {
+                    cacheTime[v] = time++;
+                }
+            }
+            
+            emitted[tri] = 1;
+        }
+        
+        // prefer the candidate that stays longest in the cache once its
+        // remaining triangles are emitted
+        var next = -1;
+        var best = -1;
+        
+        for ( i = 0; i < candidates.length; ++i )
+        {
+            var c = candidates[i];
+            
+            if ( liveCount[c] > 0 )
+            {
+                var priority = 0;
+                
+                if ( time - cacheTime[c] + 2 * liveCount[c] <= cacheSize )
+                {
+                    priority = time - cacheTime[c];
+                }
+                
+                if ( priority > best )
+                {
+                    best = priority;
+                    next = c;
+                }
+            }
+        }
+        
+        if ( -1 === next )
+        {
+            // dead end, go back through the recently used vertices or 
+            // continue with the next vertex in the input order
+            while ( deadEndLength > 0 && -1 === next )
+            {
+                var d = deadEnd[--deadEndLength];
+                if ( liveCount[d] > 0 )
+                {
+                    next = d;
+                }
+            }
+            
+            while ( cursor < this.vertCount && -1 === next )
+            {
+                if ( liveCount[cursor] > 0 )
+                {
+                    next = cursor;
+                    this.clusters.push( outLength / 3 );
+                }
+                
+                ++cursor;
+            }
+        }
+        
+        fan = next;
+    }
+    
+    this.outLength = outLength;
+    this.deadEndLength = deadEndLength;
+    this.time = time;
+    this.vertCursor = cursor;
+    this.fan = fan;
+    
+    if ( fan < 0 )
+    {
+        this.startPhase( GMeshOptimizer.PHASE_VERTEX_CACHE + 1 );
+    }
+};
+
+/**
+ * Start a new simulation of the FIFO vertex cache
+ */
+GMeshOptimizer.prototype.resetCacheSimulation = function()
+{
+    this.simCacheTime = new Uint32Array( this.vertCount );
+    this.simTime = GMeshOptimizer.CACHE_SIZE + 1;
+    this.simMisses = 0;
+};
+
+/**
+ * Run part of a triangle list through the simulated vertex cache
+ * @param {Uint32Array} indices Triangle list
+ * @param {number} start First index
+ * @param {number} end Index after the last one
+ */
+GMeshOptimizer.prototype.simulateCache = function( indices, start, end )
+{
+    var cacheTime = this.simCacheTime;
+    var time = this.simTime;
+    var misses = 0;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var v = indices[i];
+        
+        if ( time - cacheTime[v] > GMeshOptimizer.CACHE_SIZE )
+        {
+            cacheTime[v] = time++;
+            ++misses;
+        }
+    }
+    
+    this.simTime = time;
+    this.simMisses += misses;
+};
+
+/**
+ * @return {number} Average cache misses per triangle of the simulation
+ */
+GMeshOptimizer.prototype.getSimulatedAcmr = function()
+{
+    return this.simMisses / this.triCount;
+};
+
+/**
+ * Split the clusters further wherever the cache misses so far are close 
+ * enough to the ones of the whole list, each cluster restarts with a cold 
+ * cache so the cost of reordering them stays bounded
+ * @param {number} start First triangle
+ * @param {number} end Triangle after the last one
+ */
+GMeshOptimizer.prototype.splitClustersAt = function( start, end )
+{
+    var indices = this.cacheOrdered;
+    var clusters = this.clusters;
+    var cacheSize = GMeshOptimizer.CACHE_SIZE;
+    var cacheTime = this.simCacheTime;
+    var result = this.splitClusters;
+    
+    for ( var t = start; t < end; ++t )
+    {
+        while ( this.clusterIndex < clusters.length && clusters[this.clusterIndex] === t )
+        {
+            result.push( t );
+            this.clusterStart = t;
+            this.clusterMisses = 0;
+            this.simTime += cacheSize + 1;
+            ++this.clusterIndex;
+        }
+        
+        var clusterEnd = ( this.clusterIndex < clusters.length ) ? clusters[this.clusterIndex] : this.triCount;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            var v = indices[3*t+k];
+            
+            if ( this.simTime - cacheTime[v] > cacheSize )
+            {
+                cacheTime[v] = this.simTime++;
+                ++this.clusterMisses;
+            }
+        }
+        
+        if ( t + 1 < clusterEnd && this.clusterMisses <= ( t + 1 - this.clusterStart ) * this.splitTarget )
+        {
+            result.push( t + 1 );
+            this.clusterStart = t + 1;
+            this.clusterMisses = 0;
+            this.simTime += cacheSize + 1;
+        }
+    }
+};
+
+/**
+ * Add up the area weighted center and the normal of the clusters
+ * @param {number} start First triangle
+ * @param {number} end Triangle after the last one
+ */
+GMeshOptimizer.prototype.accumulateClusters = function( start, end )
+{
+    var indices = this.cacheOrdered;
+    var verts = this.mesh.getVertBuffer();
+    var clusters = this.clusters;
+    
+    for ( var t = start; t < end; ++t )
+    {
+        while ( this.clusterIndex + 1 < clusters.length && clusters[this.clusterIndex + 1] === t )
+        {
+            this.closeCluster();
+            ++this.clusterIndex;
+            this.center = [ 0, 0, 0 ];
+            this.normal = [ 0, 0, 0 ];
+            this.area = 0;
+        }
+        
+        var center = this.center;
+        var normal = this.normal;
+        var a = 3 * indices[3*t];
+        var b = 3 * indices[3*t+1];
+        var c = 3 * indices[3*t+2];
+        
+        var e1x = verts[b] - verts[a], e1y = verts[b+1] - verts[a+1], e1z = verts[b+2] - verts[a+2];
+        var e2x = verts[c] - verts[a], e2y = verts[c+1] - verts[a+1], e2z = verts[c+2] - verts[a+2];
+        var nx = e1y*e2z - e1z*e2y;
+        var ny = e1z*e2x - e1x*e2z;
+        var nz = e1x*e2y - e1y*e2x;
+        var triArea = Math.sqrt( nx*nx + ny*ny + nz*nz );
+        
+        normal[0] += nx; normal[1] += ny; normal[2] += nz;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            center[k] += triArea * ( verts[a+k] + verts[b+k] + verts[c+k] ) / 3;
+        }
+        
+        this.area += triArea;
+    }
+};
+
+/**
+ * Finish the center of the cluster being accumulated
+ */
+GMeshOptimizer.prototype.closeCluster = function()
+{
+    if ( this.clusterIndex < 0 )
+    {
+        return;
+    }
+    
+    for ( var k = 0; k < 3; ++k )
+    {
+        this.meshCenter[k] += this.center[k];
+        this.center[k] = ( this.area > 0 ) ? this.center[k] / this.area : 0;
+    }
+    
+    this.meshArea += this.area;
+    this.centers.push( this.center );
+    this.normals.push( this.normal );
+};
+
+/**
+ * Find how much the clusters face away from the center of the mesh, those 
+ * are the most likely to cover the rest of the mesh and go first
+ * @param {number} start First cluster
+ * @param {number} end Cluster after the last one
+ */
+GMeshOptimizer.prototype.buildClusterKeys = function( start, end )
+{
+    var meshCenter = this.meshCenter;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var n = this.normals[i];
+        var center = this.centers[i];
+        var length = Math.sqrt( n[0]*n[0] + n[1]*n[1] + n[2]*n[2] );
+        var dot = 0;
+        
+        if ( length > 0 )
+        {
+            dot = ( ( center[0] - meshCenter[0] ) * n[0] + 
+                    ( center[1] - meshCenter[1] ) * n[1] + 
+                    ( center[2] - meshCenter[2] ) * n[2] ) / length;
+        }
+        
+        this.keys.push( { dot: dot, cluster: i } );
+    }
+};
+
+/**
+ * Copy the triangles of the clusters in their sorted order
+ * @param {number} start First sorted cluster
+ * @param {number} end Sorted cluster after the last one
+ */
+GMeshOptimizer.prototype.copySortedClusters = function( start, end )
+{
+    var clusters = this.clusters;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var cluster = this.keys[i].cluster;
+        var first = 3 * clusters[cluster];
+        var last = 3 * ( ( cluster + 1 < clusters.length ) ? clusters[cluster+1] : this.triCount );
+        
+        this.ordered.set( this.cacheOrdered.subarray( first, last ), this.orderedLength );
+        this.orderedLength += last - first;
+    }
+};
+
+/**
+ * Write the best of the triangle orders to the mesh
+ */
+GMeshOptimizer.prototype.applyTriangleOrder = function()
+{
+    var ordered = this.ordered;
+    
+    // every cluster starts with a cold cache once they are sorted, on meshes
+    // that were already in a good order that can cost more than it saves
+    if ( this.getSimulatedAcmr() > this.inputAcmr )
+    {
+        ordered = ( this.cacheOrderedAcmr <= this.inputAcmr ) ? this.cacheOrdered : this.indices;
+    }
+    
+    this.indices.set( ordered );
+    
+    this.simCacheTime = undefined;
+    this.cacheOrdered = undefined;
+    this.ordered = undefined;
+    this.clusters = [];
+    this.centers = [];
+    this.normals = [];
+    this.keys = [];
+};
+
+/**
+ * Mark every vertex as unused
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshOptimizer.prototype.clearRemap = function( start, end )
+{
+    for ( var i = start; i < end; ++i )
+    {
+        this.remap[i] = -1;
+    }
+};
+
+/**
+ * Renumber the vertices of the mesh in the order the triangles use them, 
+ * vertices no triangle uses are dropped
+ * @param {number} start First index
+ * @param {number} end Index after the last one
+ */
+GMeshOptimizer.prototype.remapIndices = function( start, end )
+{
+    var indices = this.indices;
+    var remap = this.remap;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var v = indices[i];
+        
+        if ( -1 === remap[v] )
+        {
+            remap[v] = this.newCount++;
+        }
+        
+        indices[i] = remap[v];
+    }
+};
+
+/**
+ * Move the values of the vertices to their new position
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshOptimizer.prototype.remapAttributes = function( start, end )
+{
+    var remap = this.remap;
+    
+    for ( var a = 0; a < this.attributes.length; ++a )
+    {
+        var src = this.attributes[a].view();
+        var dst = this.remapped[a];
+        var size = this.attributeSizes[a];
+        
+        for ( var i = start; i < end; ++i )
+        {
+            if ( remap[i] >= 0 )
+            {
+                for ( var k = 0; k < size; ++k )
+                {
+                    dst[size*remap[i]+k] = src[size*i+k];
+                }
+            }
+        }
+    }
+};
+
+/**
+ * Simulate a FIFO vertex cache over a triangle list
+ * @param {Uint32Array|Uint16Array} indices Triangle list
+ * @param {number} vertCount Number of vertices referenced by the list
+ * @param {number} cacheSize
+ * @return {{acmr: number, atvr: number}} Average cache misses per triangle 
+ *         and per referenced vertex, 1 for the latter is the ideal
+ */
+GMeshOptimizer.analyzeVertexCache = function( indices, vertCount, cacheSize )
+{
+    var cacheTime = new Uint32Array( vertCount );
+    var used = new Uint8Array( vertCount );
+    var time = cacheSize + 1;
+    var misses = 0;
+    var usedCount = 0;
+    
+    for ( var i = 0; i < indices.length; ++i )
+    {
+        var v = indices[i];
+        
+        if ( time - cacheTime[v] > cacheSize )
+        {
+            cacheTime[v] = time++;
+            ++misses;
+        }
+        
+        if ( !used[v] )
+        {
+            used[v] = 1;
+            ++usedCount;
+        }
+    }
+    
+    return { acmr: ( indices.length > 0 ) ? misses / ( indices.length / 3 ) : 0,
+             atvr: ( usedCount > 0 ) ? misses / usedCount : 0 };
+};
@@ -0,0 +1,821 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Quadric error metric simplifier that builds the levels of detail of a 
+ * GeometryTriMesh.  Vertices are welded by position so the attribute seams of
+ * the mesh don't tear, edges are collapsed onto one of their end points 
+ * (half edge collapse) so the surviving vertex keeps its normal and texture
+ * coordinates, and open borders are held in place by extra constraint planes.
+ * The chain is built by step, a bounded amount of work at a time, so it can
+ * run inside the frame budget of a GJobScheduler.
+ * @constructor
+ * @param {GeometryTriMesh} mesh Mesh to simplify, it is not modified
+ */
+function GMeshSimplifier( mesh )
+{
+    this.mesh = mesh;
+    this.g = mesh.getVertBuffer();
+    this.n = mesh.getNormBuffer();
+    this.t = mesh.getTVerBuffer();
+    
+    var indices = mesh.indices.view();
+    this.triCount = indices.length / 3;
+    this.liveTriCount = this.triCount;
+    this.corners = new Uint32Array( indices );
+    this.triAlive = new Uint8Array( this.triCount );
+    
+    this.weld = new Uint32Array( this.g.length / 3 );
+    this.weldKeys = {};
+    this.weldCount = 0;
+    this.weldPos = undefined;
+    this.weldMark = undefined;
+    this.weldVerts = [];
+    this.weldTris = [];
+    this.quadrics = undefined;
+    this.edges = {};
+    this.edgeKeys = [];
+    
+    this.heapCost = [];
+    this.heapFrom = [];
+    this.heapTo = [];
+    this.heapLength = 0;
+    this.markCounter = 0;
+    
+    this.levels = [ mesh ];
+    this.phase = GMeshSimplifier.PHASE_WELD;
+    this.cursor = 0;
+}
+
+/**
+ * Fraction of the triangles kept by each level after the first one
+ */
+GMeshSimplifier.LEVEL_RATIOS = [ 0.5, 0.25, 0.1 ];
+
+/**
+ * Meshes with fewer triangles don't get levels of detail
+ */
+GMeshSimplifier.MIN_LOD_TRIANGLES = 512;
+
+/**
+ * Weight of the planes that keep open borders in place
+ */
+GMeshSimplifier.BORDER_WEIGHT = 1000;
+
+/**
+ * The phases step goes through, each one but the last two walks the 
+ * vertices, triangles or edges of the mesh from the cursor on
+ */
+GMeshSimplifier.PHASE_WELD = 0;
+GMeshSimplifier.PHASE_WELD_POSITIONS = 1;
+GMeshSimplifier.PHASE_ADJACENCY = 2;
+GMeshSimplifier.PHASE_QUADRICS = 3;
+GMeshSimplifier.PHASE_BORDERS = 4;
+GMeshSimplifier.PHASE_SEED = 5;
+GMeshSimplifier.PHASE_SIMPLIFY = 6;
+GMeshSimplifier.PHASE_DONE = 7;
+
+/**
+ * Build the chain of levels for a mesh in one go, the mesh itself is the
+ * first level
+ * @param {GeometryTriMesh} mesh
+ * @return {Array.<GeometryTriMesh>}
+ */
+GMeshSimplifier.buildLodChain = function( mesh )
+{
+    var simplifier = new GMeshSimplifier( mesh );
+    
+    while ( !simplifier.step( Infinity ) ) {}
+    
+    return simplifier.getLevels();
+};
+
+/**
+ * Do the next part of the work on the chain
+ * @param {number} budget Largest number of vertices, triangles, edges or
+ *        collapses to go through, a level is copied out on top of that 
+ *        once its target is reached
+ * @return {boolean} True once the chain is complete
+ */
+GMeshSimplifier.prototype.step = function( budget )
+{
+    if ( GMeshSimplifier.PHASE_SIMPLIFY === this.phase )
+    {
+        this.simplifyNextLevel( budget );
+    }
+    else if ( GMeshSimplifier.PHASE_DONE !== this.phase )
+    {
+        var length = this.getPhaseLength();
+        var end = Math.min( length, this.cursor + budget );
+        
+        this.runPhase( this.cursor, end );
+        this.cursor = end;
+        
+        if ( end === length )
+        {
+            this.startPhase( this.phase + 1 );
+        }
+    }
+    
+    return GMeshSimplifier.PHASE_DONE === this.phase;
+};
+
+/**
+ * Returns the levels built so far, the mesh itself is the first one
+ * @return {Array.<GeometryTriMesh>}
+ */
+GMeshSimplifier.prototype.getLevels = function()
+{
+    return this.levels;
+};
+
+/**
+ * @return {number} Number of items the current phase goes through
+ */
+GMeshSimplifier.prototype.getPhaseLength = function()
+{
+    if ( GMeshSimplifier.PHASE_WELD === this.phase || GMeshSimplifier.PHASE_WELD_POSITIONS === this.phase )
+    {
+        return this.g.length / 3;
+    }
+    
+    if ( GMeshSimplifier.PHASE_BORDERS === this.phase )
+    {
+        return this.edgeKeys.length;
+    }
+    
+    return this.triCount;
+};
+
+/**
+ * Go through part of the items of the current phase
+ * @param {number} start First item
+ * @param {number} end Item after the last one
+ */
+GMeshSimplifier.prototype.runPhase = function( start, end )
+{
+    if ( GMeshSimplifier.PHASE_WELD === this.phase )
+    {
+        this.weldVertices( start, end );
+    }
+    else if ( GMeshSimplifier.PHASE_WELD_POSITIONS === this.phase )
+    {
+        this.placeWeldedVertices( start, end );
+    }
+    else if ( GMeshSimplifier.PHASE_ADJACENCY === this.phase )
+    {
+        this.buildAdjacency( start, end );
+    }
+    else if ( GMeshSimplifier.PHASE_QUADRICS === this.phase )
+    {
+        this.buildQuadrics( start, end );
+    }
+    else if ( GMeshSimplifier.PHASE_BORDERS === this.phase )
+    {
+        this.addBorderPlanes( start, end );
+    }
+    else if ( GMeshSimplifier.PHASE_SEED === this.phase )
+    {
+        this.seedCollapses( start, end );
+    }
+};
+
+/**
+ * Move on to a phase and allocate what it needs
+ * @param {number} phase
+ */
+GMeshSimplifier.prototype.startPhase = function( phase )
+{
+    this.phase = phase;
+    this.cursor = 0;
+    
+    if ( GMeshSimplifier.PHASE_WELD_POSITIONS === phase )
+    {
+        this.weldKeys = undefined;
+        this.weldPos = new Float64Array( 3*this.weldCount );
+        this.weldMark = new Uint32Array( this.weldCount );
+    }
+    else if ( GMeshSimplifier.PHASE_QUADRICS === phase )
+    {
+        this.quadrics = new Float64Array( 10*this.weldCount );
+    }
+    else if ( GMeshSimplifier.PHASE_SEED === phase )
+    {
+        this.edges = undefined;
+        this.edgeKeys = undefined;
+    }
+};
+
+/**
+ * Collapse edges toward the target of the next level and copy the level 
+ * out once it's reached
+ * @param {number} budget Largest number of collapses to go through
+ */
+GMeshSimplifier.prototype.simplifyNextLevel = function( budget )
+{
+    var levelCount = this.levels.length;
+    var target = Math.floor( this.triCount * GMeshSimplifier.LEVEL_RATIOS[levelCount - 1] );
+    
+    if ( !this.simplify( target, budget ) )
+    {
+        return;
+    }
+    
+    if ( this.liveTriCount >= this.levels[levelCount - 1].getIndexCount() / 3 )
+    {
+        // nothing left to collapse
+        this.phase = GMeshSimplifier.PHASE_DONE;
+        return;
+    }
+    
+    this.levels.push( this.toMesh( this.mesh.getName() + "_lod" + levelCount ) );
+    
+    if ( this.levels.length > GMeshSimplifier.LEVEL_RATIOS.length )
+    {
+        this.phase = GMeshSimplifier.PHASE_DONE;
+    }
+};
+
+/**
+ * Map mesh vertices to a position shared by all the vertices at that spot
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshSimplifier.prototype.weldVertices = function( start, end )
+{
+    var g = this.g;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var key = g[3*i] + "," + g[3*i+1] + "," + g[3*i+2];
+        var id = this.weldKeys[key];
+        
+        if ( undefined === id )
+        {
+            id = this.weldCount++;
+            this.weldKeys[key] = id;
+            this.weldVerts.push( [] );
+            this.weldTris.push( [] );
+        }
+        
+        this.weld[i] = id;
+    }
+};
+
+/**
+ * Copy the positions of the welded vertices and list the mesh vertices 
+ * that share each of them
+ * @param {number} start First vertex
+ * @param {number} end Vertex after the last one
+ */
+GMeshSimplifier.prototype.placeWeldedVertices = function( start, end )
+{
+    var g = this.g;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var w = this.weld[i];
+        this.weldPos[3*w] = g[3*i];
+        this.weldPos[3*w+1] = g[3*i+1];
+        this.weldPos[3*w+2] = g[3*i+2];
+        this.weldVerts[w].push( i );
+    }
+};
+
+/**
+ * Find the triangles around each welded vertex and drop the degenerate ones
+ * @param {number} start First triangle
+ * @param {number} end Triangle after the last one
+ */
+GMeshSimplifier.prototype.buildAdjacency = function( start, end )
+{
+    for ( var t = start; t < end; ++t )
+    {
+        var a = this.weld[this.corners[3*t]];
+        var b = this.weld[this.corners[3*t+1]];
+        var c = this.weld[this.corners[3*t+2]];
+        
+        if ( a === b || b === c || c === a )
+        {
+            --this.liveTriCount;
+            continue;
+        }
+        
+        this.triAlive[t] = 1;
+        this.weldTris[a].push( t );
+        this.weldTris[b].push( t );
+        this.weldTris[c].push( t );
+    }
+};
+
+/**
+ * Accumulate the plane quadrics of the triangles around every welded vertex
+ * @param {number} start First triangle
+ * @param {number} end Triangle after the last one
+ */
+GMeshSimplifier.prototype.buildQuadrics = function( start, end )
+{
+    var edges = this.edges;
+    
+    for ( var t = start; t < end; ++t )
+    {
+        if ( 0 === this.triAlive[t] ) continue;
+        
+        var w = [ this.weld[this.corners[3*t]], 
+                  this.weld[this.corners[3*t+1]], 
+                  this.weld[this.corners[3*t+2]] ];
+        var plane = this.getPlane( w[0], w[1], w[2] );
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            // area weighted, the plane normal is not normalized by getPlane
+            this.addPlane( w[k], plane, plane[4] );
+            
+            var e0 = Math.min( w[k], w[(k+1)%3] );
+            var e1 = Math.max( w[k], w[(k+1)%3] );
+            var key = e0 + "," + e1;
+            
+            if ( undefined === edges[key] )
+            {
+                edges[key] = [ t, k ];
+                this.edgeKeys.push( key );
+            }
+            else
+            {
+                edges[key] = -1;
+            }
+        }
+    }
+};
+
+/**
+ * Open borders get a plane perpendicular to their triangle
+ * @param {number} start First edge
+ * @param {number} end Edge after the last one
+ */
+GMeshSimplifier.prototype.addBorderPlanes = function( start, end )
+{
+    var p = this.weldPos;
+    
+    for ( var i = start; i < end; ++i )
+    {
+        var edge = this.edges[this.edgeKeys[i]];
+        if ( -1 === edge ) continue;
+        
+        var t = edge[0];
+        var k = edge[1];
+        
+        var a = this.weld[this.corners[3*t+k]];
+        var b = this.weld[this.corners[3*t+(k+1)%3]];
+        var c = this.weld[this.corners[3*t+(k+2)%3]];
+        var face = this.getPlane( a, b, c );
+        
+        var ex = p[3*b] - p[3*a], ey = p[3*b+1] - p[3*a+1], ez = p[3*b+2] - p[3*a+2];
+        var nx = ey*face[2] - ez*face[1];
+        var ny = ez*face[0] - ex*face[2];
+        var nz = ex*face[1] - ey*face[0];
+        var len = Math.sqrt( nx*nx + ny*ny + nz*nz );
+        
+        if ( 0 === len ) continue;
+        
+        nx /= len; ny /= len; nz /= len;
+        var border = [ nx, ny, nz, -(nx*p[3*a] + ny*p[3*a+1] + nz*p[3*a+2]) ];
+        var weight = GMeshSimplifier.BORDER_WEIGHT * (ex*ex + ey*ey + ez*ez);
+        
+        this.addPlane( a, border, weight );
+        this.addPlane( b, border, weight );
+    }
+};
+
+/**
+ * Returns the unit plane through three welded vertices and its area
+ * @param {number} a
+ * @param {number} b
+ * @param {number} c
+ * @return {Array.<number>} [ nx, ny, nz, d, area ]
+ */
+GMeshSimplifier.prototype.getPlane = function( a, b, c )
+{
+    var p = this.weldPos;
+    var ux = p[3*b] - p[3*a], uy = p[3*b+1] - p[3*a+1], uz = p[3*b+2] - p[3*a+2];
+    var vx = p[3*c] - p[3*a], vy = p[3*c+1] - p[3*a+1], vz = p[3*c+2] - p[3*a+2];
+    var nx = uy*vz - uz*vy;
+    var ny = uz*vx - ux*vz;
+    var nz = ux*vy - uy*vx;
+    var len = Math.sqrt( nx*nx + ny*ny + nz*nz );
+    
+    if ( 0 === len )
+    {
+        return [ 0, 0, 0, 0, 0 ];
+    }
+    
+    nx /= len; ny /= len; nz /= len;
+    
+    return [ nx, ny, nz, -(nx*p[3*a] + ny*p[3*a+1] + nz*p[3*a+2]), len / 2 ];
+};
+
+/**
+ * Add a weighted plane to the quadric of a welded vertex
+ * @param {number} w
+ * @param {Array.<number>} plane
+ * @param {number} weight
+ */
+GMeshSimplifier.prototype.addPlane = function( w, plane, weight )
+{
+    var q = this.quadrics;
+    var o = 10*w;
+    var a = plane[0], b = plane[1], c = plane[2], d = plane[3];
+    
+    q[o]   += weight*a*a; q[o+1] += weight*a*b; q[o+2] += weight*a*c; q[o+3] += weight*a*d;
+    q[o+4] += weight*b*b; q[o+5] += weight*b*c; q[o+6] += weight*b*d;
+    q[o+7] += weight*c*c; q[o+8] += weight*c*d;
+    q[o+9] += weight*d*d;
+};
+
+/**
+ * Error of moving welded vertex from onto welded vertex to
+ * @param {number} from
+ * @param {number} to
+ * @return {number}
+ */
+GMeshSimplifier.prototype.getCollapseCost = function( from, to )
+{
+    var q = this.quadrics;
+    var a = 10*from;
+    var b = 10*to;
+    var x = this.weldPos[3*to], y = this.weldPos[3*to+1], z = this.weldPos[3*to+2];
+    
+    var q0 = q[a]+q[b],     q1 = q[a+1]+q[b+1], q2 = q[a+2]+q[b+2], q3 = q[a+3]+q[b+3];
+    var q4 = q[a+4]+q[b+4], q5 = q[a+5]+q[b+5], q6 = q[a+6]+q[b+6];
+    var q7 = q[a+7]+q[b+7], q8 = q[a+8]+q[b+8];
+    var q9 = q[a+9]+q[b+9];
+    
+    return q0*x*x + 2*q1*x*y + 2*q2*x*z + 2*q3*x + 
+           q4*y*y + 2*q5*y*z + 2*q6*y + 
+           q7*z*z + 2*q8*z + q9;
+};
+
+/**
+ * Push both directions of every edge around a welded vertex once
+ * @param {number} w
+ */
+GMeshSimplifier.prototype.pushCollapsesAround = function( w )
+{
+    var tris = this.weldTris[w];
+    var mark = ++this.markCounter;
+    
+    this.weldMark[w] = mark;
+    
+    for ( var i = 0; i < tris.length; ++i )
+    {
+        var t = tris[i];
+        if ( 0 === this.triAlive[t] ) continue;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            var other = this.weld[this.corners[3*t+k]];
+            
+            if ( this.weldMark[other] !== mark )
+            {
+                this.weldMark[other] = mark;
+                this.heapPush( this.getCollapseCost( w, other ), w, other );
+                this.heapPush( this.getCollapseCost( other, w ), other, w );
+            }
+        }
+    }
+};
+
+/**
+ * Queue every possible collapse of the welded mesh
+ * @param {number} start First triangle
+ * @param {number} end Triangle after the last one
+ */
+GMeshSimplifier.prototype.seedCollapses = function( start, end )
+{
+    for ( var t = start; t < end; ++t )
+    {
+        if ( 0 === this.triAlive[t] ) continue;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            var a = this.weld[this.corners[3*t+k]];
+            var b = this.weld[this.corners[3*t+(k+1)%3]];
+            
+            // every directed edge belongs to one triangle of a manifold mesh
+            this.heapPush( this.getCollapseCost( a, b ), a, b );
+        }
+    }
+};
+
+/**
+ * Collapse edges until the number of live triangles reaches the target
+ * @param {number} targetTriCount
+ * @param {number} budget Largest number of queued collapses to go through
+ * @return {boolean} True if the target was reached or nothing is left to 
+ *         collapse
+ */
+GMeshSimplifier.prototype.simplify = function( targetTriCount, budget )
+{
+    for ( var i = 0; i < budget; ++i )
+    {
+        if ( this.liveTriCount <= targetTriCount || 0 === this.heapLength )
+        {
+            return true;
+        }
+        
+        var cost = this.heapCost[0];
+        var from = this.heapFrom[0];
+        var to = this.heapTo[0];
+        
+        this.heapPop();
+        
+        // quadrics only grow, so an entry whose cost went up since it was
+        // queued is requeued instead of collapsed
+        var current = this.getCollapseCost( from, to );
+        if ( current > cost )
+        {
+            this.heapPush( current, from, to );
+            continue;
+        }
+        
+        if ( this.isCollapseValid( from, to ) )
+        {
+            this.collapse( from, to );
+        }
+    }
+    
+    return this.liveTriCount <= targetTriCount || 0 === this.heapLength;
+};
+
+/**
+ * Returns true if the collapse keeps the edge and does not fold any triangle
+ * @param {number} from
+ * @param {number} to
+ * @return {boolean}
+ */
+GMeshSimplifier.prototype.isCollapseValid = function( from, to )
+{
+    var tris = this.weldTris[from];
+    var sharesEdge = false;
+    
+    for ( var i = 0; i < tris.length; ++i )
+    {
+        var t = tris[i];
+        if ( 0 === this.triAlive[t] ) continue;
+        
+        var w = [ this.weld[this.corners[3*t]], 
+                  this.weld[this.corners[3*t+1]], 
+                  this.weld[this.corners[3*t+2]] ];
+        
+        if ( w[0] === to || w[1] === to || w[2] === to )
+        {
+            sharesEdge = true;
+            continue;
+        }
+        
+        var before = this.getPlane( w[0], w[1], w[2] );
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            if ( w[k] === from ) w[k] = to;
+        }
+        
+        var after = this.getPlane( w[0], w[1], w[2] );
+        
+        if ( 0 === after[4] || 
+             before[0]*after[0] + before[1]*after[1] + before[2]*after[2] < 0.2 )
+        {
+            return false;
+        }
+    }
+    
+    return sharesEdge;
+};
+
+/**
+ * Returns the mesh vertex of a welded vertex with the attributes closest to 
+ * the provided mesh vertex
+ * @param {number} vert Mesh vertex being replaced
+ * @param {number} w Welded vertex to pick from
+ * @return {number}
+ */
+GMeshSimplifier.prototype.getClosestVertex = function( vert, w )
+{
+    var n = this.n;
+    var t = this.t;
+    var candidates = this.weldVerts[w];
+    var best = candidates[0];
+    var bestScore = -Infinity;
+    
+    for ( var i = 0; i < candidates.length; ++i )
+    {
+        var c = candidates[i];
+        var du = t[2*c] - t[2*vert], dv = t[2*c+1] - t[2*vert+1];
+        var score = n[3*c]*n[3*vert] + n[3*c+1]*n[3*vert+1] + n[3*c+2]*n[3*vert+2] - 
+                    (du*du + dv*dv);
+        
+        if ( score > bestScore )
+        {
+            bestScore = score;
+            best = c;
+        }
+    }
+    
+    return best;
+};
+
+/**
+ * Move welded vertex from onto welded vertex to
+ * @param {number} from
+ * @param {number} to
+ */
+GMeshSimplifier.prototype.collapse = function( from, to )
+{
+    var q = this.quadrics;
+    var tris = this.weldTris[from];
+    var around = this.weldTris[to];
+    var i = 0;
+    var k = 0;
+    
+    for ( i = 0; i < 10; ++i )
+    {
+        q[10*to+i] += q[10*from+i];
+    }
+    
+    for ( i = 0; i < tris.length; ++i )
+    {
+        var t = tris[i];
+        if ( 0 === this.triAlive[t] ) continue;
+        
+        if ( this.weld[this.corners[3*t]] === to || 
+             this.weld[this.corners[3*t+1]] === to || 
+             this.weld[this.corners[3*t+2]] === to )
+        {
+            this.triAlive[t] = 0;
+            --this.liveTriCount;
+            continue;
+        }
+        
+        for ( k = 0; k < 3; ++k )
+        {
+            var vert = this.corners[3*t+k];
+            if ( this.weld[vert] === from )
+            {
+                this.corners[3*t+k] = this.getClosestVertex( vert, to );
+            }
+        }
+        
+        around.push( t );
+    }
+    
+    this.weldTris[from] = [];
+    
+    var alive = [];
+    for ( i = 0; i < around.length; ++i )
+    {
+        if ( 1 === this.triAlive[around[i]] ) alive.push( around[i] );
+    }
+    this.weldTris[to] = alive;
+    
+    // the collapse created edges between to and the old neighbors of from
+    this.pushCollapsesAround( to );
+};
+
+/**
+ * Copy the live triangles into a new mesh, only the vertices they use are
+ * kept
+ * @param {string} name
+ * @return {GeometryTriMesh}
+ */
+GMeshSimplifier.prototype.toMesh = function( name )
+{
+    var g = this.g;
+    var n = this.n;
+    var t = this.t;
+    var remap = new Int32Array( g.length / 3 );
+    var vertCount = 0;
+    var tri = 0;
+    var k = 0;
+    
+    for ( k = 0; k < remap.length; ++k )
+    {
+        remap[k] = -1;
+    }
+    
+    for ( tri = 0; tri < this.triCount; ++tri )
+    {
+        if ( 0 === this.triAlive[tri] ) continue;
+        
+        for ( k = 0; k < 3; ++k )
+        {
+            var vert = this.corners[3*tri+k];
+            if ( -1 === remap[vert] )
+            {
+                remap[vert] = vertCount++;
+            }
+        }
+    }
+    
+    var mesh = new GeometryTriMesh( name, vertCount, 3*this.liveTriCount );
+    mesh.setMtlName( this.mesh.getMtlName() );
+    
+    mesh.gVerts.resize( 3*vertCount );
+    mesh.nVerts.resize( 3*vertCount );
+    mesh.tVerts.resize( 2*vertCount );
+    
+    for ( k = 0; k < remap.length; ++k )
+    {
+        var r = remap[k];
+        if ( -1 === r ) continue;
+        
+        mesh.gVerts.data[3*r] = g[3*k]; mesh.gVerts.data[3*r+1] = g[3*k+1]; mesh.gVerts.data[3*r+2] = g[3*k+2];
+        mesh.nVerts.data[3*r] = n[3*k]; mesh.nVerts.data[3*r+1] = n[3*k+1]; mesh.nVerts.data[3*r+2] = n[3*k+2];
+        mesh.tVerts.data[2*r] = t[2*k]; mesh.tVerts.data[2*r+1] = t[2*k+1];
+    }
+    
+    for ( tri = 0; tri < this.triCount; ++tri )
+    {
+        if ( 0 === this.triAlive[tri] ) continue;
+        
+        mesh.addIndex( remap[this.corners[3*tri]] );
+        mesh.addIndex( remap[this.corners[3*tri+1]] );
+        mesh.addIndex( remap[this.corners[3*tri+2]] );
+    }
+    
+    return mesh;
+};
+
+/**
+ * Queue a collapse, the cheapest one is always at the top
+ * @param {number} cost
+ * @param {number} from
+ * @param {number} to
+ */
+GMeshSimplifier.prototype.heapPush = function( cost, from, to )
+{
+    var i = this.heapLength++;
+    
+    while ( i > 0 )
+    {
+        var parent = (i - 1) >> 1;
+        if ( this.heapCost[parent] <= cost ) break;
+        
+        this.heapCost[i] = this.heapCost[parent];
+        this.heapFrom[i] = this.heapFrom[parent];
+        this.heapTo[i] = this.heapTo[parent];
+        i = parent;
+    }
+    
+    this.heapCost[i] = cost;
+    this.heapFrom[i] = from;
+    this.heapTo[i] = to;
+};
+
+/**
+ * Remove the cheapest collapse from the queue
+ */
+GMeshSimplifier.prototype.heapPop = function()
+{
+    var last = --this.heapLength;
+    var cost = this.heapCost[last];
+    var i = 0;
+    
+    while ( true )
+    {
+        var child = 2*i + 1;
+        if ( child >= last ) break;
+        
+        if ( child + 1 < last && this.heapCost[child+1] < this.heapCost[child] )
+        {
+            ++child;
+        }
+        
+        if ( this.heapCost[child] >= cost ) break;
+        
+        this.heapCost[i] = this.heapCost[child];
+        this.heapFrom[i] = this.heapFrom[child];
+        this.heapTo[i] = this.heapTo[child];
+        i = child;
+    }
+    
+    this.heapCost[i] = cost;
+    this.heapFrom[i] = this.heapFrom[last];
+    this.heapTo[i] = this.heapTo[last];
+};
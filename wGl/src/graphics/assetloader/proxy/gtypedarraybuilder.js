@@ -0,0 +1,207 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Growable wrapper around a typed array.  Values are appended to the backing
+ * store which is reallocated with double the capacity whenever it runs out.
+ * @constructor
+ * @param {function(new:ArrayBufferView, number)} type Typed array constructor
+ * @param {number=} capacity Initial number of elements
+ */
+function GTypedArrayBuilder( type, capacity )
+{
+    this.type = type;
+    this.data = new type( Math.max( capacity || 0, 16 ) );
+    this.length = 0;
+}
+
+/**
+ * Runs shorter than this are copied element by element in appendBuilder
+ */
+GTypedArrayBuilder.SMALL_COPY_LENGTH = 256;
+
+/**
+ * Make sure there is room for the provided number of extra elements
+ * @param {number} count Number of elements that are about to be appended
+ */
+GTypedArrayBuilder.prototype.reserve = function( count )
+{
+    var required = this.length + count;
+
+    if ( required > this.data.length )
+    {
+        var capacity = Math.max( 16, this.data.length * 2 );
+        while ( capacity < required )
+        {
+            capacity *= 2;
+        }
+
+        var newData = new this.type( capacity );
+        newData.set( this.data.subarray( 0, this.length ) );
+        this.data = newData;
+    }
+};
+
+/**
+ * Append one value
+ * @param {number} a
+ */
+GTypedArrayBuilder.prototype.push = function( a )
+{
+    if ( this.length === this.data.length )
+    {
+        this.reserve( 1 );
+    }
+
+    this.data[this.length++] = a;
+};
+
+/**
+ * Append two values
+ * @param {number} a
+ * @param {number} b
+ */
+GTypedArrayBuilder.prototype.push2 = function( a, b )
+{
+    this.reserve( 2 );
+    this.data[this.length++] = a;
+    this.data[this.length++] = b;
+};
+
+/**
+ * Append three values
+ * @param {number} a
+ * @param {number} b
+ * @param {number} c
+ */
+GTypedArrayBuilder.prototype.push3 = function( a, b, c )
+{
+    this.reserve( 3 );
+    this.data[this.length++] = a;
+    this.data[this.length++] = b;
+    this.data[this.length++] = c;
+};
+
+/**
+ * Append every value of the provided array
+ * @param {ArrayBufferView|Array.<number>} array
+ */
+GTypedArrayBuilder.prototype.append = function( array )
+{
+    this.reserve( array.length );
+    this.data.set( array, this.length );
+    this.length += array.length;
+};
+
+/**
+ * Append the contents of another builder
+ * @param {GTypedArrayBuilder} other
+ */
+GTypedArrayBuilder.prototype.appendBuilder = function( other )
+{
+    var count = other.length;
+    this.reserve( count );
+
+    if ( count < GTypedArrayBuilder.SMALL_COPY_LENGTH )
+    {
+        // creating the subarray costs more than copying short runs by hand
+        var src = other.data;
+        var dst = this.data;
+        var offset = this.length;
+        for ( var i = 0; i < count; ++i )
+        {
+            dst[offset + i] = src[i];
+        }
+    }
+    else
+    {
+        this.data.set( ( other.data.length === count ) ? other.data : other.view(), this.length );
+    }
+
+    this.length += count;
+};
+
+/**
+ * Copy the current contents into a typed array
+ * @param {ArrayBufferView} target Array with room for the contents
+ * @param {number} offset Index in target of the first value
+ */
+GTypedArrayBuilder.prototype.copyTo = function( target, offset )
+{
+    // a trimmed builder is copied without creating a view
+    target.set( ( this.data.length === this.length ) ? this.data : this.view(), offset );
+};
+
+/**
+ * Release the unused capacity of the backing store
+ */
+GTypedArrayBuilder.prototype.trim = function()
+{
+    if ( this.data.length !== this.length )
+    {
+        this.data = this.toTypedArray();
+    }
+};
+
+/**
+ * Returns a view over the current contents, the view is only valid until
+ * the next value is appended
+ * @return {ArrayBufferView}
+ */
+GTypedArrayBuilder.prototype.view = function()
+{
+    return this.data.subarray( 0, this.length );
+};
+
+/**
+ * Change the number of values, new values are zero so the caller can write
+ * them straight into data
+ * @param {number} length
+ */
+GTypedArrayBuilder.prototype.resize = function( length )
+{
+    if ( length > this.length )
+    {
+        this.reserve( length - this.length );
+        for ( var i = this.length; i < length; ++i )
+        {
+            this.data[i] = 0;
+        }
+    }
+
+    this.length = length;
+};
+
+/**
+ * Remove all the values without releasing the backing store
+ */
+GTypedArrayBuilder.prototype.clear = function()
+{
+    this.length = 0;
+};
+
+/**
+ * Returns a tightly sized copy of the current contents
+ * @return {ArrayBufferView}
+ */
+GTypedArrayBuilder.prototype.toTypedArray = function()
+{
+    return new this.type( this.data.subarray( 0, this.length ) );
+};
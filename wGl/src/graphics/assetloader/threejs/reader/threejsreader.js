@@ -115,6 +115,26 @@
 //         255, 0,1,2,3, 0, 0, 0,1,2,3, 0, 0,1,2,3, 0, 0,1,2,3,
 //     ]
 // }
+// 
+// BufferGeometry
+// 
+// Newer exporters write the geometry as flat attribute arrays that can be 
+// copied as they are, no faces need to be decoded.
+// 
+// {
+//     "metadata": { "type": "BufferGeometry" },
+//     "data": {
+//         "attributes": {
+//             "position":   { "itemSize": 3, "array": [ ... ] },
+//             "normal":     { "itemSize": 3, "array": [ ... ] },
+//             "uv":         { "itemSize": 2, "array": [ ... ] },
+//             "skinIndex":  { "itemSize": 4, "array": [ ... ] },
+//             "skinWeight": { "itemSize": 4, "array": [ ... ] }
+//         },
+//         "index": { "array": [ ... ] }
+//     },
+//     "bones": [ ... ], "animations": [ ... ], "materials": [ ... ]
+// }
 
 /**
  * @interface
@@ -138,36 +158,22 @@ ThreejsReaderObserver.prototype.onNewMeshAvailable = function ( mesh, skin ) {};
  */
 function ThreejsReader( path, json, scene, group, observer )
 {
-	/**
-	 * @struct
-	 */
-	this.IndexRecord = function( string )
-	{
-		var tokens = string.split("/");
-		this.vertIdx = parseFloat(tokens[0])-1;
-		this.textIdx = parseFloat(tokens[1])-1;
-		this.normIdx = parseFloat(tokens[2])-1;			
-	};
-
-	
 	this.scene = scene;
 	this.group = group;
 	this.path = path;
 	this.json = json;
 	this.observer = observer;
+	this.faces = json['faces'] || [];
 
 	this.pIdx = 0;
-	
-	this.groupMap = {};
-	
+	this.vIdx = 0;
 	
 	this.isLoadComplete = false;
-	this.updateIndex = 0;
 	this.polyCount = 0;
 	
-	this.currentMesh = new GeometryTriMesh( "name" );
-	this.currentSkin = new GeometrySkin();
-	this.currentIndex = 0;
+	this.currentMesh = undefined;
+	this.currentSkin = undefined;
+	this.uvLayerCount = 0;
 	
 	this.totalProgress = 0;
 	
@@ -188,6 +194,21 @@ function ThreejsReader( path, json, scene, group, observer )
      };
 }
 
+/**
+ * Number of faces decoded on every call to update
+ */
+ThreejsReader.FACES_PER_UPDATE = 8192;
+
+/**
+ * Returns true if the json describes a BufferGeometry instead of faces
+ * @param {Object} json
+ * @return {boolean}
+ */
+ThreejsReader.isBufferGeometry = function ( json )
+{
+    return undefined !== json['data'] && undefined !== json['data']['attributes'];
+};
+
 /**
  * Returns true if the reader is done 
  * @return {boolean}
@@ -214,239 +235,323 @@ ThreejsReader.prototype.update = function (time)
 {
     if ( this.isLoadComplete ) return;
     
-    if ( this.pIdx < this.json['faces'].length )
+    if ( undefined === this.currentMesh )
     {
-        var bitField = this.json['faces'][this.pIdx];
-        ++this.pIdx;
-        if ( bitField & this.BITMASK.QUAD )
+        if ( ThreejsReader.isBufferGeometry( this.json ) )
         {
-            this.processQuad( bitField );
+            this.readBufferGeometry();
         }
         else
         {
-            this.processTri( bitField );
+            this.prepareFaceBuffers();
         }
-        
-        this.totalProgress = this.pIdx / this.json['faces'].length;
+    }
+    else if ( this.pIdx < this.faces.length )
+    {
+        this.processFaces( ThreejsReader.FACES_PER_UPDATE );
+        this.totalProgress = this.pIdx / this.faces.length;
     }
     else
     {
         this.isLoadComplete = true;
         this.totalProgress = 1;
+        this.currentMesh.prepareToClose();
+        this.currentSkin.prepareToClose();
         this.observer.onNewMeshAvailable( this.currentMesh, this.currentSkin );
         // console.debug("Loaded " + this.polyCount + " polygons in 1 object.");
     }
 };
 
 /**
- * Populates an out vector with the vertex at the requested index
- * @param {number} index to get the vector value from
- * @param {Array.<number>} out vector
+ * Decode every face in one go
  */
-ThreejsReader.prototype.getVertexAtIndex = function ( idx, outV )
+ThreejsReader.prototype.readAll = function ()
 {
-    var len = this.json['vertices'].length;
-    
-    if ( idx*3 + 2 > len )
+    while ( !this.isLoadComplete )
     {
-        outV[0] = outV[1] = outV[2] = 0;
-        return;
+        this.update( 0 );
     }
-    
-    outV[0] = this.json['vertices'][ idx*3 + 0 ];
-    outV[1] = this.json['vertices'][ idx*3 + 1 ];
-    outV[2] = this.json['vertices'][ idx*3 + 2 ];
 };
 
 /**
- * Populates an out vector with the normal at the requested index
- * @param {number} index to get the vector value from
- * @param {Array.<number>} out vector
+ * Returns the number of values following the type of a face
+ * @param {number} bitField Type of the face
+ * @return {number}
  */
-ThreejsReader.prototype.getNormalAtIndex = function ( idx, outV )
+ThreejsReader.prototype.getFaceLength = function ( bitField )
 {
-    var len = this.json['normals'].length;
-	
-	if ( idx*3 + 2 > len )
-	{
-		outV[0] = outV[1] = outV[2] = 0;
-		return;
-	}
-	
-	outV[0] = this.json['normals'][ idx*3 + 0 ];
-	outV[1] = this.json['normals'][ idx*3 + 1 ];
-	outV[2] = this.json['normals'][ idx*3 + 2 ];
-};
-
-/**
- * Populates an out vector with the color at the requested index
- * @param {number} index to get the vector value from
- * @param {Array.<number>} out vector
- */
-ThreejsReader.prototype.getColorAtIndex = function ( idx, outV )
-{
-    var len = this.json['colors'].length;
-	
-	if ( idx*3 + 2 > len )
-	{
-		outV[0] = outV[1] = outV[2] = 0;
-		return;
-	}
-	
-	outV[0] = this.json['colors'][ idx*3 + 0 ];
-	outV[1] = this.json['colors'][ idx*3 + 1 ];
-	outV[2] = this.json['colors'][ idx*3 + 2 ];
+    var n = ( bitField & this.BITMASK.QUAD ) ? 4 : 3;
+    var length = n;
+    
+    if ( bitField & this.BITMASK.FACE_MATERIAL )      length += 1;
+    if ( bitField & this.BITMASK.FACE_UV )            length += this.uvLayerCount;
+    if ( bitField & this.BITMASK.FACE_VERTEX_UV )     length += n * this.uvLayerCount;
+    if ( bitField & this.BITMASK.FACE_NORMAL )        length += 1;
+    if ( bitField & this.BITMASK.FACE_VERTEX_NORMAL ) length += n;
+    if ( bitField & this.BITMASK.FACE_COLOR )         length += 1;
+    if ( bitField & this.BITMASK.FACE_VERTEX_COLOR )  length += n;
+    
+    return length;
 };
 
 /**
- * Populates an out vector with the skin information
- * @param {number} index to get the vector value from
- * @param {Array.<number>} out vector
+ * Walk the face stream once to count the vertices it will produce and
+ * allocate the mesh and skin with room for all of them
  */
-ThreejsReader.prototype.getSkinAtIndex = function ( idx, outV )
+ThreejsReader.prototype.prepareFaceBuffers = function ()
 {
-    var lenI = this.json['skinIndices'].length;
-    var lenW = this.json['skinWeights'].length;
-    
-    outV[0] = outV[1] = outV[2] = outV[3] = 0;
+    var faces = this.faces;
+    var facesLen = faces.length;
+    var uvs = this.json['uvs'] || [];
+    var vertCount = 0;
+    var i = 0;
     
-    if ( idx*2 + 1 <= lenI )
+    for ( i = 0; i < uvs.length; ++i )
     {
-        outV[0] = this.json['skinIndices'][ idx*2 + 0 ];
-        outV[1] = this.json['skinIndices'][ idx*2 + 1 ];
+        if ( uvs[i].length > 0 )
+        {
+            ++this.uvLayerCount;
+        }
     }
     
-    if ( idx*2 + 1 <= lenW )
+    i = 0;
+    while ( i < facesLen )
     {
-        outV[2] = this.json['skinWeights'][ idx*2 + 0 ];
-        outV[3] = this.json['skinWeights'][ idx*2 + 1 ];
+        var bitField = faces[i];
+        vertCount += ( bitField & this.BITMASK.QUAD ) ? 6 : 3;
+        i += 1 + this.getFaceLength( bitField );
     }
+    
+    this.currentMesh = new GeometryTriMesh( "name", vertCount, vertCount );
+    this.currentSkin = new GeometrySkin( vertCount );
+    
+    this.currentMesh.gVerts.resize( 3*vertCount );
+    this.currentMesh.nVerts.resize( 3*vertCount );
+    this.currentMesh.tVerts.resize( 2*vertCount );
+    this.currentMesh.indices.resize( vertCount );
+    this.currentSkin.sVerts.resize( 4*vertCount );
 };
 
 /**
- * process a quad face
- * @param {number} bit field for this face
+ * Decode faces straight into the buffers allocated by prepareFaceBuffers
+ * @param {number} maxFaces Largest number of faces to decode
  */
-ThreejsReader.prototype.processQuad = function ( bitField )
+ThreejsReader.prototype.processFaces = function ( maxFaces )
 {
-    this.polyCount += 2;
-	
-    var skin = [ [0,0,0,0],[0,0,0,0],[0,0,0,0],[0,0,0,0] ];
-	var vert = [ [0,0,0],[0,0,0],[0,0,0],[0,0,0] ];
-	var norm = [ [0,0,0],[0,0,0],[0,0,0],[0,0,0] ];
-	var vtex = [ [0,0],[0,0],[0,0],[0,0] ];
-	
-	// verts go first
-	for ( var i = 0; i < 4; ++i )
-	{
-	    this.getVertexAtIndex( this.json['faces'][this.pIdx + i], vert[i] );
-	    this.getSkinAtIndex( this.json['faces'][this.pIdx + i], skin[i] );
-	}
-	this.pIdx += 4;
-	
-	if ( bitField & this.BITMASK.FACE_MATERIAL )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_UV ) 
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_UV )
-	{
-		this.pIdx += 4;
-	}
-	if ( bitField & this.BITMASK.FACE_NORMAL )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_NORMAL )
-	{
-		for ( var i = 0; i < 4; ++i )
+    var faces = this.faces;
+    var facesLen = faces.length;
+    var verts = this.json['vertices'] || [];
+    var normals = this.json['normals'] || [];
+    var uvs = ( this.uvLayerCount > 0 ) ? this.json['uvs'][0] : [];
+    var skinIndices = this.json['skinIndices'] || [];
+    var skinWeights = this.json['skinWeights'] || [];
+    
+    var g = this.currentMesh.gVerts.data;
+    var n = this.currentMesh.nVerts.data;
+    var t = this.currentMesh.tVerts.data;
+    var idx = this.currentMesh.indices.data;
+    var s = this.currentSkin.sVerts.data;
+    
+    var vertIdx = [0, 0, 0, 0];
+    var normIdx = [-1, -1, -1, -1];
+    var textIdx = [-1, -1, -1, -1];
+    
+    // quads are split into 0 1 2 and 2 3 0
+    var quadCorners = [0, 1, 2, 2, 3, 0];
+    
+    var p = this.pIdx;
+    var v = this.vIdx;
+    var c = 0;
+    
+    for ( var face = 0; face < maxFaces && p < facesLen; ++face )
+    {
+        var bitField = faces[p++];
+        var isQuad = 0 !== ( bitField & this.BITMASK.QUAD );
+        var cornerCount = isQuad ? 4 : 3;
+        
+        for ( c = 0; c < cornerCount; ++c )
         {
-            this.getNormalAtIndex( this.json['faces'][this.pIdx + i], norm[i] );
+            vertIdx[c] = faces[p++];
+            normIdx[c] = -1;
+            textIdx[c] = -1;
         }
-		this.pIdx += 4;
-	}
-	if ( bitField & this.BITMASK.FACE_COLOR )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_COLOR )
-	{
-		this.pIdx += 4;
-	}
-	
-	for ( var i = 0; i < 3; ++i )
-	{
-		this.currentMesh.gVerts.push(vert[i]);
-		this.currentMesh.nVerts.push(norm[i]);
-		this.currentMesh.tVerts.push(vtex[i]);
-		this.currentMesh.indices.push(this.currentIndex++);
-		
-		this.currentSkin.sVerts.push(skin[i]);
-	}
-	
-	for ( var i = 2; i < 5; ++i )
-	{
-		this.currentMesh.gVerts.push(vert[i%4]);
-		this.currentMesh.nVerts.push(norm[i%4]);
-		this.currentMesh.tVerts.push(vtex[i%4]);
-		this.currentMesh.indices.push(this.currentIndex++);
-		
-		this.currentSkin.sVerts.push(skin[i%4]);
-	}
+        
+        if ( bitField & this.BITMASK.FACE_MATERIAL )
+        {
+            p += 1;
+        }
+        if ( bitField & this.BITMASK.FACE_UV ) 
+        {
+            p += this.uvLayerCount;
+        }
+        if ( bitField & this.BITMASK.FACE_VERTEX_UV )
+        {
+            for ( c = 0; c < cornerCount; ++c )
+            {
+                textIdx[c] = faces[p + c];
+            }
+            p += cornerCount * this.uvLayerCount;
+        }
+        if ( bitField & this.BITMASK.FACE_NORMAL )
+        {
+            normIdx[0] = normIdx[1] = normIdx[2] = normIdx[3] = faces[p];
+            p += 1;
+        }
+        if ( bitField & this.BITMASK.FACE_VERTEX_NORMAL )
+        {
+            for ( c = 0; c < cornerCount; ++c )
+            {
+                normIdx[c] = faces[p + c];
+            }
+            p += cornerCount;
+        }
+        if ( bitField & this.BITMASK.FACE_COLOR )
+        {
+            p += 1;
+        }
+        if ( bitField & this.BITMASK.FACE_VERTEX_COLOR )
+        {
+            p += cornerCount;
+        }
+        
+        var emitCount = isQuad ? 6 : 3;
+        this.polyCount += isQuad ? 2 : 1;
+        
+        for ( var e = 0; e < emitCount; ++e )
+        {
+            c = quadCorners[e];
+            
+            var vi = vertIdx[c];
+            var ni = normIdx[c];
+            var ti = textIdx[c];
+            
+            // indices that point outside of the arrays are left as zeros
+            if ( 3*vi+2 < verts.length )
+            {
+                g[3*v] = verts[3*vi]; g[3*v+1] = verts[3*vi+1]; g[3*v+2] = verts[3*vi+2];
+            }
+            
+            if ( ni >= 0 && 3*ni+2 < normals.length )
+            {
+                n[3*v] = normals[3*ni]; n[3*v+1] = normals[3*ni+1]; n[3*v+2] = normals[3*ni+2];
+            }
+            
+            if ( ti >= 0 && 2*ti+1 < uvs.length )
+            {
+                t[2*v] = uvs[2*ti]; t[2*v+1] = uvs[2*ti+1];
+            }
+            
+            if ( 2*vi+1 < skinIndices.length )
+            {
+                s[4*v] = skinIndices[2*vi]; s[4*v+1] = skinIndices[2*vi+1];
+            }
+            
+            if ( 2*vi+1 < skinWeights.length )
+            {
+                s[4*v+2] = skinWeights[2*vi]; s[4*v+3] = skinWeights[2*vi+1];
+            }
+            
+            idx[v] = v;
+            ++v;
+        }
+    }
+    
+    this.pIdx = p;
+    this.vIdx = v;
 };
- 
+
 /**
- * process a tri face
- * @param {number} bit field for this face
+ * Copy the attribute arrays of a BufferGeometry, missing attributes are left
+ * as zeros
  */
-ThreejsReader.prototype.processTri = function ( bitField )
+ThreejsReader.prototype.readBufferGeometry = function ()
 {
-    this.polyCount += 1;
-	
-	var vert = [ [0,0,0],[0,0,0],[0,0,0] ];
-	var norm = [ [0,0,0],[0,0,0],[0,0,0] ];
-	var vtex = [ [0,0],[0,0],[0,0] ];
-	
-	// verts go first
-	this.pIdx += 3;
-	
-	if ( bitField & this.BITMASK.FACE_MATERIAL )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_UV ) 
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_UV )
-	{
-		this.pIdx += 3;
-	}
-	if ( bitField & this.BITMASK.FACE_NORMAL )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_NORMAL )
-	{
-		this.pIdx += 3;
-	}
-	if ( bitField & this.BITMASK.FACE_COLOR )
-	{
-		this.pIdx += 1;
-	}
-	if ( bitField & this.BITMASK.FACE_VERTEX_COLOR )
-	{
-		this.pIdx += 4;
-	}
-	
-	for ( var i = 0; i < 3; ++i )
-	{
-		this.currentMesh.gVerts.push(vert[i]);
-		this.currentMesh.nVerts.push(norm[i]);
-		this.currentMesh.tVerts.push(vtex[i]);
-		this.currentMesh.indices.push(this.currentIndex++);
-	} 
+    var data = this.json['data'];
+    var attributes = data['attributes'];
+    var position = attributes['position']['array'];
+    var vertCount = position.length / 3;
+    var index = ( undefined !== data['index'] ) ? data['index']['array'] : undefined;
+    var indexCount = ( undefined !== index ) ? index.length : vertCount;
+    var i = 0;
+    
+    var mesh = new GeometryTriMesh( "name", vertCount, indexCount );
+    var skin = new GeometrySkin( vertCount );
+    
+    mesh.gVerts.append( position );
+    mesh.nVerts.resize( 3*vertCount );
+    mesh.tVerts.resize( 2*vertCount );
+    skin.sVerts.resize( 4*vertCount );
+    
+    if ( undefined !== attributes['normal'] )
+    {
+        mesh.nVerts.data.set( attributes['normal']['array'].slice( 0, 3*vertCount ) );
+    }
+    
+    if ( undefined !== attributes['uv'] )
+    {
+        mesh.tVerts.data.set( attributes['uv']['array'].slice( 0, 2*vertCount ) );
+    }
+    
+    if ( undefined !== index )
+    {
+        mesh.indices.append( index );
+    }
+    else
+    {
+        mesh.indices.resize( vertCount );
+        for ( i = 0; i < vertCount; ++i )
+        {
+            mesh.indices.data[i] = i;
+        }
+    }
+    
+    // only the two strongest influences fit in the skin buffer, their 
+    // weights are scaled up to the total of the influences they replace
+    var skinIndex = attributes['skinIndex'];
+    var skinWeight = attributes['skinWeight'];
+    if ( undefined !== skinIndex && undefined !== skinWeight )
+    {
+        var si = skinIndex['array'];
+        var sw = skinWeight['array'];
+        var iSize = skinIndex['itemSize'];
+        var wSize = skinWeight['itemSize'];
+        var influenceCount = Math.min( iSize, wSize );
+        var sv = skin.sVerts.data;
+        
+        for ( i = 0; i < vertCount; ++i )
+        {
+            var first = -1;
+            var second = -1;
+            var total = 0;
+            
+            for ( var j = 0; j < influenceCount; ++j )
+            {
+                var w = sw[wSize*i+j];
+                total += w;
+                
+                if ( -1 === first || w > sw[wSize*i+first] )
+                {
+                    second = first;
+                    first = j;
+                }
+                else if ( -1 === second || w > sw[wSize*i+second] )
+                {
+                    second = j;
+                }
+            }
+            
+            var w0 = ( -1 !== first ) ? sw[wSize*i+first] : 0;
+            var w1 = ( -1 !== second ) ? sw[wSize*i+second] : 0;
+            var scale = ( w0 + w1 > 0 ) ? total / ( w0 + w1 ) : 1;
+            
+            sv[4*i]   = ( -1 !== first ) ? si[iSize*i+first] : 0;
+            sv[4*i+1] = ( -1 !== second ) ? si[iSize*i+second] : 0;
+            sv[4*i+2] = w0 * scale;
+            sv[4*i+3] = w1 * scale;
+        }
+    }
+    
+    this.polyCount = indexCount / 3;
+    this.currentMesh = mesh;
+    this.currentSkin = skin;
 };
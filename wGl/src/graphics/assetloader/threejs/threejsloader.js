@@ -43,6 +43,8 @@ ThreejsLoaderObserver.prototype.onThreejsLoaderArmatureAnimatorLoaded = function
 /**
  * @constructor
  * @implements {ThreejsReaderObserver}
+ * @implements {GDecodeJobObserver}
+ * @implements {GJob}
  * @param {GScene} Target scene for this loader
  * @param {GGroup} Target group for this loader
  */
@@ -54,11 +56,34 @@ function ThreejsLoader( scene, group )
 	this.isDownloadComplete = false;
 	this.isReaderReady = false;
 	this.isReadComplete = false;
-	this.availableTime = 17;
 	this.downloadProgress = 0;
 	this.totalProgress = 0;
+	this.decodePool = undefined;
+	this.decodedResult = undefined;
+	this.scheduler = undefined;
+	this.ownsScheduler = false;
 }
 
+/**
+ * Decode the json file on a worker from the provided pool instead of on the
+ * render thread
+ * @param {GDecodeWorkerPool|undefined} pool
+ */
+ThreejsLoader.prototype.setDecodePool = function( pool )
+{
+    this.decodePool = pool;
+};
+
+/**
+ * Run the loading work on the provided scheduler, usually the one of the
+ * context.  Without one the loader runs its own and has to be updated.
+ * @param {GJobScheduler} scheduler
+ */
+ThreejsLoader.prototype.setJobScheduler = function( scheduler )
+{
+    this.scheduler = scheduler;
+};
+
 
 
 /**
@@ -71,6 +96,29 @@ ThreejsLoader.prototype.loadJson = function ( path, source )
     this.isDownloadComplete = false;
     this.client.open('GET', path + source);
     this.currentPath = path;
+    
+    if ( undefined === this.scheduler )
+    {
+        this.scheduler = new GJobScheduler();
+        this.ownsScheduler = true;
+    }
+    
+    this.scheduler.addJob( this );
+
+    if ( undefined !== this.decodePool )
+    {
+        this.client.responseType = "arraybuffer";
+        this.client.onload = function(e)
+        {
+            if (this.client.status === 200)
+            {
+                this.decodePool.decode( { 'kind': "threejs", 'buffer': this.client.response }, this );
+            }
+        }.bind(this);
+        this.client.send();
+        return;
+    }
+
     this.client.onload = function(e) 
     {
 		var status = this.client.status;
@@ -85,27 +133,10 @@ ThreejsLoader.prototype.loadJson = function ( path, source )
 };
 
 /**
- * Update the available time and current progress
- * @param {number} Milliseconds sine the last update
+ * Refresh the current progress and report it to the observer
  */
-ThreejsLoader.prototype.updateTimeAndProgress = function ( time )
+ThreejsLoader.prototype.updateProgress = function ()
 {
-    var targetTime = 17;
-    
-    if (time > targetTime)
-    {
-        --this.availableTime;
-    }
-    else
-    {
-        ++this.availableTime;
-    }
-	
-	if ( this.availableTime <= 0 )
-	{
-		this.availableTime = 5;
-	}
-	
 	if ( undefined != this.observer &&
 	     undefined != this.reader )
 	{
@@ -115,32 +146,67 @@ ThreejsLoader.prototype.updateTimeAndProgress = function ( time )
 };
 
 /**
- * Update this json loader
+ * Update this json loader, only needed when no scheduler was provided with
+ * setJobScheduler
  * @param {number} Milliseconds since the last update
  */
 ThreejsLoader.prototype.update = function ( time )
 {
-    var timeStart = new Date().getTime();
-    
-    this.updateTimeAndProgress( time );
+    if ( this.ownsScheduler )
+    {
+        this.scheduler.update( time );
+    }
+};
+
+/**
+ * @return {number} Current priority of the loader
+ */
+ThreejsLoader.prototype.getPriority = function ()
+{
+    return ( undefined !== this.decodedResult ) ? GJobScheduler.PRIORITY_UPLOAD : GJobScheduler.PRIORITY_PARSE;
+};
+
+/**
+ * @return {number} Total progress of the loader
+ */
+ThreejsLoader.prototype.getProgress = function ()
+{
+    return this.isReadComplete ? 1 : this.totalProgress;
+};
+
+/**
+ * Do the next unit of loading work
+ * @return {number} One of the GJobScheduler.STEP_* values
+ */
+ThreejsLoader.prototype.step = function ()
+{
+    this.updateProgress();
     
-    while ( ( (new Date().getTime()) - timeStart) < this.availableTime )
+    if ( this.isReadComplete )
     {
-        if ( this.isReadComplete )
-        {
-            return;
-        }
-        else if ( this.isReaderReady )
-        {
-            this.updateReaderReady( time );
-        }
-		else if ( this.isDownloadComplete )
-		{
-		    this.reader = new ThreejsReader( this.currentPath, this.jsonToRead, 
-		                                     this.scene, this.group, this );
-		    this.isReaderReady = true;
-		}
+        return GJobScheduler.STEP_DONE;
+    }
+    else if ( undefined !== this.decodedResult )
+    {
+        this.addDecodedResult();
+    }
+    else if ( this.isReaderReady )
+    {
+        this.updateReaderReady( 0 );
     }
+    else if ( this.isDownloadComplete )
+    {
+        this.reader = new ThreejsReader( this.currentPath, this.jsonToRead, 
+                                         this.scene, this.group, this );
+        this.isReaderReady = true;
+    }
+    else
+    {
+        // waiting on the network or the decode worker
+        return GJobScheduler.STEP_WAITING;
+    }
+    
+    return GJobScheduler.STEP_WORKED;
 };
 
 /**
@@ -165,14 +231,72 @@ ThreejsLoader.prototype.updateReaderReady = function ( time )
     } 
 };
 
+/**
+ * This function is called when the decode pool is done with the json file
+ * @param {Object} result Mesh, skin and json sections decoded by the worker
+ */
+ThreejsLoader.prototype.onDecodeJobCompleted = function ( result )
+{
+    this.decodedResult = result;
+};
+
+/**
+ * Build the armature from the data decoded on the worker
+ */
+ThreejsLoader.prototype.addDecodedResult = function ()
+{
+    var result = this.decodedResult;
+    this.decodedResult = undefined;
+    this.isReadComplete = true;
+
+    if ( undefined !== result['error'] )
+    {
+        return;
+    }
+
+    this.jsonToRead = result['json'];
+
+    var packed = result['meshes'][0];
+    var mesh = new Mesh( packed['verts'], packed['tverts'], packed['normals'],
+                         packed['indices'], this.source );
+    mesh.setMtlName( this.path + this.source );
+
+    this.armature = new ArmatureMeshDecorator( mesh, new Skin( packed['skin'] ), this.createBones() );
+    this.group.addChild( this.armature );
+
+    this.assembleAnimator();
+    this.assembleMaterial();
+
+    if ( undefined != this.observer )
+    {
+        this.observer.onThreejsLoaderProgress( this, 1 );
+        this.observer.onThreejsLoaderCompleted( this );
+    }
+};
+
 /** 
  * Form the material object
  */
 ThreejsLoader.prototype.assembleMaterial = function()
 {
-    var newMat = new GMaterial( this.path + this.source );
+    // BufferGeometry files don't always carry their materials
+    var materials = this.jsonToRead['materials'];
     
-    var jsonMat = this.jsonToRead['materials'][0];
+    if ( undefined !== materials && materials.length > 0 )
+    {
+        this.scene.addMaterial( ThreejsLoader.createMaterial( this.path + this.source, materials[0] ) );
+    }
+};
+
+/**
+ * Create a material from its three.js json description
+ * @param {string} name Name for the new material
+ * @param {Object} jsonMat Material description
+ * @return {GMaterial}
+ */
+ThreejsLoader.createMaterial = function( name, jsonMat )
+{
+    var newMat = new GMaterial( name );
     
     var ambient = jsonMat['colorAmbient'];
     newMat.setKa( ambient );
@@ -183,7 +307,7 @@ ThreejsLoader.prototype.assembleMaterial = function()
     var specular = jsonMat['colorSpecular'];
     newMat.setKs( specular );
     
-    this.scene.addMaterial( newMat );
+    return newMat;
 };
 
 /**
@@ -191,7 +315,23 @@ ThreejsLoader.prototype.assembleMaterial = function()
  */
 ThreejsLoader.prototype.assembleAnimator = function()
 {
-	var jAnimations = this.jsonToRead['animations'];
+	var animator = ThreejsLoader.createAnimator( this.jsonToRead['animations'] );
+    
+    animator.setTarget( this.armature );
+    
+    if ( undefined != this.observer )
+    {
+        this.observer.onThreejsLoaderArmatureAnimatorLoaded( animator );
+    }
+};
+
+/**
+ * Create an animator from the three.js json animations
+ * @param {Object} jAnimations Animation descriptions
+ * @return {ArmatureAnimator}
+ */
+ThreejsLoader.createAnimator = function( jAnimations )
+{
 	var animator = new ArmatureAnimator();
     
 	for (var i in jAnimations )
@@ -218,12 +358,7 @@ ThreejsLoader.prototype.assembleAnimator = function()
         animator.addAnimation( animation );
     }
     
-    animator.setTarget( this.armature );
-    
-    if ( undefined != this.observer )
-    {
-        this.observer.onThreejsLoaderArmatureAnimatorLoaded( animator );
-    }
+    return animator;
 };
 
 /**
@@ -236,7 +371,7 @@ ThreejsLoader.prototype.onNewMeshAvailable = function ( proxyMesh, proxySkin )
 	var mesh = new Mesh( proxyMesh.getVertBuffer(),
 		 			     proxyMesh.getTVerBuffer(),
 					     proxyMesh.getNormBuffer(),
-					     proxyMesh.indices,
+					     proxyMesh.getIndexBuffer(),
 					     this.source );
 	mesh.setMtlName( this.path + this.source );
 	
@@ -253,9 +388,18 @@ ThreejsLoader.prototype.onNewMeshAvailable = function ( proxyMesh, proxySkin )
  * @return {Array.<Bone>} Array of bones defined in the json
  */
 ThreejsLoader.prototype.createBones = function ()
+{
+    return ThreejsLoader.createBones( this.jsonToRead['bones'] );
+};
+
+/**
+ * Create bone objects from their three.js json description
+ * @param {Object} jsonBones Bone descriptions
+ * @return {Array.<Bone>} Array of bones
+ */
+ThreejsLoader.createBones = function ( jsonBones )
 {
     var bones = [];
-    var jsonBones = this.jsonToRead['bones'];
     
     for ( var i in jsonBones )
     {
@@ -0,0 +1,228 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * @interface
+ */
+function GDecodeJobObserver () {}
+
+/**
+ * This function is called when a worker finishes decoding a job
+ * @param {Object} result Message posted back by the worker, holds an 'error'
+ *                 entry instead of the decoded data if the job failed
+ */
+GDecodeJobObserver.prototype.onDecodeJobCompleted = function ( result ) {};
+
+/**
+ * Pool of decode workers.  Jobs are queued and handed to the next idle
+ * worker, buffers travel in both directions as transferables so the decoded
+ * typed arrays land in the main thread without a copy.
+ * @constructor
+ * @param {function():Object} createWorker Returns a new worker, anything with a
+ *                            postMessage( message, transferList ) function and
+ *                            assignable onmessage and onerror handlers will do
+ * @param {number} size Number of workers in the pool
+ */
+function GDecodeWorkerPool( createWorker, size )
+{
+    this.createWorker = createWorker;
+    this.workers = [];
+    this.idleWorkers = [];
+    this.pendingJobs = [];
+    this.activeJobs = {};
+    this.nextJobId = 1;
+
+    for ( var i = 0; i < size; ++i )
+    {
+        this.addWorker();
+    }
+}
+
+/**
+ * Create a new worker and add it to the idle ones
+ */
+GDecodeWorkerPool.prototype.addWorker = function ()
+{
+    var worker = this.createWorker();
+    worker.onmessage = this.onWorkerMessage.bind( this, worker );
+    worker.onerror = this.onWorkerError.bind( this, worker );
+    this.workers.push( worker );
+    this.idleWorkers.push( worker );
+};
+
+/**
+ * Create a pool of browser workers, one per spare core
+ * @param {string} scriptUrl Url of the decode worker script
+ * @return {GDecodeWorkerPool|undefined} The new pool or undefined if workers
+ *         are not supported
+ */
+GDecodeWorkerPool.createBrowserPool = function ( scriptUrl )
+{
+    // The closure compiler has problems accessing members of the navigator
+    // unless they are called like this
+    if ( undefined === window['Worker'] )
+    {
+        return undefined;
+    }
+
+    var cores = window.navigator['hardwareConcurrency'] || 2;
+    var size = Math.max( 1, Math.min( 4, cores - 1 ) );
+
+    return new GDecodeWorkerPool( function () { return new Worker( scriptUrl ); }, size );
+};
+
+/**
+ * Queue a new decode job
+ * @param {Object} request Message for the worker, at least 'kind' and 'buffer'
+ * @param {GDecodeJobObserver} observer Receives the decoded result
+ */
+GDecodeWorkerPool.prototype.decode = function ( request, observer )
+{
+    request['id'] = this.nextJobId++;
+    this.pendingJobs.push( { request: request, observer: observer } );
+    this.dispatchJobs();
+};
+
+/**
+ * Send queued jobs to the idle workers
+ */
+GDecodeWorkerPool.prototype.dispatchJobs = function ()
+{
+    if ( 0 === this.workers.length )
+    {
+        // every worker failed, nothing is ever going to run these jobs
+        while ( this.pendingJobs.length > 0 )
+        {
+            this.failJob( this.pendingJobs.shift(), "no decode workers left" );
+        }
+    }
+    
+    while ( this.pendingJobs.length > 0 && this.idleWorkers.length > 0 )
+    {
+        var job = this.pendingJobs.shift();
+        var worker = this.idleWorkers.shift();
+        var transferList = [];
+
+        if ( undefined !== job.request['buffer'] )
+        {
+            transferList.push( job.request['buffer'] );
+        }
+
+        job.worker = worker;
+        this.activeJobs[ job.request['id'] ] = job;
+        worker.postMessage( job.request, transferList );
+    }
+};
+
+/**
+ * Handle a message posted back by one of the workers
+ * @param {Object} worker Worker that posted the message
+ * @param {Object} e Message event (or the message itself for node workers)
+ */
+GDecodeWorkerPool.prototype.onWorkerMessage = function ( worker, e )
+{
+    var result = ( undefined !== e['data'] ) ? e['data'] : e;
+    var job = this.activeJobs[ result['id'] ];
+
+    delete this.activeJobs[ result['id'] ];
+    this.idleWorkers.push( worker );
+
+    if ( undefined !== result['error'] )
+    {
+        console.debug( "GDecodeWorkerPool: " + result['error'] );
+    }
+
+    if ( undefined !== job )
+    {
+        job.observer.onDecodeJobCompleted( result );
+    }
+
+    this.dispatchJobs();
+};
+
+/**
+ * Handle a worker that threw or could not load its script.  The job it was
+ * running fails and the worker is replaced, a worker that fails while idle 
+ * is dropped so a script that does not load cannot keep creating workers.
+ * @param {Object} worker Worker that failed
+ * @param {Object} e Error event (or the error itself for node workers)
+ */
+GDecodeWorkerPool.prototype.onWorkerError = function ( worker, e )
+{
+    var message = ( undefined !== e['message'] ) ? e['message'] : String( e );
+    var failedJob = undefined;
+
+    if ( undefined !== e['preventDefault'] )
+    {
+        e['preventDefault']();
+    }
+
+    for ( var id in this.activeJobs )
+    {
+        if ( this.activeJobs[id].worker === worker )
+        {
+            failedJob = this.activeJobs[id];
+            delete this.activeJobs[id];
+        }
+    }
+
+    this.workers.splice( this.workers.indexOf( worker ), 1 );
+
+    var idleIndex = this.idleWorkers.indexOf( worker );
+    if ( -1 !== idleIndex )
+    {
+        this.idleWorkers.splice( idleIndex, 1 );
+    }
+
+    worker.terminate();
+
+    if ( undefined !== failedJob )
+    {
+        this.addWorker();
+        this.failJob( failedJob, message );
+    }
+
+    this.dispatchJobs();
+};
+
+/**
+ * Report a job as failed to its observer
+ * @param {Object} job
+ * @param {string} message
+ */
+GDecodeWorkerPool.prototype.failJob = function ( job, message )
+{
+    console.debug( "GDecodeWorkerPool: " + message );
+    job.observer.onDecodeJobCompleted( { 'id': job.request['id'], 'error': message } );
+};
+
+/**
+ * Stop all the workers in the pool
+ */
+GDecodeWorkerPool.prototype.terminate = function ()
+{
+    for ( var i = 0; i < this.workers.length; ++i )
+    {
+        this.workers[i].terminate();
+    }
+
+    this.workers = [];
+    this.idleWorkers = [];
+};
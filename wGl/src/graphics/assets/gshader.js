@@ -29,9 +29,62 @@ function GShader(vertex, fragment)
     this.fragment = fragment;
 }
 
+/**
+ * COMPLETION_STATUS_KHR from KHR_parallel_shader_compile
+ */
+GShader.COMPLETION_STATUS = 0x91B1;
+
+/**
+ * Get KHR_parallel_shader_compile for the context, it lets the status of a
+ * program be polled without waiting for the compilation to finish
+ * @param {WebGLRenderingContext} gl
+ * @return {Object} The extension or null if not supported
+ */
+GShader.getParallelCompileExtension = function ( gl )
+{
+    if ( undefined === gl.parallelShaderCompile )
+    {
+        gl.parallelShaderCompile = gl.getExtension( 'KHR_parallel_shader_compile' );
+    }
+    
+    return gl.parallelShaderCompile;
+};
+
+/**
+ * Finish the programs whose compilation is complete.  Without 
+ * KHR_parallel_shader_compile the completion can't be known without waiting
+ * for it, so only one program is finished on each call to spread the wait
+ * over several frames.
+ * @param {WebGLRenderingContext} gl
+ * @param {Array.<GShader|ShaderComposite>} pending Programs that were
+ *        started with startCompile, the finished ones are removed
+ */
+GShader.finishCompletedPrograms = function ( gl, pending )
+{
+    var canPoll = null !== GShader.getParallelCompileExtension( gl );
+    
+    for ( var i = 0; i < pending.length; )
+    {
+        if ( canPoll && !pending[i].isCompileComplete() )
+        {
+            ++i;
+            continue;
+        }
+        
+        pending[i].finishCompile();
+        pending.splice( i, 1 );
+        
+        if ( !canPoll )
+        {
+            return;
+        }
+    }
+};
+
 /**
  * Create the shader object and send to the GPU. This has to be called once for
- * the vertex shader and once for the fragment shader.
+ * the vertex shader and once for the fragment shader.  The compile status is
+ * only checked by finishCompile.
  * @param {string} source for this shader
  * @param {number} Constant containing the shader type
  * @return {WebGLShader}
@@ -45,14 +98,23 @@ GShader.prototype.getShader = function (shaderScript, shaderType)
     gl.shaderSource(shader, shaderScript);
     gl.compileShader(shader);
 
+    return shader;
+};
+
+/**
+ * Log the errors of a shader that didn't compile
+ * @param {WebGLShader} shader
+ * @param {string} shaderScript Source of the shader
+ */
+GShader.prototype.logShaderErrors = function (shader, shaderScript)
+{
+    var gl = this.gl;
+    
     if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) 
     {
         console.debug(shaderScript);
         console.debug(gl.getShaderInfoLog(shader));
-        return null;
     }
-
-    return shader;
 };
 
 /**
@@ -72,23 +134,61 @@ GShader.prototype.destroy = function ()
 };
 
 /**
- * Called to bind this shader program to a gl context
+ * Called to bind this shader program to a gl context, it waits for the
+ * program to be compiled
  * @param {WebGLRenderingContext} Context to bind to this texture
  */
 GShader.prototype.bindToContext = function ( gl )
+{
+    this.startCompile( gl );
+    this.finishCompile();
+};
+
+/**
+ * Send the sources to the GPU and link the program without waiting for the
+ * result, finishCompile has to be called before the program is used
+ * @param {WebGLRenderingContext} gl Context to bind to this program
+ */
+GShader.prototype.startCompile = function ( gl )
 {
     this.gl = gl;
     
-    var fragmentShader = this.getShader(this.fragment, gl.FRAGMENT_SHADER);
-    var vertexShader = this.getShader(this.vertex, gl.VERTEX_SHADER);
+    this.fShader = this.getShader(this.fragment, gl.FRAGMENT_SHADER);
+    this.vShader = this.getShader(this.vertex, gl.VERTEX_SHADER);
+
+    this.glProgram = gl.createProgram();
+    gl.attachShader(this.glProgram, this.vShader);
+    gl.attachShader(this.glProgram, this.fShader);
+    gl.linkProgram(this.glProgram);
+};
+
+/**
+ * Check if the program can be finished without waiting, this is always true
+ * without KHR_parallel_shader_compile
+ * @return {boolean}
+ */
+GShader.prototype.isCompileComplete = function ()
+{
+    if ( null === GShader.getParallelCompileExtension( this.gl ) )
+    {
+        return true;
+    }
+    
+    return true === this.gl.getProgramParameter( this.glProgram, GShader.COMPLETION_STATUS );
+};
 
-    var shaderProgram = gl.createProgram();
-    gl.attachShader(shaderProgram, vertexShader);
-    gl.attachShader(shaderProgram, fragmentShader);
-    gl.linkProgram(shaderProgram);
+/**
+ * Check the result of startCompile and look up the attributes and uniforms
+ */
+GShader.prototype.finishCompile = function ()
+{
+    var gl = this.gl;
+    var shaderProgram = this.glProgram;
 
     if (!gl.getProgramParameter(shaderProgram, gl.LINK_STATUS)) 
     { 
+        this.logShaderErrors(this.vShader, this.vertex);
+        this.logShaderErrors(this.fShader, this.fragment);
         console.debug(gl.getProgramInfoLog(shaderProgram));
         console.debug("Could not initialise shaders");
     }
@@ -98,13 +198,18 @@ GShader.prototype.bindToContext = function ( gl )
     attr.textureVertexAttribute  = gl.getAttribLocation( shaderProgram, "aTextureVertex" );
     attr.normalVertexAttribute   = gl.getAttribLocation( shaderProgram, "aNormalVertex" );
     attr.skinVertexAttribute     = gl.getAttribLocation( shaderProgram, "aSkinVertex" );
+    // a mat4 attribute takes this location and the three after it
+    attr.instanceVertexAttribute = gl.getAttribLocation( shaderProgram, "aInstanceMatrix" );
     
     var uniforms = {};
     uniforms.aMatrixUniform  = gl.getUniformLocation( shaderProgram, "uAMatrix" );
     uniforms.pMatrixUniform  = gl.getUniformLocation( shaderProgram, "uPMatrix" );
-    uniforms.mvMatrixUniform = gl.getUniformLocation( shaderProgram, "uMVMatrix" );
+    uniforms.mMatrixUniform  = gl.getUniformLocation( shaderProgram, "uMMatrix" );
+    uniforms.vMatrixUniform  = gl.getUniformLocation( shaderProgram, "uVMatrix" );
     uniforms.nMatrixUniform  = gl.getUniformLocation( shaderProgram, "uNMatrix" );
     uniforms.hMatrixUniform  = gl.getUniformLocation( shaderProgram, "uHMatrix" );
+    uniforms.positionDecode  = gl.getUniformLocation( shaderProgram, "uPositionDecode" );
+    uniforms.textureDecode   = gl.getUniformLocation( shaderProgram, "uTextureDecode" );
     
     uniforms.Ka              = gl.getUniformLocation( shaderProgram, "uKa" );
     uniforms.Kd              = gl.getUniformLocation( shaderProgram, "uKd" );
@@ -136,9 +241,19 @@ GShader.prototype.bindToContext = function ( gl )
     
     this.attributes = attr;
     this.uniforms = uniforms;
-    this.glProgram = shaderProgram;
-    this.vShader = vertexShader;
-    this.fShader = fragmentShader;
+    this.attributeLayout = [ attr.positionVertexAttribute, attr.normalVertexAttribute,
+                             attr.textureVertexAttribute, attr.skinVertexAttribute,
+                             attr.instanceVertexAttribute ].join( "," );
+};
+
+/**
+ * Get a key for the attribute locations of this program, the programs with
+ * the same one can share the vertex array objects of the meshes
+ * @return {string}
+ */
+GShader.prototype.getAttributeLayout = function()
+{
+    return this.attributeLayout;
 };
 
 /**
@@ -170,6 +285,18 @@ GShader.prototype.deactivate = function()
         {
             gl.disableVertexAttribArray(this.attributes.skinVertexAttribute);
         }
+        
+        if ( -1 < this.attributes.instanceVertexAttribute)
+        {
+            // the divisors stay with the default vertex array when there are
+            // no vertex array objects, the next program could read these 
+            // locations per vertex
+            for ( var i = 0; i < 4; ++i )
+            {
+                gl.disableVertexAttribArray(this.attributes.instanceVertexAttribute + i);
+                gl.vertexAttribDivisor(this.attributes.instanceVertexAttribute + i, 0);
+            }
+        }
 	}
 };
 
@@ -202,6 +329,14 @@ GShader.prototype.activate = function()
     {
         gl.enableVertexAttribArray(this.attributes.skinVertexAttribute);
     } 
+    
+    if ( -1 < this.attributes.instanceVertexAttribute)
+    {
+        for ( var i = 0; i < 4; ++i )
+        {
+            gl.enableVertexAttribArray(this.attributes.instanceVertexAttribute + i);
+        }
+    }
 };
 
 
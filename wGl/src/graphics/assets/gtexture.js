@@ -20,6 +20,7 @@
 
 /**
  * @constructor
+ * @implements {GJob}
  * @param {Array.<string>} Array of material arguments to use while creating this texture.
  * @param {string} Path to the location of the texture resource
  */
@@ -27,9 +28,37 @@ function GTexture( mtlargs, path )
 {
 	this.scale = vec2.fromValues(1, 1);
     this.path = path;
+    this.compressedVariants = [];
+    this.clamp = false;
+    this.cacheEntry = undefined;
+    this.ownedEntry = undefined;
+    this.uploadState = GTexture.UPLOAD_NONE;
     this.processArgs( mtlargs );
 }
 
+/**
+ * Block compressed variants, in order of preference
+ */
+GTexture.COMPRESSED_VARIANTS = [ "astc", "dxt", "etc1" ];
+
+/**
+ * Variants that GTextureBlockDecoder can decompress when the context lacks
+ * the matching extension
+ */
+GTexture.DECODABLE_VARIANTS = [ "dxt", "etc1" ];
+
+GTexture.COMPRESSED_RGB8_ETC2 = 0x9274;
+
+/**
+ * States of a texture that uploads through the job scheduler of its context
+ */
+GTexture.UPLOAD_NONE = 0;
+GTexture.UPLOAD_WAITING = 1;
+GTexture.UPLOAD_IMAGE = 2;
+GTexture.UPLOAD_KTX = 3;
+GTexture.UPLOAD_FAILED = 4;
+GTexture.UPLOAD_DONE = 5;
+
 /** 
  * This function handles the arguments sent to the constructor
  * @param {Array.<string>} Array of material arguments to use while creating this texture.
@@ -46,6 +75,10 @@ GTexture.prototype.processArgs = function( args )
             this.scale[0] = parseFloat(args[++i]);
             this.scale[1] = parseFloat(args[++i]);
         }
+        else if ( args[i] === "-clamp" )
+        {
+            this.clamp = ( "on" === args[++i] );
+        }
         else
         {
             this.name = args[i];
@@ -92,11 +125,21 @@ GTexture.prototype.release = function()
 };
 
 /**
- * Called to delete all the resources under this material
+ * Called to delete all the resources under this material.  Textures loaded 
+ * through the context's GTextureCache only drop their reference.
  */
 GTexture.prototype.deleteResources = function()
 {
-    this.gl.deleteTexture( this.glTHandle );
+    if ( undefined !== this.cacheEntry )
+    {
+        GTextureCache.get( this.gl ).release( this.cacheEntry, this );
+        this.cacheEntry = undefined;
+        this.glTHandle = undefined;
+    }
+    else if ( undefined === this.name )
+    {
+        this.gl.deleteTexture( this.glTHandle );
+    }
 };
 
 /**
@@ -119,18 +162,278 @@ GTexture.prototype.getName = function()
     return this.name;
 };
 
+/**
+ * Get the part of the cache key that comes from the sampler state, textures
+ * of the same image with a different wrap mode can't share a GL texture
+ * @return {string}
+ */
+GTexture.prototype.getSamplerKey = function()
+{
+    return this.clamp ? "clamp" : "repeat";
+};
+
+/**
+ * Set the block compressed variants that were transcoded for this texture,
+ * the variant files are named <name>.<variant>.ktx with the extension of the
+ * texture name dropped (see tools/wgltexture.js)
+ * @param {Array.<string>} variants Some of GTexture.COMPRESSED_VARIANTS
+ */
+GTexture.prototype.setCompressedVariants = function( variants )
+{
+    this.compressedVariants = variants;
+};
+
+/**
+ * Find the compressed texture extensions of a context, the result is cached
+ * on the context
+ * @param {WebGLRenderingContext} gl
+ * @return {Object} Support of every variant
+ */
+GTexture.getCompressedSupport = function( gl )
+{
+    if ( undefined === gl.compressedSupport )
+    {
+        var hasExtension = function( names )
+        {
+            for ( var i = 0; i < names.length; ++i )
+            {
+                if ( null !== gl.getExtension( names[i] ) )
+                {
+                    return true;
+                }
+            }
+            
+            return false;
+        };
+        
+        gl.compressedSupport = 
+        {
+            "astc": hasExtension( [ "WEBGL_compressed_texture_astc" ] ),
+            "dxt":  hasExtension( [ "WEBGL_compressed_texture_s3tc", 
+                                    "WEBKIT_WEBGL_compressed_texture_s3tc",
+                                    "MOZ_WEBGL_compressed_texture_s3tc" ] ),
+            "etc1": hasExtension( [ "WEBGL_compressed_texture_etc1" ] ),
+            "etc":  hasExtension( [ "WEBGL_compressed_texture_etc" ] )
+        };
+    }
+    
+    return gl.compressedSupport;
+};
+
+/**
+ * Pick the variant to download, the context's own formats come first and
+ * the ones that can be decompressed on the cpu after them
+ * @return {Object|undefined} { name, decode } or undefined to load the image
+ */
+GTexture.prototype.chooseCompressedVariant = function()
+{
+    var support = GTexture.getCompressedSupport( this.gl );
+    var i = 0;
+    
+    for ( i = 0; i < GTexture.COMPRESSED_VARIANTS.length; ++i )
+    {
+        var name = GTexture.COMPRESSED_VARIANTS[i];
+        
+        // ETC2 decoders read ETC1 blocks unchanged
+        var supported = support[name] || ( "etc1" === name && support["etc"] );
+        
+        if ( supported && this.compressedVariants.indexOf( name ) !== -1 )
+        {
+            return { name: name, decode: false };
+        }
+    }
+    
+    for ( i = 0; i < GTexture.DECODABLE_VARIANTS.length; ++i )
+    {
+        if ( this.compressedVariants.indexOf( GTexture.DECODABLE_VARIANTS[i] ) !== -1 )
+        {
+            return { name: GTexture.DECODABLE_VARIANTS[i], decode: true };
+        }
+    }
+    
+    return undefined;
+};
+
 /**
  * Start the loading process for this texture (usually from a web serever)
  */
 GTexture.prototype.loadTexture = function() 
 {   
     if ( undefined != this.path &&
-         undefined != this.name )
+         undefined != this.name &&
+         undefined != this.gl &&
+         undefined === this.cacheEntry )
+    {
+        this.cacheEntry = GTextureCache.get( this.gl ).acquire( this );
+        
+        if ( this.cacheEntry.owner !== this )
+        {
+            // shared with a texture that is already loaded or loading it
+            return;
+        }
+        
+        this.ownedEntry = this.cacheEntry;
+        
+        if ( undefined !== this.gl.jobScheduler )
+        {
+            // the upload waits for its turn in the context's frame budget
+            this.uploadState = GTexture.UPLOAD_WAITING;
+            this.gl.jobScheduler.addJob( this );
+        }
+        
+        var variant = this.chooseCompressedVariant();
+        
+        if ( undefined !== variant )
+        {
+            this.loadCompressedTexture( variant );
+        }
+        else
+        {
+            this.loadImage();
+        }
+    }
+};
+
+/**
+ * Download the uncompressed image
+ */
+GTexture.prototype.loadImage = function() 
+{
+    this.image = new Image();
+    this.image.onload = this.handleTextureLoaded.bind(this);
+    this.image.onerror = this.handleTextureFailed.bind(this);
+    this.image.src = this.path+this.name;
+};
+
+/**
+ * Download a compressed variant, falls back to the image if the variant is
+ * missing or can't be read
+ * @param {Object} variant As returned by chooseCompressedVariant
+ */
+GTexture.prototype.loadCompressedTexture = function( variant ) 
+{
+    var client = new XMLHttpRequest();
+    
+    client.open( 'GET', this.path + this.name.replace( /\.[^.\/]*$/, "" ) + "." + variant.name + ".ktx" );
+    client.responseType = "arraybuffer";
+    client.onreadystatechange = function()
+    {
+        if ( client.readyState === 4 )
+        {
+            var ktx = ( 200 === client.status || 0 === client.status ) && null !== client.response ? 
+                      GKtxReader.parse( client.response ) : undefined;
+            
+            if ( undefined !== ktx )
+            {
+                this.handleCompressedTextureLoaded( ktx, variant.decode );
+            }
+            else
+            {
+                console.debug( "GTexture: no " + variant.name + " variant of " + this.name );
+                this.loadImage();
+            }
+        }
+    }.bind( this );
+    client.send();
+};
+
+/**
+ * Called when a compressed variant has been downloaded
+ * @param {Object} ktx As returned by GKtxReader.parse
+ * @param {boolean} decode True to decompress the levels on the cpu
+ */
+GTexture.prototype.handleCompressedTextureLoaded = function( ktx, decode ) 
+{
+    if ( decode && !GTextureBlockDecoder.canDecode( ktx.internalFormat ) )
+    {
+        console.debug( "GTexture: can't decompress format " + ktx.internalFormat + " of " + this.name );
+        this.loadImage();
+        return;
+    }
+    
+    this.ktx = ktx;
+    this.ktxDecode = decode;
+    
+    if ( GTexture.UPLOAD_WAITING === this.uploadState )
+    {
+        this.ktxLevel = 0;
+        this.uploadState = GTexture.UPLOAD_KTX;
+    }
+    else if (this.gl !== undefined)
+    {
+        this.sendCompressedTextureToGl();
+    }
+};
+
+/**
+ * Send the mip levels of a compressed variant to the GPU, as they are or
+ * decompressed to RGBA8.  The chain comes from the file so there is no 
+ * generateMipmap call.
+ */
+GTexture.prototype.sendCompressedTextureToGl = function()
+{
+    this.beginCompressedUpload();
+    
+    while ( this.uploadCompressedLevel() ) {}
+};
+
+/**
+ * Create the GL texture for the compressed variant
+ */
+GTexture.prototype.beginCompressedUpload = function()
+{
+    this.ktxInternalFormat = this.ktx.internalFormat;
+    
+    if ( GTextureBlockDecoder.ETC1_RGB8 === this.ktxInternalFormat && 
+         !GTexture.getCompressedSupport( this.gl )["etc1"] )
     {
-        this.image = new Image();
-        this.image.onload = this.handleTextureLoaded.bind(this);
-        this.image.src = this.path+this.name;
+        this.ktxInternalFormat = GTexture.COMPRESSED_RGB8_ETC2;
     }
+    
+    this.glTHandle = this.gl.createTexture();
+    this.ktxLevel = 0;
+    this.ktxBytes = 0;
+};
+
+/**
+ * Upload the next mip level of the compressed variant
+ * @return {boolean} True if there are levels left
+ */
+GTexture.prototype.uploadCompressedLevel = function()
+{
+    var gl = this.gl;
+    var ktx = this.ktx;
+    var i = this.ktxLevel++;
+    var level = ktx.levels[i];
+    
+    gl.bindTexture(gl.TEXTURE_2D, this.glTHandle);
+    
+    if ( this.ktxDecode )
+    {
+        var pixels = GTextureBlockDecoder.decode( ktx.internalFormat, level.data, level.width, level.height );
+        gl.texImage2D(gl.TEXTURE_2D, i, gl.RGBA, level.width, level.height, 0, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+        this.ktxBytes += pixels.length;
+    }
+    else
+    {
+        gl.compressedTexImage2D(gl.TEXTURE_2D, i, this.ktxInternalFormat, level.width, level.height, 0, level.data);
+        this.ktxBytes += level.data.length;
+    }
+    
+    if ( this.ktxLevel < ktx.levels.length )
+    {
+        gl.bindTexture(gl.TEXTURE_2D, null);
+        return true;
+    }
+    
+    this.setSamplerParameters( ktx.levels.length > 1 );
+    gl.bindTexture(gl.TEXTURE_2D, null);
+    
+    // the blocks are on the GPU now
+    this.ktx = undefined;
+    
+    this.onTextureUploaded( this.ktxBytes );
+    return false;
 };
 
 /**
@@ -138,7 +441,11 @@ GTexture.prototype.loadTexture = function()
  */
 GTexture.prototype.handleTextureLoaded = function() 
 {
-    if (this.gl !== undefined)
+    if ( GTexture.UPLOAD_WAITING === this.uploadState )
+    {
+        this.uploadState = GTexture.UPLOAD_IMAGE;
+    }
+    else if (this.gl !== undefined)
     {
         this.sendTextureToGl();
     }
@@ -146,6 +453,98 @@ GTexture.prototype.handleTextureLoaded = function()
     this.image.loaded = true;
 };
 
+/**
+ * Called if the image can't be downloaded
+ */
+GTexture.prototype.handleTextureFailed = function() 
+{
+    console.debug( "GTexture: could not load [" + this.path + this.name + "]" );
+    
+    if ( GTexture.UPLOAD_WAITING === this.uploadState )
+    {
+        this.uploadState = GTexture.UPLOAD_FAILED;
+    }
+    
+    if ( undefined !== this.ownedEntry )
+    {
+        GTextureCache.get( this.gl ).reject( this.ownedEntry );
+    }
+};
+
+/**
+ * Called by the cache when the download of the entry of this texture fails,
+ * the texture loads again if it's bound to a context again
+ * @param {Object} entry
+ */
+GTexture.prototype.onCacheEntryRejected = function( entry )
+{
+    if ( this.cacheEntry === entry )
+    {
+        this.cacheEntry = undefined;
+    }
+    
+    if ( this.ownedEntry === entry )
+    {
+        this.ownedEntry = undefined;
+    }
+};
+
+/**
+ * @return {number} Textures go after the geometry
+ */
+GTexture.prototype.getPriority = function()
+{
+    return GJobScheduler.PRIORITY_TEXTURE;
+};
+
+/**
+ * @return {number} Progress of the upload
+ */
+GTexture.prototype.getProgress = function()
+{
+    if ( GTexture.UPLOAD_KTX === this.uploadState && undefined !== this.ktx )
+    {
+        return this.ktxLevel / this.ktx.levels.length;
+    }
+    
+    return ( GTexture.UPLOAD_DONE === this.uploadState || GTexture.UPLOAD_FAILED === this.uploadState ) ? 1 : 0;
+};
+
+/**
+ * Upload the downloaded image, or the next mip level of a compressed variant
+ * @return {number} One of the GJobScheduler.STEP_* values
+ */
+GTexture.prototype.step = function()
+{
+    if ( GTexture.UPLOAD_IMAGE === this.uploadState )
+    {
+        this.sendTextureToGl();
+    }
+    else if ( GTexture.UPLOAD_KTX === this.uploadState )
+    {
+        if ( 0 === this.ktxLevel )
+        {
+            this.beginCompressedUpload();
+        }
+        
+        if ( this.uploadCompressedLevel() )
+        {
+            return GJobScheduler.STEP_WORKED;
+        }
+    }
+    else if ( GTexture.UPLOAD_WAITING === this.uploadState )
+    {
+        return GJobScheduler.STEP_WAITING;
+    }
+    
+    if ( GTexture.UPLOAD_FAILED !== this.uploadState )
+    {
+        this.uploadState = GTexture.UPLOAD_DONE;
+    }
+    
+    return GJobScheduler.STEP_DONE;
+};
+
 /**
  * This function is used to send the texture data over to the GPU
  */
@@ -156,10 +555,50 @@ GTexture.prototype.sendTextureToGl = function()
     
     gl.bindTexture(gl.TEXTURE_2D, this.glTHandle);
     gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, gl.RGBA, gl.UNSIGNED_BYTE, this.image);
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
-    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.LINEAR_MIPMAP_NEAREST);
+    this.setSamplerParameters(true);
     gl.generateMipmap(gl.TEXTURE_2D);
     gl.bindTexture(gl.TEXTURE_2D, null);
+    
+    // a full mip chain adds a third to the base level
+    this.onTextureUploaded( Math.round( 4 * this.image.width * this.image.height * 4 / 3 ) );
+};
+
+/**
+ * Set the sampler state of the bound texture
+ * @param {boolean} mipmapped
+ */
+GTexture.prototype.setSamplerParameters = function( mipmapped )
+{
+    var gl = this.gl;
+    
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, mipmapped ? gl.LINEAR_MIPMAP_NEAREST : gl.LINEAR);
+    
+    if ( this.clamp )
+    {
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+        gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    }
+};
+
+/**
+ * Hand the uploaded texture to the cache entry of this texture so the
+ * textures waiting for it can use it
+ * @param {number} bytes GPU memory of the texture
+ */
+GTexture.prototype.onTextureUploaded = function( bytes )
+{
+    if ( undefined !== this.ownedEntry )
+    {
+        GTextureCache.get( this.gl ).resolve( this.ownedEntry, this.glTHandle, bytes );
+        this.ownedEntry = undefined;
+    }
+    
+    if ( undefined === this.cacheEntry )
+    {
+        // released while loading, the cache owns the texture now
+        this.glTHandle = undefined;
+    }
 };
 
 /**
@@ -0,0 +1,237 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Shares the GL textures of a context between the GTexture instances that
+ * reference the same image with the same sampler state.  The first texture
+ * of a key downloads and uploads the image, the ones that ask for it while 
+ * it's in flight wait for that upload instead of starting their own.  The GL
+ * texture is deleted when the last reference is released.  A failed download
+ * drops its entry, so the next texture that asks for the key tries again.
+ * @constructor
+ * @param {WebGLRenderingContext} gl
+ */
+function GTextureCache( gl )
+{
+    this.gl = gl;
+    this.entries = {};
+    
+    this.stats = 
+    {
+        requests: 0,
+        hits: 0,
+        inFlightHits: 0,
+        bytesSaved: 0,
+        textures: 0,
+        bytes: 0
+    };
+}
+
+/**
+ * Get the cache of a context, it's created on first use and kept on the 
+ * context
+ * @param {WebGLRenderingContext} gl
+ * @return {GTextureCache}
+ */
+GTextureCache.get = function( gl )
+{
+    if ( undefined === gl.textureCache )
+    {
+        gl.textureCache = new GTextureCache( gl );
+    }
+    
+    return gl.textureCache;
+};
+
+/**
+ * Resolve the "." and ".." segments of a url so different spellings of the 
+ * same file share a key
+ * @param {string} url
+ * @return {string}
+ */
+GTextureCache.resolvePath = function( url )
+{
+    var parts = url.replace( /\\/g, "/" ).split( "/" );
+    var out = [];
+    
+    for ( var i = 0; i < parts.length; ++i )
+    {
+        if ( "." === parts[i] || ( "" === parts[i] && i > 0 && i < parts.length - 1 ) )
+        {
+            continue;
+        }
+        
+        if ( ".." === parts[i] && out.length > 0 && ".." !== out[out.length - 1] )
+        {
+            out.pop();
+        }
+        else
+        {
+            out.push( parts[i] );
+        }
+    }
+    
+    return out.join( "/" );
+};
+
+/**
+ * Take a reference to the GL texture of a GTexture
+ * @param {GTexture} texture
+ * @return {Object} The cache entry, texture has to load it if it's the owner
+ *         of the entry
+ */
+GTextureCache.prototype.acquire = function( texture )
+{
+    var key = GTextureCache.resolvePath( texture.path + texture.getName() ) + "|" + texture.getSamplerKey();
+    var entry = this.entries[key];
+    
+    ++this.stats.requests;
+    
+    if ( undefined === entry )
+    {
+        entry = { key: key, owner: texture, refCount: 0, glTHandle: undefined, bytes: 0, waiting: [] };
+        this.entries[key] = entry;
+        ++this.stats.textures;
+    }
+    else
+    {
+        ++this.stats.hits;
+        
+        if ( undefined !== entry.glTHandle )
+        {
+            texture.setTextureHandle( entry.glTHandle );
+            this.stats.bytesSaved += entry.bytes;
+        }
+        else
+        {
+            ++this.stats.inFlightHits;
+            entry.waiting.push( texture );
+        }
+    }
+    
+    ++entry.refCount;
+    
+    return entry;
+};
+
+/**
+ * Called by the owner of an entry once the GL texture is uploaded
+ * @param {Object} entry
+ * @param {WebGLTexture} handle
+ * @param {number} bytes GPU memory of the texture including the mip levels
+ */
+GTextureCache.prototype.resolve = function( entry, handle, bytes )
+{
+    if ( 0 === entry.refCount )
+    {
+        // every reference was released during the download
+        this.gl.deleteTexture( handle );
+        return;
+    }
+    
+    entry.glTHandle = handle;
+    entry.bytes = bytes;
+    this.stats.bytes += bytes;
+    
+    for ( var i = 0; i < entry.waiting.length; ++i )
+    {
+        entry.waiting[i].setTextureHandle( handle );
+        this.stats.bytesSaved += bytes;
+    }
+    
+    entry.waiting = [];
+};
+
+/**
+ * Called by the owner of an entry when its download fails.  The entry is
+ * dropped so the next acquire of the key downloads it again, the textures
+ * waiting on it share the url that failed and are left without an image.
+ * @param {Object} entry
+ */
+GTextureCache.prototype.reject = function( entry )
+{
+    if ( this.entries[entry.key] === entry )
+    {
+        delete this.entries[entry.key];
+        --this.stats.textures;
+    }
+    
+    entry.owner.onCacheEntryRejected( entry );
+    
+    for ( var i = 0; i < entry.waiting.length; ++i )
+    {
+        entry.waiting[i].onCacheEntryRejected( entry );
+    }
+    
+    entry.waiting = [];
+    entry.refCount = 0;
+};
+
+/**
+ * Drop a reference, the GL texture is deleted with the last one
+ * @param {Object} entry
+ * @param {GTexture} texture
+ */
+GTextureCache.prototype.release = function( entry, texture )
+{
+    var index = entry.waiting.indexOf( texture );
+    
+    if ( index !== -1 )
+    {
+        entry.waiting.splice( index, 1 );
+    }
+    
+    if ( --entry.refCount > 0 )
+    {
+        return;
+    }
+    
+    if ( undefined !== entry.glTHandle )
+    {
+        this.gl.deleteTexture( entry.glTHandle );
+        this.stats.bytes -= entry.bytes;
+    }
+    
+    // a key can get a new entry while this one is still referenced
+    if ( this.entries[entry.key] === entry )
+    {
+        delete this.entries[entry.key];
+        --this.stats.textures;
+    }
+};
+
+/**
+ * Get the cache counters
+ * @return {Object} requests, hits (requests served by an existing entry),
+ *         inFlightHits (hits that waited for a download), bytesSaved (GPU 
+ *         memory not allocated thanks to the hits), textures and bytes (live
+ *         GL textures and their memory)
+ */
+GTextureCache.prototype.getStats = function()
+{
+    var ret = {};
+    
+    for ( var key in this.stats )
+    {
+        ret[key] = this.stats[key];
+    }
+    
+    return ret;
+};
@@ -0,0 +1,179 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Axis aligned box and bounding sphere around a set of points.  The sphere
+ * is centered on the box, it's the cheaper test and the box is only checked
+ * when the sphere is not conclusive.
+ * @constructor
+ */
+function GBounds()
+{
+    this.min = vec3.create();
+    this.max = vec3.create();
+    this.center = vec3.create();
+    this.radius = 0;
+    this.infinite = false;
+    this.corner = vec3.create();
+    
+    this.reset();
+}
+
+/**
+ * Calculate the bounds of a vertex array
+ * @param {Array.<number>|Float32Array} verts Vertices with 3 components each
+ * @return {GBounds}
+ */
+GBounds.fromVertices = function( verts )
+{
+    var bounds = new GBounds();
+    var i = 0;
+    
+    for ( i = 0; i < verts.length; i += 3 )
+    {
+        bounds.addPoint( verts[i], verts[i+1], verts[i+2] );
+    }
+    
+    bounds.updateSphere();
+    
+    if ( bounds.isEmpty() )
+    {
+        return bounds;
+    }
+    
+    // the farthest vertex from the center of the box is usually well inside
+    // the half diagonal
+    var c = bounds.center;
+    var radiusSq = 0;
+    
+    for ( i = 0; i < verts.length; i += 3 )
+    {
+        var dx = verts[i] - c[0];
+        var dy = verts[i+1] - c[1];
+        var dz = verts[i+2] - c[2];
+        radiusSq = Math.max( radiusSq, dx*dx + dy*dy + dz*dz );
+    }
+    
+    bounds.radius = Math.sqrt( radiusSq );
+    
+    return bounds;
+};
+
+/**
+ * Empty the bounds
+ */
+GBounds.prototype.reset = function()
+{
+    vec3.set( this.min, Infinity, Infinity, Infinity );
+    vec3.set( this.max, -Infinity, -Infinity, -Infinity );
+    vec3.set( this.center, 0, 0, 0 );
+    this.radius = 0;
+    this.infinite = false;
+};
+
+/**
+ * @return {boolean} True if no point was added
+ */
+GBounds.prototype.isEmpty = function()
+{
+    return this.min[0] > this.max[0];
+};
+
+/**
+ * Make the bounds cover everything, used when a part of the contents can't
+ * be bounded
+ */
+GBounds.prototype.setInfinite = function()
+{
+    this.infinite = true;
+};
+
+/**
+ * @return {boolean}
+ */
+GBounds.prototype.isInfinite = function()
+{
+    return this.infinite;
+};
+
+/**
+ * Grow the box to contain a point, updateSphere has to be called once all 
+ * the points are added
+ * @param {number} x
+ * @param {number} y
+ * @param {number} z
+ */
+GBounds.prototype.addPoint = function( x, y, z )
+{
+    var min = this.min;
+    var max = this.max;
+    
+    min[0] = Math.min( min[0], x ); max[0] = Math.max( max[0], x );
+    min[1] = Math.min( min[1], y ); max[1] = Math.max( max[1], y );
+    min[2] = Math.min( min[2], z ); max[2] = Math.max( max[2], z );
+};
+
+/**
+ * Make the sphere the one around the box
+ */
+GBounds.prototype.updateSphere = function()
+{
+    if ( this.isEmpty() )
+    {
+        return;
+    }
+    
+    vec3.add( this.center, this.min, this.max );
+    vec3.scale( this.center, this.center, 0.5 );
+    this.radius = vec3.distance( this.center, this.max );
+};
+
+/**
+ * Grow the box to contain other bounds seen through a matrix
+ * @param {GBounds} bounds
+ * @param {Float32Array} mat Transformation from the space of bounds to the 
+ *        space of these bounds
+ */
+GBounds.prototype.addBounds = function( bounds, mat )
+{
+    if ( bounds.isInfinite() )
+    {
+        this.setInfinite();
+        return;
+    }
+    
+    if ( bounds.isEmpty() )
+    {
+        return;
+    }
+    
+    var p = this.corner;
+    
+    for ( var i = 0; i < 8; ++i )
+    {
+        vec3.set( p, ( i & 1 ) ? bounds.max[0] : bounds.min[0],
+                     ( i & 2 ) ? bounds.max[1] : bounds.min[1],
+                     ( i & 4 ) ? bounds.max[2] : bounds.min[2] );
+        vec3.transformMat4( p, p, mat );
+        this.addPoint( p[0], p[1], p[2] );
+    }
+    
+    this.updateSphere();
+};
@@ -38,9 +38,13 @@ function GCamera()
 	
 	this.aspect = 1.7777777777777777;
 	this.fovy = 0.8*(3.14159/4);
+	
+	// the matrices are only recalculated after one of the values changes
+	this.isDirty = true;
 
     this.inverseProjectionReady = false;
     this.inverseProjectionMatrix = mat4.create();
+    this.rayPoint = vec4.create();
 }
 	
 /**
@@ -56,6 +60,11 @@ GCamera.prototype.draw = function( ouMvMatrix, shader )
     mat4.copy(ouMvMatrix, this.mvMatrix);
     
     gl.uniformMatrix4fv( shader.uniforms.pMatrixUniform, false, this.pMatrix );
+    
+    if ( null != shader.uniforms.vMatrixUniform )
+    {
+        gl.uniformMatrix4fv( shader.uniforms.vMatrixUniform, false, this.mvMatrix );
+    }
 };
 
 /**
@@ -92,6 +101,16 @@ GCamera.prototype.bindToContext = function(gl)
 GCamera.prototype.setFovy = function( fovy )
 {
     this.fovy = fovy;
+    this.isDirty = true;
+};
+
+/**
+ * Get the field of view on the y-axis
+ * @return {number} Field of view along the y axis
+ */
+GCamera.prototype.getFovy = function()
+{
+    return this.fovy;
 };
 
 /**
@@ -100,7 +119,11 @@ GCamera.prototype.setFovy = function( fovy )
  */
 GCamera.prototype.setAspect = function( aspect )
 {
-    this.aspect = aspect;
+    if ( aspect !== this.aspect )
+    {
+        this.aspect = aspect;
+        this.isDirty = true;
+    }
 };
 
 /**
@@ -112,6 +135,7 @@ GCamera.prototype.setAspect = function( aspect )
 GCamera.prototype.setEye = function ( x, y, z )
 {
     this.eye[0] = x; this.eye[1] = y; this.eye[2] = z;
+    this.isDirty = true;
 };
 
 /**
@@ -134,6 +158,7 @@ GCamera.prototype.getEye = function ( outA )
 GCamera.prototype.setUp = function ( x, y, z )
 {
     this.up[0] = x; this.up[1] = y; this.up[2] = z;
+    this.isDirty = true;
 };
 
 /**
@@ -156,6 +181,7 @@ GCamera.prototype.getUp = function ( outA )
 GCamera.prototype.setLookAt = function ( x, y, z )
 {
     this.lookAt[0] = x; this.lookAt[1] = y; this.lookAt[2] = z;
+    this.isDirty = true;
 };
 
 /**
@@ -170,10 +196,17 @@ GCamera.prototype.getLookAt = function ( outA )
 };
 
 /**
- * Calculate the matrices for the current update cycle
+ * Calculate the matrices for the current update cycle, nothing is done if 
+ * the camera didn't change since the last call
  */
 GCamera.prototype.updateMatrices = function()
 {
+    if ( !this.isDirty )
+    {
+        return;
+    }
+    
+    this.isDirty = false;
     this.inverseProjectionReady = false;
     mat4.lookAt(this.mvMatrix, this.eye, this.lookAt, this.up);
     mat4.perspective(this.pMatrix, this.fovy, this.aspect, 0.1, 100.0);
@@ -197,3 +230,28 @@ GCamera.prototype.inverseProject = function( vector )
     vec4.transformMat4( vector, vector, this.inverseProjectionMatrix );
 };
 
+/**
+ * Get the world space ray going through a point of the screen
+ * @param {number} x Horizontal position in normalized device coordinates
+ * @param {number} y Vertical position in normalized device coordinates
+ * @param {Float32Array} outOrigin Receives the point of the ray on the near plane
+ * @param {Float32Array} outDirection Receives the normalized direction of the ray
+ */
+GCamera.prototype.getRay = function( x, y, outOrigin, outDirection )
+{
+    var p = this.rayPoint;
+    
+    this.updateMatrices();
+    
+    vec4.set( p, x, y, -1, 1 );
+    this.inverseProject( p );
+    vec3.set( outOrigin, p[0]/p[3], p[1]/p[3], p[2]/p[3] );
+    
+    vec4.set( p, x, y, 1, 1 );
+    this.inverseProject( p );
+    vec3.set( outDirection, p[0]/p[3] - outOrigin[0], 
+                            p[1]/p[3] - outOrigin[1], 
+                            p[2]/p[3] - outOrigin[2] );
+    vec3.normalize( outDirection, outDirection );
+};
+
@@ -72,6 +72,9 @@ function GContext( canvas )
 	this.screenIndxBuffer = undefined;
 	this.currentProgram   = undefined;
 	this.mouseObservers = [];
+	this.jobScheduler = new GJobScheduler();
+	this.rayOrigin = vec3.create();
+	this.rayDirection = vec3.create();
 	
 	var whiteTexture = new GTexture(["white.jpg"], "assets/2d/");
 	var randomTexture = new GTexture(["noise_1024.png"], "assets/2d/");
@@ -85,6 +88,9 @@ function GContext( canvas )
         this.gl = canvas.getContext("experimental-webgl", { antialias: true } );
     }
     
+    // everything is drawn through the state cache, so it sees every change
+    this.gl = new GStateCache( this.gl );
+    
     var _this = this;
     canvas.onmousedown = function(ev) {_this.handleMouseDown(ev);};
     document.onmouseup = function(ev) {_this.handleMouseUp(ev);};
@@ -107,6 +113,7 @@ function GContext( canvas )
     
     this.renderStrategy = this.renderStrategyFactory.creteBestFit();
     
+    gl.jobScheduler = this.jobScheduler;
     
     whiteTexture.bindToContext(gl);
     randomTexture.bindToContext(gl);
@@ -294,27 +301,41 @@ GContext.prototype.handleMouseMove = function(ev)
 };
 
 /**
+ * Cast a ray from the camera of the scene through the pointer location
  * @param {PointingEvent} pev
- * @return {number}
+ * @return {GRayHit|undefined} Closest hit, undefined if nothing was hit
+ */
+GContext.prototype.pickScene = function ( pev )
+{
+    var x = 2*pev.getX() - 1;
+    var y = 1 - 2*pev.getY();
+    
+    this.scene.getCamera().getRay( x, y, this.rayOrigin, this.rayDirection );
+    
+    return this.scene.intersectRay( this.rayOrigin, this.rayDirection );
+};
+
+/**
+ * @param {PointingEvent} pev
+ * @return {number} Object id of the closest object under the pointer, -1 if there is none
  */
 GContext.prototype.getSceneObjectIdAt = function ( pev )
 {
-    var x = Math.round(1024*pev.getX());
-    var y = 1024-Math.round(1024*pev.getY());
+    var hit = this.pickScene( pev );
     
-    return this.renderStrategy.getObjectIdAt( x, y );
+    return ( undefined !== hit ) ? hit.objId : -1;
 };
 
 /**
  * @param {PointingEvent} pev
- * @return {Float32Array}
+ * @return {Float32Array} World position of the closest object under the pointer, the
+ *         point under the pointer on the near plane if there is none
  */
 GContext.prototype.getScene3dPossAt = function ( pev )
 {
-    var x = Math.round(1024*pev.getX());
-    var y = 1024-Math.round(1024*pev.getY());
-
-    return this.renderStrategy.ge3dPositionAt( x, y );
+    var hit = this.pickScene( pev );
+    
+    return vec3.clone( ( undefined !== hit ) ? hit.point : this.rayOrigin );
 };
 
 /**
@@ -365,6 +386,82 @@ GContext.prototype.getHud = function ()
     return this.hud;
 };
 
+/**
+ * Upload the vertex attributes of the meshes quantized and decode them in 
+ * the scene shaders.  Positions become shorts inside the bounds of their 
+ * mesh, normals octahedron encoded shorts, texture coordinates shorts and the
+ * skin bytes, less than half of the memory and fetch bandwidth of floats.
+ * Has to be called before the scene and the render strategies are bound.
+ */
+GContext.prototype.enableQuantizedAttributes = function ()
+{
+    this.gl.quantizedAttributes = true;
+};
+
+/**
+ * Set the pool of workers that loaders can use to decode assets
+ * @param {GDecodeWorkerPool|undefined} pool
+ */
+GContext.prototype.setDecodePool = function ( pool )
+{
+    this.decodePool = pool;
+};
+
+/**
+ * @return {GDecodeWorkerPool|undefined}
+ */
+GContext.prototype.getDecodePool = function ()
+{
+    return this.decodePool;
+};
+
+/**
+ * Returns true if meshes can be drawn with 32 bit indices
+ * @return {boolean}
+ */
+GContext.prototype.isUintIndexSupported = function ()
+{
+    return Mesh.isUintIndexSupported( this.gl );
+};
+
+/**
+ * Get the counters of the texture cache shared by the materials of this 
+ * context, see GTextureCache.getStats
+ * @return {Object}
+ */
+GContext.prototype.getTextureCacheStats = function ()
+{
+    return GTextureCache.get( this.gl ).getStats();
+};
+
+/**
+ * Get the scheduler that runs the loading work of this context inside of
+ * the frame budget
+ * @return {GJobScheduler}
+ */
+GContext.prototype.getJobScheduler = function ()
+{
+    return this.jobScheduler;
+};
+
+/**
+ * Set how many milliseconds of each frame can be spent on loading work
+ * @param {number} budget
+ */
+GContext.prototype.setFrameBudget = function ( budget )
+{
+    this.jobScheduler.setFrameBudget( budget );
+};
+
+/**
+ * Run the pending loading work, has to be called once per frame
+ * @param {number} elapsed Milliseconds since the last frame
+ */
+GContext.prototype.update = function ( elapsed )
+{
+    this.jobScheduler.update( elapsed );
+};
+
 /**
  * Draw the current context with it's scene and HUD elements
  */
@@ -374,8 +471,19 @@ GContext.prototype.draw = function()
     var y = this.dom.window.innerHeight || this.dom.element.clientHeight || this.dom.body.clientHeight;
     
     this.scene.getCamera().setAspect( x/y );
+    this.scene.prepareDraw();
     
     this.renderStrategy.draw(this.scene, this.hud);
+    this.gl.endFrame();
+};
+
+/**
+ * Get the GL call counters of the last frame, see GStateCache.getStats
+ * @return {Object}
+ */
+GContext.prototype.getGlStats = function ()
+{
+    return this.gl.getStats();
 };
 
 /**
@@ -0,0 +1,154 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * The six planes of a camera frustum in world space.  Bounds are tested with
+ * the cached world matrices of the scene, so the same matrices serve the 
+ * scene camera and the cameras of the shadow passes.
+ * @constructor
+ */
+function GFrustum()
+{
+    // a, b, c, d of each plane with the normal pointing inside
+    this.planes = new Float32Array( 24 );
+    this.center = vec3.create();
+}
+
+GFrustum.OUTSIDE = 0;
+GFrustum.INTERSECTS = 1;
+GFrustum.INSIDE = 2;
+
+/**
+ * Extract the planes from a projection matrix, they end up in the space the
+ * matrix transforms from.  World space for a view projection matrix.
+ * @param {Float32Array} p 4 by 4 projection matrix
+ */
+GFrustum.prototype.setFromProjection = function( p )
+{
+    var planes = this.planes;
+    
+    // left, right, bottom, top, near, far: the 4th row plus or minus
+    // one of the other rows
+    for ( var i = 0; i < 6; ++i )
+    {
+        var row = i >> 1;
+        var sign = ( i & 1 ) ? -1 : 1;
+        
+        var a = p[3]  + sign * p[row];
+        var b = p[7]  + sign * p[4 + row];
+        var c = p[11] + sign * p[8 + row];
+        var d = p[15] + sign * p[12 + row];
+        var length = Math.sqrt( a*a + b*b + c*c );
+        
+        planes[4*i]     = a / length;
+        planes[4*i + 1] = b / length;
+        planes[4*i + 2] = c / length;
+        planes[4*i + 3] = d / length;
+    }
+};
+
+/**
+ * Classify a sphere against the frustum
+ * @param {Float32Array} c Center of the sphere in the space of the planes
+ * @param {number} radius
+ * @return {number} GFrustum.OUTSIDE, INTERSECTS or INSIDE
+ */
+GFrustum.prototype.classifySphere = function( c, radius )
+{
+    var planes = this.planes;
+    var result = GFrustum.INSIDE;
+    
+    for ( var i = 0; i < 24; i += 4 )
+    {
+        var distance = planes[i]*c[0] + planes[i+1]*c[1] + planes[i+2]*c[2] + planes[i+3];
+        
+        if ( distance < -radius )
+        {
+            return GFrustum.OUTSIDE;
+        }
+        
+        if ( distance < radius )
+        {
+            result = GFrustum.INTERSECTS;
+        }
+    }
+    
+    return result;
+};
+
+/**
+ * Classify bounds against the frustum
+ * @param {GBounds} bounds Bounds in the space of the model
+ * @param {Float32Array} mvMat Matrix from the space of the model to the 
+ *        space of the planes
+ * @return {number} GFrustum.OUTSIDE, INTERSECTS or INSIDE
+ */
+GFrustum.prototype.classify = function( bounds, mvMat )
+{
+    if ( bounds.isInfinite() )
+    {
+        return GFrustum.INTERSECTS;
+    }
+    
+    if ( bounds.isEmpty() )
+    {
+        return GFrustum.OUTSIDE;
+    }
+    
+    var planes = this.planes;
+    var m = mvMat;
+    var c = this.center;
+    vec3.transformMat4( c, bounds.center, m );
+    
+    // the largest axis scale of the matrix scales the radius
+    var scale = Math.sqrt( Math.max( m[0]*m[0] + m[1]*m[1] + m[2]*m[2],
+                                     m[4]*m[4] + m[5]*m[5] + m[6]*m[6],
+                                     m[8]*m[8] + m[9]*m[9] + m[10]*m[10] ) );
+    var result = this.classifySphere( c, bounds.radius * scale );
+    
+    if ( GFrustum.INTERSECTS !== result )
+    {
+        return result;
+    }
+    
+    // the sphere touches a plane, the box can still be completely outside
+    // of it.  The box is projected on the plane normal through the matrix.
+    var ex = ( bounds.max[0] - bounds.min[0] ) / 2;
+    var ey = ( bounds.max[1] - bounds.min[1] ) / 2;
+    var ez = ( bounds.max[2] - bounds.min[2] ) / 2;
+    
+    for ( var i = 0; i < 24; i += 4 )
+    {
+        var a = planes[i];
+        var b = planes[i+1];
+        var d = planes[i+2];
+        
+        var extent = ex * Math.abs( a*m[0] + b*m[1] + d*m[2] ) +
+                     ey * Math.abs( a*m[4] + b*m[5] + d*m[6] ) +
+                     ez * Math.abs( a*m[8] + b*m[9] + d*m[10] );
+        
+        if ( a*c[0] + b*c[1] + d*c[2] + planes[i+3] < -extent )
+        {
+            return GFrustum.OUTSIDE;
+        }
+    }
+    
+    return result;
+};
@@ -0,0 +1,238 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * A piece of loading work that can be resumed across frames
+ * @interface
+ */
+function GJob () {}
+
+/**
+ * Do the next small unit of work, it should take well under a millisecond
+ * @return {number} GJobScheduler.STEP_WORKED, STEP_WAITING if there is
+ *         nothing to do until something outside the job happens (a download)
+ *         or STEP_DONE once the job is complete
+ */
+GJob.prototype.step = function () {};
+
+/**
+ * @return {number} One of the GJobScheduler.PRIORITY_* values, it can change
+ *         as the job moves between phases
+ */
+GJob.prototype.getPriority = function () {};
+
+/**
+ * @return {number} Progress of the job between 0 and 1
+ */
+GJob.prototype.getProgress = function () {};
+
+/**
+ * Runs the loading jobs of a context within a per frame time budget.  The 
+ * budget shrinks when the frames take longer than the target frame time and
+ * grows back up to the configured budget when they don't.  Jobs with a lower
+ * priority value run first, jobs of the same priority take turns so loads
+ * that run at the same time progress together.
+ * @constructor
+ */
+function GJobScheduler()
+{
+    this.jobs = [];
+    this.frameBudget = GJobScheduler.DEFAULT_FRAME_BUDGET;
+    this.targetFrameTime = GJobScheduler.DEFAULT_TARGET_FRAME_TIME;
+    this.availableTime = this.frameBudget;
+    this.turn = 0;
+    this.doneWeight = 0;
+    this.totalWeight = 0;
+}
+
+GJobScheduler.STEP_DONE = 0;
+GJobScheduler.STEP_WORKED = 1;
+GJobScheduler.STEP_WAITING = 2;
+
+GJobScheduler.PRIORITY_UPLOAD = 0;
+GJobScheduler.PRIORITY_MERGE = 1;
+GJobScheduler.PRIORITY_PARSE = 2;
+GJobScheduler.PRIORITY_TEXTURE = 3;
+GJobScheduler.PRIORITY_PICKING = 4;
+
+GJobScheduler.DEFAULT_FRAME_BUDGET = 12;
+GJobScheduler.DEFAULT_TARGET_FRAME_TIME = 17;
+GJobScheduler.MIN_FRAME_BUDGET = 2;
+
+/**
+ * @return {number} Current time in milliseconds
+ */
+GJobScheduler.now = function ()
+{
+    return ( typeof performance !== "undefined" ) ? performance.now() : new Date().getTime();
+};
+
+/**
+ * Set the most time the jobs can take in one frame
+ * @param {number} ms
+ */
+GJobScheduler.prototype.setFrameBudget = function ( ms )
+{
+    this.frameBudget = ms;
+    this.availableTime = Math.min( this.availableTime, ms );
+};
+
+/**
+ * Set the frame time the budget adapts to
+ * @param {number} ms
+ */
+GJobScheduler.prototype.setTargetFrameTime = function ( ms )
+{
+    this.targetFrameTime = ms;
+};
+
+/**
+ * Queue a job
+ * @param {GJob} job
+ * @param {number=} weight Share of the job in the overall progress, defaults
+ *                  to 1
+ */
+GJobScheduler.prototype.addJob = function ( job, weight )
+{
+    var w = ( undefined === weight ) ? 1 : weight;
+    
+    this.jobs.push( { job: job, weight: w, lastTurn: -1 } );
+    this.totalWeight += w;
+};
+
+/**
+ * @return {boolean} True if there are jobs left
+ */
+GJobScheduler.prototype.isBusy = function ()
+{
+    return this.jobs.length > 0;
+};
+
+/**
+ * Progress of the jobs queued since the scheduler was last idle
+ * @return {number} Between 0 and 1
+ */
+GJobScheduler.prototype.getProgress = function ()
+{
+    if ( 0 === this.totalWeight )
+    {
+        return 1;
+    }
+    
+    var progress = this.doneWeight;
+    
+    for ( var i = 0; i < this.jobs.length; ++i )
+    {
+        progress += this.jobs[i].weight * Math.min( 1, Math.max( 0, this.jobs[i].job.getProgress() ) );
+    }
+    
+    return progress / this.totalWeight;
+};
+
+/**
+ * @return {number} Milliseconds the jobs can use in the next frame
+ */
+GJobScheduler.prototype.getAvailableTime = function ()
+{
+    return this.availableTime;
+};
+
+/**
+ * Run the jobs for one frame
+ * @param {number} elapsed Milliseconds since the last frame
+ */
+GJobScheduler.prototype.update = function ( elapsed )
+{
+    if ( elapsed > this.targetFrameTime )
+    {
+        this.availableTime = Math.max( GJobScheduler.MIN_FRAME_BUDGET, this.availableTime * 0.75 );
+    }
+    else
+    {
+        this.availableTime = Math.min( this.frameBudget, this.availableTime + 1 );
+    }
+    
+    var start = GJobScheduler.now();
+    var waiting = [];
+    
+    while ( GJobScheduler.now() - start < this.availableTime )
+    {
+        var entry = this.nextEntry( waiting );
+        
+        if ( undefined === entry )
+        {
+            // everything left is waiting on something outside the frame
+            break;
+        }
+        
+        entry.lastTurn = this.turn++;
+        
+        var result = entry.job.step();
+        
+        if ( GJobScheduler.STEP_DONE === result )
+        {
+            this.jobs.splice( this.jobs.indexOf( entry ), 1 );
+            this.doneWeight += entry.weight;
+        }
+        else if ( GJobScheduler.STEP_WAITING === result )
+        {
+            waiting.push( entry );
+        }
+    }
+    
+    if ( 0 === this.jobs.length )
+    {
+        this.doneWeight = 0;
+        this.totalWeight = 0;
+    }
+};
+
+/**
+ * Pick the job to step next, the one with the lowest priority value that
+ * waited the longest
+ * @param {Array.<Object>} waiting Entries that can't progress in this frame
+ * @return {Object|undefined}
+ */
+GJobScheduler.prototype.nextEntry = function ( waiting )
+{
+    var best = undefined;
+    var bestPriority = 0;
+    
+    for ( var i = 0; i < this.jobs.length; ++i )
+    {
+        var entry = this.jobs[i];
+        
+        if ( waiting.indexOf( entry ) !== -1 )
+        {
+            continue;
+        }
+        
+        var priority = entry.job.getPriority();
+        
+        if ( undefined === best || priority < bestPriority ||
+             ( priority === bestPriority && entry.lastTurn < best.lastTurn ) )
+        {
+            best = entry;
+            bestPriority = priority;
+        }
+    }
+    
+    return best;
+};
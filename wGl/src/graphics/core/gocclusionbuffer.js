@@ -0,0 +1,493 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Low resolution depth buffer the occluders of a scene are rasterized into
+ * on the CPU, and the hierarchy of its farthest depths the bounds of the
+ * other objects are tested against.  An object whose bounds are behind the
+ * farthest occluder depth everywhere they cover on screen is hidden and 
+ * doesn't need to be drawn.  The depths are the normalized device 
+ * coordinates of the view projection matrix, so the same buffer serves the
+ * scene camera and the cameras of the shadow passes.
+ * @constructor
+ * @param {number=} width Width of the buffer in pixels
+ * @param {number=} height Height of the buffer in pixels
+ */
+function GOcclusionBuffer( width, height )
+{
+    this.width = width || GOcclusionBuffer.WIDTH;
+    this.height = height || GOcclusionBuffer.HEIGHT;
+    this.viewProjection = mat4.create();
+    this.modelViewProjection = mat4.create();
+    
+    // level 0 is the depth buffer itself, every level after it holds the
+    // farthest depth of 2 by 2 pixels of the one before
+    this.levels = [];
+    this.levelWidths = [];
+    this.levelHeights = [];
+    
+    var w = this.width;
+    var h = this.height;
+    
+    for ( ;; )
+    {
+        this.levels.push( new Float32Array( w * h ) );
+        this.levelWidths.push( w );
+        this.levelHeights.push( h );
+        
+        if ( 1 === w && 1 === h )
+        {
+            break;
+        }
+        
+        w = ( w + 1 ) >> 1;
+        h = ( h + 1 ) >> 1;
+    }
+    
+    this.depth = this.levels[0];
+    
+    // clip space vertices of the mesh being rasterized and the polygon left
+    // after clipping a triangle against the near plane
+    this.clipVerts = new Float32Array( 0 );
+    this.polygon = new Float32Array( 16 );
+    this.clippedPolygon = new Float32Array( 20 );
+    
+    this.triangleCount = 0;
+    this.testCount = 0;
+    this.occludedCount = 0;
+    
+    this.clear();
+}
+
+/**
+ * Default size of the buffer, the depth of the occluders is only needed at
+ * the size objects are culled at
+ */
+GOcclusionBuffer.WIDTH = 256;
+GOcclusionBuffer.HEIGHT = 128;
+
+/**
+ * Reset the depth to the far plane and set the view projection matrix the 
+ * occluders and the tested bounds go through
+ * @param {Float32Array} viewProjection
+ */
+GOcclusionBuffer.prototype.begin = function( viewProjection )
+{
+    mat4.copy( this.viewProjection, viewProjection );
+    this.clear();
+};
+
+/**
+ * Check if the buffer was started with the provided matrix
+ * @param {Float32Array} viewProjection
+ * @return {boolean}
+ */
+GOcclusionBuffer.prototype.isBuiltFor = function( viewProjection )
+{
+    for ( var i = 0; i < 16; ++i )
+    {
+        if ( this.viewProjection[i] !== viewProjection[i] )
+        {
+            return false;
+        }
+    }
+    
+    return true;
+};
+
+/**
+ * Reset the depth to the far plane
+ */
+GOcclusionBuffer.prototype.clear = function()
+{
+    var depth = this.depth;
+    var count = depth.length;
+    
+    for ( var i = 0; i < count; ++i )
+    {
+        depth[i] = 1;
+    }
+    
+    this.triangleCount = 0;
+    this.testCount = 0;
+    this.occludedCount = 0;
+};
+
+/**
+ * Rasterize the triangles of an occluder
+ * @param {Array.<number>|Float32Array} verts Positions, 3 values per vertex
+ * @param {Array.<number>|Uint16Array|Uint32Array} indices 3 per triangle
+ * @param {Float32Array} worldMatrix World matrix of the occluder
+ */
+GOcclusionBuffer.prototype.rasterizeMesh = function( verts, indices, worldMatrix )
+{
+    var m = this.modelViewProjection;
+    mat4.multiply( m, this.viewProjection, worldMatrix );
+    
+    var vertCount = verts.length / 3;
+    
+    if ( this.clipVerts.length < 4 * vertCount )
+    {
+        this.clipVerts = new Float32Array( 4 * vertCount );
+    }
+    
+    var clip = this.clipVerts;
+    var i = 0;
+    
+    for ( i = 0; i < vertCount; ++i )
+    {
+        var x = verts[3*i];
+        var y = verts[3*i+1];
+        var z = verts[3*i+2];
+        
+        clip[4*i]   = m[0]*x + m[4]*y + m[8]*z  + m[12];
+        clip[4*i+1] = m[1]*x + m[5]*y + m[9]*z  + m[13];
+        clip[4*i+2] = m[2]*x + m[6]*y + m[10]*z + m[14];
+        clip[4*i+3] = m[3]*x + m[7]*y + m[11]*z + m[15];
+    }
+    
+    var polygon = this.polygon;
+    
+    for ( i = 0; i + 2 < indices.length; i += 3 )
+    {
+        var a = 4 * indices[i];
+        var b = 4 * indices[i+1];
+        var c = 4 * indices[i+2];
+        
+        var wa = clip[a+3];
+        var wb = clip[b+3];
+        var wc = clip[c+3];
+        
+        // completely on the outer side of one of the side planes
+        if ( ( clip[a]   >  wa && clip[b]   >  wb && clip[c]   >  wc ) ||
+             ( clip[a]   < -wa && clip[b]   < -wb && clip[c]   < -wc ) ||
+             ( clip[a+1] >  wa && clip[b+1] >  wb && clip[c+1] >  wc ) ||
+             ( clip[a+1] < -wa && clip[b+1] < -wb && clip[c+1] < -wc ) )
+        {
+            continue;
+        }
+        
+        var da = clip[a+2] + wa;
+        var db = clip[b+2] + wb;
+        var dc = clip[c+2] + wc;
+        
+        if ( da < 0 && db < 0 && dc < 0 )
+        {
+            continue;
+        }
+        
+        for ( var k = 0; k < 4; ++k )
+        {
+            polygon[k]   = clip[a+k];
+            polygon[4+k] = clip[b+k];
+            polygon[8+k] = clip[c+k];
+        }
+        
+        if ( da >= 0 && db >= 0 && dc >= 0 )
+        {
+            this.rasterizeTriangle( polygon, 0, 4, 8 );
+        }
+        else
+        {
+            this.rasterizeClipped( polygon );
+        }
+    }
+};
+
+/**
+ * Clip a triangle crossing the near plane, z = -w, and rasterize what is in
+ * front of it.  One or two of the corners are cut off so up to four 
+ * vertices are left.
+ * @param {Float32Array} triangle Clip space vertices, 4 values each
+ */
+GOcclusionBuffer.prototype.rasterizeClipped = function( triangle )
+{
+    var out = this.clippedPolygon;
+    var count = 0;
+    
+    for ( var i = 0; i < 3; ++i )
+    {
+        var p = 4 * i;
+        var q = 4 * ( ( i + 1 ) % 3 );
+        var dp = triangle[p+2] + triangle[p+3];
+        var dq = triangle[q+2] + triangle[q+3];
+        var k = 0;
+        
+        if ( dp >= 0 )
+        {
+            for ( k = 0; k < 4; ++k )
+            {
+                out[4*count+k] = triangle[p+k];
+            }
+            
+            ++count;
+        }
+        
+        if ( ( dp >= 0 ) !== ( dq >= 0 ) )
+        {
+            var t = dp / ( dp - dq );
+            
+            for ( k = 0; k < 4; ++k )
+            {
+                out[4*count+k] = triangle[p+k] + t * ( triangle[q+k] - triangle[p+k] );
+            }
+            
+            ++count;
+        }
+    }
+    
+    for ( var j = 2; j < count; ++j )
+    {
+        this.rasterizeTriangle( out, 0, 4 * ( j - 1 ), 4 * j );
+    }
+};
+
+/**
+ * Rasterize a triangle that is in front of the near plane, every pixel whose
+ * center it covers keeps the nearest depth
+ * @param {Float32Array} v Clip space vertices, 4 values each
+ * @param {number} a Offset of the first vertex in v
+ * @param {number} b Offset of the second vertex in v
+ * @param {number} c Offset of the third vertex in v
+ */
+GOcclusionBuffer.prototype.rasterizeTriangle = function( v, a, b, c )
+{
+    var width = this.width;
+    var height = this.height;
+    var depth = this.depth;
+    
+    // to pixels, y grows up like in normalized device coordinates
+    var x0 = ( v[a]   / v[a+3] * 0.5 + 0.5 ) * width;
+    var y0 = ( v[a+1] / v[a+3] * 0.5 + 0.5 ) * height;
+    var z0 =   v[a+2] / v[a+3];
+    var x1 = ( v[b]   / v[b+3] * 0.5 + 0.5 ) * width;
+    var y1 = ( v[b+1] / v[b+3] * 0.5 + 0.5 ) * height;
+    var z1 =   v[b+2] / v[b+3];
+    var x2 = ( v[c]   / v[c+3] * 0.5 + 0.5 ) * width;
+    var y2 = ( v[c+1] / v[c+3] * 0.5 + 0.5 ) * height;
+    var z2 =   v[c+2] / v[c+3];
+    
+    var area = ( x1 - x0 ) * ( y2 - y0 ) - ( x2 - x0 ) * ( y1 - y0 );
+    
+    if ( 0 === area || area !== area )
+    {
+        return;
+    }
+    
+    // both windings occlude, the edges are walked counter clockwise
+    if ( area < 0 )
+    {
+        var t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+        t = z1; z1 = z2; z2 = t;
+        area = -area;
+    }
+    
+    var minX = Math.max( 0, Math.floor( Math.min( x0, x1, x2 ) ) );
+    var maxX = Math.min( width - 1, Math.ceil( Math.max( x0, x1, x2 ) ) );
+    var minY = Math.max( 0, Math.floor( Math.min( y0, y1, y2 ) ) );
+    var maxY = Math.min( height - 1, Math.ceil( Math.max( y0, y1, y2 ) ) );
+    
+    if ( minX > maxX || minY > maxY )
+    {
+        return;
+    }
+    
+    this.triangleCount += 1;
+    
+    // depth is linear in screen space after the perspective divide
+    var dzdx = ( ( z1 - z0 ) * ( y2 - y0 ) - ( z2 - z0 ) * ( y1 - y0 ) ) / area;
+    var dzdy = ( ( z2 - z0 ) * ( x1 - x0 ) - ( z1 - z0 ) * ( x2 - x0 ) ) / area;
+    
+    // edge functions at the center of the first pixel, positive inside
+    var px = minX + 0.5;
+    var py = minY + 0.5;
+    var e0Row = ( x2 - x1 ) * ( py - y1 ) - ( y2 - y1 ) * ( px - x1 );
+    var e1Row = ( x0 - x2 ) * ( py - y2 ) - ( y0 - y2 ) * ( px - x2 );
+    var e2Row = ( x1 - x0 ) * ( py - y0 ) - ( y1 - y0 ) * ( px - x0 );
+    var zRow = z0 + dzdx * ( px - x0 ) + dzdy * ( py - y0 );
+    
+    var e0dx = y1 - y2;
+    var e1dx = y2 - y0;
+    var e2dx = y0 - y1;
+    var e0dy = x2 - x1;
+    var e1dy = x0 - x2;
+    var e2dy = x1 - x0;
+    
+    for ( var y = minY; y <= maxY; ++y )
+    {
+        var e0 = e0Row;
+        var e1 = e1Row;
+        var e2 = e2Row;
+        var z = zRow;
+        var index = y * width + minX;
+        
+        for ( var x = minX; x <= maxX; ++x )
+        {
+            if ( e0 >= 0 && e1 >= 0 && e2 >= 0 && z < depth[index] )
+            {
+                depth[index] = z;
+            }
+            
+            e0 += e0dx;
+            e1 += e1dx;
+            e2 += e2dx;
+            z += dzdx;
+            ++index;
+        }
+        
+        e0Row += e0dy;
+        e1Row += e1dy;
+        e2Row += e2dy;
+        zRow += dzdy;
+    }
+};
+
+/**
+ * Build the hierarchy of farthest depths once every occluder is rasterized
+ */
+GOcclusionBuffer.prototype.end = function()
+{
+    for ( var l = 1; l < this.levels.length; ++l )
+    {
+        var src = this.levels[l-1];
+        var srcWidth = this.levelWidths[l-1];
+        var srcHeight = this.levelHeights[l-1];
+        var dst = this.levels[l];
+        var width = this.levelWidths[l];
+        var height = this.levelHeights[l];
+        
+        for ( var y = 0; y < height; ++y )
+        {
+            // an odd row or column at the edge is covered by one pixel
+            var row0 = 2 * y * srcWidth;
+            var row1 = Math.min( 2 * y + 1, srcHeight - 1 ) * srcWidth;
+            
+            for ( var x = 0; x < width; ++x )
+            {
+                var x0 = 2 * x;
+                var x1 = Math.min( 2 * x + 1, srcWidth - 1 );
+                
+                dst[y * width + x] = Math.max( src[row0 + x0], src[row0 + x1],
+                                               src[row1 + x0], src[row1 + x1] );
+            }
+        }
+    }
+};
+
+/**
+ * Test bounds against the occluders.  The screen rectangle of the box is 
+ * checked at the level of the hierarchy where it covers at most 2 by 2 
+ * pixels, with the nearest depth of its corners.
+ * @param {GBounds} bounds Bounds in the space of the model
+ * @param {Float32Array} worldMatrix World matrix of the model
+ * @return {boolean} False if the bounds are hidden behind the occluders
+ */
+GOcclusionBuffer.prototype.isVisible = function( bounds, worldMatrix )
+{
+    if ( bounds.isInfinite() || bounds.isEmpty() )
+    {
+        return true;
+    }
+    
+    this.testCount += 1;
+    
+    var m = this.modelViewProjection;
+    mat4.multiply( m, this.viewProjection, worldMatrix );
+    
+    var minX = Infinity;
+    var maxX = -Infinity;
+    var minY = Infinity;
+    var maxY = -Infinity;
+    var minZ = Infinity;
+    
+    for ( var i = 0; i < 8; ++i )
+    {
+        var x = ( i & 1 ) ? bounds.max[0] : bounds.min[0];
+        var y = ( i & 2 ) ? bounds.max[1] : bounds.min[1];
+        var z = ( i & 4 ) ? bounds.max[2] : bounds.min[2];
+        
+        var cx = m[0]*x + m[4]*y + m[8]*z  + m[12];
+        var cy = m[1]*x + m[5]*y + m[9]*z  + m[13];
+        var cz = m[2]*x + m[6]*y + m[10]*z + m[14];
+        var cw = m[3]*x + m[7]*y + m[11]*z + m[15];
+        
+        // the box reaches the near plane, it can't be behind anything
+        if ( cz < -cw || cw <= 0 )
+        {
+            return true;
+        }
+        
+        var sx = ( cx / cw * 0.5 + 0.5 ) * this.width;
+        var sy = ( cy / cw * 0.5 + 0.5 ) * this.height;
+        
+        minX = Math.min( minX, sx );
+        maxX = Math.max( maxX, sx );
+        minY = Math.min( minY, sy );
+        maxY = Math.max( maxY, sy );
+        minZ = Math.min( minZ, cz / cw );
+    }
+    
+    var x0 = Math.max( 0, Math.floor( minX ) );
+    var x1 = Math.min( this.width - 1, Math.floor( maxX ) );
+    var y0 = Math.max( 0, Math.floor( minY ) );
+    var y1 = Math.min( this.height - 1, Math.floor( maxY ) );
+    
+    // off screen, that is up to the frustum
+    if ( x0 > x1 || y0 > y1 )
+    {
+        return true;
+    }
+    
+    var level = 0;
+    
+    while ( ( ( x1 >> level ) - ( x0 >> level ) ) > 1 || ( ( y1 >> level ) - ( y0 >> level ) ) > 1 )
+    {
+        ++level;
+    }
+    
+    var depth = this.levels[level];
+    var width = this.levelWidths[level];
+    
+    for ( var ty = y0 >> level; ty <= y1 >> level; ++ty )
+    {
+        for ( var tx = x0 >> level; tx <= x1 >> level; ++tx )
+        {
+            if ( minZ <= depth[ty * width + tx] )
+            {
+                return true;
+            }
+        }
+    }
+    
+    this.occludedCount += 1;
+    
+    return false;
+};
+
+/**
+ * Get the counters since the last begin
+ * @return {Object} triangles (rasterized occluder triangles), tested and 
+ *         occluded bounds
+ */
+GOcclusionBuffer.prototype.getStats = function()
+{
+    return { triangles: this.triangleCount, tested: this.testCount, occluded: this.occludedCount };
+};
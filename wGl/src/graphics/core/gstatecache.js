@@ -0,0 +1,607 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Stands in for the WebGLRenderingContext of a GContext and drops the calls
+ * that wouldn't change the state of the context: binding the bound program,
+ * buffer, texture or framebuffer again, enabling what is enabled, setting the
+ * same viewport or blend function and uploading a uniform value the location
+ * already holds.  The other calls, constants and properties are forwarded to
+ * the context unchanged, so the rest of the engine uses it like the context.
+ * Everything has to go through the same cache for the tracked state to match
+ * the context, vertex array objects included: they are created and bound 
+ * with the methods of the cache, whether they come from WebGL2 or from 
+ * OES_vertex_array_object.  Instanced draws go through the cache the same
+ * way, from WebGL2 or from ANGLE_instanced_arrays.
+ * @constructor
+ * @param {WebGLRenderingContext} gl Context to forward the calls to
+ */
+function GStateCache( gl )
+{
+    this.context = gl;
+    
+    this.program = null;
+    this.arrayBuffer = null;
+    this.framebuffer = null;
+    this.renderbuffer = null;
+    this.activeUnit = gl.TEXTURE0;
+    this.textures2d = {};
+    this.texturesCube = {};
+    this.capabilities = {};
+    this.viewportRect = [ -1, -1, -1, -1 ];
+    this.blendFactors = [ -1, -1 ];
+    this.scratch = new Float32Array( 16 );
+    
+    // the element buffer and enabled arrays belong to the bound vertex array
+    this.defaultArrayState = new GStateCache.ArrayState();
+    this.arrayState = this.defaultArrayState;
+    this.vertexArray = null;
+    this.vertexArrayExt = null;
+    this.vertexArraySupported = undefined;
+    this.instancingExt = null;
+    this.instancingSupported = undefined;
+    
+    this.issued = 0;
+    this.elided = 0;
+    this.stats = { issued: 0, elided: 0 };
+    
+    for ( var key in gl )
+    {
+        if ( key in GStateCache.prototype )
+        {
+            continue;
+        }
+        
+        if ( 'function' === typeof gl[key] )
+        {
+            this[key] = GStateCache.forward( this, gl, gl[key] );
+        }
+        else if ( key.toUpperCase() === key )
+        {
+            this[key] = gl[key];
+        }
+        else
+        {
+            GStateCache.forwardProperty( this, gl, key );
+        }
+    }
+}
+
+/**
+ * State stored by a vertex array object
+ * @constructor
+ */
+GStateCache.ArrayState = function()
+{
+    this.elementArrayBuffer = null;
+    this.enabledArrays = [];
+};
+
+/**
+ * Create a function that counts and forwards a call to the context
+ * @param {GStateCache} cache
+ * @param {WebGLRenderingContext} gl
+ * @param {Function} func Function of the context
+ * @return {Function}
+ */
+GStateCache.forward = function( cache, gl, func )
+{
+    return function()
+    {
+        cache.issued += 1;
+        return func.apply( gl, arguments );
+    };
+};
+
+/**
+ * Read a property like canvas or drawingBufferWidth from the context, they
+ * can change after the cache is created
+ * @param {GStateCache} cache
+ * @param {WebGLRenderingContext} gl
+ * @param {string} key
+ */
+GStateCache.forwardProperty = function( cache, gl, key )
+{
+    Object.defineProperty( cache, key, { get: function() { return gl[key]; } } );
+};
+
+/**
+ * Close the counters of the current frame, GContext calls it after drawing
+ */
+GStateCache.prototype.endFrame = function()
+{
+    this.stats.issued = this.issued;
+    this.stats.elided = this.elided;
+    this.issued = 0;
+    this.elided = 0;
+};
+
+/**
+ * Get the counters of the last frame
+ * @return {Object} issued (calls that reached the context) and elided (calls
+ *         dropped because they wouldn't change anything)
+ */
+GStateCache.prototype.getStats = function()
+{
+    return { issued: this.stats.issued, elided: this.stats.elided };
+};
+
+/**
+ * Count a call that reached the context, or one that was dropped
+ * @param {boolean} isIssued
+ * @return {boolean} isIssued
+ */
+GStateCache.prototype.count = function( isIssued )
+{
+    if ( isIssued )
+    {
+        this.issued += 1;
+    }
+    else
+    {
+        this.elided += 1;
+    }
+    
+    return isIssued;
+};
+
+GStateCache.prototype.useProgram = function( program )
+{
+    if ( this.count( program !== this.program ) )
+    {
+        this.program = program;
+        this.context.useProgram( program );
+    }
+};
+
+GStateCache.prototype.deleteProgram = function( program )
+{
+    if ( program === this.program )
+    {
+        this.program = null;
+    }
+    
+    this.count( true );
+    this.context.deleteProgram( program );
+};
+
+GStateCache.prototype.bindBuffer = function( target, buffer )
+{
+    if ( target === this.context.ELEMENT_ARRAY_BUFFER )
+    {
+        if ( this.count( buffer !== this.arrayState.elementArrayBuffer ) )
+        {
+            this.arrayState.elementArrayBuffer = buffer;
+            this.context.bindBuffer( target, buffer );
+        }
+    }
+    else if ( this.count( buffer !== this.arrayBuffer ) )
+    {
+        this.arrayBuffer = buffer;
+        this.context.bindBuffer( target, buffer );
+    }
+};
+
+GStateCache.prototype.deleteBuffer = function( buffer )
+{
+    if ( buffer === this.arrayBuffer )
+    {
+        this.arrayBuffer = null;
+    }
+    
+    if ( buffer === this.arrayState.elementArrayBuffer )
+    {
+        this.arrayState.elementArrayBuffer = null;
+    }
+    
+    this.count( true );
+    this.context.deleteBuffer( buffer );
+};
+
+GStateCache.prototype.bindFramebuffer = function( target, framebuffer )
+{
+    if ( this.count( framebuffer !== this.framebuffer ) )
+    {
+        this.framebuffer = framebuffer;
+        this.context.bindFramebuffer( target, framebuffer );
+    }
+};
+
+GStateCache.prototype.deleteFramebuffer = function( framebuffer )
+{
+    if ( framebuffer === this.framebuffer )
+    {
+        this.framebuffer = null;
+    }
+    
+    this.count( true );
+    this.context.deleteFramebuffer( framebuffer );
+};
+
+GStateCache.prototype.bindRenderbuffer = function( target, renderbuffer )
+{
+    if ( this.count( renderbuffer !== this.renderbuffer ) )
+    {
+        this.renderbuffer = renderbuffer;
+        this.context.bindRenderbuffer( target, renderbuffer );
+    }
+};
+
+GStateCache.prototype.deleteRenderbuffer = function( renderbuffer )
+{
+    if ( renderbuffer === this.renderbuffer )
+    {
+        this.renderbuffer = null;
+    }
+    
+    this.count( true );
+    this.context.deleteRenderbuffer( renderbuffer );
+};
+
+GStateCache.prototype.activeTexture = function( unit )
+{
+    if ( this.count( unit !== this.activeUnit ) )
+    {
+        this.activeUnit = unit;
+        this.context.activeTexture( unit );
+    }
+};
+
+GStateCache.prototype.bindTexture = function( target, texture )
+{
+    var bound = ( target === this.context.TEXTURE_2D ) ? this.textures2d : this.texturesCube;
+    
+    if ( this.count( texture !== bound[this.activeUnit] ) )
+    {
+        bound[this.activeUnit] = texture;
+        this.context.bindTexture( target, texture );
+    }
+};
+
+GStateCache.prototype.deleteTexture = function( texture )
+{
+    for ( var unit in this.textures2d )
+    {
+        if ( texture === this.textures2d[unit] )
+        {
+            this.textures2d[unit] = null;
+        }
+    }
+    
+    for ( var unit in this.texturesCube )
+    {
+        if ( texture === this.texturesCube[unit] )
+        {
+            this.texturesCube[unit] = null;
+        }
+    }
+    
+    this.count( true );
+    this.context.deleteTexture( texture );
+};
+
+GStateCache.prototype.enableVertexAttribArray = function( index )
+{
+    if ( this.count( true !== this.arrayState.enabledArrays[index] ) )
+    {
+        this.arrayState.enabledArrays[index] = true;
+        this.context.enableVertexAttribArray( index );
+    }
+};
+
+GStateCache.prototype.disableVertexAttribArray = function( index )
+{
+    if ( this.count( true === this.arrayState.enabledArrays[index] ) )
+    {
+        this.arrayState.enabledArrays[index] = false;
+        this.context.disableVertexAttribArray( index );
+    }
+};
+
+/**
+ * Returns true if vertex array objects can be created, either because the
+ * context is a WebGL2 one or because OES_vertex_array_object could be enabled
+ * @return {boolean}
+ */
+GStateCache.prototype.isVertexArraySupported = function()
+{
+    if ( undefined === this.vertexArraySupported )
+    {
+        var isWebGl2 = ( 'function' === typeof this.context.createVertexArray );
+        
+        this.vertexArrayExt = isWebGl2 ? null : this.context.getExtension( "OES_vertex_array_object" );
+        this.vertexArraySupported = isWebGl2 || null !== this.vertexArrayExt;
+    }
+    
+    return this.vertexArraySupported;
+};
+
+/**
+ * @return {WebGLVertexArrayObject}
+ */
+GStateCache.prototype.createVertexArray = function()
+{
+    this.count( true );
+    
+    return ( null !== this.vertexArrayExt ) ? this.vertexArrayExt.createVertexArrayOES() :
+                                              this.context.createVertexArray();
+};
+
+/**
+ * @param {WebGLVertexArrayObject} vertexArray Vertex array to bind, null for the default one
+ */
+GStateCache.prototype.bindVertexArray = function( vertexArray )
+{
+    if ( !this.count( vertexArray !== this.vertexArray ) )
+    {
+        return;
+    }
+    
+    if ( null === vertexArray )
+    {
+        this.arrayState = this.defaultArrayState;
+    }
+    else
+    {
+        if ( undefined === vertexArray.cachedState )
+        {
+            vertexArray.cachedState = new GStateCache.ArrayState();
+        }
+        
+        this.arrayState = vertexArray.cachedState;
+    }
+    
+    this.vertexArray = vertexArray;
+    
+    if ( null !== this.vertexArrayExt )
+    {
+        this.vertexArrayExt.bindVertexArrayOES( vertexArray );
+    }
+    else
+    {
+        this.context.bindVertexArray( vertexArray );
+    }
+};
+
+/**
+ * @param {WebGLVertexArrayObject} vertexArray
+ */
+GStateCache.prototype.deleteVertexArray = function( vertexArray )
+{
+    if ( vertexArray === this.vertexArray )
+    {
+        this.vertexArray = null;
+        this.arrayState = this.defaultArrayState;
+    }
+    
+    this.count( true );
+    
+    if ( null !== this.vertexArrayExt )
+    {
+        this.vertexArrayExt.deleteVertexArrayOES( vertexArray );
+    }
+    else
+    {
+        this.context.deleteVertexArray( vertexArray );
+    }
+};
+
+/**
+ * Check if instanced draws are available, with WebGL2 or through the
+ * ANGLE_instanced_arrays extension
+ * @return {boolean}
+ */
+GStateCache.prototype.isInstancingSupported = function()
+{
+    if ( undefined === this.instancingSupported )
+    {
+        var isWebGl2 = ( 'function' === typeof this.context.drawElementsInstanced );
+        
+        this.instancingExt = isWebGl2 ? null : this.context.getExtension( "ANGLE_instanced_arrays" );
+        this.instancingSupported = isWebGl2 || null !== this.instancingExt;
+    }
+    
+    return this.instancingSupported;
+};
+
+/**
+ * @param {number} index Attribute location
+ * @param {number} divisor Number of instances drawn with each value, 0 to 
+ *        advance once per vertex
+ */
+GStateCache.prototype.vertexAttribDivisor = function( index, divisor )
+{
+    this.count( true );
+    
+    if ( null !== this.instancingExt )
+    {
+        this.instancingExt.vertexAttribDivisorANGLE( index, divisor );
+    }
+    else
+    {
+        this.context.vertexAttribDivisor( index, divisor );
+    }
+};
+
+/**
+ * @param {number} mode
+ * @param {number} count Number of indices for each instance
+ * @param {number} type
+ * @param {number} offset
+ * @param {number} instanceCount
+ */
+GStateCache.prototype.drawElementsInstanced = function( mode, count, type, offset, instanceCount )
+{
+    this.count( true );
+    
+    if ( null !== this.instancingExt )
+    {
+        this.instancingExt.drawElementsInstancedANGLE( mode, count, type, offset, instanceCount );
+    }
+    else
+    {
+        this.context.drawElementsInstanced( mode, count, type, offset, instanceCount );
+    }
+};
+
+GStateCache.prototype.enable = function( cap )
+{
+    if ( this.count( true !== this.capabilities[cap] ) )
+    {
+        this.capabilities[cap] = true;
+        this.context.enable( cap );
+    }
+};
+
+GStateCache.prototype.disable = function( cap )
+{
+    if ( this.count( false !== this.capabilities[cap] ) )
+    {
+        this.capabilities[cap] = false;
+        this.context.disable( cap );
+    }
+};
+
+GStateCache.prototype.viewport = function( x, y, width, height )
+{
+    var r = this.viewportRect;
+    
+    if ( this.count( r[0] !== x || r[1] !== y || r[2] !== width || r[3] !== height ) )
+    {
+        r[0] = x;
+        r[1] = y;
+        r[2] = width;
+        r[3] = height;
+        this.context.viewport( x, y, width, height );
+    }
+};
+
+GStateCache.prototype.blendFunc = function( sfactor, dfactor )
+{
+    var f = this.blendFactors;
+    
+    if ( this.count( f[0] !== sfactor || f[1] !== dfactor ) )
+    {
+        f[0] = sfactor;
+        f[1] = dfactor;
+        this.context.blendFunc( sfactor, dfactor );
+    }
+};
+
+/**
+ * Returns true if a uniform location doesn't hold the provided value yet 
+ * and remembers it.  The values are kept on the location, they belong to 
+ * the program of the location and a new one is queried after linking.
+ * @param {WebGLUniformLocation} location
+ * @param {Float32Array|Array.<number>} value
+ * @return {boolean}
+ */
+GStateCache.prototype.isUniformChanged = function( location, value )
+{
+    var length = value.length;
+    
+    if ( length > this.scratch.length )
+    {
+        this.scratch = new Float32Array( length );
+    }
+    
+    // compare with the precision the values are uploaded with
+    var scratch = this.scratch;
+    scratch.set( value );
+    
+    var cached = location.cachedValue;
+    
+    if ( undefined === cached || cached.length !== length )
+    {
+        location.cachedValue = new Float32Array( scratch.subarray( 0, length ) );
+        return true;
+    }
+    
+    var isChanged = false;
+    
+    for ( var i = 0; i < length; ++i )
+    {
+        if ( cached[i] !== scratch[i] )
+        {
+            cached[i] = scratch[i];
+            isChanged = true;
+        }
+    }
+    
+    return isChanged;
+};
+
+GStateCache.prototype.uniform1i = function( location, x )
+{
+    if ( this.count( null !== location && location.cachedValue !== x ) )
+    {
+        location.cachedValue = x;
+        this.context.uniform1i( location, x );
+    }
+};
+
+GStateCache.prototype.uniform1f = function( location, x )
+{
+    if ( this.count( null !== location && location.cachedValue !== x ) )
+    {
+        location.cachedValue = x;
+        this.context.uniform1f( location, x );
+    }
+};
+
+GStateCache.prototype.uniform2fv = function( location, value )
+{
+    if ( this.count( null !== location && this.isUniformChanged( location, value ) ) )
+    {
+        this.context.uniform2fv( location, value );
+    }
+};
+
+GStateCache.prototype.uniform3fv = function( location, value )
+{
+    if ( this.count( null !== location && this.isUniformChanged( location, value ) ) )
+    {
+        this.context.uniform3fv( location, value );
+    }
+};
+
+GStateCache.prototype.uniform4fv = function( location, value )
+{
+    if ( this.count( null !== location && this.isUniformChanged( location, value ) ) )
+    {
+        this.context.uniform4fv( location, value );
+    }
+};
+
+GStateCache.prototype.uniformMatrix3fv = function( location, transpose, value )
+{
+    if ( this.count( null !== location && this.isUniformChanged( location, value ) ) )
+    {
+        this.context.uniformMatrix3fv( location, transpose, value );
+    }
+};
+
+GStateCache.prototype.uniformMatrix4fv = function( location, transpose, value )
+{
+    if ( this.count( null !== location && this.isUniformChanged( location, value ) ) )
+    {
+        this.context.uniformMatrix4fv( location, transpose, value );
+    }
+};
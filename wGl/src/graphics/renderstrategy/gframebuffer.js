@@ -71,6 +71,12 @@ GFrameBuffer.prototype.addBufferTexture = function ( cfg )
     gl.framebufferTexture2D(gl.FRAMEBUFFER, cfg.attachment, gl.TEXTURE_2D, texture, 0);
     this.textures[cfg.name] = texture;
     
+    if ( cfg.attachment === gl.COLOR_ATTACHMENT0 )
+    {
+        // readPixels always samples the first color attachment
+        this.readType = cfg.type;
+    }
+    
     if ( undefined != this.cfg.extensions &&
          undefined != this.cfg.extensions.WEBGL_draw_buffers &&
          // The closure compiler has problems accessing members of extensions unless they are called like this
@@ -88,10 +94,12 @@ GFrameBuffer.prototype.addBufferTexture = function ( cfg )
 
 /**
  * Complete the creation of this frame buffer and make it ready for use
+ * @return {boolean} true if the frame buffer is complete and can be rendered to
  */
 GFrameBuffer.prototype.complete = function ()
 {
     var gl = this.cfg.gl;
+    var isComplete = true;
     
     if ( undefined != this.WEBGL_draw_buffers_drawBuffersList )
     {
@@ -102,11 +110,14 @@ GFrameBuffer.prototype.complete = function ()
     if (gl.checkFramebufferStatus(gl.FRAMEBUFFER) !== gl.FRAMEBUFFER_COMPLETE)
     {
         console.debug("incomplete famebuffer");
+        isComplete = false;
     }
     
     gl.bindTexture(gl.TEXTURE_2D, null);
     gl.bindRenderbuffer(gl.RENDERBUFFER, null);
     gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    
+    return isComplete;
 };
 
 /**
@@ -178,9 +189,27 @@ GFrameBuffer.prototype.getColorValueAt = function( x, y, outArg )
 {
     this.bindBuffer();
     var gl = this.cfg.gl;
+    
+    if ( gl.FLOAT === this.readType )
+    {
+        // float attachments can't be read back as bytes, convert them here so
+        // callers see the same values they would get from a RGBA8 buffer
+        var floatA = GFrameBuffer.tempFloatA;
+        gl.readPixels(x, y, 1, 1, gl.RGBA, gl.FLOAT, floatA);
+        
+        for ( var i = 0; i < 4; ++i )
+        {
+            outArg[i] = Math.round( Math.min( Math.max( floatA[i], 0 ), 1 ) * 255 );
+        }
+        
+        return;
+    }
+    
     gl.readPixels(x, y, 1, 1, gl.RGBA, gl.UNSIGNED_BYTE, outArg);
 };
 
+GFrameBuffer.tempFloatA = new Float32Array(4);
+
 /**
  * Called to delete all the resources under this buffer
  */
@@ -0,0 +1,186 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Downloads the shader sources of a context.  All the sources come in one
+ * request from the bundle written by tools/wglshaders.js, sources that are 
+ * not in the bundle (or all of them if there is no bundle) are downloaded
+ * one by one from the shader directory.  The sources are kept so render
+ * strategies that get reloaded don't download them again.
+ * @constructor
+ */
+function GShaderBundle()
+{
+    this.sources = {};
+    this.requested = {};
+    this.requests = [];
+    this.bundleState = GShaderBundle.BUNDLE_NONE;
+}
+
+GShaderBundle.BUNDLE_NONE = 0;
+GShaderBundle.BUNDLE_LOADING = 1;
+GShaderBundle.BUNDLE_DONE = 2;
+
+GShaderBundle.SHADER_PATH = "assets/shaders/";
+GShaderBundle.BUNDLE_NAME = "shaders.json";
+
+/**
+ * Get the bundle of a context, it's created on first use and kept on the 
+ * context
+ * @param {WebGLRenderingContext} gl
+ * @return {GShaderBundle}
+ */
+GShaderBundle.get = function( gl )
+{
+    if ( undefined === gl.shaderBundle )
+    {
+        gl.shaderBundle = new GShaderBundle();
+    }
+    
+    return gl.shaderBundle;
+};
+
+/**
+ * Request a set of shader sources, the callback is always called 
+ * asynchronously
+ * @param {Array.<string>} names File names of the shaders
+ * @param {function(Object.<string,string>)} callback Receives the sources by
+ *        file name once all of them are available
+ */
+GShaderBundle.prototype.request = function( names, callback )
+{
+    this.requests.push( { names: names, callback: callback } );
+    
+    if ( GShaderBundle.BUNDLE_NONE === this.bundleState )
+    {
+        this.loadBundle();
+    }
+    else if ( GShaderBundle.BUNDLE_DONE === this.bundleState )
+    {
+        setTimeout( function() { this.loadMissing(); }.bind(this), 0 );
+    }
+};
+
+/**
+ * Start the download of the bundle
+ */
+GShaderBundle.prototype.loadBundle = function()
+{
+    this.bundleState = GShaderBundle.BUNDLE_LOADING;
+    
+    var client = new XMLHttpRequest();
+    client.open( 'GET', GShaderBundle.SHADER_PATH + GShaderBundle.BUNDLE_NAME );
+    client.onreadystatechange = function() 
+    {
+        if ( client.readyState !== 4 )
+        {
+            return;
+        }
+        
+        if ( 200 === client.status )
+        {
+            var shaders = JSON.parse( client.responseText )['shaders'];
+            
+            for ( var name in shaders )
+            {
+                this.sources[name] = shaders[name];
+                this.requested[name] = true;
+            }
+        }
+        else
+        {
+            console.debug( "GShaderBundle: no shader bundle, loading the sources one by one" );
+        }
+        
+        this.bundleState = GShaderBundle.BUNDLE_DONE;
+        this.loadMissing();
+    }.bind(this);
+    client.send();
+};
+
+/**
+ * Download the requested sources that the bundle didn't have and answer the
+ * requests that are complete
+ */
+GShaderBundle.prototype.loadMissing = function()
+{
+    for ( var i = 0; i < this.requests.length; ++i )
+    {
+        var names = this.requests[i].names;
+        
+        for ( var j = 0; j < names.length; ++j )
+        {
+            if ( true !== this.requested[names[j]] )
+            {
+                this.requested[names[j]] = true;
+                this.loadSource( names[j] );
+            }
+        }
+    }
+    
+    this.answerRequests();
+};
+
+/**
+ * Download a single shader source
+ * @param {string} name File name of the shader
+ */
+GShaderBundle.prototype.loadSource = function( name )
+{
+    var client = new XMLHttpRequest();
+    client.open( 'GET', GShaderBundle.SHADER_PATH + name );
+    client.onreadystatechange = function() 
+    {
+        if ( client.readyState === 4 )
+        {
+            this.sources[name] = client.responseText;
+            this.answerRequests();
+        }
+    }.bind(this);
+    client.send();
+};
+
+/**
+ * Call back the requests whose sources are all available
+ */
+GShaderBundle.prototype.answerRequests = function()
+{
+    for ( var i = 0; i < this.requests.length; )
+    {
+        var names = this.requests[i].names;
+        var isComplete = true;
+        
+        for ( var j = 0; j < names.length && isComplete; ++j )
+        {
+            isComplete = ( undefined !== this.sources[names[j]] );
+        }
+        
+        if ( isComplete )
+        {
+            var callback = this.requests[i].callback;
+            this.requests.splice( i, 1 );
+            callback( this.sources );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+};
@@ -90,21 +90,6 @@ GRenderStrategy.prototype.isReady = function() {return false;};
  */
 GRenderStrategy.prototype.reload = function() {};
 
-/**
- * Get the object id of the object at the provided mouse location
- * @param {number} x
- * @param {number} y
- */
-GRenderStrategy.prototype.getObjectIdAt = function(x,y) { return -1; };
-
-/**
- * Get the 3d position of the pixel at the provided mouse location
- * @param {number} x
- * @param {number} y
- * @return {Array<number>}
- */
-GRenderStrategy.prototype.ge3dPositionAt = function(x, y) { return [0, 0, 0]; };
-
 /**
  * Get the object id of the object at the provided mouse location
  * @param {number} x
@@ -26,19 +26,24 @@
 function GRenderDeferredStrategy( gl )
 {
     /** @type {WebGLRenderingContext} */ this.gl = gl;
-    this.configure();
     
     this.extensions = {};
     this.extensions.stdDeriv = gl.getExtension('OES_standard_derivatives');
+    this.extensions.texFloat = gl.getExtension('OES_texture_float');
+    this.extensions.drawBuffers = gl.getExtension('WEBGL_draw_buffers');
+    
+    // the G-buffer is written in a single pass when multiple render targets are available
+    this.useMrt = this.checkMrtSupport();
+    
+    this.configure();
     
     this.renderLevel = 0;
-    this.lastScene = undefined;
 }
 
 GRenderDeferredStrategy.prototype = Object.create( GRenderStrategy.prototype );
 
 /**
- * Configures the strategy and starts the download process for the shader source
+ * Configures the strategy and requests the shader sources from the bundle
  */
 GRenderDeferredStrategy.prototype.configure = function()
 {
@@ -59,8 +64,6 @@ GRenderDeferredStrategy.prototype.configure = function()
         "normaldepth-vs.c":undefined,
         "fxaa-vs.c":undefined,
         "fxaa-fs.c":undefined,
-        "objid-fs.c":undefined,
-        "objid-vs.c":undefined,
         "objidscr-fs.c":undefined,
         "objidscr-vs.c":undefined,
         "position-fs.c":undefined,
@@ -73,10 +76,38 @@ GRenderDeferredStrategy.prototype.configure = function()
         "tonemap-vs.c":undefined
     };
     
+    if ( this.useMrt )
+    {
+        map["gbuffer-vs.c"] = undefined;
+        map["gbuffer-fs.c"] = undefined;
+    }
+    
+    var names = [];
     for (var key in map)
     {
-        this.loadShader(key);
+        names.push(key);
+    }
+    
+    GShaderBundle.get( this.gl ).request( names, this.onShaderSourcesLoaded.bind(this) );
+};
+
+/**
+ * Check if the context can render the G-buffer in a single pass 
+ * using WEBGL_draw_buffers
+ * @return {boolean}
+ */
+GRenderDeferredStrategy.prototype.checkMrtSupport = function()
+{
+    var ext = this.extensions.drawBuffers;
+    
+    if ( null == ext || null == this.extensions.texFloat )
+    {
+        return false;
     }
+    
+    // The closure compiler has problems accessing members of extensions unless they are called like this
+    return this.gl.getParameter( ext['MAX_DRAW_BUFFERS_WEBGL'] ) >= 3 &&
+           this.gl.getParameter( ext['MAX_COLOR_ATTACHMENTS_WEBGL'] ) >= 3;
 };
 
 /**
@@ -85,6 +116,7 @@ GRenderDeferredStrategy.prototype.configure = function()
 GRenderDeferredStrategy.prototype.deleteResources = function()
 {
     this._isReady = false;
+    this.pendingPrograms = undefined;
     
     for ( var fKey in this.frameBuffers )
     {
@@ -97,8 +129,6 @@ GRenderDeferredStrategy.prototype.deleteResources = function()
         this.programs[key] = undefined;
     }
 
-    this.lastScene = undefined;
-    
     this.deleteScreenVBOs();
 };
 
@@ -112,57 +142,48 @@ GRenderDeferredStrategy.prototype.reload = function()
 };
 
 /**
- * Start the download process for the requested shader
- * @param {string} srcName source name of the shader that needs to be loaded
- */
-GRenderDeferredStrategy.prototype.loadShader = function( srcName )
-{
-    var client = new XMLHttpRequest();
-    var _this = this;
-    client.open('GET', "assets/shaders/" + srcName);
-    client.onreadystatechange = function() 
-    {
-        if ( client.readyState === 4 )
-        {
-            var devS = (_this.extensions.stdDeriv != null)?
-                    "#define HAS_OES_DERIVATIVES\n":
-                    "";
-                    
-            _this.shaderSrcMap[srcName] = devS + client.responseText; 
-            _this.checkShaderDependencies();
-        }
-    };
-    client.send();
-};
-
-/**
- * Checks if all the shader code has been downloaded from the web server
- * and if so it starts the initilization process
+ * Called by the shader bundle once all the shader sources are available
+ * @param {Object.<string,string>} sources Shader sources by file name
  */
-GRenderDeferredStrategy.prototype.checkShaderDependencies = function()
+GRenderDeferredStrategy.prototype.onShaderSourcesLoaded = function( sources )
 {
+    var devS = (this.extensions.stdDeriv != null)?
+            "#define HAS_OES_DERIVATIVES\n":
+            "";
+    
     for (var key in this.shaderSrcMap)
     {
-        if (this.shaderSrcMap[key] === undefined)
-        {
-            return;
-        }
+        this.shaderSrcMap[key] = devS + sources[key];
     }
     
     this.initialize();
 };
 
 /**
- * Initialize this render strategy
+ * Initialize this render strategy, the strategy becomes ready once the 
+ * shaders finish compiling
  */
 GRenderDeferredStrategy.prototype.initialize = function()
 {   
     this.initTextureFramebuffer();
     this.initScreenVBOs();
     this.initShaders();
-    this.initPassCmds();
+};
+
+/**
+ * Finish the programs that are done compiling and set up the passes once 
+ * all of them are
+ */
+GRenderDeferredStrategy.prototype.checkShaderCompletion = function()
+{
+    GShader.finishCompletedPrograms( this.gl, this.pendingPrograms );
     
-    this._isReady = true;
+    if ( 0 === this.pendingPrograms.length )
+    {
+        this.pendingPrograms = undefined;
+        this.initPassCmds();
+        this._isReady = true;
+    }
 };
 
 /**
@@ -172,6 +193,11 @@ GRenderDeferredStrategy.prototype.initialize = function()
  */
 GRenderDeferredStrategy.prototype.isReady = function()
 {
+    if ( undefined !== this.pendingPrograms )
+    {
+        this.checkShaderCompletion();
+    }
+    
     return true === this._isReady;
 };
 
@@ -240,8 +266,9 @@ GRenderDeferredStrategy.prototype.deleteScreenVBOs = function()
 };
 
 /**
- * Helper function to compile the shaders after all the source has been
- * downloaded
+ * Helper function to start compiling the shaders after all the source has 
+ * been downloaded.  Every program is submitted before any of them is checked
+ * so the driver can compile them in parallel.
  */
 GRenderDeferredStrategy.prototype.initShaders = function () 
 {
@@ -258,16 +285,26 @@ GRenderDeferredStrategy.prototype.initShaders = function ()
     this.programs.fxaa        = new GShader( shaderSrcMap["fxaa-vs.c"],        shaderSrcMap["fxaa-fs.c"]        );
     this.programs.objidscr    = new GShader( shaderSrcMap["objidscr-vs.c"],    shaderSrcMap["objidscr-fs.c"]       );
     
-    this.programs.colorspec   = new ShaderComposite( shaderSrcMap["colorspec-vs.c"],   shaderSrcMap["colorspec-fs.c"]   );
-    this.programs.normaldepth = new ShaderComposite( shaderSrcMap["normaldepth-vs.c"], shaderSrcMap["normaldepth-fs.c"] );
-    this.programs.position    = new ShaderComposite( shaderSrcMap["position-vs.c"],    shaderSrcMap["position-fs.c"]    );
     this.programs.depth       = new ShaderComposite( shaderSrcMap["depth-vs.c"],       shaderSrcMap["depth-fs.c"]       );
-    this.programs.objid       = new ShaderComposite( shaderSrcMap["objid-vs.c"],       shaderSrcMap["objid-fs.c"]       );
+    
+    if ( this.useMrt )
+    {
+        this.programs.gbuffer     = new ShaderComposite( shaderSrcMap["gbuffer-vs.c"],     shaderSrcMap["gbuffer-fs.c"]     );
+    }
+    else
+    {
+        this.programs.colorspec   = new ShaderComposite( shaderSrcMap["colorspec-vs.c"],   shaderSrcMap["colorspec-fs.c"]   );
+        this.programs.normaldepth = new ShaderComposite( shaderSrcMap["normaldepth-vs.c"], shaderSrcMap["normaldepth-fs.c"] );
+        this.programs.position    = new ShaderComposite( shaderSrcMap["position-vs.c"],    shaderSrcMap["position-fs.c"]    );
+    }
     
 
+    this.pendingPrograms = [];
+    
     for ( var key in this.programs )
     {
-        this.programs[key].bindToContext(gl);
+        this.programs[key].startCompile(gl);
+        this.pendingPrograms.push(this.programs[key]);
     }
 };
 
@@ -327,10 +364,10 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     
     this.lightCamControlers = {};
     
-    var colorPass = new GGeometryRenderPassCmd( this.gl, this.programs.colorspec, this.frameBuffers.color );
-    var normalPass = new GGeometryRenderPassCmd( this.gl, this.programs.normaldepth, this.frameBuffers.normal );
-    var positionPass = new GGeometryRenderPassCmd( this.gl, this.programs.position, this.frameBuffers.position );
-    var objidPass = new GGeometryRenderPassCmd( this.gl, this.programs.objid, this.frameBuffers.objid );
+    var normalTexture   = this.getGBufferTexture( "normal" );
+    var positionTexture = this.getGBufferTexture( "position" );
+    var colorTexture    = this.getGBufferTexture( "color" );
+    
     var clearPhongLightPong = new GRenderPassClearCmd( this.gl, this.frameBuffers.phongLightPong );
     
     var clearShadowmap = new GRenderPassClearCmd( this.gl, this.frameBuffers.shadowmapPong );
@@ -340,13 +377,13 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     this.lightCamControlers.down = downCtrl;
     var normalSource = new GCustomCamGeometryRenderPassCmd( this.gl, this.programs.depth, this.frameBuffers.lightNormal, downCtrl ); 
     var shadowmapPass = new GPostEffectLitRenderPassCmd( this.gl, this.programs.shadowmap, this.frameBuffers.shadowmapPong, this.screen, downCtrl.getCamera() );
-    shadowmapPass.addInputTexture( this.frameBuffers.position.getGTexture(),    gl.TEXTURE0 );
+    shadowmapPass.addInputTexture( positionTexture,    gl.TEXTURE0 );
     shadowmapPass.addInputTexture( this.frameBuffers.lightNormal.getGTexture(), gl.TEXTURE1 );
     shadowmapPass.addInputTexture( this.gl.whiteCircleTexture, gl.TEXTURE2 );
  
     var phongLightPassPing = new GPostEffectLitRenderPassCmd( this.gl, this.programs.light, this.frameBuffers.phongLightPing, this.screen );
-    phongLightPassPing.addInputTexture( this.frameBuffers.normal.getGTexture(),        gl.TEXTURE0 );
-    phongLightPassPing.addInputTexture( this.frameBuffers.position.getGTexture(),      gl.TEXTURE1 );
+    phongLightPassPing.addInputTexture( normalTexture,        gl.TEXTURE0 );
+    phongLightPassPing.addInputTexture( positionTexture,      gl.TEXTURE1 );
     if ( 1 >= this.renderLevel )
     {
         phongLightPassPing.addInputTexture( this.gl.whiteTexture, gl.TEXTURE2 );
@@ -358,8 +395,8 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     phongLightPassPing.addInputTexture( this.frameBuffers.phongLightPong.getGTexture(),gl.TEXTURE3 );
     
     var phongLightPassPong = new GPostEffectLitRenderPassCmd( this.gl, this.programs.light, this.frameBuffers.phongLightPong, this.screen );
-    phongLightPassPong.addInputTexture( this.frameBuffers.normal.getGTexture(),        gl.TEXTURE0 );
-    phongLightPassPong.addInputTexture( this.frameBuffers.position.getGTexture(),      gl.TEXTURE1 );
+    phongLightPassPong.addInputTexture( normalTexture,        gl.TEXTURE0 );
+    phongLightPassPong.addInputTexture( positionTexture,      gl.TEXTURE1 );
     if ( 1 >= this.renderLevel )
     {
         phongLightPassPong.addInputTexture( this.gl.whiteTexture, gl.TEXTURE2 );
@@ -371,7 +408,7 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     phongLightPassPong.addInputTexture( this.frameBuffers.phongLightPing.getGTexture(),gl.TEXTURE3 );
     
     var saoPass = new GPostEffectRenderPassCmd( this.gl, this.programs.ssao, this.frameBuffers.ssao, this.screen );
-    saoPass.addInputFrameBuffer( this.frameBuffers.position, gl.TEXTURE0 );
+    saoPass.addInputTexture( positionTexture );
     saoPass.addInputTexture( this.gl.randomTexture );
     
     var saoBlurPing = new GPostEffectRenderPassCmd( this.gl, this.programs.blur, this.frameBuffers.blurPing, this.screen );
@@ -383,7 +420,7 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     saoBlurPong.addInputFrameBuffer( this.frameBuffers.blurPing, gl.TEXTURE0 );
     
     var toneMapPassPing = new GPostEffectRenderPassCmd( this.gl, this.programs.toneMap, this.frameBuffers.phongLightPong, this.screen );
-    toneMapPassPing.addInputFrameBuffer( this.frameBuffers.color, gl.TEXTURE0 );
+    toneMapPassPing.addInputTexture( colorTexture );
     toneMapPassPing.addInputFrameBuffer( this.frameBuffers.phongLightPing, gl.TEXTURE1 );
     if ( 0 >= this.renderLevel )
     {
@@ -395,7 +432,7 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     }
     
     var toneMapPassPong = new GPostEffectRenderPassCmd( this.gl, this.programs.toneMap, this.frameBuffers.phongLightPing, this.screen );
-    toneMapPassPong.addInputFrameBuffer( this.frameBuffers.color, gl.TEXTURE0 );
+    toneMapPassPong.addInputTexture( colorTexture );
     toneMapPassPong.addInputFrameBuffer( this.frameBuffers.phongLightPong, gl.TEXTURE1 );
     if ( 0 >= this.renderLevel )
     {
@@ -416,10 +453,17 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     
     var toneMapCmds = [];
     
-    preCmds.push( normalPass );
-    preCmds.push( positionPass );
-    preCmds.push( colorPass );
-    preCmds.push( objidPass );
+    if ( this.useMrt )
+    {
+        preCmds.push( new GGeometryRenderPassCmd( this.gl, this.programs.gbuffer, this.frameBuffers.gBuffer ) );
+    }
+    else
+    {
+        preCmds.push( new GGeometryRenderPassCmd( this.gl, this.programs.normaldepth, this.frameBuffers.normal ) );
+        preCmds.push( new GGeometryRenderPassCmd( this.gl, this.programs.position, this.frameBuffers.position ) );
+        preCmds.push( new GGeometryRenderPassCmd( this.gl, this.programs.colorspec, this.frameBuffers.color ) );
+    }
+    
     preCmds.push( clearPhongLightPong );
     
     if ( this.renderLevel >= 2 )
@@ -452,6 +496,22 @@ GRenderDeferredStrategy.prototype.initPassCmds = function()
     }
 };
 
+/**
+ * Get one of the G-buffer textures (normal, position or color) regardless
+ * of it being an attachment of the single pass G-buffer or a frame buffer of its own
+ * @param {string} name Name of the G-buffer texture
+ * @return {GTexture}
+ */
+GRenderDeferredStrategy.prototype.getGBufferTexture = function ( name )
+{
+    if ( this.useMrt )
+    {
+        return this.frameBuffers.gBuffer.getGTexture( name );
+    }
+    
+    return this.frameBuffers[name].getGTexture();
+};
+
 /**
  * Get the current render level
  * @return {number}
@@ -492,8 +552,6 @@ GRenderDeferredStrategy.prototype.setRenderLevel = function ( newLevel )
  */
 GRenderDeferredStrategy.prototype.draw = function ( scene, hud )
 {
-    this.lastScene = scene;
-
     var gl = this.gl;
     gl.disable(gl.BLEND);
     var lCount = scene.getLights().length;
@@ -545,10 +603,6 @@ GRenderDeferredStrategy.prototype.draw = function ( scene, hud )
     this.setHRec(0, 0, 1, 1);
     this.drawScreenBuffer(this.programs.fxaa); 
     
-    /*this.frameBuffers.objid.bindTexture(gl.TEXTURE0, "color");
-    this.setHRec(-0.125+0.75, 0.125-0.75, 0.125, 0.125);
-    this.drawScreenBuffer(this.programs.fxaa);*/
-    
     /*this.frameBuffers.phongLightPong.bindTexture(gl.TEXTURE0, "color");
     this.setHRec(0.125+0.75, 0.125-0.75, 0.125, 0.125);
     this.drawScreenBuffer(this.programs.fxaa); */
@@ -580,44 +634,6 @@ GRenderDeferredStrategy.prototype.draw = function ( scene, hud )
 
 GRenderDeferredStrategy.tempObjIdA = new Uint8Array(4);
 
-/**
- * Get the object id of the object at the provided mouse location
- * @param {number} x
- * @param {number} y
- */
-GRenderDeferredStrategy.prototype.getObjectIdAt = function ( x, y )
-{
-    this.frameBuffers.objid.getColorValueAt(x, y, GRenderDeferredStrategy.tempObjIdA);
-    
-    return ( GRenderDeferredStrategy.tempObjIdA[0] << 8  |
-             GRenderDeferredStrategy.tempObjIdA[1] );
-};
-
-/**
- * Get the 3d position of the pixel at the provided mouse location
- * @param {number} x
- * @param {number} y
- * @return {Float32Array}
- */
-GRenderDeferredStrategy.prototype.ge3dPositionAt = function(x, y)
-{
-    this.frameBuffers.objid.getColorValueAt(x, y, GRenderDeferredStrategy.tempObjIdA);
-
-    var zVal = ( GRenderDeferredStrategy.tempObjIdA[2] + (GRenderDeferredStrategy.tempObjIdA[3]/256.0) ) / 256.0;
-    var ret = vec4.fromValues(2*(x/1024.0) - 1.0, 2*(y/1024.0) - 1.0, 2*zVal - 1.0, 1.0);
-
-    if ( undefined !== this.lastScene )
-    {
-        var camera = this.lastScene.getCamera();
-        camera.inverseProject( ret );
-    }
-
-    ret[0] /= ret[3];ret[1] /= ret[3];
-    ret[2] /= ret[3];ret[3] /= ret[3];
-
-    return ret;
-};
-
 /**
  * Get the object id of the object at the provided mouse location
  * @param {number} x
@@ -696,25 +712,29 @@ GRenderDeferredStrategy.prototype.initTextureFramebuffer = function()
     frameBuffer.complete();
     this.frameBuffers.blurPing = frameBuffer;
     
-    frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
-    frameBuffer.addBufferTexture(texCfg);
-    frameBuffer.complete();
-    this.frameBuffers.color = frameBuffer;
-    
-    frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
-    frameBuffer.addBufferTexture(texCfgFloat);
-    frameBuffer.complete();
-    this.frameBuffers.normal = frameBuffer;
-    
-    frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
-    frameBuffer.addBufferTexture(texCfgFloat);
-    frameBuffer.complete();
-    this.frameBuffers.position = frameBuffer;
+    if ( this.useMrt && !this.initGBufferMrt( floatTexFilter ) )
+    {
+        console.debug("WEBGL_draw_buffers G-buffer incomplete, falling back to multi-pass");
+        this.useMrt = false;
+    }
     
-    frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
-    frameBuffer.addBufferTexture(texCfg);
-    frameBuffer.complete();
-    this.frameBuffers.objid = frameBuffer;
+    if ( !this.useMrt )
+    {
+        frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
+        frameBuffer.addBufferTexture(texCfg);
+        frameBuffer.complete();
+        this.frameBuffers.color = frameBuffer;
+        
+        frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
+        frameBuffer.addBufferTexture(texCfgFloat);
+        frameBuffer.complete();
+        this.frameBuffers.normal = frameBuffer;
+        
+        frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
+        frameBuffer.addBufferTexture(texCfgFloat);
+        frameBuffer.complete();
+        this.frameBuffers.position = frameBuffer;
+    }
     
     frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
     frameBuffer.addBufferTexture(texCfg);
@@ -747,5 +767,43 @@ GRenderDeferredStrategy.prototype.initTextureFramebuffer = function()
     this.frameBuffers.phongLightPong = frameBuffer;
 };
 
-
-
+/**
+ * Create the single pass G-buffer with one attachment per G-buffer texture
+ * @param {number} filter Filter to use for the float textures
+ * @return {boolean} true if the G-buffer is usable
+ */
+GRenderDeferredStrategy.prototype.initGBufferMrt = function( filter )
+{
+    var gl = this.gl;
+    var ext = this.extensions.drawBuffers;
+    
+    // WEBGL_draw_buffers requires every attachment to have the same number of 
+    // bitplanes so all of them are float
+    var names = [ "normal", "position", "color" ];
+    
+    var frameBuffer = new GFrameBuffer({ gl: gl, width: 1024, height: 1024, 
+                                         extensions: { WEBGL_draw_buffers: ext } });
+    
+    for ( var i = 0; i < names.length; ++i )
+    {
+        frameBuffer.addBufferTexture(
+        {
+            filter: filter,
+            format: gl.RGBA,
+            type: gl.FLOAT,
+            // The closure compiler has problems accessing members of extensions unless they are called like this
+            attachment: ext['COLOR_ATTACHMENT0_WEBGL'] + i,
+            name: names[i]
+        });
+    }
+    
+    if ( !frameBuffer.complete() )
+    {
+        frameBuffer.deleteResources();
+        return false;
+    }
+    
+    this.frameBuffers.gBuffer = frameBuffer;
+    
+    return true;
+};
@@ -55,7 +55,7 @@ GRenderPhongStrategy.prototype.checkNavigatorProfile = function( extensionName )
 };
 
 /**
- * Configures the strategy and starts the download process for the shader source
+ * Configures the strategy and requests the shader sources from the bundle
  */
 GRenderPhongStrategy.prototype.configure = function()
 {
@@ -66,18 +66,19 @@ GRenderPhongStrategy.prototype.configure = function()
         "fullscr-fs.c":undefined,
         "fxaa-vs.c":undefined,
         "fxaa-fs.c":undefined,
-        "objid-fs.c":undefined,
-        "objid-vs.c":undefined,
         "objidscr-fs.c":undefined,
         "objidscr-vs.c":undefined,
         "phong-vs.c":undefined,
         "phong-fs.c":undefined
     };
     
+    var names = [];
     for (var key in this.shaderSrcMap)
     {
-        this.loadShader(key);
+        names.push(key);
     }
+    
+    GShaderBundle.get( this.gl ).request( names, this.onShaderSourcesLoaded.bind(this) );
 };
 
 /**
@@ -86,6 +87,7 @@ GRenderPhongStrategy.prototype.configure = function()
 GRenderPhongStrategy.prototype.deleteResources = function()
 {
     this._isReady = false;
+    this.pendingPrograms = undefined;
     
     for ( var fKey in this.frameBuffers )
     {
@@ -98,8 +100,6 @@ GRenderPhongStrategy.prototype.deleteResources = function()
         this.programs[key] = undefined;
     }
 
-    this.lastScene = undefined;
-    
     this.deleteScreenVBOs();
 };
 
@@ -113,48 +113,26 @@ GRenderPhongStrategy.prototype.reload = function()
 };
 
 /**
- * Start the download process for the requested shader
- * @param {string} source name of the shader that needs to be loaded
- */
-GRenderPhongStrategy.prototype.loadShader = function(srcName)
-{
-    var client = new XMLHttpRequest();
-    var _this = this;
-    client.open('GET', "assets/shaders/" + srcName);
-    client.onreadystatechange = function() 
-    {
-        if ( client.readyState === 4 )
-        {
-            var devS = (_this.extensions.stdDeriv != null)?
-                    "#define HAS_OES_DERIVATIVES\n":
-                    "";
-                    
-            _this.shaderSrcMap[srcName] = devS + client.responseText; 
-            _this.checkShaderDependencies();
-        }
-    };
-    client.send();
-};
-
-/**
- * Checks if all the shader code has been downloaded from the web server
- * and if so it starts the initilization process
+ * Called by the shader bundle once all the shader sources are available
+ * @param {Object.<string,string>} sources Shader sources by file name
  */
-GRenderPhongStrategy.prototype.checkShaderDependencies = function()
+GRenderPhongStrategy.prototype.onShaderSourcesLoaded = function( sources )
 {
+    var devS = (this.extensions.stdDeriv != null)?
+            "#define HAS_OES_DERIVATIVES\n":
+            "";
+    
     for (var key in this.shaderSrcMap)
     {
-        if (this.shaderSrcMap[key] === undefined)
-        {
-            return;
-        }
+        this.shaderSrcMap[key] = devS + sources[key];
     }
     
     this.initialize();
 };
 
 /**
- * Initialize this render strategy
+ * Initialize this render strategy, the strategy becomes ready once the 
+ * shaders finish compiling
  */
 GRenderPhongStrategy.prototype.initialize = function()
 {   
@@ -162,9 +140,22 @@ GRenderPhongStrategy.prototype.initialize = function()
     this.initShaders(this.shaderSrcMap);
     
     this.initScreenVBOs();
+};
+
+/**
+ * Finish the programs that are done compiling and set up the passes once 
+ * all of them are
+ */
+GRenderPhongStrategy.prototype.checkShaderCompletion = function()
+{
+    GShader.finishCompletedPrograms( this.gl, this.pendingPrograms );
     
-    this.initPassCmds();
-    this._isReady = true;
+    if ( 0 === this.pendingPrograms.length )
+    {
+        this.pendingPrograms = undefined;
+        this.initPassCmds();
+        this._isReady = true;
+    }
 };
 
 /**
@@ -174,6 +165,11 @@ GRenderPhongStrategy.prototype.initialize = function()
  */
 GRenderPhongStrategy.prototype.isReady = function()
 {
+    if ( undefined !== this.pendingPrograms )
+    {
+        this.checkShaderCompletion();
+    }
+    
     return true === this._isReady;
 };
 
@@ -263,11 +259,6 @@ GRenderPhongStrategy.prototype.initTextureFramebuffer = function()
     frameBuffer.complete();
     this.frameBuffers.color = frameBuffer;
     
-    frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
-    frameBuffer.addBufferTexture(texCfg);
-    frameBuffer.complete();
-    this.frameBuffers.objid = frameBuffer;
-    
     frameBuffer = new GFrameBuffer({ gl: this.gl, width: 1024, height: 1024 });
     frameBuffer.addBufferTexture(texCfg);
     frameBuffer.complete();
@@ -275,8 +266,8 @@ GRenderPhongStrategy.prototype.initTextureFramebuffer = function()
 };
 
 /**
- * Helper function to compile the shaders after all the source has been
- * downloaded
+ * Helper function to start compiling the shaders after all the source has 
+ * been downloaded, see GRenderDeferredStrategy.initShaders
  */
 GRenderPhongStrategy.prototype.initShaders = function (shaderSrcMap) 
 {
@@ -284,15 +275,17 @@ GRenderPhongStrategy.prototype.initShaders = function (shaderSrcMap)
     this.programs = {};
     
     this.programs.phongComposite = new ShaderComposite( shaderSrcMap["phong-vs.c"], shaderSrcMap["phong-fs.c"] ); 
-    this.programs.objidComposite = new ShaderComposite( shaderSrcMap["objid-vs.c"], shaderSrcMap["objid-fs.c"] );
     
     this.programs.fullScr  = new GShader( shaderSrcMap["fullscr-vs.c"],  shaderSrcMap["fullscr-fs.c"] );
     this.programs.fxaa     = new GShader( shaderSrcMap["fxaa-vs.c"],     shaderSrcMap["fxaa-fs.c"] );
     this.programs.objidscr = new GShader( shaderSrcMap["objidscr-vs.c"], shaderSrcMap["objidscr-fs.c"]       );
     
+    this.pendingPrograms = [];
+    
     for ( var key in this.programs )
     {
-        this.programs[key].bindToContext(gl);
+        this.programs[key].startCompile(gl);
+        this.pendingPrograms.push(this.programs[key]);
     }
 };
 
@@ -340,9 +333,8 @@ GRenderPhongStrategy.prototype.drawScreenBuffer = function(shader)
 GRenderPhongStrategy.prototype.initPassCmds = function()
 {   
     var colorPass = new GGeometryRenderPassCmd( this.gl, this.programs.phongComposite, this.frameBuffers.color );
-    var objidPass = new GGeometryRenderPassCmd( this.gl, this.programs.objidComposite, this.frameBuffers.objid );
     
-    this.passes = [ colorPass, objidPass ];
+    this.passes = [ colorPass ];
 };
     
 
@@ -353,7 +345,6 @@ GRenderPhongStrategy.prototype.initPassCmds = function()
  */
 GRenderPhongStrategy.prototype.draw = function ( scene, hud )
 {
-    this.lastScene = scene;
     var gl = this.gl;
     gl.disable(gl.BLEND);
     
@@ -384,44 +375,6 @@ GRenderPhongStrategy.prototype.draw = function ( scene, hud )
 
 GRenderPhongStrategy.tempObjIdA = new Uint8Array(4);
 
-/**
- * Get the 3d position of the pixel at the provided mouse location
- * @param {number} x
- * @param {number} y
- * @return {Float32Array}
- */
-GRenderPhongStrategy.prototype.ge3dPositionAt = function(x, y)
-{
-    this.frameBuffers.objid.getColorValueAt(x, y, GRenderPhongStrategy.tempObjIdA);
-
-    var zVal = ( GRenderPhongStrategy.tempObjIdA[2] + (GRenderPhongStrategy.tempObjIdA[3]/256.0) ) / 256.0;
-    var ret = vec4.fromValues(2*(x/1024.0) - 1.0, 2*(y/1024.0) - 1.0, 2*zVal - 1.0, 1.0);
-
-    if ( undefined !== this.lastScene )
-    {
-        var camera = this.lastScene.getCamera();
-        camera.inverseProject( ret );
-    }
-
-    ret[0] /= ret[3];ret[1] /= ret[3];
-    ret[2] /= ret[3];ret[3] /= ret[3];
-
-    return ret;
-};
-
-/**
- * Get the object id of the object at the provided mouse location
- * @param {number} x
- * @param {number} y
- */
-GRenderPhongStrategy.prototype.getObjectIdAt = function ( x, y )
-{
-    this.frameBuffers.objid.getColorValueAt(x, y, GRenderPhongStrategy.tempObjIdA);
-    
-    return ( GRenderPhongStrategy.tempObjIdA[0] << 8  |
-             GRenderPhongStrategy.tempObjIdA[1] );
-};
-
 /**
  * Get the object id of the object at the provided mouse location
  * @param {number} x
@@ -429,11 +382,11 @@ GRenderPhongStrategy.prototype.getObjectIdAt = function ( x, y )
  */
 GRenderPhongStrategy.prototype.getHudObjectIdAt = function ( x, y )
 {
-    this.frameBuffers.objidHud.getColorValueAt(x, y, GRenderDeferredStrategy.tempObjIdA);
+    this.frameBuffers.objidHud.getColorValueAt(x, y, GRenderPhongStrategy.tempObjIdA);
     
-    return ( GRenderDeferredStrategy.tempObjIdA[0] << 16 |
-             GRenderDeferredStrategy.tempObjIdA[1] << 8  |
-             GRenderDeferredStrategy.tempObjIdA[2] );
+    return ( GRenderPhongStrategy.tempObjIdA[0] << 16 |
+             GRenderPhongStrategy.tempObjIdA[1] << 8  |
+             GRenderPhongStrategy.tempObjIdA[2] );
 };
 
 
@@ -20,7 +20,7 @@
 
 /**
  * @constructor
- * @param {Array.<number>} Buffer containing the skin properties
+ * @param {Array.<number>|Float32Array} Buffer containing the skin properties
  */
 function Skin( sverts )
 {
@@ -28,7 +28,8 @@ function Skin( sverts )
 } 
 
 /**
- * Draw this object
+ * Point the skin attribute of the shader to the buffer of this skin, the 
+ * mesh it is set on calls it while binding its attributes
  * @param {GShader} Shader program to use for rendering
  */
 Skin.prototype.draw = function( shader )
@@ -39,7 +40,7 @@ Skin.prototype.draw = function( shader )
     {
         gl.bindBuffer( gl.ARRAY_BUFFER, this.svertBuffer );
         gl.vertexAttribPointer( shader.attributes.skinVertexAttribute, 
-                                this.svertBuffer.itemSize, gl.FLOAT, false, 0, 0 );
+                                this.svertBuffer.itemSize, this.svertType, false, 0, 0 );
     } 
 };
 
@@ -59,9 +60,32 @@ Skin.prototype.bindToContext = function( gl )
 {
     this.gl = gl;
     
+    var sverts;
+    
+    if ( Mesh.isQuantizationEnabled( gl ) )
+    {
+        // bone indices and weights in bytes, the weights are scaled back by
+        // the shader
+        sverts = new Uint8Array( this.svertA.length );
+        for ( var i = 0; i < sverts.length; i += 4 )
+        {
+            sverts[i]   = this.svertA[i];
+            sverts[i+1] = this.svertA[i+1];
+            sverts[i+2] = Math.round( Math.max( 0, Math.min( 1, this.svertA[i+2] ) ) * 255 );
+            sverts[i+3] = Math.round( Math.max( 0, Math.min( 1, this.svertA[i+3] ) ) * 255 );
+        }
+        
+        this.svertType = gl.UNSIGNED_BYTE;
+    }
+    else
+    {
+        sverts = Mesh.toFloat32Array( this.svertA );
+        this.svertType = gl.FLOAT;
+    }
+    
     this.svertBuffer = gl.createBuffer();
     gl.bindBuffer(gl.ARRAY_BUFFER, this.svertBuffer); 
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(this.svertA), gl.STATIC_DRAW);
+    gl.bufferData(gl.ARRAY_BUFFER, sverts, gl.STATIC_DRAW);
     this.svertBuffer.itemSize = 4;
     this.svertBuffer.numItems = this.svertA.length/4;
 };
@@ -29,9 +29,11 @@ function GGroup( name )
     
 	this.name = name;
 	this.children = [];
-    this.drawMvMatrix = mat4.create(); 
 	this.mvMatrix = mat4.create();
+	this.worldMatrix = mat4.create();
 	this.gl = undefined;
+	this.bounds = new GBounds();
+	this.boundsDirty = true;
 } 
 
 GGroup.prototype = Object.create( SceneDrawable.prototype );
@@ -66,6 +68,116 @@ GGroup.prototype.getName = function()
 GGroup.prototype.setMvMatrix = function(mat)
 {
     mat4.copy(this.mvMatrix, mat);
+    this.isTransformDirty = true;
+    this.invalidateParentBounds();
+};
+
+/**
+ * Recalculate the world matrix of this group if it or its parent moved since
+ * the last call and let the children do the same
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+GGroup.prototype.updateWorldMatrix = function( parentWorldMatrix, isParentChanged )
+{
+    var isChanged = isParentChanged || this.isTransformDirty;
+    
+    if ( isChanged )
+    {
+        mat4.multiply(this.worldMatrix, parentWorldMatrix, this.mvMatrix);
+        this.isTransformDirty = false;
+    }
+    
+    var childCount = this.children.length;
+    for (var i = 0; i < childCount; ++i)
+    {
+        this.children[i].updateWorldMatrix( this.worldMatrix, isChanged );
+    }
+};
+
+/**
+ * Mark the bounds of this group and the groups above it for recalculation
+ */
+GGroup.prototype.invalidateBounds = function()
+{
+    // a group is only clean when everything below it is, so the groups 
+    // above a dirty one are dirty already
+    if ( !this.boundsDirty )
+    {
+        this.boundsDirty = true;
+        this.invalidateParentBounds();
+    }
+};
+
+/**
+ * Get the bounds of the children of this group in the space of the group, 
+ * they are recalculated when they are needed after something below the 
+ * group moved
+ * @return {GBounds}
+ */
+GGroup.prototype.getBounds = function()
+{
+    if ( this.boundsDirty )
+    {
+        this.bounds.reset();
+        
+        var childCount = this.children.length;
+        for (var i = 0; i < childCount; ++i)
+        {
+            if ( !this.children[i].addBoundsTo( this.bounds ) )
+            {
+                this.bounds.setInfinite();
+            }
+        }
+        
+        this.boundsDirty = false;
+    }
+    
+    return this.bounds;
+};
+
+/**
+ * Add the bounds of this group, in the space of its parent, to the provided
+ * bounds
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+GGroup.prototype.addBoundsTo = function( outBounds )
+{
+    outBounds.addBounds( this.getBounds(), this.mvMatrix );
+    return !this.bounds.isInfinite();
+};
+
+/**
+ * Add the meshes under this group to the picking hierarchy of the scene
+ * @param {GSceneBvh} bvh
+ */
+GGroup.prototype.addPickItems = function( bvh )
+{
+    var childCount = this.children.length;
+    for (var i = 0; i < childCount; ++i)
+    {
+        this.children[i].addPickItems( bvh );
+    }
+};
+
+/**
+ * Add the drawables under this group to the render queue of the scene, the
+ * passes classify the bounds of the group before the drawables, see 
+ * GRenderQueue.classifyGroups
+ * @param {GRenderQueue} queue
+ */
+GGroup.prototype.addToRenderQueue = function( queue )
+{
+    queue.beginGroup( this );
+    
+    var childCount = this.children.length;
+    for (var i = 0; i < childCount; ++i)
+    {
+        this.children[i].addToRenderQueue( queue );
+    }
+    
+    queue.endGroup();
 };
    
 /**
@@ -102,7 +214,10 @@ GGroup.prototype.addChild = function( child )
 {
 	child.bindToContext( this.gl );
 	child.setObserver( this.observer );
+	child.setParent( this );
 	this.children.push( child );
+	this.invalidateBounds();
+	this.notifyChanged();
 };
 
 /**
@@ -113,24 +228,17 @@ GGroup.prototype.removeChild = function( child )
 {
     this.children.splice( this.children.indexOf( child ), 1 );
     
+    if ( this === child.parent )
+    {
+        child.setParent( undefined );
+    }
+    
+    this.invalidateBounds();
+    this.notifyChanged();
+    
     return child;
 };
 
-/**
- * Draw this group
- * @param {Array.<number>} List of numbers representing the parent 4 by 4 view matrix
- * @param {Array.<GMaterial>} List of materials to use for rendering
- * @param {GShader} Shader program to use for rendering
- * @param {number} Draw mode for drawing the VBOs
- */
-GGroup.prototype.draw = function( parentMvMat, materials, shader, drawMode )
-{
-	mat4.multiply(this.drawMvMatrix, parentMvMat, this.mvMatrix);
-	var childCount = this.children.length;
-	for (var i = 0; i < childCount; ++i)
-	{
-		this.children[i].draw(this.drawMvMatrix, materials, shader, drawMode);
-	}
-};
+
 
 
@@ -21,20 +21,31 @@
 /**
  * @constructor
  * @extends {SceneDrawable}
- * @param {Array.<number>} verts Buffer containing the vertices for this object
- * @param {Array.<number>} tverts Buffer containing the texture vertices for this object
- * @param {Array.<number>} normals Buffer containing the normals for this object
- * @param {Array.<number>} indices Buffer containing the indices for this object
+ * @param {Array.<number>|Float32Array} verts Buffer containing the vertices for this object
+ * @param {Array.<number>|Float32Array} tverts Buffer containing the texture vertices for this object
+ * @param {Array.<number>|Float32Array} normals Buffer containing the normals for this object
+ * @param {Array.<number>|Uint16Array|Uint32Array} indices Buffer containing the indices for this object
  * @param {string} name Name for this object
  */
 function Mesh( verts, tverts, normals, indices, name )
 {
     SceneDrawable.call( this );
      
-    this.vertBuffer = undefined;
-    this.tverBuffer = undefined;
-    this.normlBuffer = undefined;
+    this.vertexBuffer = undefined;
     this.indexBuffer = undefined;
+    this.indexType = undefined;
+    this.attributeType = undefined;
+    this.vertexStride = 0;
+    this.normalOffset = 0;
+    this.normalSize = 3;
+    this.textureOffset = 0;
+    this.vertexArrays = {};
+    this.skin = undefined;
+    this.instances = undefined;
+    this.occluder = false;
+    this.quantized = false;
+    this.positionDecode = undefined;
+    this.textureDecode = undefined;
     this.vertA = verts;
     this.tverA = tverts;
     this.normA = normals;
@@ -46,12 +57,155 @@ function Mesh( verts, tverts, normals, indices, name )
     this.mtlName = undefined;
     this.material = undefined;
     this.valid = true;
-    this.drawMvMatrix = mat4.create();
+    this.worldMatrix = mat4.create();
     this.normalMatrix = mat4.create();
+    this.localBounds = undefined;
 }
 
 Mesh.prototype = Object.create( SceneDrawable.prototype );
 
+/**
+ * Typed arrays (e.g. the ones decoded by the worker pool) are uploaded as they
+ * are, plain arrays get copied into a new Float32Array
+ * @param {Array.<number>|Float32Array} array
+ * @return {Float32Array}
+ */
+Mesh.toFloat32Array = function( array )
+{
+    return (array instanceof Float32Array) ? array : new Float32Array(array);
+};
+
+/**
+ * Returns true if the meshes bound to the context upload their attributes
+ * quantized, see GContext.enableQuantizedAttributes
+ * @param {WebGLRenderingContext} gl
+ * @return {boolean}
+ */
+Mesh.isQuantizationEnabled = function( gl )
+{
+    return true === gl.quantizedAttributes;
+};
+
+/**
+ * Quantize values to normalized shorts inside the range they cover, value = 
+ * offset + scale * short / 32767
+ * @param {Array.<number>|Float32Array} values
+ * @param {number} size Number of components per vertex
+ * @param {Array.<number>} scale Receives the scale of every component
+ * @param {Array.<number>} offset Receives the offset of every component
+ * @return {Int16Array}
+ */
+Mesh.quantizeToShorts = function( values, size, scale, offset )
+{
+    var out = new Int16Array( values.length );
+    var i = 0;
+    var k = 0;
+    
+    for ( k = 0; k < size; ++k )
+    {
+        var min = Infinity;
+        var max = -Infinity;
+        
+        for ( i = k; i < values.length; i += size )
+        {
+            min = Math.min( min, values[i] );
+            max = Math.max( max, values[i] );
+        }
+        
+        offset[k] = ( values.length > 0 ) ? ( min + max ) / 2 : 0;
+        scale[k] = ( values.length > 0 ) ? ( max - min ) / 2 : 0;
+        
+        var inverse = ( scale[k] > 0 ) ? 1 / scale[k] : 0;
+        
+        for ( i = k; i < values.length; i += size )
+        {
+            var n = ( values[i] - offset[k] ) * inverse;
+            out[i] = Math.round( Math.max( -1, Math.min( 1, n ) ) * 32767 );
+        }
+    }
+    
+    return out;
+};
+
+/**
+ * Encode unit normals as two normalized shorts by projecting them on an 
+ * octahedron and unfolding its lower half
+ * @param {Array.<number>|Float32Array} normals
+ * @return {Int16Array}
+ */
+Mesh.octEncodeNormals = function( normals )
+{
+    var count = normals.length / 3;
+    var out = new Int16Array( 2 * count );
+    
+    for ( var i = 0; i < count; ++i )
+    {
+        var x = normals[3*i];
+        var y = normals[3*i+1];
+        var z = normals[3*i+2];
+        var l1 = Math.abs( x ) + Math.abs( y ) + Math.abs( z );
+        
+        if ( l1 > 0 )
+        {
+            x /= l1;
+            y /= l1;
+        }
+        
+        if ( z < 0 )
+        {
+            var ox = ( 1 - Math.abs( y ) ) * ( ( x >= 0 ) ? 1 : -1 );
+            var oy = ( 1 - Math.abs( x ) ) * ( ( y >= 0 ) ? 1 : -1 );
+            x = ox;
+            y = oy;
+        }
+        
+        out[2*i]   = Math.round( Math.max( -1, Math.min( 1, x ) ) * 32767 );
+        out[2*i+1] = Math.round( Math.max( -1, Math.min( 1, y ) ) * 32767 );
+    }
+    
+    return out;
+};
+
+/**
+ * Returns true if the context can draw with 32 bit indices, either because 
+ * it's a WebGL2 context or because OES_element_index_uint could be enabled
+ * @param {WebGLRenderingContext} gl
+ * @return {boolean}
+ */
+Mesh.isUintIndexSupported = function( gl )
+{
+    if ( undefined === gl.isUintIndexSupported )
+    {
+        gl.isUintIndexSupported = 
+            ( typeof WebGL2RenderingContext !== "undefined" && gl instanceof WebGL2RenderingContext ) ||
+            null !== gl.getExtension( "OES_element_index_uint" );
+    }
+    
+    return gl.isUintIndexSupported;
+};
+
+/**
+ * Returns true if the meshes keep their attribute bindings in vertex array
+ * objects, see GStateCache.isVertexArraySupported
+ * @param {WebGLRenderingContext} gl
+ * @return {boolean}
+ */
+Mesh.isVertexArraySupported = function( gl )
+{
+    return undefined !== gl.isVertexArraySupported && gl.isVertexArraySupported();
+};
+
+/**
+ * Returns true if the context can draw instances, see 
+ * GStateCache.isInstancingSupported
+ * @param {WebGLRenderingContext} gl
+ * @return {boolean}
+ */
+Mesh.isInstancingSupported = function( gl )
+{
+    return undefined !== gl && undefined !== gl.isInstancingSupported && gl.isInstancingSupported();
+};
+
 /**
  * Get the name of this object
  * @return {string} The name of this object
@@ -71,6 +225,45 @@ Mesh.prototype.setMtlName = function( mName )
     this.material = undefined;
 };
 
+/**
+ * Set the skin whose attribute is bound along with the attributes of this
+ * object
+ * @param {Skin} skin
+ */
+Mesh.prototype.setSkin = function( skin )
+{
+    this.skin = skin;
+};
+
+/**
+ * Set the instanced mesh whose per instance attribute is bound along with 
+ * the attributes of this object
+ * @param {InstancedMesh} instances
+ */
+Mesh.prototype.setInstances = function( instances )
+{
+    this.instances = instances;
+};
+
+/**
+ * Set whether this object hides the objects behind it when the scene culls
+ * occluded objects, see GScene.setOcclusionCulling
+ * @param {boolean} isOccluder
+ */
+Mesh.prototype.setOccluder = function( isOccluder )
+{
+    this.occluder = isOccluder;
+};
+
+/**
+ * Get the mesh rasterized into the occlusion buffer for this object
+ * @return {Mesh|undefined} Undefined if this object is not an occluder
+ */
+Mesh.prototype.getOccluderMesh = function()
+{
+    return this.occluder ? this : undefined;
+};
+
 /**
  * Set the model view matrix for this object
  * @param {Float32Array} mat Array of numbers representing the 4 by 4 model view matrix
@@ -78,6 +271,75 @@ Mesh.prototype.setMtlName = function( mName )
 Mesh.prototype.setMvMatrix = function( mat )
 {
     mat4.copy(this.mvMatrix, mat);
+    this.isTransformDirty = true;
+    this.invalidateParentBounds();
+};
+
+/**
+ * Recalculate the world and normal matrices of this object if it or its 
+ * parent moved since the last call
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+Mesh.prototype.updateWorldMatrix = function( parentWorldMatrix, isParentChanged )
+{
+    if ( !isParentChanged && !this.isTransformDirty )
+    {
+        return;
+    }
+    
+    mat4.multiply(this.worldMatrix, parentWorldMatrix, this.mvMatrix);
+    
+    // mat4 normalMatrix = transpose(inverse(world));
+    mat4.invert(this.normalMatrix, this.worldMatrix);
+    mat4.transpose(this.normalMatrix, this.normalMatrix);
+    
+    this.isTransformDirty = false;
+};
+
+/**
+ * Get the bounds of the vertices of this object, they are calculated when 
+ * the mesh is uploaded or the first time they are needed
+ * @return {GBounds}
+ */
+Mesh.prototype.getLocalBounds = function()
+{
+    if ( undefined === this.localBounds )
+    {
+        this.localBounds = GBounds.fromVertices( this.vertA || [] );
+    }
+    
+    return this.localBounds;
+};
+
+/**
+ * Add the bounds of this object, in the space of its parent, to the 
+ * provided bounds
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+Mesh.prototype.addBoundsTo = function( outBounds )
+{
+    outBounds.addBounds( this.getLocalBounds(), this.mvMatrix );
+    return true;
+};
+
+/**
+ * Add this object to the picking hierarchy of the scene
+ * @param {GSceneBvh} bvh
+ */
+Mesh.prototype.addPickItems = function( bvh )
+{
+    bvh.addMesh( this.getObjId(), this, this, this.worldMatrix );
+};
+
+/**
+ * Add this object to the render queue of the scene
+ * @param {GRenderQueue} queue
+ */
+Mesh.prototype.addToRenderQueue = function( queue )
+{
+    queue.add( this, this, GRenderQueue.MESH );
 };
    
 /**
@@ -92,37 +354,116 @@ Mesh.prototype.bindToContext = function(gl_)
     this.gl = gl_;
     var gl = this.gl;
     
-    this.vertBuffer = gl.createBuffer();
-    gl.bindBuffer(gl.ARRAY_BUFFER, this.vertBuffer); 
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(this.vertA), gl.STATIC_DRAW);
-    this.vertBuffer.itemSize = 3;
-    this.vertBuffer.numItems = this.vertA.length/3;
+    var verts = this.vertA;
+    var tverts = this.tverA;
+    var normals = this.normA;
+    var count = this.vertA.length/3;
     
-    this.tverBuffer = gl.createBuffer();
-    gl.bindBuffer(gl.ARRAY_BUFFER, this.tverBuffer); 
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(this.tverA), gl.STATIC_DRAW);
-    this.tverBuffer.itemSize = 2;
-    this.tverBuffer.numItems = this.tverA.length/2;
-
-    this.normlBuffer = gl.createBuffer();
-    gl.bindBuffer(gl.ARRAY_BUFFER, this.normlBuffer);
-    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array(this.normA), gl.STATIC_DRAW);
-    this.normlBuffer.itemSize = 3;
-    this.normlBuffer.numItems = this.normA.length/3;
+    // indices may share vertices so only the vertex attributes need to line up
+    if ( this.normA.length/3 !== count || this.tverA.length/2 !== count )
+    {
+        console.debug("Mesh: index missmatch [" + this.name + "]");
+        this.valid = false;
+        return;
+    }
+    
+    this.quantized = Mesh.isQuantizationEnabled( gl );
+    this.normalSize = 3;
+    this.vertexArrays = {};
+    
+    if ( this.quantized )
+    {
+        // 6 bytes per position, 4 per normal and 4 per texture vertex 
+        // instead of 12, 12 and 8
+        var scale = [ 0, 0, 0 ];
+        var offset = [ 0, 0, 0 ];
+        
+        verts = Mesh.quantizeToShorts( this.vertA, 3, scale, offset );
+        this.positionDecode = mat4.create();
+        mat4.identity( this.positionDecode );
+        this.positionDecode[0]  = scale[0];
+        this.positionDecode[5]  = scale[1];
+        this.positionDecode[10] = scale[2];
+        this.positionDecode[12] = offset[0];
+        this.positionDecode[13] = offset[1];
+        this.positionDecode[14] = offset[2];
+        
+        tverts = Mesh.quantizeToShorts( this.tverA, 2, scale, offset );
+        this.textureDecode = new Float32Array( [ scale[0], scale[1], offset[0], offset[1] ] );
+        
+        normals = Mesh.octEncodeNormals( this.normA );
+        this.normalSize = 2;
+        this.attributeType = gl.SHORT;
+    }
+    else
+    {
+        this.attributeType = gl.FLOAT;
+    }
+    
+    // the attributes of every vertex are interleaved in 8 components, 
+    // [ x, y, z, (pad,) nx, ny, (nz,) u, v ], 16 bytes quantized and 32 as
+    // floats.  The padding keeps the quantized normal 4 byte aligned.
+    var vertices = this.quantized ? new Int16Array( 8 * count ) : new Float32Array( 8 * count );
+    var normalStart = this.quantized ? 4 : 3;
+    var n = this.normalSize;
+    
+    for ( var i = 0; i < count; ++i )
+    {
+        var v = 8 * i;
+        
+        vertices[v]   = verts[3*i];
+        vertices[v+1] = verts[3*i+1];
+        vertices[v+2] = verts[3*i+2];
+        
+        for ( var k = 0; k < n; ++k )
+        {
+            vertices[v+normalStart+k] = normals[n*i+k];
+        }
+        
+        vertices[v+6] = tverts[2*i];
+        vertices[v+7] = tverts[2*i+1];
+    }
+    
+    this.vertexStride = 8 * vertices.BYTES_PER_ELEMENT;
+    this.normalOffset = normalStart * vertices.BYTES_PER_ELEMENT;
+    this.textureOffset = 6 * vertices.BYTES_PER_ELEMENT;
+    
+    this.vertexBuffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.vertexBuffer); 
+    gl.bufferData(gl.ARRAY_BUFFER, vertices, gl.STATIC_DRAW);
+    this.vertexBuffer.numItems = count;
+    
+    this.getLocalBounds();
+    
+    // 16 bit indices whenever the vertex count allows it, 32 bit ones only 
+    // when the context supports them
+    var indices = this.indxA;
+    this.indexType = gl.UNSIGNED_SHORT;
+    
+    if ( count > 65536 )
+    {
+        if ( Mesh.isUintIndexSupported( gl ) )
+        {
+            indices = (indices instanceof Uint32Array) ? indices : new Uint32Array(indices);
+            this.indexType = gl.UNSIGNED_INT;
+        }
+        else
+        {
+            console.debug("Mesh: too many vertices for 16 bit indices [" + this.name + "]");
+            this.valid = false;
+        }
+    }
+    
+    if ( gl.UNSIGNED_SHORT === this.indexType && !(indices instanceof Uint16Array) )
+    {
+        indices = new Uint16Array(indices);
+    }
     
     this.indexBuffer = gl.createBuffer();
     gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, this.indexBuffer);
-    gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, new Uint16Array(this.indxA), gl.STATIC_DRAW);
+    gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, indices, gl.STATIC_DRAW);
     this.indexBuffer.itemSize = 1;
     this.indexBuffer.numItems = this.indxA.length;
-    
-    if (this.indexBuffer.numItems != this.normlBuffer.numItems  ||
-        this.indexBuffer.numItems != this.tverBuffer.numItems || 
-        this.indexBuffer.numItems != this.vertBuffer.numItems)
-    {
-        console.debug("Mesh: index missmatch [" + this.name + "]");
-        this._valid = false;
-    }
 };
 
 /**
@@ -130,95 +471,223 @@ Mesh.prototype.bindToContext = function(gl_)
  */
 Mesh.prototype.deleteResources = function () 
 {
-    this.gl.deleteBuffer( this.vertBuffer );
-    this.gl.deleteBuffer( this.tverBuffer );
-    this.gl.deleteBuffer( this.normlBuffer );
+    for ( var layout in this.vertexArrays )
+    {
+        this.gl.deleteVertexArray( this.vertexArrays[layout] );
+    }
+    
+    this.vertexArrays = {};
+    this.gl.deleteBuffer( this.vertexBuffer );
     this.gl.deleteBuffer( this.indexBuffer );
     this.valid = false;
 };
 
 /**
- * Draw this object
- * @param {Float32Array} parentMvMat List of numbers representing the parent 4 by 4 view matrix
- * @param {Array.<GMaterial>} materials List of materials to use for rendering
+ * Get the material this object is drawn with, it is looked up by name the
+ * first time
+ * @param {Object.<string, GMaterial>} materials Materials of the scene
+ * @return {GMaterial|undefined}
+ */
+Mesh.prototype.getMaterial = function( materials )
+{
+    if ( this.material === undefined &&
+         this.mtlName !== undefined )
+    {
+        this.material = materials[this.mtlName];
+    }
+    
+    return this.material;
+};
+
+/**
+ * Point the attributes of the shader to the interleaved buffer, the skin and
+ * the instances of this object and bind its index buffer
  * @param {GShader} shader Shader program to use for rendering
- * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {boolean} enable True to enable the attribute arrays as well, they
+ *        are part of the state of a vertex array object
  */
-Mesh.prototype.draw = function( parentMvMat, materials, shader, drawMode )
+Mesh.prototype.setupAttributes = function( shader, enable )
 {
-   if ( !this.valid ) return;
-   
-   var gl = this.gl;
-   
-    if (shader.attributes.positionVertexAttribute > -1)
+    var gl = this.gl;
+    var attributes = shader.attributes;
+    
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.vertexBuffer);
+    
+    if (attributes.positionVertexAttribute > -1)
     {
-        gl.bindBuffer(gl.ARRAY_BUFFER, this.vertBuffer);
-        gl.vertexAttribPointer(shader.attributes.positionVertexAttribute, 
-                               this.vertBuffer.itemSize, gl.FLOAT, false, 0, 0);
+        gl.vertexAttribPointer(attributes.positionVertexAttribute, 3, this.attributeType, 
+                               this.quantized, this.vertexStride, 0);
     }
 
-    if (shader.attributes.normalVertexAttribute > -1)
+    if (attributes.normalVertexAttribute > -1)
     {
-        gl.bindBuffer(gl.ARRAY_BUFFER, this.normlBuffer);
-        gl.vertexAttribPointer(shader.attributes.normalVertexAttribute, 
-                               this.normlBuffer.itemSize, gl.FLOAT, false, 0, 0);
+        gl.vertexAttribPointer(attributes.normalVertexAttribute, this.normalSize, this.attributeType, 
+                               this.quantized, this.vertexStride, this.normalOffset);
     }
     
-    if (shader.attributes.textureVertexAttribute > -1)
+    if (attributes.textureVertexAttribute > -1)
     {
-        gl.bindBuffer(gl.ARRAY_BUFFER, this.tverBuffer);
-        gl.vertexAttribPointer(shader.attributes.textureVertexAttribute, 
-                               this.tverBuffer.itemSize, gl.FLOAT, false, 0, 0);
+        gl.vertexAttribPointer(attributes.textureVertexAttribute, 2, this.attributeType, 
+                               this.quantized, this.vertexStride, this.textureOffset);
     }
     
-    var isDrawMvMatrixReady = false;
-    if ( null != shader.uniforms.mvMatrixUniform )
+    if ( undefined !== this.skin )
     {
-        mat4.multiply(this.drawMvMatrix, parentMvMat, this.mvMatrix);
-        isDrawMvMatrixReady = true;
-        gl.uniformMatrix4fv(shader.uniforms.mvMatrixUniform, false, this.drawMvMatrix);
+        this.skin.draw( shader );
     }
     
-    if ( null != shader.uniforms.nMatrixUniform )
+    if ( undefined !== this.instances )
     {
-        if ( !isDrawMvMatrixReady )
+        this.instances.setupInstanceAttributes( shader, enable );
+    }
+    
+    if ( enable )
+    {
+        var locations = [ attributes.positionVertexAttribute, attributes.normalVertexAttribute,
+                          attributes.textureVertexAttribute, attributes.skinVertexAttribute ];
+        
+        for ( var i = 0; i < locations.length; ++i )
         {
-            mat4.multiply(this.drawMvMatrix, parentMvMat, this.mvMatrix);
+            if ( locations[i] > -1 )
+            {
+                gl.enableVertexAttribArray( locations[i] );
+            }
         }
-        
-        // mat4 normalMatrix = transpose(inverse(modelView));
-        mat4.invert(this.normalMatrix, this.drawMvMatrix);
-        mat4.transpose(this.normalMatrix, this.normalMatrix);
-        
-        gl.uniformMatrix4fv(shader.uniforms.nMatrixUniform, false, this.normalMatrix);
     }
     
-    if ( this.material === undefined &&
-         this.mtlName !== undefined )
+    gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, this.indexBuffer);
+};
+
+/**
+ * Bind the geometry of this object for the shader.  With vertex array 
+ * objects it is a single bind of the one created for the attribute layout 
+ * of the shader the first time, without them the attributes are pointed to
+ * the buffers again.  Objects sharing the buffers can be drawn with 
+ * drawGeometry without binding them again.
+ * @param {GShader} shader Shader program to use for rendering
+ */
+Mesh.prototype.bindGeometry = function( shader )
+{
+    var gl = this.gl;
+    
+    if ( Mesh.isVertexArraySupported( gl ) )
     {
-        this.material = materials[this.mtlName];
+        var layout = shader.getAttributeLayout();
+        var vertexArray = this.vertexArrays[layout];
+        
+        if ( undefined === vertexArray )
+        {
+            vertexArray = gl.createVertexArray();
+            this.vertexArrays[layout] = vertexArray;
+            
+            gl.bindVertexArray( vertexArray );
+            this.setupAttributes( shader, true );
+        }
+        else
+        {
+            gl.bindVertexArray( vertexArray );
+        }
+    }
+    else
+    {
+        this.setupAttributes( shader, false );
     }
     
-    if ( this.material != undefined )
+    if ( this.quantized )
+    {
+        if ( null != shader.uniforms.positionDecode )
+        {
+            gl.uniformMatrix4fv(shader.uniforms.positionDecode, false, this.positionDecode);
+        }
+        
+        if ( null != shader.uniforms.textureDecode )
+        {
+            gl.uniform4fv(shader.uniforms.textureDecode, this.textureDecode);
+        }
+    }
+};
+
+/**
+ * Go back to the default vertex array once the objects are drawn, the 
+ * screen buffers and the HUD point the attributes of the default one
+ */
+Mesh.prototype.unbindGeometry = function()
+{
+    if ( Mesh.isVertexArraySupported( this.gl ) )
+    {
+        this.gl.bindVertexArray( null );
+    }
+};
+
+/**
+ * Send the world and normal matrices to the shader
+ * @param {GShader} shader Shader program to use for rendering
+ * @param {Float32Array} worldMatrix
+ * @param {Float32Array} normalMatrix
+ */
+Mesh.prototype.uploadMatrices = function( shader, worldMatrix, normalMatrix )
+{
+    if ( null != shader.uniforms.mMatrixUniform )
     {
-        this.material.draw( shader );
+        this.gl.uniformMatrix4fv(shader.uniforms.mMatrixUniform, false, worldMatrix);
     }
     
-    if ( null != shader.uniforms.objid )
+    if ( null != shader.uniforms.nMatrixUniform )
+    {
+        this.gl.uniformMatrix4fv(shader.uniforms.nMatrixUniform, false, normalMatrix);
+    }
+};
+
+/**
+ * Issue the draw call for the geometry bound by bindGeometry
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {number=} instanceCount Number of instances to draw with a single 
+ *        instanced call, see InstancedMesh
+ */
+Mesh.prototype.drawGeometry = function( drawMode, instanceCount )
+{
+    if ( undefined === instanceCount )
+    {
+        this.gl.drawElements(drawMode, this.indexBuffer.numItems, this.indexType, 0);
+    }
+    else
     {
-        gl.uniform4fv(shader.uniforms.objid, this.objid);
+        this.gl.drawElementsInstanced(drawMode, this.indexBuffer.numItems, this.indexType, 0, instanceCount);
     }
+};
+
+/**
+ * Draw this object with the world and normal matrices calculated by the 
+ * last updateWorldMatrix, the view matrix is set by the camera
+ * @param {Float32Array} viewMat List of numbers representing the 4 by 4 view matrix
+ * @param {Array.<GMaterial>} materials List of materials to use for rendering
+ * @param {GShader} shader Shader program to use for rendering
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum World space frustum of the camera, nothing is 
+ *        drawn if the object is outside of it
+ */
+Mesh.prototype.draw = function( viewMat, materials, shader, drawMode, frustum )
+{
+   if ( !this.valid ) return;
+   
+   if ( undefined !== frustum &&
+        GFrustum.OUTSIDE === frustum.classify( this.getLocalBounds(), this.worldMatrix ) )
+   {
+       return;
+   }
+   
+    this.bindGeometry( shader );
+    this.uploadMatrices( shader, this.worldMatrix, this.normalMatrix );
+    
+    var material = this.getMaterial( materials );
     
-    if (this.indexBuffer.numItems !=  this.normlBuffer.numItems  ||
-        this.indexBuffer.numItems !=  this.tverBuffer.numItems || 
-        this.indexBuffer.numItems != this.vertBuffer.numItems)
+    if ( material != undefined )
     {
-        console.debug("Mesh: index missmatch [" + this.name + "]");
-        this.valid = false;
+        material.draw( shader );
     }
     
-    gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, this.indexBuffer);
-    gl.drawElements(drawMode, this.indexBuffer.numItems, gl.UNSIGNED_SHORT, 0);
+    this.drawGeometry( drawMode );
+    this.unbindGeometry();
 };
 
 
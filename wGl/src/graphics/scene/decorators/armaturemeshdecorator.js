@@ -27,6 +27,8 @@
  */
 function ArmatureMeshDecorator( mesh, skin, bones )
 {
+    MeshDecorator.call( this, mesh );
+    
     this.rootBones = [];
     this.bones = bones;
     this.skin = skin;
@@ -55,13 +57,34 @@ function ArmatureMeshDecorator( mesh, skin, bones )
     
     this.boneMatrixCollection = new Float32Array( this.bones.length * 32 ); // 16 for vert mat and 16 for normal mat
     
-    MeshDecorator.call( this, mesh );
+    mesh.setSkin( skin );
 } 
 
 ArmatureMeshDecorator.prototype = Object.create( MeshDecorator.prototype );
 
 /**
- * Draw this object
+ * Skinned vertices move away from the rest pose the bounds are calculated 
+ * for, so this object is never culled
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+ArmatureMeshDecorator.prototype.addBoundsTo = function( outBounds )
+{
+    return false;
+};
+
+/**
+ * Add this object to the render queue of the scene, it is drawn after the 
+ * other records with the armature variant of the shaders
+ * @param {GRenderQueue} queue
+ */
+ArmatureMeshDecorator.prototype.addToRenderQueue = function( queue )
+{
+    queue.add( this, this.mesh, GRenderQueue.ARMATURE );
+};
+
+/**
+ * Draw this object, the frustum is ignored, see addBoundsTo
  * @param {Array.<number>} List of numbers representing the parent 4 by 4 view matrix
  * @param {Array.<GMaterial>} List of materials to use for rendering
  * @param {GShader} Shader program to use for rendering
@@ -69,21 +92,8 @@ ArmatureMeshDecorator.prototype = Object.create( MeshDecorator.prototype );
  */
 ArmatureMeshDecorator.prototype.draw = function( parentMvMat, materials, shader, drawMode )
 {
-    if ( null === shader.uniforms.aMatrixUniform )
-    {
-        var dCommand = new DrawCommand( this, parentMvMat, materials, drawMode );
-        if ( this.requestDeferredDraw( dCommand, SceneDrawableDeferConditionCode.ARMATURE_REQUEST) )
-        {
-            // the current shader does not have armature support and we are 
-            // going to defer until we have a more suitable shader
-            return;
-        }
-    }
-    
     var gl = this.gl; 
     
-    this.skin.draw( shader );
-    
     for ( var i in this.rootBones )
     {
         this.rootBones[i].calculateMatrices( this.identMat );
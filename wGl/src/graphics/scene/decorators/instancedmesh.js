@@ -0,0 +1,326 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Mesh drawn many times with one draw call.  Every instance has its own 
+ * transformation in the space of the mesh and its own object id for 
+ * picking, the matrices are uploaded to a buffer read once per instance 
+ * through ANGLE_instanced_arrays or WebGL2.  Contexts without instancing
+ * get one queue record per instance instead, they share the buffers of the
+ * mesh so they are still drawn without binding anything in between.
+ * @constructor
+ * @extends {MeshDecorator}
+ * @param {Mesh} mesh Mesh every instance draws
+ */
+function InstancedMesh( mesh )
+{
+    MeshDecorator.call( this, mesh );
+    
+    this.instanceMatrices = [];
+    this.instanceIds = [];
+    this.instanceWorlds = [];
+    this.instanceNormals = [];
+    this.instanceBuffer = undefined;
+    this.isInstanceBufferDirty = false;
+    this.areInstanceWorldsDirty = false;
+    this.instanceBounds = new GBounds();
+    
+    mesh.setInstances( this );
+}
+
+InstancedMesh.prototype = Object.create( MeshDecorator.prototype );
+
+/**
+ * Add an instance of the mesh
+ * @param {Float32Array} mat Transformation of the instance in the space of 
+ *        the mesh, the normals are transformed by it as well so it should 
+ *        only rotate, translate and scale uniformly
+ * @return {number} Object id of the instance, see GScene.intersectRay
+ */
+InstancedMesh.prototype.addInstance = function( mat )
+{
+    var instanceMatrix = mat4.clone( mat );
+    var objId = SceneDrawable.instanceCounter;
+    SceneDrawable.instanceCounter += 1;
+    
+    this.instanceMatrices.push( instanceMatrix );
+    this.instanceIds.push( objId );
+    this.instanceWorlds.push( mat4.create() );
+    this.instanceNormals.push( mat4.create() );
+    
+    this.instanceBounds.addBounds( this.mesh.getLocalBounds(), instanceMatrix );
+    this.isInstanceBufferDirty = true;
+    this.areInstanceWorldsDirty = true;
+    this.invalidateParentBounds();
+    
+    return objId;
+};
+
+/**
+ * @return {number} Number of instances
+ */
+InstancedMesh.prototype.getInstanceCount = function()
+{
+    return this.instanceMatrices.length;
+};
+
+/**
+ * Find the instance with an object id returned by addInstance
+ * @param {number} objId
+ * @return {number} Index of the instance, -1 if it isn't one of this object
+ */
+InstancedMesh.prototype.getInstanceIndex = function( objId )
+{
+    return this.instanceIds.indexOf( objId );
+};
+
+/**
+ * Recalculate the world matrices of the instances along with the one of the
+ * mesh
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+InstancedMesh.prototype.updateWorldMatrix = function( parentWorldMatrix, isParentChanged )
+{
+    var isChanged = isParentChanged || this.isTransformDirty || this.mesh.isTransformDirty;
+    
+    MeshDecorator.prototype.updateWorldMatrix.call( this, parentWorldMatrix, isParentChanged );
+    
+    if ( !isChanged && !this.areInstanceWorldsDirty )
+    {
+        return;
+    }
+    
+    for ( var i = 0; i < this.instanceMatrices.length; ++i )
+    {
+        var world = this.instanceWorlds[i];
+        var normal = this.instanceNormals[i];
+        
+        mat4.multiply( world, this.mesh.worldMatrix, this.instanceMatrices[i] );
+        mat4.invert( normal, world );
+        mat4.transpose( normal, normal );
+    }
+    
+    this.areInstanceWorldsDirty = false;
+};
+
+/**
+ * Get the bounds of all the instances in the space of the mesh
+ * @return {GBounds}
+ */
+InstancedMesh.prototype.getLocalBounds = function()
+{
+    return this.instanceBounds;
+};
+
+/**
+ * Add the bounds of all the instances to the provided bounds
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+InstancedMesh.prototype.addBoundsTo = function( outBounds )
+{
+    outBounds.addBounds( this.instanceBounds, this.mesh.mvMatrix );
+    return true;
+};
+
+/**
+ * Add every instance to the picking hierarchy of the scene with its own 
+ * object id
+ * @param {GSceneBvh} bvh
+ */
+InstancedMesh.prototype.addPickItems = function( bvh )
+{
+    for ( var i = 0; i < this.instanceMatrices.length; ++i )
+    {
+        bvh.addMesh( this.instanceIds[i], this, this.mesh, this.instanceWorlds[i] );
+    }
+};
+
+/**
+ * Add this object to the render queue of the scene, as a single instanced 
+ * record or as one record per instance without instancing
+ * @param {GRenderQueue} queue
+ */
+InstancedMesh.prototype.addToRenderQueue = function( queue )
+{
+    var count = this.instanceMatrices.length;
+    
+    if ( 0 === count )
+    {
+        return;
+    }
+    
+    if ( undefined !== this.instanceBuffer )
+    {
+        queue.add( this, this.mesh, GRenderQueue.INSTANCED );
+        return;
+    }
+    
+    for ( var i = 0; i < count; ++i )
+    {
+        queue.add( this, this.mesh, GRenderQueue.MESH, this.instanceWorlds[i], this.instanceNormals[i] );
+    }
+};
+
+/**
+ * Called to bind this object to a gl context
+ * @param {WebGLRenderingContext} gl Context to bind to this object
+ */
+InstancedMesh.prototype.bindToContext = function( gl )
+{
+    MeshDecorator.prototype.bindToContext.call( this, gl );
+    
+    if ( undefined === gl || gl === this.gl )
+    {
+        return;
+    }
+    
+    this.gl = gl;
+    this.instanceBuffer = Mesh.isInstancingSupported( gl ) ? gl.createBuffer() : undefined;
+    this.isInstanceBufferDirty = true;
+};
+
+/**
+ * Called to delete all the resources under this drawable
+ */
+InstancedMesh.prototype.deleteResources = function () 
+{
+    if ( undefined !== this.instanceBuffer )
+    {
+        this.gl.deleteBuffer( this.instanceBuffer );
+        this.instanceBuffer = undefined;
+    }
+    
+    MeshDecorator.prototype.deleteResources.call( this );
+};
+
+/**
+ * Copy the instance matrices to the instance buffer if instances were added
+ * since the last upload
+ */
+InstancedMesh.prototype.uploadInstances = function()
+{
+    if ( !this.isInstanceBufferDirty )
+    {
+        return;
+    }
+    
+    var gl = this.gl;
+    var data = new Float32Array( 16 * this.instanceMatrices.length );
+    
+    for ( var i = 0; i < this.instanceMatrices.length; ++i )
+    {
+        data.set( this.instanceMatrices[i], 16 * i );
+    }
+    
+    gl.bindBuffer( gl.ARRAY_BUFFER, this.instanceBuffer );
+    gl.bufferData( gl.ARRAY_BUFFER, data, gl.STATIC_DRAW );
+    this.isInstanceBufferDirty = false;
+};
+
+/**
+ * Point the instance matrix of the shader to the instance buffer, the mesh
+ * calls it while binding its attributes.  The matrix takes four locations,
+ * one per column, that advance once per instance.
+ * @param {GShader} shader Shader program to use for rendering
+ * @param {boolean} enable True to enable the attribute arrays as well
+ */
+InstancedMesh.prototype.setupInstanceAttributes = function( shader, enable )
+{
+    var gl = this.gl;
+    var location = shader.attributes.instanceVertexAttribute;
+    
+    if ( location < 0 || undefined === this.instanceBuffer )
+    {
+        return;
+    }
+    
+    gl.bindBuffer( gl.ARRAY_BUFFER, this.instanceBuffer );
+    
+    for ( var i = 0; i < 4; ++i )
+    {
+        gl.vertexAttribPointer( location + i, 4, gl.FLOAT, false, 64, 16 * i );
+        gl.vertexAttribDivisor( location + i, 1 );
+        
+        if ( enable )
+        {
+            gl.enableVertexAttribArray( location + i );
+        }
+    }
+};
+
+/**
+ * Draw all the instances, with a single call if the shader is the instanced
+ * variant and one call per instance otherwise
+ * @param {Float32Array} viewMat List of numbers representing the 4 by 4 view matrix
+ * @param {Array.<GMaterial>} materials List of materials to use for rendering
+ * @param {GShader} shader Shader program to use for rendering
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum World space frustum of the camera
+ */
+InstancedMesh.prototype.draw = function( viewMat, materials, shader, drawMode, frustum )
+{
+    var mesh = this.mesh;
+    var count = this.instanceMatrices.length;
+    
+    if ( !mesh.valid || 0 === count )
+    {
+        return;
+    }
+    
+    if ( undefined !== frustum &&
+         GFrustum.OUTSIDE === frustum.classify( this.instanceBounds, mesh.worldMatrix ) )
+    {
+        return;
+    }
+    
+    var isInstanced = ( shader.attributes.instanceVertexAttribute > -1 );
+    
+    if ( isInstanced )
+    {
+        this.uploadInstances();
+    }
+    
+    mesh.bindGeometry( shader );
+    
+    var material = mesh.getMaterial( materials );
+    
+    if ( material != undefined )
+    {
+        material.draw( shader );
+    }
+    
+    if ( isInstanced )
+    {
+        mesh.uploadMatrices( shader, mesh.worldMatrix, mesh.normalMatrix );
+        mesh.drawGeometry( drawMode, count );
+    }
+    else
+    {
+        for ( var i = 0; i < count; ++i )
+        {
+            mesh.uploadMatrices( shader, this.instanceWorlds[i], this.instanceNormals[i] );
+            mesh.drawGeometry( drawMode );
+        }
+    }
+    
+    mesh.unbindGeometry();
+};
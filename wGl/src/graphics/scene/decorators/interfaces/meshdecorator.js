@@ -51,6 +51,34 @@ MeshDecorator.prototype.setMtlName = function( mName )
     this.mesh.setMtlName( mName );
 };
 
+/**
+ * Set the skin bound along with the attributes of the decorated mesh
+ * @param {Skin} skin
+ */
+MeshDecorator.prototype.setSkin = function( skin )
+{
+    this.mesh.setSkin( skin );
+};
+
+/**
+ * Set the instances bound along with the attributes of the decorated mesh
+ * @param {InstancedMesh} instances
+ */
+MeshDecorator.prototype.setInstances = function( instances )
+{
+    this.mesh.setInstances( instances );
+};
+
+/**
+ * Decorators have no geometry of their own, the ones that can occlude 
+ * provide the mesh to rasterize
+ * @return {Mesh|undefined}
+ */
+MeshDecorator.prototype.getOccluderMesh = function()
+{
+    return undefined;
+};
+
 /**
  * Set the model view matrix for this object
  * @param {Array.<number>} Array of numbers representing the 4 by 4 model view matrix
@@ -58,6 +86,57 @@ MeshDecorator.prototype.setMtlName = function( mName )
 MeshDecorator.prototype.setMvMatrix = function( mat )
 {
 	this.mesh.setMvMatrix( mat );
+	this.invalidateParentBounds();
+};
+
+/**
+ * Recalculate the world matrix of the decorated mesh
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+MeshDecorator.prototype.updateWorldMatrix = function( parentWorldMatrix, isParentChanged )
+{
+    var isChanged = isParentChanged || this.isTransformDirty;
+    this.isTransformDirty = false;
+    
+    this.mesh.updateWorldMatrix( parentWorldMatrix, isChanged );
+};
+
+/**
+ * Get the bounds of the decorated mesh
+ * @return {GBounds}
+ */
+MeshDecorator.prototype.getLocalBounds = function()
+{
+    return this.mesh.getLocalBounds();
+};
+
+/**
+ * Add the bounds of the decorated mesh to the provided bounds
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+MeshDecorator.prototype.addBoundsTo = function( outBounds )
+{
+    return this.mesh.addBoundsTo( outBounds );
+};
+
+/**
+ * Add the decorated mesh to the picking hierarchy of the scene
+ * @param {GSceneBvh} bvh
+ */
+MeshDecorator.prototype.addPickItems = function( bvh )
+{
+    this.mesh.addPickItems( bvh );
+};
+
+/**
+ * Add the decorated mesh to the render queue of the scene
+ * @param {GRenderQueue} queue
+ */
+MeshDecorator.prototype.addToRenderQueue = function( queue )
+{
+    this.mesh.addToRenderQueue( queue );
 };
    
 /**
@@ -79,14 +158,15 @@ MeshDecorator.prototype.deleteResources = function ()
 
 /**
  * Draw this object
- * @param {Array.<number>} List of numbers representing the parent 4 by 4 view matrix
+ * @param {Array.<number>} List of numbers representing the 4 by 4 view matrix of the camera
  * @param {Array.<GMaterial>} List of materials to use for rendering
  * @param {GShader} Shader program to use for rendering
  * @param {number} Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum Frustum of the camera
  */
-MeshDecorator.prototype.draw = function( parentMvMat, materials, shader, drawMode )
+MeshDecorator.prototype.draw = function( parentMvMat, materials, shader, drawMode, frustum )
 {
-	this.mesh.draw( parentMvMat, materials, shader, drawMode );
+	this.mesh.draw( parentMvMat, materials, shader, drawMode, frustum );
 };
 
 
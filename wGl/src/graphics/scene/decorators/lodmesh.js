@@ -0,0 +1,262 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Mesh with levels of detail.  Every time it's drawn the bounding sphere of
+ * the first level is projected through the camera and the level matching its
+ * size on screen is drawn instead of the full resolution mesh.
+ * @constructor
+ * @extends {MeshDecorator}
+ * @param {Array.<Mesh>} levels Meshes from the most to the least detailed
+ * @param {GCamera} camera Camera used to measure the size on screen
+ */
+function LodMesh( levels, camera )
+{
+    this.levels = levels;
+    this.camera = camera;
+    this.center = vec3.create();
+    this.radius = 0;
+    this.currentLevel = 0;
+    this.occluderLevel = 0;
+    this.lodMvMatrix = mat4.create();
+    this.viewCenter = vec3.create();
+    
+    MeshDecorator.call( this, levels[0] );
+    
+    var bounds = levels[0].getLocalBounds();
+    vec3.copy( this.center, bounds.center );
+    this.radius = bounds.radius;
+}
+
+LodMesh.prototype = Object.create( MeshDecorator.prototype );
+
+/**
+ * Level i+1 is drawn once the bounding sphere covers less than 
+ * SCREEN_SIZES[i] of the screen height
+ */
+LodMesh.SCREEN_SIZES = [ 0.4, 0.15, 0.05 ];
+
+/**
+ * Returns the level to draw with the provided view matrix
+ * @param {Float32Array} viewMat
+ * @return {number}
+ */
+LodMesh.prototype.selectLevel = function( viewMat )
+{
+    var m = this.lodMvMatrix;
+    mat4.multiply( m, viewMat, this.levels[0].worldMatrix );
+    vec3.transformMat4( this.viewCenter, this.center, m );
+    
+    // the largest axis scale of the matrix scales the radius
+    var scale = Math.sqrt( Math.max( m[0]*m[0] + m[1]*m[1] + m[2]*m[2],
+                                     m[4]*m[4] + m[5]*m[5] + m[6]*m[6],
+                                     m[8]*m[8] + m[9]*m[9] + m[10]*m[10] ) );
+    var radius = this.radius * scale;
+    var distance = -this.viewCenter[2];
+    
+    if ( distance <= radius )
+    {
+        return 0;
+    }
+    
+    var screenSize = radius / ( distance * Math.tan( this.camera.getFovy() / 2 ) );
+    var level = 0;
+    
+    while ( level < this.levels.length - 1 && 
+            level < LodMesh.SCREEN_SIZES.length &&
+            screenSize < LodMesh.SCREEN_SIZES[level] )
+    {
+        ++level;
+    }
+    
+    return level;
+};
+
+/**
+ * Select the level to draw with the provided view matrix and make it the
+ * decorated mesh
+ * @param {Float32Array} viewMat
+ * @return {Mesh} The selected level
+ */
+LodMesh.prototype.selectMesh = function( viewMat )
+{
+    this.currentLevel = this.selectLevel( viewMat );
+    this.mesh = this.levels[this.currentLevel];
+    
+    return this.mesh;
+};
+
+/**
+ * Returns the level that was drawn last
+ * @return {number}
+ */
+LodMesh.prototype.getCurrentLevel = function()
+{
+    return this.currentLevel;
+};
+
+/**
+ * Set the material name for this object to use
+ * @param {string} name of the material that should be used by this object
+ */
+LodMesh.prototype.setMtlName = function( mName )
+{
+    for ( var i = 0; i < this.levels.length; ++i )
+    {
+        this.levels[i].setMtlName( mName );
+    }
+};
+
+/**
+ * Set the level that stands in for this object in the occlusion buffer.
+ * The simplifier can move the surface of the coarser levels outward, the
+ * occluder should be the most detailed level that is cheap enough.
+ * @param {number} level Index of the level, the full resolution one (0) 
+ *        by default
+ */
+LodMesh.prototype.setOccluderLevel = function( level )
+{
+    this.occluderLevel = level;
+};
+
+/**
+ * The occluder level stands in for this object in the occlusion buffer
+ * @return {Mesh|undefined} Undefined if this object is not an occluder
+ */
+LodMesh.prototype.getOccluderMesh = function()
+{
+    return this.occluder ? this.levels[this.occluderLevel] : undefined;
+};
+
+/**
+ * Set the model view matrix for this object
+ * @param {Array.<number>} Array of numbers representing the 4 by 4 model view matrix
+ */
+LodMesh.prototype.setMvMatrix = function( mat )
+{
+    for ( var i = 0; i < this.levels.length; ++i )
+    {
+        this.levels[i].setMvMatrix( mat );
+    }
+    
+    this.invalidateParentBounds();
+};
+
+/**
+ * Recalculate the world matrices of every level
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+LodMesh.prototype.updateWorldMatrix = function( parentWorldMatrix, isParentChanged )
+{
+    var isChanged = isParentChanged || this.isTransformDirty;
+    this.isTransformDirty = false;
+    
+    for ( var i = 0; i < this.levels.length; ++i )
+    {
+        this.levels[i].updateWorldMatrix( parentWorldMatrix, isChanged );
+    }
+};
+
+/**
+ * Get the bounds of the most detailed level, they contain the other levels
+ * @return {GBounds}
+ */
+LodMesh.prototype.getLocalBounds = function()
+{
+    return this.levels[0].getLocalBounds();
+};
+
+/**
+ * Add the bounds of the most detailed level to the provided bounds
+ * @param {GBounds} outBounds
+ * @return {boolean}
+ */
+LodMesh.prototype.addBoundsTo = function( outBounds )
+{
+    return this.levels[0].addBoundsTo( outBounds );
+};
+
+/**
+ * Add the most detailed level to the picking hierarchy of the scene, it
+ * shows up as this object whatever level is drawn
+ * @param {GSceneBvh} bvh
+ */
+LodMesh.prototype.addPickItems = function( bvh )
+{
+    bvh.addMesh( this.getObjId(), this, this.levels[0], this.levels[0].worldMatrix );
+};
+
+/**
+ * Add this object to the render queue of the scene, the level is selected 
+ * by the queue for every camera
+ * @param {GRenderQueue} queue
+ */
+LodMesh.prototype.addToRenderQueue = function( queue )
+{
+    queue.add( this, this.levels[0], GRenderQueue.LOD );
+};
+   
+/**
+ * Called to bind this object to a gl context
+ * @param {WebGLRenderingContext} Context to bind to this object
+ */
+LodMesh.prototype.bindToContext = function( gl )
+{
+    for ( var i = 0; i < this.levels.length; ++i )
+    {
+        this.levels[i].bindToContext( gl );
+    }
+    
+    this.gl = gl;
+};
+
+/**
+ * Called to delete all the resources under this drawable
+ */
+LodMesh.prototype.deleteResources = function () 
+{
+    for ( var i = 0; i < this.levels.length; ++i )
+    {
+        this.levels[i].deleteResources();
+    }
+};
+
+/**
+ * Draw the level matching the size of this object on screen
+ * @param {Array.<number>} List of numbers representing the 4 by 4 view matrix of the camera
+ * @param {Array.<GMaterial>} List of materials to use for rendering
+ * @param {GShader} Shader program to use for rendering
+ * @param {number} Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum World space frustum of the camera, the level is
+ *        only selected if the object is inside of it
+ */
+LodMesh.prototype.draw = function( viewMat, materials, shader, drawMode, frustum )
+{
+    if ( undefined !== frustum &&
+         GFrustum.OUTSIDE === frustum.classify( this.getLocalBounds(), this.levels[0].worldMatrix ) )
+    {
+        return;
+    }
+    
+    this.selectMesh( viewMat );
+    
+    MeshDecorator.prototype.draw.call( this, viewMat, materials, shader, drawMode );
+};
@@ -0,0 +1,492 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Flat list of everything the scene draws, built once per frame after the
+ * world matrices are updated.  The records are kept in parallel arrays and
+ * the world and normal matrices of all of them share one Float32Array.  The
+ * records are sorted by shader variant, material and mesh so the passes 
+ * don't walk the scene graph and skip redundant program, texture and 
+ * buffer changes.
+ * @constructor
+ */
+function GRenderQueue()
+{
+    this.count = 0;
+    this.capacity = 0;
+    
+    this.drawables = [];
+    this.meshes = [];
+    this.occluders = [];
+    this.types = new Uint8Array( 0 );
+    this.keys = new Float64Array( 0 );
+    this.order = new Uint32Array( 0 );
+    
+    // 32 values per record, the world matrix followed by the normal matrix
+    this.matrices = new Float32Array( 0 );
+    this.worldMatrices = [];
+    this.normalMatrices = [];
+    
+    // center and radius of the world space bounding sphere of every record,
+    // a negative radius for the ones that are never culled
+    this.spheres = new Float32Array( 0 );
+    
+    // the groups the records were added under, parents come before their 
+    // children.  Every record keeps the index of its closest group, -1 for
+    // the ones that are not under a group.
+    this.groups = [];
+    this.groupParents = [];
+    this.groupResults = [];
+    this.groupCount = 0;
+    this.currentGroup = -1;
+    this.recordGroups = new Int32Array( 0 );
+    
+    this.materialIds = {};
+    this.materialCount = 0;
+    this.instancedStart = 0;
+    this.armatureStart = 0;
+    this.center = vec3.create();
+}
+
+/**
+ * Record types
+ */
+GRenderQueue.MESH = 0;
+GRenderQueue.LOD = 1;
+GRenderQueue.ARMATURE = 2;
+GRenderQueue.INSTANCED = 3;
+
+/**
+ * Sort keys are built like a 64 bit integer out of the parts that fit in the
+ * 53 bits of a double: shader variant, material and mesh
+ */
+GRenderQueue.VARIANT_SHIFT = Math.pow( 2, 42 );
+GRenderQueue.MATERIAL_SHIFT = Math.pow( 2, 21 );
+
+/**
+ * Grow the arrays so they can hold the provided number of records
+ * @param {number} capacity
+ */
+GRenderQueue.prototype.reserve = function( capacity )
+{
+    var types = new Uint8Array( capacity );
+    var keys = new Float64Array( capacity );
+    var matrices = new Float32Array( 32 * capacity );
+    var spheres = new Float32Array( 4 * capacity );
+    var recordGroups = new Int32Array( capacity );
+    
+    types.set( this.types );
+    keys.set( this.keys );
+    matrices.set( this.matrices );
+    spheres.set( this.spheres );
+    recordGroups.set( this.recordGroups );
+    
+    this.types = types;
+    this.keys = keys;
+    this.order = new Uint32Array( capacity );
+    this.matrices = matrices;
+    this.spheres = spheres;
+    this.recordGroups = recordGroups;
+    
+    for ( var i = 0; i < capacity; ++i )
+    {
+        this.worldMatrices[i] = matrices.subarray( 32*i, 32*i + 16 );
+        this.normalMatrices[i] = matrices.subarray( 32*i + 16, 32*i + 32 );
+    }
+    
+    this.capacity = capacity;
+};
+
+/**
+ * Rebuild the queue from the drawables of the scene, their world matrices
+ * have to be up to date
+ * @param {Array.<SceneDrawable>} children Children of the scene
+ */
+GRenderQueue.prototype.build = function( children )
+{
+    this.count = 0;
+    this.groupCount = 0;
+    this.currentGroup = -1;
+    
+    var childCount = children.length;
+    for ( var i = 0; i < childCount; ++i )
+    {
+        children[i].addToRenderQueue( this );
+    }
+    
+    this.sort();
+};
+
+/**
+ * Called by the groups during build before they add their children, the 
+ * records added until the matching endGroup are culled with the group
+ * @param {GGroup} group
+ */
+GRenderQueue.prototype.beginGroup = function( group )
+{
+    var g = this.groupCount;
+    
+    this.groups[g] = group;
+    this.groupParents[g] = this.currentGroup;
+    this.groupResults[g] = GFrustum.INTERSECTS;
+    this.currentGroup = g;
+    this.groupCount += 1;
+};
+
+/**
+ * Called by the groups during build after they added their children
+ */
+GRenderQueue.prototype.endGroup = function()
+{
+    this.currentGroup = this.groupParents[this.currentGroup];
+};
+
+/**
+ * Classify the groups against the frustum of a pass, the children of the 
+ * groups that are completely inside or outside of it don't need their own
+ * tests.  Has to be called before the records are drawn or rasterized
+ * through a new frustum.
+ * @param {GFrustum=} frustum World space frustum of the camera
+ */
+GRenderQueue.prototype.classifyGroups = function( frustum )
+{
+    if ( undefined === frustum )
+    {
+        return;
+    }
+    
+    for ( var g = 0; g < this.groupCount; ++g )
+    {
+        var parent = this.groupParents[g];
+        var result = ( parent < 0 ) ? GFrustum.INTERSECTS : this.groupResults[parent];
+        
+        if ( GFrustum.INTERSECTS === result )
+        {
+            result = frustum.classify( this.groups[g].getBounds(), this.groups[g].worldMatrix );
+        }
+        
+        this.groupResults[g] = result;
+    }
+};
+
+/**
+ * Classify the bounding sphere of a record against the frustum the groups
+ * were last classified against
+ * @param {number} i Record
+ * @param {GFrustum=} frustum World space frustum of the camera
+ * @return {number} GFrustum.OUTSIDE, INTERSECTS or INSIDE, INSIDE for the
+ *         records that are never culled
+ */
+GRenderQueue.prototype.classifyRecord = function( i, frustum )
+{
+    var s = 4 * i;
+    
+    if ( undefined === frustum || this.spheres[s+3] < 0 )
+    {
+        return GFrustum.INSIDE;
+    }
+    
+    var g = this.recordGroups[i];
+    var result = ( g < 0 ) ? GFrustum.INTERSECTS : this.groupResults[g];
+    
+    if ( GFrustum.INTERSECTS === result )
+    {
+        vec3.set( this.center, this.spheres[s], this.spheres[s+1], this.spheres[s+2] );
+        result = frustum.classifySphere( this.center, this.spheres[s+3] );
+    }
+    
+    return result;
+};
+
+/**
+ * Called by the drawables during build for everything they draw
+ * @param {SceneDrawable} drawable Drawable the record belongs to
+ * @param {Mesh} mesh Mesh with the buffers, matrices and bounds of the record
+ * @param {number} type GRenderQueue.MESH, LOD, ARMATURE or INSTANCED, the
+ *        bounds of the INSTANCED records are the ones of the drawable
+ * @param {Float32Array=} worldMatrix World matrix of the record, the one of
+ *        the mesh if undefined
+ * @param {Float32Array=} normalMatrix Normal matrix of the record, the one 
+ *        of the mesh if undefined
+ */
+GRenderQueue.prototype.add = function( drawable, mesh, type, worldMatrix, normalMatrix )
+{
+    if ( !mesh.valid )
+    {
+        return;
+    }
+    
+    var i = this.count;
+    
+    if ( i === this.capacity )
+    {
+        this.reserve( Math.max( 16, 2 * this.capacity ) );
+    }
+    
+    this.drawables[i] = drawable;
+    this.meshes[i] = mesh;
+    this.occluders[i] = drawable.getOccluderMesh();
+    this.types[i] = type;
+    this.recordGroups[i] = this.currentGroup;
+    
+    var m = worldMatrix || mesh.worldMatrix;
+    this.worldMatrices[i].set( m );
+    this.normalMatrices[i].set( normalMatrix || mesh.normalMatrix );
+    
+    var s = 4 * i;
+    var bounds = ( GRenderQueue.INSTANCED === type ) ? drawable.getLocalBounds() : mesh.getLocalBounds();
+    
+    if ( GRenderQueue.ARMATURE === type || bounds.isInfinite() )
+    {
+        this.spheres[s+3] = -1;
+    }
+    else
+    {
+        var c = this.center;
+        vec3.transformMat4( c, bounds.center, m );
+        
+        // the largest axis scale of the matrix scales the radius
+        var scale = Math.sqrt( Math.max( m[0]*m[0] + m[1]*m[1] + m[2]*m[2],
+                                         m[4]*m[4] + m[5]*m[5] + m[6]*m[6],
+                                         m[8]*m[8] + m[9]*m[9] + m[10]*m[10] ) );
+        
+        this.spheres[s]   = c[0];
+        this.spheres[s+1] = c[1];
+        this.spheres[s+2] = c[2];
+        this.spheres[s+3] = bounds.radius * scale;
+    }
+    
+    var materialId = 0;
+    
+    if ( undefined !== mesh.mtlName )
+    {
+        materialId = this.materialIds[mesh.mtlName];
+        
+        if ( undefined === materialId )
+        {
+            this.materialCount += 1;
+            materialId = this.materialCount;
+            this.materialIds[mesh.mtlName] = materialId;
+        }
+    }
+    
+    // the static variant first, then the instanced one and the armature one
+    var variant = ( GRenderQueue.ARMATURE === type ) ? 2 : ( GRenderQueue.INSTANCED === type ) ? 1 : 0;
+    
+    this.keys[i] = variant * GRenderQueue.VARIANT_SHIFT +
+                   ( materialId % GRenderQueue.MATERIAL_SHIFT ) * GRenderQueue.MATERIAL_SHIFT +
+                   ( mesh.getObjId() % GRenderQueue.MATERIAL_SHIFT );
+    
+    this.count += 1;
+};
+
+/**
+ * Sort the draw order by key, the instanced and then the skinned records end
+ * up at the back
+ */
+GRenderQueue.prototype.sort = function()
+{
+    var keys = this.keys;
+    var order = this.order.subarray( 0, this.count );
+    
+    for ( var i = 0; i < this.count; ++i )
+    {
+        order[i] = i;
+    }
+    
+    order.sort( function( a, b ) { return ( keys[a] - keys[b] ) || ( a - b ); } );
+    
+    this.armatureStart = this.count;
+    
+    while ( this.armatureStart > 0 && 
+            GRenderQueue.ARMATURE === this.types[order[this.armatureStart - 1]] )
+    {
+        this.armatureStart -= 1;
+    }
+    
+    this.instancedStart = this.armatureStart;
+    
+    while ( this.instancedStart > 0 && 
+            GRenderQueue.INSTANCED === this.types[order[this.instancedStart - 1]] )
+    {
+        this.instancedStart -= 1;
+    }
+};
+
+/**
+ * @return {boolean} True if there are instanced records to draw
+ */
+GRenderQueue.prototype.hasInstances = function()
+{
+    return this.instancedStart < this.armatureStart;
+};
+
+/**
+ * @return {boolean} True if there are skinned records to draw
+ */
+GRenderQueue.prototype.hasArmatures = function()
+{
+    return this.armatureStart < this.count;
+};
+
+/**
+ * Rasterize the occluders inside the frustum into an occlusion buffer
+ * @param {GOcclusionBuffer} occlusion Buffer started with the view 
+ *        projection matrix of the camera
+ * @param {GFrustum=} frustum World space frustum of the camera
+ */
+GRenderQueue.prototype.rasterizeOccluders = function( occlusion, frustum )
+{
+    for ( var i = 0; i < this.count; ++i )
+    {
+        var occluder = this.occluders[i];
+        
+        if ( undefined === occluder || !occluder.valid ||
+             GFrustum.OUTSIDE === this.classifyRecord( i, frustum ) )
+        {
+            continue;
+        }
+        
+        occlusion.rasterizeMesh( occluder.vertA, occluder.indxA, this.worldMatrices[i] );
+    }
+};
+
+/**
+ * Draw the records that don't need the instanced or armature variants of 
+ * the shaders
+ * @param {Float32Array} viewMat View matrix of the camera
+ * @param {Object.<string, GMaterial>} materials Materials of the scene
+ * @param {GShader} shader Static variant of the shader of the pass
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum World space frustum of the camera
+ * @param {GOcclusionBuffer=} occlusion Occluders of the camera, the records
+ *        hidden behind them are skipped
+ */
+GRenderQueue.prototype.drawStatic = function( viewMat, materials, shader, drawMode, frustum, occlusion )
+{
+    var lastMesh = undefined;
+    var lastMaterial = undefined;
+    var spheres = this.spheres;
+    
+    for ( var k = 0; k < this.instancedStart; ++k )
+    {
+        var i = this.order[k];
+        var mesh = this.meshes[i];
+        var s = 4 * i;
+        var result = this.classifyRecord( i, frustum );
+        
+        if ( GFrustum.OUTSIDE === result ||
+             ( GFrustum.INTERSECTS === result &&
+               GFrustum.OUTSIDE === frustum.classify( mesh.getLocalBounds(), this.worldMatrices[i] ) ) )
+        {
+            continue;
+        }
+        
+        if ( undefined !== occlusion && spheres[s+3] >= 0 &&
+             !occlusion.isVisible( mesh.getLocalBounds(), this.worldMatrices[i] ) )
+        {
+            continue;
+        }
+        
+        if ( GRenderQueue.LOD === this.types[i] )
+        {
+            mesh = this.drawables[i].selectMesh( viewMat );
+        }
+        
+        if ( !mesh.valid )
+        {
+            continue;
+        }
+        
+        if ( mesh !== lastMesh )
+        {
+            mesh.bindGeometry( shader );
+            lastMesh = mesh;
+        }
+        
+        var material = mesh.getMaterial( materials );
+        
+        if ( material !== lastMaterial && material != undefined )
+        {
+            material.draw( shader );
+            lastMaterial = material;
+        }
+        
+        mesh.uploadMatrices( shader, this.worldMatrices[i], this.normalMatrices[i] );
+        mesh.drawGeometry( drawMode );
+    }
+    
+    if ( undefined !== lastMesh )
+    {
+        lastMesh.unbindGeometry();
+    }
+};
+
+/**
+ * Draw the instanced records, each one draws all its instances with a 
+ * single call
+ * @param {Float32Array} viewMat View matrix of the camera
+ * @param {Object.<string, GMaterial>} materials Materials of the scene
+ * @param {GShader} shader Instanced variant of the shader of the pass
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum World space frustum of the camera
+ * @param {GOcclusionBuffer=} occlusion Occluders of the camera
+ */
+GRenderQueue.prototype.drawInstanced = function( viewMat, materials, shader, drawMode, frustum, occlusion )
+{
+    var spheres = this.spheres;
+    
+    for ( var k = this.instancedStart; k < this.armatureStart; ++k )
+    {
+        var i = this.order[k];
+        var s = 4 * i;
+        var result = this.classifyRecord( i, frustum );
+        
+        if ( GFrustum.OUTSIDE === result )
+        {
+            continue;
+        }
+        
+        if ( undefined !== occlusion && spheres[s+3] >= 0 &&
+             !occlusion.isVisible( this.drawables[i].getLocalBounds(), this.worldMatrices[i] ) )
+        {
+            continue;
+        }
+        
+        // the box is only checked by the drawable when the sphere crosses
+        this.drawables[i].draw( viewMat, materials, shader, drawMode,
+                                ( GFrustum.INTERSECTS === result ) ? frustum : undefined );
+    }
+};
+
+/**
+ * Draw the skinned records, they set up their bones themselves
+ * @param {Float32Array} viewMat View matrix of the camera
+ * @param {Object.<string, GMaterial>} materials Materials of the scene
+ * @param {GShader} shader Armature variant of the shader of the pass
+ * @param {number} drawMode Draw mode for drawing the VBOs
+ */
+GRenderQueue.prototype.drawArmatures = function( viewMat, materials, shader, drawMode )
+{
+    for ( var k = this.armatureStart; k < this.count; ++k )
+    {
+        this.drawables[this.order[k]].draw( viewMat, materials, shader, drawMode );
+    }
+};
@@ -26,8 +26,11 @@
  */
 function ShaderComposite ( vertexSource, fragmentSource )
 {
+    this.vertexSource = vertexSource;
     this.staticS = new GShader(vertexSource, fragmentSource);
     this.armatureS = new GShader("#define ARMATURE_SUPPORT\n"+vertexSource, fragmentSource);
+    this.instancedS = new GShader("#define INSTANCED\n"+vertexSource, fragmentSource);
+    this.instancedSupported = false;
 }
 
 /**
@@ -48,14 +51,73 @@ ShaderComposite.prototype.getArmatureShader = function ()
     return this.armatureS;
 };
 
+/**
+ * Access to the shader for the instanced meshes
+ * @return {GShader} undefined if the context can't draw instances
+ */
+ShaderComposite.prototype.getInstancedShader = function ()
+{
+    return this.instancedSupported ? this.instancedS : undefined;
+};
+
 /**
  * Called to bind the shaders to a gl context
  * @param {WebGLRenderingContext} Context to bind to this object
  */
 ShaderComposite.prototype.bindToContext = function ( gl )
 {
-    this.staticS.bindToContext( gl );
-    this.armatureS.bindToContext( gl );
+    this.startCompile( gl );
+    this.finishCompile();
+};
+
+/**
+ * Start compiling the variants, see GShader.startCompile
+ * @param {WebGLRenderingContext} gl Context to bind to this object
+ */
+ShaderComposite.prototype.startCompile = function ( gl )
+{
+    // scene shaders decode the attributes the way the meshes bound to the 
+    // same context upload them
+    if ( Mesh.isQuantizationEnabled( gl ) )
+    {
+        this.staticS.vertex = "#define QUANTIZED_ATTRIBUTES\n" + this.vertexSource;
+        this.armatureS.vertex = "#define ARMATURE_SUPPORT\n#define QUANTIZED_ATTRIBUTES\n" + this.vertexSource;
+        this.instancedS.vertex = "#define INSTANCED\n#define QUANTIZED_ATTRIBUTES\n" + this.vertexSource;
+    }
+    
+    // the instanced variant is only compiled where it can be drawn
+    this.instancedSupported = ( undefined !== gl.isInstancingSupported ) && gl.isInstancingSupported();
+    
+    this.staticS.startCompile( gl );
+    this.armatureS.startCompile( gl );
+    
+    if ( this.instancedSupported )
+    {
+        this.instancedS.startCompile( gl );
+    }
+};
+
+/**
+ * @return {boolean} True if the variants can be finished without waiting
+ */
+ShaderComposite.prototype.isCompileComplete = function ()
+{
+    return this.staticS.isCompileComplete() && this.armatureS.isCompileComplete() &&
+           ( !this.instancedSupported || this.instancedS.isCompileComplete() );
+};
+
+/**
+ * Finish compiling the variants, see GShader.finishCompile
+ */
+ShaderComposite.prototype.finishCompile = function ()
+{
+    this.staticS.finishCompile();
+    this.armatureS.finishCompile();
+    
+    if ( this.instancedSupported )
+    {
+        this.instancedS.finishCompile();
+    }
 };
 
 /**
@@ -65,4 +127,9 @@ ShaderComposite.prototype.destroy = function ()
 {
     this.staticS.destroy();
     this.armatureS.destroy();
+    
+    if ( this.instancedSupported )
+    {
+        this.instancedS.destroy();
+    }
 };
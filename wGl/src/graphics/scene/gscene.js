@@ -30,6 +30,18 @@ function GScene()
 	this.eyeMvMatrix = mat4.create();
 	
 	this.tempMatrix = mat4.create();
+	this.identMatrix = mat4.create();
+	this.projectionMatrix = mat4.create();
+	this.viewMatrix = mat4.create();
+	this.frustum = new GFrustum();
+	this.isFrustumCullingEnabled = true;
+	this.isOcclusionCullingEnabled = false;
+	this.occlusionBuffers = [];
+	this.frameIndex = 0;
+	
+	this.picker = new GScenePicker( this );
+	this.rayHit = new GRayHit();
+	this.renderQueue = new GRenderQueue();
 	
 	this.materials = {};
 	this.lights = [];
@@ -38,40 +50,17 @@ function GScene()
 	
 	this.activeLightIndex = 0;
 	
-	this.drawSectionEnum = 
-	{
-	    STATIC: 0,
-	    ARMATURE: 1
-	};
-	
-	this.drawSection = this.drawSectionEnum.STATIC;
-	this.deferredDrawCommands = [];
-	
 	this.isVisible = true;
 }
 
 /**
- * This function is part of SceneDrawableObserver sends a defer request to the 
- * observer.  This is useful, for example, in situations where the Drawable is 
- * not provided a shader that accepts all the attributes it can offer.  The idea 
- * is to defer drawing until a more suitable shader becomes available.
- * The observer needs to report on it's ability to service 
- * the deferral request.  If the observer can't service the deferral request, the
- * Drawable needs to make do with whatever shader is available at the moment.
- * @param {DrawCommand} Draw command being requested for deferral
- * @param {number} Condition code as defined by SceneDrawableDeferConditionCode that is cause for the deferral
- * @return {boolean} True if the draw can be deferred, false otherwise
+ * This function is part of SceneDrawableObserver, the picking hierarchy is 
+ * brought up to date with the drawable in a later job
+ * @param {SceneDrawable} drawable Drawable that changed
  */
-GScene.prototype.onDeferredDrawRequested = function ( command, conditionCode ) 
-{ 
-    if ( conditionCode === SceneDrawableDeferConditionCode.ARMATURE_REQUEST &&
-         this.drawSection === this.drawSectionEnum.STATIC )
-    {
-        this.deferredDrawCommands.push( command );
-        return true;
-    }
-    
-    return false; 
+GScene.prototype.onDrawableChanged = function ( drawable )
+{
+    this.picker.invalidate();
 };
 
 
@@ -122,6 +111,8 @@ GScene.prototype.bindToContext = function( gl )
     this.drawMode = gl.TRIANGLES;
     
     this.camera.bindToContext( gl );
+    this.picker.setJobScheduler( gl.jobScheduler );
+    
     var childCount = this.children.length;
     for (var i = 0; i < childCount; ++i)
     {
@@ -169,98 +160,223 @@ GScene.prototype.setVisibility = function ( visibility )
 };
 
 /**
- * Draw the geometry using the provided view matrix and shader
- * @param {Array.<number>} Array of numbers that represent the 4 by 4 view matrix
- * @param {GShader} Shader program to use for rendering
+ * Enable or disable skipping the objects outside of the camera frustum
+ * @param {boolean} enabled
  */
-GScene.prototype.drawGeometry = function ( parentMvMatrix, shader )
+GScene.prototype.setFrustumCulling = function ( enabled )
 {
-    var childCount = this.children.length;
-    for (var i = 0; i < childCount; ++i)
-    {
-        this.children[i].draw( parentMvMatrix, this.materials, shader, this.drawMode );
-    }
+    this.isFrustumCullingEnabled = enabled;
 };
 
 /**
- * Draw the scene through a custom camera without having to attach it to the scene
- * @param {GCamera} Camera to use for rendering
- * @param {ShaderComposite} Shader to use for rendering
+ * Enable or disable skipping the objects hidden behind the occluders of the
+ * scene, see Mesh.setOccluder.  Every camera gets its own GOcclusionBuffer,
+ * rebuilt once per frame or whenever the camera moves.
+ * @param {boolean} enabled
  */
-GScene.prototype.drawThroughCamera = function ( camera, shaderComposite )
+GScene.prototype.setOcclusionCulling = function ( enabled )
 {
-    if ( false === this.isVisible )
+    this.isOcclusionCullingEnabled = enabled;
+};
+
+/**
+ * Get the occlusion buffer of a camera with the occluders of this frame
+ * @param {GCamera} camera Camera whose matrices were updated by its draw call
+ * @param {GFrustum|undefined} frustum Frustum of the camera, the occluders
+ *        outside of it are not rasterized
+ * @return {GOcclusionBuffer|undefined} Undefined if culling is disabled
+ */
+GScene.prototype.getCameraOcclusion = function ( camera, frustum )
+{
+    if ( !this.isOcclusionCullingEnabled )
     {
-        return;
+        return undefined;
     }
     
-    this.drawSection = this.drawSectionEnum.STATIC;
-    
-    var shader = shaderComposite.getStaticShader();
-    shader.activate();
-    
-    camera.draw( this.tempMatrix, shader );    
-    this.drawLights( shader );    
-    this.drawGeometry( this.tempMatrix, shader );
+    var entry = undefined;
     
-    shader.deactivate();
+    for ( var i = 0; i < this.occlusionBuffers.length; ++i )
+    {
+        if ( this.occlusionBuffers[i].camera === camera )
+        {
+            entry = this.occlusionBuffers[i];
+        }
+    }
     
-    this.drawSection = this.drawSectionEnum.ARMATURE;
+    if ( undefined === entry )
+    {
+        entry = { camera: camera, buffer: new GOcclusionBuffer(), frame: -1 };
+        this.occlusionBuffers.push( entry );
+    }
     
-    shader = shaderComposite.getArmatureShader();
-    shader.activate();
+    camera.getPMatrix( this.projectionMatrix );
+    camera.getMvMatrix( this.viewMatrix );
+    mat4.multiply( this.projectionMatrix, this.projectionMatrix, this.viewMatrix );
     
-    camera.draw( this.tempMatrix, shader );
-    this.drawLights( shader );
+    // the passes of a frame that share the camera share the buffer
+    if ( entry.frame !== this.frameIndex || !entry.buffer.isBuiltFor( this.projectionMatrix ) )
+    {
+        entry.buffer.begin( this.projectionMatrix );
+        this.renderQueue.rasterizeOccluders( entry.buffer, frustum );
+        entry.buffer.end();
+        entry.frame = this.frameIndex;
+    }
     
-    for ( var i in this.deferredDrawCommands )
+    return entry.buffer;
+};
+
+/**
+ * Get the world space frustum the geometry drawn through a camera is culled against
+ * @param {GCamera} camera Camera whose matrices were updated by its draw call
+ * @return {GFrustum|undefined} Undefined if culling is disabled
+ */
+GScene.prototype.getCameraFrustum = function ( camera )
+{
+    if ( !this.isFrustumCullingEnabled )
     {
-        this.deferredDrawCommands[i].run( shader );
+        return undefined;
     }
     
-    shader.deactivate();
+    camera.getPMatrix( this.projectionMatrix );
+    camera.getMvMatrix( this.viewMatrix );
+    mat4.multiply( this.projectionMatrix, this.projectionMatrix, this.viewMatrix );
+    this.frustum.setFromProjection( this.projectionMatrix );
     
-    this.deferredDrawCommands = [];
+    return this.frustum;
 };
 
 /**
- * Render the scene with the provided shader program
- * @param {ShaderComposite} Shader program to use for rendering
+ * Recalculate the world and normal matrices of the objects that moved since
+ * the last call.  Every pass and camera of a frame draws with the matrices
+ * calculated here, GContext calls it once before drawing the frame.
  */
-GScene.prototype.draw = function( shaderComposite )
+GScene.prototype.updateWorldMatrices = function ()
+{
+    var childCount = this.children.length;
+    for (var i = 0; i < childCount; ++i)
+    {
+        this.children[i].updateWorldMatrix( this.identMatrix, false );
+    }
+};
+
+/**
+ * Bring the world matrices up to date and rebuild the render queue every
+ * pass and camera of the frame draws from.  GContext calls it once before 
+ * drawing the frame.
+ */
+GScene.prototype.prepareDraw = function ()
+{
+    this.updateWorldMatrices();
+    this.renderQueue.build( this.children );
+    this.frameIndex += 1;
+};
+
+/**
+ * Find the closest mesh hit by a ray.  The picking hierarchy is kept up to
+ * date by a job of the context, so the ray sees the scene as it was when that
+ * job last finished.  Nothing is hit while the scene is hidden.
+ * @param {Float32Array} origin Origin of the ray in world space
+ * @param {Float32Array} direction Normalized direction of the ray
+ * @return {GRayHit|undefined} Undefined if the ray doesn't hit anything
+ */
+GScene.prototype.intersectRay = function ( origin, direction )
 {
     if ( false === this.isVisible )
     {
-        return;
+        return undefined;
     }
     
-    this.drawSection = this.drawSectionEnum.STATIC;
+    if ( this.picker.intersect( origin, direction, this.rayHit ) )
+    {
+        return this.rayHit;
+    }
+    
+    return undefined;
+};
+
+/**
+ * Draw the render queue through the provided camera, the static records 
+ * first, then the instanced and skinned ones with their variants of the 
+ * shader
+ * @param {GCamera} Camera to use for rendering
+ * @param {Array.<number>} Array of numbers the view matrix of the camera is written to
+ * @param {ShaderComposite} Shader to use for rendering
+ */
+GScene.prototype.drawQueue = function ( camera, viewMatrix, shaderComposite )
+{
+    var queue = this.renderQueue;
     
     var shader = shaderComposite.getStaticShader();
     shader.activate();
     
-    this.camera.draw( this.eyeMvMatrix, shader );
-    this.drawLights( shader );
-    this.drawGeometry( this.eyeMvMatrix, shader );
+    camera.draw( viewMatrix, shader );    
+    this.drawLights( shader );    
+    
+    var frustum = this.getCameraFrustum( camera );
+    queue.classifyGroups( frustum );
+    
+    var occlusion = this.getCameraOcclusion( camera, frustum );
+    
+    queue.drawStatic( viewMatrix, this.materials, shader, this.drawMode, frustum, occlusion );
     
     shader.deactivate();
     
-    this.drawSection = this.drawSectionEnum.ARMATURE;
+    if ( queue.hasInstances() )
+    {
+        // the instanced meshes draw one instance at a time with the static 
+        // shader if the variant is missing
+        shader = shaderComposite.getInstancedShader() || shaderComposite.getStaticShader();
+        shader.activate();
+        
+        camera.draw( viewMatrix, shader );
+        this.drawLights( shader );
+        queue.drawInstanced( viewMatrix, this.materials, shader, this.drawMode, frustum, occlusion );
+        
+        shader.deactivate();
+    }
+    
+    if ( !queue.hasArmatures() )
+    {
+        return;
+    }
     
     shader = shaderComposite.getArmatureShader();
     shader.activate();
     
-    this.camera.draw( this.eyeMvMatrix, shader );
+    camera.draw( viewMatrix, shader );
     this.drawLights( shader );
+    queue.drawArmatures( viewMatrix, this.materials, shader, this.drawMode );
     
-    for ( var i in this.deferredDrawCommands )
+    shader.deactivate();
+};
+
+/**
+ * Draw the scene through a custom camera without having to attach it to the scene
+ * @param {GCamera} Camera to use for rendering
+ * @param {ShaderComposite} Shader to use for rendering
+ */
+GScene.prototype.drawThroughCamera = function ( camera, shaderComposite )
+{
+    if ( false === this.isVisible )
     {
-        this.deferredDrawCommands[i].run( shader );
+        return;
     }
     
-    shader.deactivate();
+    this.drawQueue( camera, this.tempMatrix, shaderComposite );
+};
+
+/**
+ * Render the scene with the provided shader program
+ * @param {ShaderComposite} Shader program to use for rendering
+ */
+GScene.prototype.draw = function( shaderComposite )
+{
+    if ( false === this.isVisible )
+    {
+        return;
+    }
     
-    this.deferredDrawCommands = [];
+    this.drawQueue( this.camera, this.eyeMvMatrix, shaderComposite );
 };
 
 /**
@@ -349,6 +465,7 @@ GScene.prototype.addChild = function( child )
     child.bindToContext( this.gl );
     child.setObserver( this );
     this.children.push( child );
+    this.picker.invalidate();
 };
 
 /**
@@ -365,6 +482,7 @@ GScene.prototype.removeChild = function( child )
     }
     
     this.children.splice( i, 1 );
+    this.picker.invalidate();
 };
 
 /**
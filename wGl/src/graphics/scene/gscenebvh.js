@@ -0,0 +1,916 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+/**
+ * Closest intersection of a ray with the scene
+ * @constructor
+ */
+function GRayHit()
+{
+    this.objId = -1;
+    this.drawable = undefined;
+    this.distance = Infinity;
+    this.point = vec3.create();
+    this.normal = vec3.create();
+}
+
+/**
+ * Bounding volume hierarchy over the world space triangles of the meshes in
+ * a scene, objects are picked by casting rays through it instead of reading
+ * an object id buffer back from the GPU.  The hierarchy is rebuilt when 
+ * meshes are added or removed and only refitted when they move.  An update
+ * is done by step, a bounded amount of work at a time, see GScenePicker.
+ * @constructor
+ */
+function GSceneBvh()
+{
+    this.items = [];
+    this.itemCount = 0;
+    this.isStructureDirty = true;
+    this.isTransformDirty = false;
+    
+    this.phase = GSceneBvh.PHASE_DONE;
+    this.cursor = 0;
+    this.itemCursor = 0;
+    this.centroids = undefined;
+    this.ranges = [];
+    this.range = undefined;
+    
+    // 9 values per triangle, the vertices in world space
+    this.triangles = new Float32Array( 0 );
+    this.triangleItems = new Int32Array( 0 );
+    this.triangleOrder = new Int32Array( 0 );
+    this.triangleCount = 0;
+    
+    // min and max of every node, followed by the first triangle and the 
+    // triangle count of the leaves or the left child and 0 for inner nodes
+    this.nodeBounds = new Float32Array( 0 );
+    this.nodeData = new Int32Array( 0 );
+    this.nodeCount = 0;
+    
+    this.stack = [];
+}
+
+/**
+ * Largest number of triangles in a leaf
+ */
+GSceneBvh.LEAF_SIZE = 4;
+
+/**
+ * The phases an update goes through, a build transforms the triangles, finds
+ * their centroids and splits the nodes, a refit transforms the triangles of 
+ * the items that moved and grows or shrinks the nodes
+ */
+GSceneBvh.PHASE_DONE = 0;
+GSceneBvh.PHASE_TRANSFORM = 1;
+GSceneBvh.PHASE_CENTROIDS = 2;
+GSceneBvh.PHASE_SPLIT = 3;
+GSceneBvh.PHASE_REFIT_TRANSFORM = 4;
+GSceneBvh.PHASE_REFIT = 5;
+
+/**
+ * Bring the hierarchy up to date with the drawables of the scene in one go,
+ * their world matrices have to be up to date
+ * @param {Array.<SceneDrawable>} children Children of the scene
+ */
+GSceneBvh.prototype.update = function( children )
+{
+    this.beginUpdate( children );
+    
+    while ( !this.step( Infinity ) ) {}
+};
+
+/**
+ * Collect the meshes of the scene and start the build or refit they need,
+ * the world matrices have to be up to date.  The hierarchy can't be 
+ * intersected until step reports the update is complete.
+ * @param {Array.<SceneDrawable>} children Children of the scene
+ */
+GSceneBvh.prototype.beginUpdate = function( children )
+{
+    this.itemCount = 0;
+    
+    var childCount = children.length;
+    for ( var i = 0; i < childCount; ++i )
+    {
+        children[i].addPickItems( this );
+    }
+    
+    if ( this.itemCount !== this.items.length )
+    {
+        this.items.length = this.itemCount;
+        this.isStructureDirty = true;
+    }
+    
+    if ( this.isStructureDirty )
+    {
+        this.startBuild();
+    }
+    else if ( this.isTransformDirty )
+    {
+        this.phase = GSceneBvh.PHASE_REFIT_TRANSFORM;
+        this.cursor = 0;
+        this.itemCursor = 0;
+    }
+    else
+    {
+        this.phase = GSceneBvh.PHASE_DONE;
+    }
+    
+    this.isStructureDirty = false;
+    this.isTransformDirty = false;
+};
+
+/**
+ * Do the next part of the update
+ * @param {number} budget Largest number of triangles or nodes to go through
+ * @return {boolean} True once the update is complete
+ */
+GSceneBvh.prototype.step = function( budget )
+{
+    if ( GSceneBvh.PHASE_TRANSFORM === this.phase )
+    {
+        if ( this.transformItems( budget, false ) )
+        {
+            this.phase = GSceneBvh.PHASE_CENTROIDS;
+            this.cursor = 0;
+            this.centroids = new Float32Array( 3 * this.triangleCount );
+        }
+    }
+    else if ( GSceneBvh.PHASE_CENTROIDS === this.phase )
+    {
+        this.findCentroids( budget );
+    }
+    else if ( GSceneBvh.PHASE_SPLIT === this.phase )
+    {
+        this.splitNodes( budget );
+    }
+    else if ( GSceneBvh.PHASE_REFIT_TRANSFORM === this.phase )
+    {
+        if ( this.transformItems( budget, true ) )
+        {
+            this.phase = GSceneBvh.PHASE_REFIT;
+            this.cursor = this.nodeCount - 1;
+        }
+    }
+    else if ( GSceneBvh.PHASE_REFIT === this.phase )
+    {
+        this.refit( budget );
+    }
+    
+    return GSceneBvh.PHASE_DONE === this.phase;
+};
+
+/**
+ * Called by the drawables during update for every mesh that can be picked
+ * @param {number} objId Object id reported when the mesh is hit
+ * @param {SceneDrawable} drawable Drawable reported when the mesh is hit
+ * @param {Mesh} mesh Mesh with the triangles
+ * @param {Float32Array} worldMatrix Transformation of the mesh to world space
+ */
+GSceneBvh.prototype.addMesh = function( objId, drawable, mesh, worldMatrix )
+{
+    var item = this.items[this.itemCount];
+    var triangleCount = Math.floor( mesh.indxA.length / 3 );
+    
+    if ( undefined === item || 
+         item.mesh !== mesh ||
+         item.objId !== objId ||
+         item.triangleCount !== triangleCount )
+    {
+        item = 
+        {
+            objId: objId,
+            drawable: drawable,
+            mesh: mesh,
+            matrix: mat4.clone( worldMatrix ),
+            firstTriangle: 0,
+            triangleCount: triangleCount,
+            isDirty: false
+        };
+        
+        this.items[this.itemCount] = item;
+        this.isStructureDirty = true;
+    }
+    else
+    {
+        for ( var i = 0; i < 16; ++i )
+        {
+            if ( item.matrix[i] !== worldMatrix[i] )
+            {
+                mat4.copy( item.matrix, worldMatrix );
+                item.isDirty = true;
+                this.isTransformDirty = true;
+                break;
+            }
+        }
+    }
+    
+    this.itemCount += 1;
+};
+
+/**
+ * Write the triangles of the items to the triangle buffer in world space
+ * @param {number} budget Largest number of triangles to go through
+ * @param {boolean} onlyDirty True to skip the items that didn't move
+ * @return {boolean} True once every item is done
+ */
+GSceneBvh.prototype.transformItems = function( budget, onlyDirty )
+{
+    while ( budget > 0 && this.cursor < this.itemCount )
+    {
+        var item = this.items[this.cursor];
+        
+        if ( onlyDirty && !item.isDirty )
+        {
+            ++this.cursor;
+            continue;
+        }
+        
+        var end = Math.min( item.triangleCount, this.itemCursor + budget );
+        
+        this.transformItem( item, this.itemCursor, end );
+        
+        for ( var t = this.itemCursor; t < end; ++t )
+        {
+            this.triangleItems[item.firstTriangle + t] = this.cursor;
+        }
+        
+        budget -= end - this.itemCursor;
+        this.itemCursor = end;
+        
+        if ( end === item.triangleCount )
+        {
+            item.isDirty = false;
+            ++this.cursor;
+            this.itemCursor = 0;
+        }
+    }
+    
+    return this.cursor === this.itemCount;
+};
+
+/**
+ * Write a range of the triangles of an item to the triangle buffer in world
+ * space
+ * @param {Object} item
+ * @param {number} first First triangle of the item
+ * @param {number} end Triangle after the last one
+ */
+GSceneBvh.prototype.transformItem = function( item, first, end )
+{
+    var m = item.matrix;
+    var verts = item.mesh.vertA;
+    var indices = item.mesh.indxA;
+    var triangles = this.triangles;
+    var o = 9 * ( item.firstTriangle + first );
+    var count = 3 * end;
+    
+    for ( var i = 3 * first; i < count; ++i )
+    {
+        var v = 3 * indices[i];
+        var x = verts[v];
+        var y = verts[v+1];
+        var z = verts[v+2];
+        
+        triangles[o]   = m[0] * x + m[4] * y + m[8]  * z + m[12];
+        triangles[o+1] = m[1] * x + m[5] * y + m[9]  * z + m[13];
+        triangles[o+2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+        o += 3;
+    }
+};
+
+/**
+ * Set the bounds of a node to the bounds of a range of the triangle order
+ * @param {number} node
+ * @param {number} first
+ * @param {number} count
+ */
+GSceneBvh.prototype.setNodeBounds = function( node, first, count )
+{
+    var b = this.nodeBounds;
+    var o = 6 * node;
+    
+    b[o] = b[o+1] = b[o+2] = Infinity;
+    b[o+3] = b[o+4] = b[o+5] = -Infinity;
+    
+    this.growNodeBounds( node, first, first + count );
+};
+
+/**
+ * Grow the bounds of a node around a range of the triangle order
+ * @param {number} node
+ * @param {number} first
+ * @param {number} end Index after the last triangle of the range
+ */
+GSceneBvh.prototype.growNodeBounds = function( node, first, end )
+{
+    var b = this.nodeBounds;
+    var o = 6 * node;
+    var triangles = this.triangles;
+    
+    for ( var i = first; i < end; ++i )
+    {
+        var t = 9 * this.triangleOrder[i];
+        
+        for ( var k = 0; k < 9; ++k )
+        {
+            var value = triangles[t+k];
+            var axis = k % 3;
+            
+            if ( value < b[o+axis] )   b[o+axis] = value;
+            if ( value > b[o+3+axis] ) b[o+3+axis] = value;
+        }
+    }
+};
+
+/**
+ * Start building the hierarchy from scratch, nodes are split at the middle 
+ * of the longest axis of the centroids of their triangles
+ */
+GSceneBvh.prototype.startBuild = function()
+{
+    var count = 0;
+    
+    for ( var i = 0; i < this.itemCount; ++i )
+    {
+        this.items[i].firstTriangle = count;
+        count += this.items[i].triangleCount;
+    }
+    
+    if ( count !== this.triangleCount )
+    {
+        this.triangles = new Float32Array( 9 * count );
+        this.triangleItems = new Int32Array( count );
+        this.triangleOrder = new Int32Array( count );
+        this.nodeBounds = new Float32Array( 6 * Math.max( 1, 2 * count - 1 ) );
+        this.nodeData = new Int32Array( 2 * Math.max( 1, 2 * count - 1 ) );
+        this.triangleCount = count;
+    }
+    
+    this.nodeCount = 0;
+    this.phase = GSceneBvh.PHASE_TRANSFORM;
+    this.cursor = 0;
+    this.itemCursor = 0;
+};
+
+/**
+ * Find the centroids of the next triangles, the root node is started once
+ * every triangle has one
+ * @param {number} budget Largest number of triangles to go through
+ */
+GSceneBvh.prototype.findCentroids = function( budget )
+{
+    var triangles = this.triangles;
+    var order = this.triangleOrder;
+    var centroids = this.centroids;
+    var end = Math.min( this.triangleCount, this.cursor + budget );
+    
+    for ( var i = this.cursor; i < end; ++i )
+    {
+        order[i] = i;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            centroids[3*i+k] = ( triangles[9*i+k] + triangles[9*i+3+k] + triangles[9*i+6+k] ) / 3;
+        }
+    }
+    
+    this.cursor = end;
+    
+    if ( end < this.triangleCount )
+    {
+        return;
+    }
+    
+    if ( 0 === this.triangleCount )
+    {
+        this.centroids = undefined;
+        this.phase = GSceneBvh.PHASE_DONE;
+        return;
+    }
+    
+    // node, first triangle and triangle count of the ranges left to split
+    this.ranges.length = 0;
+    this.ranges.push( 0, 0, this.triangleCount );
+    this.range = undefined;
+    this.nodeCount = 1;
+    this.phase = GSceneBvh.PHASE_SPLIT;
+};
+
+/**
+ * Start splitting the next range of triangles into a node
+ * @return {Object} State of the split
+ */
+GSceneBvh.prototype.startRange = function()
+{
+    var count = this.ranges.pop();
+    var first = this.ranges.pop();
+    var node = this.ranges.pop();
+    var b = this.nodeBounds;
+    var o = 6 * node;
+    
+    b[o] = b[o+1] = b[o+2] = Infinity;
+    b[o+3] = b[o+4] = b[o+5] = -Infinity;
+    
+    this.nodeData[2*node]   = first;
+    this.nodeData[2*node+1] = count;
+    this.cursor = first;
+    
+    return {
+        node: node,
+        first: first,
+        count: count,
+        isPartitioning: false,
+        min: [ Infinity, Infinity, Infinity ],
+        max: [ -Infinity, -Infinity, -Infinity ],
+        axis: 0,
+        split: 0,
+        leftCount: 0
+    };
+};
+
+/**
+ * Go on splitting the ranges of triangles into nodes, a range first finds
+ * its bounds and the extent of its centroids, then partitions its triangles
+ * around the middle of the longest axis
+ * @param {number} budget Largest number of triangles to go through
+ */
+GSceneBvh.prototype.splitNodes = function( budget )
+{
+    var order = this.triangleOrder;
+    var centroids = this.centroids;
+    var i = 0;
+    var k = 0;
+    
+    while ( budget > 0 )
+    {
+        if ( undefined === this.range )
+        {
+            if ( 0 === this.ranges.length )
+            {
+                this.centroids = undefined;
+                this.phase = GSceneBvh.PHASE_DONE;
+                return;
+            }
+            
+            this.range = this.startRange();
+        }
+        
+        var range = this.range;
+        var last = range.first + range.count;
+        var end = Math.min( last, this.cursor + budget );
+        
+        budget -= end - this.cursor;
+        
+        if ( !range.isPartitioning )
+        {
+            this.growNodeBounds( range.node, this.cursor, end );
+            
+            if ( range.count > GSceneBvh.LEAF_SIZE )
+            {
+                for ( i = this.cursor; i < end; ++i )
+                {
+                    for ( k = 0; k < 3; ++k )
+                    {
+                        range.min[k] = Math.min( range.min[k], centroids[3*order[i]+k] );
+                        range.max[k] = Math.max( range.max[k], centroids[3*order[i]+k] );
+                    }
+                }
+            }
+            
+            this.cursor = end;
+            
+            if ( end < last )
+            {
+                continue;
+            }
+            
+            if ( range.count <= GSceneBvh.LEAF_SIZE )
+            {
+                this.range = undefined;
+                continue;
+            }
+            
+            var min = range.min;
+            var max = range.max;
+            
+            for ( k = 1; k < 3; ++k )
+            {
+                if ( max[k] - min[k] > max[range.axis] - min[range.axis] )
+                {
+                    range.axis = k;
+                }
+            }
+            
+            if ( max[range.axis] <= min[range.axis] )
+            {
+                // every centroid is in the same spot, there is nothing to split
+                this.range = undefined;
+                continue;
+            }
+            
+            range.split = ( min[range.axis] + max[range.axis] ) / 2;
+            range.isPartitioning = true;
+            this.cursor = range.first;
+            continue;
+        }
+        
+        for ( i = this.cursor; i < end; ++i )
+        {
+            if ( centroids[3*order[i]+range.axis] < range.split )
+            {
+                var swap = order[i];
+                order[i] = order[range.first + range.leftCount];
+                order[range.first + range.leftCount] = swap;
+                range.leftCount += 1;
+            }
+        }
+        
+        this.cursor = end;
+        
+        if ( end < last )
+        {
+            continue;
+        }
+        
+        var leftCount = range.leftCount;
+        
+        if ( 0 === leftCount || range.count === leftCount )
+        {
+            leftCount = range.count >> 1;
+        }
+        
+        var left = this.nodeCount;
+        this.nodeCount += 2;
+        
+        this.nodeData[2*range.node]   = left;
+        this.nodeData[2*range.node+1] = 0;
+        
+        this.ranges.push( left, range.first, leftCount );
+        this.ranges.push( left + 1, range.first + leftCount, range.count - leftCount );
+        this.range = undefined;
+    }
+};
+
+/**
+ * Grow or shrink the next nodes around the triangles that were transformed 
+ * without changing the topology of the hierarchy
+ * @param {number} budget Largest number of triangles to go through, an inner
+ *        node counts as one
+ */
+GSceneBvh.prototype.refit = function( budget )
+{
+    var b = this.nodeBounds;
+    var node = this.cursor;
+    
+    // children are always stored after their parent
+    for ( ; node >= 0 && budget > 0; --node )
+    {
+        var count = this.nodeData[2*node+1];
+        
+        if ( count > 0 )
+        {
+            this.setNodeBounds( node, this.nodeData[2*node], count );
+            budget -= count;
+            continue;
+        }
+        
+        var o = 6 * node;
+        var l = 6 * this.nodeData[2*node];
+        var r = l + 6;
+        
+        for ( var k = 0; k < 3; ++k )
+        {
+            b[o+k]   = Math.min( b[l+k], b[r+k] );
+            b[o+3+k] = Math.max( b[l+3+k], b[r+3+k] );
+        }
+        
+        budget -= 1;
+    }
+    
+    this.cursor = node;
+    
+    if ( node < 0 )
+    {
+        this.phase = GSceneBvh.PHASE_DONE;
+    }
+};
+
+/**
+ * Distance along the ray to the bounding box of a node
+ * @param {number} node
+ * @param {Float32Array} origin
+ * @param {Array.<number>} invDirection
+ * @return {number} Infinity if the ray misses the box
+ */
+GSceneBvh.prototype.intersectNode = function( node, origin, invDirection )
+{
+    var b = this.nodeBounds;
+    var o = 6 * node;
+    var tMin = 0;
+    var tMax = Infinity;
+    
+    for ( var k = 0; k < 3; ++k )
+    {
+        var t0 = ( b[o+k]   - origin[k] ) * invDirection[k];
+        var t1 = ( b[o+3+k] - origin[k] ) * invDirection[k];
+        
+        tMin = Math.max( tMin, Math.min( t0, t1 ) );
+        tMax = Math.min( tMax, Math.max( t0, t1 ) );
+    }
+    
+    return ( tMin <= tMax ) ? tMin : Infinity;
+};
+
+/**
+ * Distance along the ray to a triangle, both sides of the triangle are hit
+ * @param {number} triangle
+ * @param {Float32Array} origin
+ * @param {Float32Array} direction
+ * @return {number} Infinity if the ray misses the triangle
+ */
+GSceneBvh.prototype.intersectTriangle = function( triangle, origin, direction )
+{
+    var v = this.triangles;
+    var o = 9 * triangle;
+    
+    var e1x = v[o+3] - v[o], e1y = v[o+4] - v[o+1], e1z = v[o+5] - v[o+2];
+    var e2x = v[o+6] - v[o], e2y = v[o+7] - v[o+1], e2z = v[o+8] - v[o+2];
+    
+    var px = direction[1] * e2z - direction[2] * e2y;
+    var py = direction[2] * e2x - direction[0] * e2z;
+    var pz = direction[0] * e2y - direction[1] * e2x;
+    
+    var det = e1x * px + e1y * py + e1z * pz;
+    
+    if ( 0 === det )
+    {
+        return Infinity;
+    }
+    
+    var invDet = 1 / det;
+    var sx = origin[0] - v[o], sy = origin[1] - v[o+1], sz = origin[2] - v[o+2];
+    var u = ( sx * px + sy * py + sz * pz ) * invDet;
+    
+    if ( u < 0 || u > 1 )
+    {
+        return Infinity;
+    }
+    
+    var qx = sy * e1z - sz * e1y;
+    var qy = sz * e1x - sx * e1z;
+    var qz = sx * e1y - sy * e1x;
+    var w = ( direction[0] * qx + direction[1] * qy + direction[2] * qz ) * invDet;
+    
+    if ( w < 0 || u + w > 1 )
+    {
+        return Infinity;
+    }
+    
+    var t = ( e2x * qx + e2y * qy + e2z * qz ) * invDet;
+    
+    return ( t >= 0 ) ? t : Infinity;
+};
+
+/**
+ * Find the closest triangle hit by a ray, update has to be called first
+ * @param {Float32Array} origin Origin of the ray in world space
+ * @param {Float32Array} direction Normalized direction of the ray
+ * @param {GRayHit} outHit Receives the hit
+ * @return {boolean} false if the ray doesn't hit anything
+ */
+GSceneBvh.prototype.intersect = function( origin, direction, outHit )
+{
+    if ( 0 === this.nodeCount )
+    {
+        return false;
+    }
+    
+    var invDirection = [ 1 / direction[0], 1 / direction[1], 1 / direction[2] ];
+    var stack = this.stack;
+    var best = Infinity;
+    var bestTriangle = -1;
+    var i = 0;
+    
+    stack.length = 0;
+    
+    if ( this.intersectNode( 0, origin, invDirection ) < Infinity )
+    {
+        stack.push( 0 );
+    }
+    
+    while ( stack.length > 0 )
+    {
+        var node = stack.pop();
+        var first = this.nodeData[2*node];
+        var count = this.nodeData[2*node+1];
+        
+        if ( count > 0 )
+        {
+            for ( i = first; i < first + count; ++i )
+            {
+                var triangle = this.triangleOrder[i];
+                var t = this.intersectTriangle( triangle, origin, direction );
+                
+                if ( t < best )
+                {
+                    best = t;
+                    bestTriangle = triangle;
+                }
+            }
+            
+            continue;
+        }
+        
+        var tLeft = this.intersectNode( first, origin, invDirection );
+        var tRight = this.intersectNode( first + 1, origin, invDirection );
+        
+        // the closer child is popped first so far nodes can be skipped
+        if ( tLeft <= tRight )
+        {
+            if ( tRight < best ) stack.push( first + 1 );
+            if ( tLeft < best )  stack.push( first );
+        }
+        else
+        {
+            if ( tLeft < best )  stack.push( first );
+            if ( tRight < best ) stack.push( first + 1 );
+        }
+    }
+    
+    if ( bestTriangle < 0 )
+    {
+        return false;
+    }
+    
+    var item = this.items[this.triangleItems[bestTriangle]];
+    outHit.objId = item.objId;
+    outHit.drawable = item.drawable;
+    outHit.distance = best;
+    vec3.scaleAndAdd( outHit.point, origin, direction, best );
+    
+    var v = this.triangles;
+    var o = 9 * bestTriangle;
+    var n = outHit.normal;
+    var e1x = v[o+3] - v[o], e1y = v[o+4] - v[o+1], e1z = v[o+5] - v[o+2];
+    var e2x = v[o+6] - v[o], e2y = v[o+7] - v[o+1], e2z = v[o+8] - v[o+2];
+    
+    vec3.set( n, e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x );
+    vec3.normalize( n, n );
+    
+    // the normal faces the side of the triangle the ray came from
+    if ( vec3.dot( n, direction ) > 0 )
+    {
+        vec3.negate( n, n );
+    }
+    
+    return true;
+};
+
+/**
+ * Keeps the picking hierarchy of a scene up to date as a job of the context,
+ * one hierarchy is intersected while the other one is brought up to date a
+ * bounded amount of work at a time, they swap once the update is done.
+ * @constructor
+ * @implements {GJob}
+ * @param {GScene} scene
+ */
+function GScenePicker( scene )
+{
+    this.scene = scene;
+    this.front = new GSceneBvh();
+    this.back = new GSceneBvh();
+    this.scheduler = undefined;
+    this.isDirty = true;
+    this.isQueued = false;
+    this.isUpdating = false;
+}
+
+/**
+ * Largest number of triangles or nodes a step of the update goes through
+ */
+GScenePicker.STEP_SIZE = 4096;
+
+/**
+ * Set the scheduler the updates run in, the hierarchy is brought up to date
+ * in the pick when there is none
+ * @param {GJobScheduler|undefined} scheduler
+ */
+GScenePicker.prototype.setJobScheduler = function( scheduler )
+{
+    this.scheduler = scheduler;
+    this.isQueued = false;
+    
+    if ( this.isDirty || this.isUpdating )
+    {
+        this.queue();
+    }
+};
+
+/**
+ * Queue the update job if it isn't already
+ */
+GScenePicker.prototype.queue = function()
+{
+    if ( undefined !== this.scheduler && !this.isQueued )
+    {
+        this.scheduler.addJob( this, 0 );
+        this.isQueued = true;
+    }
+};
+
+/**
+ * The scene changed, update the hierarchy in a later job
+ */
+GScenePicker.prototype.invalidate = function()
+{
+    this.isDirty = true;
+    this.queue();
+};
+
+/**
+ * Part of GJob, do the next part of the update
+ * @return {number}
+ */
+GScenePicker.prototype.step = function()
+{
+    if ( !this.isUpdating )
+    {
+        if ( !this.isDirty )
+        {
+            this.isQueued = false;
+            return GJobScheduler.STEP_DONE;
+        }
+        
+        // changes from here on need another update
+        this.isDirty = false;
+        this.isUpdating = true;
+        this.scene.updateWorldMatrices();
+        this.back.beginUpdate( this.scene.children );
+        
+        return GJobScheduler.STEP_WORKED;
+    }
+    
+    if ( this.back.step( GScenePicker.STEP_SIZE ) )
+    {
+        var bvh = this.front;
+        this.front = this.back;
+        this.back = bvh;
+        this.isUpdating = false;
+    }
+    
+    return GJobScheduler.STEP_WORKED;
+};
+
+/**
+ * Part of GJob
+ * @return {number}
+ */
+GScenePicker.prototype.getPriority = function()
+{
+    return GJobScheduler.PRIORITY_PICKING;
+};
+
+/**
+ * Part of GJob, the job doesn't count towards the loading progress
+ * @return {number}
+ */
+GScenePicker.prototype.getProgress = function()
+{
+    return 0;
+};
+
+/**
+ * Find the closest triangle hit by a ray in the last completed hierarchy
+ * @param {Float32Array} origin Origin of the ray in world space
+ * @param {Float32Array} direction Normalized direction of the ray
+ * @param {GRayHit} outHit Receives the hit
+ * @return {boolean} false if the ray doesn't hit anything
+ */
+GScenePicker.prototype.intersect = function( origin, direction, outHit )
+{
+    if ( undefined === this.scheduler )
+    {
+        while ( GJobScheduler.STEP_WORKED === this.step() ) {}
+    }
+    
+    return this.front.intersect( origin, direction, outHit );
+};
@@ -18,15 +18,6 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
 // SOFTWARE.
 
-
-/**
- * @enum {number}
- */
-var SceneDrawableDeferConditionCode = 
-{
-    ARMATURE_REQUEST: 0
-};
- 
 /**
  * @interface
  */
@@ -35,17 +26,11 @@ function SceneDrawableObserver()
 }
 
 /**
- * This function sends a defer request to the observer.  This is useful, for example, 
- * in situations where the Drawable is not provided a shader that accepts all the 
- * attributes it can offer.  The idea is to defer drawing until a more suitable shader 
- * becomes available.  The observer needs to report on it's ability to service 
- * the deferral request.  If the observer can't service the deferral request, the
- * Drawable needs to make do with whatever shader is available at the moment.
- * @param {DrawCommand} Draw command being requested for deferral
- * @param {number} Condition code as defined by SceneDrawableDeferConditionCode that is cause for the deferral
- * @return {boolean} True if the draw can be deferred, false otherwise
+ * Called when a drawable moved or children were added to or removed from it,
+ * anything the observer keeps about the geometry of the scene is out of date
+ * @param {SceneDrawable} drawable Drawable that changed
  */
-SceneDrawableObserver.prototype.onDeferredDrawRequested = function ( command, conditionCode ) { return false; };
+SceneDrawableObserver.prototype.onDrawableChanged = function ( drawable ) {};
 
 /**
  * @constructor
@@ -53,13 +38,10 @@ SceneDrawableObserver.prototype.onDeferredDrawRequested = function ( command, co
 function SceneDrawable()
 {
     this.observer = undefined;
+    this.parent = undefined;
+    this.isTransformDirty = true;
     var objid_ = SceneDrawable.instanceCounter;
     this.objid_ = objid_;
-
-    // the first two bytes are used for the instance number
-    // the second two bytes are for the z value in screen space
-    this.objid = [ (0x000000ff & (objid_>>8))/255,
-                   (0x000000ff & objid_)/255, 1, 1];
     SceneDrawable.instanceCounter += 1;
 }
 
@@ -83,22 +65,71 @@ SceneDrawable.prototype.setObserver = function ( observer )
 };
 
 /**
- * Send out a deferred draw request to the observer.  See notes for 
- * SceneDrawableObserver.onDeferredDrawRequested()
- * @param {DrawCommand} Draw command being requested for deferral
- * @param {number} Condition code as defined by SceneDrawableDeferConditionCode that is cause for the deferral
- * @return {boolean} True if the draw can be deferred, false otherwise
+ * Set the group this drawable is a child of
+ * @param {GGroup|undefined} parent
  */
-SceneDrawable.prototype.requestDeferredDraw = function( command, conditionCode )
+SceneDrawable.prototype.setParent = function ( parent )
+{
+    this.parent = parent;
+    this.isTransformDirty = true;
+};
+
+/**
+ * Let the observer know this drawable changed, see 
+ * SceneDrawableObserver.onDrawableChanged()
+ */
+SceneDrawable.prototype.notifyChanged = function ()
 {
     if ( undefined != this.observer )
     {
-        return this.observer.onDeferredDrawRequested( command, conditionCode );
+        this.observer.onDrawableChanged( this );
+    }
+};
+
+/**
+ * Let the parent know the bounds of this drawable changed in its space and 
+ * the observer that it changed
+ */
+SceneDrawable.prototype.invalidateParentBounds = function ()
+{
+    if ( undefined !== this.parent )
+    {
+        this.parent.invalidateBounds();
     }
     
-    return false;
+    this.notifyChanged();
 };
 
+/**
+ * Add the bounds of this drawable, in the space of its parent, to the 
+ * provided bounds
+ * @param {GBounds} outBounds
+ * @return {boolean} False if the drawable can't be bounded, it is never culled
+ */
+SceneDrawable.prototype.addBoundsTo = function ( outBounds ) { return false; };
+
+/**
+ * Recalculate the world matrix of this drawable and the ones below it if 
+ * they moved since the last call
+ * @param {Float32Array} parentWorldMatrix World matrix of the parent
+ * @param {boolean} isParentChanged True if the parent world matrix changed
+ */
+SceneDrawable.prototype.updateWorldMatrix = function ( parentWorldMatrix, isParentChanged ) {};
+
+/**
+ * Add the meshes under this drawable to the picking hierarchy of the scene,
+ * the world matrices have to be up to date
+ * @param {GSceneBvh} bvh
+ */
+SceneDrawable.prototype.addPickItems = function ( bvh ) {};
+
+/**
+ * Add the meshes under this drawable to the render queue of the scene, the 
+ * world matrices have to be up to date
+ * @param {GRenderQueue} queue
+ */
+SceneDrawable.prototype.addToRenderQueue = function ( queue ) {};
+
 /**
  * Get the name of this Drawable
  * @param {string} The name of this object
@@ -123,11 +154,13 @@ SceneDrawable.prototype.bindToContext = function( gl ) {};
 SceneDrawable.prototype.deleteResources = function () {};
 
 /**
- * Draw this group
- * @param {Array.<number>} List of numbers representing the parent 4 by 4 view matrix
+ * Draw this group, the world matrices have to be up to date
+ * @param {Array.<number>} List of numbers representing the 4 by 4 view matrix of the camera
  * @param {Array.<GMaterial>} List of materials to use for rendering
  * @param {GShader} Shader program to use for rendering
  * @param {number} Draw mode for drawing the VBOs
+ * @param {GFrustum=} frustum Frustum of the camera, drawables outside of it 
+ *        are skipped.  Undefined when everything has to be drawn.
  */
-SceneDrawable.prototype.draw = function( parentMvMat, materials, shader, drawMode ) {};
+SceneDrawable.prototype.draw = function( parentMvMat, materials, shader, drawMode, frustum ) {};
 
@@ -75,9 +75,7 @@ function Cuboid( w, h, d, name )
         30, 31, 32,  33, 34, 35  // back
     ];
     
-    this.vertBuffer = undefined;
-    this.tverBuffer = undefined;
-    this.normlBuffer = undefined;
+    this.vertexBuffer = undefined;
     this.indexBuffer = undefined;
     this.vertA = verts;
     this.tverA = tverts;
@@ -90,7 +88,6 @@ function Cuboid( w, h, d, name )
     this.mtlName = undefined;
     this.material = undefined;
     this.valid = true;
-    this.drawMvMatrix = mat4.create();
     this.normalMatrix = mat4.create();
 }
 
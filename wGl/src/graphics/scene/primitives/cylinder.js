@@ -37,9 +37,7 @@ function Cylinder( radius, height, sliceCount, name )
     
     this.updateBufferArrays();
     
-    this.vertBuffer = undefined;
-    this.tverBuffer = undefined;
-    this.normlBuffer = undefined;
+    this.vertexBuffer = undefined;
     this.indexBuffer = undefined;
      
     this.mvMatrix = mat4.create(); 
@@ -49,7 +47,6 @@ function Cylinder( radius, height, sliceCount, name )
     this.mtlName = undefined;
     this.material = undefined;
     this.valid = true;
-    this.drawMvMatrix = mat4.create();
     this.normalMatrix = mat4.create();
 }
 
@@ -36,9 +36,7 @@ function Sphere( radius, sliceCount, stackCount, name )
     
     this.updateBufferArrays();
     
-    this.vertBuffer = undefined;
-    this.tverBuffer = undefined;
-    this.normlBuffer = undefined;
+    this.vertexBuffer = undefined;
     this.indexBuffer = undefined;
      
     this.mvMatrix = mat4.create(); 
@@ -48,7 +46,6 @@ function Sphere( radius, sliceCount, stackCount, name )
     this.mtlName = undefined;
     this.material = undefined;
     this.valid = true;
-    this.drawMvMatrix = mat4.create();
     this.normalMatrix = mat4.create();
 }
 
@@ -38,9 +38,7 @@ function Torus( radiusMajor, radiusMinor, sliceCountMajor, sliceCountMinor, name
     
     this.updateBufferArrays();
     
-    this.vertBuffer = undefined;
-    this.tverBuffer = undefined;
-    this.normlBuffer = undefined;
+    this.vertexBuffer = undefined;
     this.indexBuffer = undefined;
      
     this.mvMatrix = mat4.create(); 
@@ -50,7 +48,6 @@ function Torus( radiusMajor, radiusMinor, sliceCountMajor, sliceCountMinor, name
     this.mtlName = undefined;
     this.material = undefined;
     this.valid = true;
-    this.drawMvMatrix = mat4.create();
     this.normalMatrix = mat4.create();
 }
 
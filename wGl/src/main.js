@@ -62,6 +62,7 @@ function animate() {
 
 	if (context.isReady())
 	{
+        context.update(elapsed);
         lesson.update(elapsed);
     }
     if (context.isReady())
@@ -163,6 +164,12 @@ function createAppFSM()
 function mainLoop()
 {
 	context = new GContext(document.getElementById("glcanvas"));
+	
+	if ( "1" === _appArgs["quantize"] )
+	{
+	    context.enableQuantizedAttributes();
+	}
+	
 	scene   = new GScene();
 	camera  = new GCamera();
 	hud     = new GHudController();
@@ -170,6 +177,7 @@ function mainLoop()
 	scene.setCamera(camera);
 	context.setScene(scene);
 	context.setHud(hud);
+	context.setDecodePool(GDecodeWorkerPool.createBrowserPool("src/workers/gdecodeworker.js"));
 	
 	createAppFSM();
 	
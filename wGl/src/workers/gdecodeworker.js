@@ -0,0 +1,320 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Entry point of the decode workers created by GDecodeWorkerPool.  This file
+// is not part of the main bundle, the release build concatenates it with the
+// readers it needs into build/gdecodeworker.js.  When loaded straight from the
+// sources the readers are imported here.  In node the port is provided as
+// GDecodeWorkerPort by whoever starts the worker thread.
+
+if ( typeof GObjReader === "undefined" && typeof importScripts === "function" )
+{
+    importScripts( "../graphics/core/glmatrix.js",
+                   "../graphics/assetloader/proxy/gtypedarraybuilder.js",
+                   "../graphics/assetloader/proxy/geometryskin.js",
+                   "../graphics/assetloader/proxy/geometrytrimesh.js",
+                   "../graphics/assetloader/proxy/gmeshmergeplanner.js",
+                   "../graphics/assetloader/proxy/gmeshsimplifier.js",
+                   "../graphics/assetloader/proxy/gmeshoptimizer.js",
+                   "../graphics/assetloader/proxy/ginstancedetector.js",
+                   "../graphics/assetloader/obj/reader/gobjtokenizer.js",
+                   "../graphics/assetloader/obj/reader/gobjreader.js",
+                   "../graphics/assetloader/threejs/reader/threejsreader.js" );
+}
+
+/**
+ * @constructor
+ * @implements {GObjReaderObserver}
+ * @implements {ThreejsReaderObserver}
+ * @param {Object} port Object used to post the results back
+ */
+function GDecodeWorker( port )
+{
+    this.port = port;
+    this.meshes = [];
+    this.skins = [];
+    this.lodChains = [];
+    this.instanceSets = [];
+    this.mtlLibs = [];
+}
+
+/**
+ * Decode the requested file and post the result back
+ * @param {Object} request
+ */
+GDecodeWorker.prototype.onMessage = function ( request )
+{
+    var response = { 'id': request['id'] };
+    var transferList = [];
+
+    this.meshes = [];
+    this.skins = [];
+    this.lodChains = [];
+    this.instanceSets = [];
+    this.mtlLibs = [];
+
+    try
+    {
+        if ( "obj" === request['kind'] )
+        {
+            this.decodeObj( request );
+        }
+        else if ( "threejs" === request['kind'] )
+        {
+            response['json'] = this.decodeThreejs( request );
+        }
+        else
+        {
+            throw new Error( "unknown job kind [" + request['kind'] + "]" );
+        }
+
+        response['meshes'] = [];
+        for ( var i = 0; i < this.meshes.length; ++i )
+        {
+            response['meshes'].push( this.packMesh( this.meshes[i], this.skins[i], transferList ) );
+        }
+        for ( i = 0; i < this.lodChains.length; ++i )
+        {
+            response['meshes'].push( this.packLodChain( this.lodChains[i], transferList ) );
+        }
+        for ( i = 0; i < this.instanceSets.length; ++i )
+        {
+            response['meshes'].push( this.packInstanceSet( this.instanceSets[i], transferList ) );
+        }
+        response['mtlLibs'] = this.mtlLibs;
+    }
+    catch ( e )
+    {
+        response = { 'id': request['id'], 'error': String( e ) };
+        transferList = [];
+    }
+
+    this.port.postMessage( response, transferList );
+};
+
+/**
+ * Decode an obj file
+ * @param {Object} request
+ */
+GDecodeWorker.prototype.decodeObj = function ( request )
+{
+    var reader = new GObjReader( "", null, null, this );
+    reader.read( new Uint8Array( request['buffer'] ) );
+    reader.finish();
+
+    // the copies are found before anything rewrites the meshes, they don't
+    // take part in the levels of detail or the merge
+    if ( true === request['instancing'] )
+    {
+        var found = GInstanceDetector.findDuplicates( this.meshes );
+        this.meshes = found.meshes;
+        this.instanceSets = found.instances;
+    }
+
+    if ( true === request['lod'] )
+    {
+        this.buildLodChains();
+    }
+
+    if ( true === request['merge'] )
+    {
+        this.meshes = GeometryTriMesh.mergeByMaterial( this.meshes, request['maxMergeVertCount'] );
+    }
+
+    // reorder once the final meshes are known, merging would only 
+    // concatenate the orders of its inputs
+    for ( var i = 0; i < this.meshes.length; ++i )
+    {
+        GMeshOptimizer.optimize( this.meshes[i] );
+    }
+
+    for ( i = 0; i < this.lodChains.length; ++i )
+    {
+        for ( var j = 0; j < this.lodChains[i].length; ++j )
+        {
+            GMeshOptimizer.optimize( this.lodChains[i][j] );
+        }
+    }
+
+    for ( i = 0; i < this.instanceSets.length; ++i )
+    {
+        GMeshOptimizer.optimize( this.instanceSets[i].mesh );
+    }
+};
+
+/**
+ * Move the meshes that are large enough out of the decoded list and build
+ * their levels of detail, these don't take part in the merge by material
+ */
+GDecodeWorker.prototype.buildLodChains = function ()
+{
+    var meshes = [];
+
+    for ( var i = 0; i < this.meshes.length; ++i )
+    {
+        if ( this.meshes[i].getIndexCount() / 3 >= GMeshSimplifier.MIN_LOD_TRIANGLES )
+        {
+            this.lodChains.push( GMeshSimplifier.buildLodChain( this.meshes[i] ) );
+        }
+        else
+        {
+            meshes.push( this.meshes[i] );
+        }
+    }
+
+    this.meshes = meshes;
+};
+
+/**
+ * Decode a three.js json file
+ * @param {Object} request
+ * @return {Object} The parts of the json the loader still needs
+ */
+GDecodeWorker.prototype.decodeThreejs = function ( request )
+{
+    var json = JSON.parse( this.decodeText( new Uint8Array( request['buffer'] ) ) );
+    var reader = new ThreejsReader( "", json, null, null, this );
+
+    reader.readAll();
+
+    return { 'bones': json['bones'],
+             'animations': json['animations'],
+             'materials': json['materials'] };
+};
+
+/**
+ * Collect the typed arrays of a decoded mesh, the mesh is dropped once it's
+ * packed so its buffers are transferred instead of copied
+ * @param {GeometryTriMesh} mesh
+ * @param {GeometrySkin|undefined} skin
+ * @param {Array.<ArrayBuffer>} transferList Receives the buffers to transfer
+ * @return {Object}
+ */
+GDecodeWorker.prototype.packMesh = function ( mesh, skin, transferList )
+{
+    var packed = 
+    {
+        'name': mesh.getName(),
+        'mtlName': mesh.getMtlName(),
+        'verts': mesh.getVertBuffer(),
+        'tverts': mesh.getTVerBuffer(),
+        'normals': mesh.getNormBuffer(),
+        'indices': mesh.getIndexBuffer()
+    };
+
+    transferList.push( packed['verts'].buffer, packed['tverts'].buffer,
+                       packed['normals'].buffer, packed['indices'].buffer );
+
+    if ( undefined !== skin )
+    {
+        packed['skin'] = skin.getSkinBuffer();
+        transferList.push( packed['skin'].buffer );
+    }
+
+    return packed;
+};
+
+/**
+ * Pack the first level of a chain, the other levels go in its lods list
+ * @param {Array.<GeometryTriMesh>} levels
+ * @param {Array.<ArrayBuffer>} transferList Receives the buffers to transfer
+ * @return {Object}
+ */
+GDecodeWorker.prototype.packLodChain = function ( levels, transferList )
+{
+    var packed = this.packMesh( levels[0], undefined, transferList );
+
+    packed['lods'] = [];
+    for ( var i = 1; i < levels.length; ++i )
+    {
+        packed['lods'].push( this.packMesh( levels[i], undefined, transferList ) );
+    }
+
+    return packed;
+};
+
+/**
+ * Pack the mesh of a set of copies along with the offsets of the copies
+ * @param {Object} set Set found by GInstanceDetector.findDuplicates
+ * @param {Array.<ArrayBuffer>} transferList Receives the buffers to transfer
+ * @return {Object}
+ */
+GDecodeWorker.prototype.packInstanceSet = function ( set, transferList )
+{
+    var packed = this.packMesh( set.mesh, undefined, transferList );
+
+    packed['instances'] = set.offsets;
+    transferList.push( set.offsets.buffer );
+
+    return packed;
+};
+
+/**
+ * Decode utf-8 bytes into a string
+ * @param {Uint8Array} bytes
+ * @return {string}
+ */
+GDecodeWorker.prototype.decodeText = function ( bytes )
+{
+    if ( typeof TextDecoder !== "undefined" )
+    {
+        return new TextDecoder( "utf-8" ).decode( bytes );
+    }
+
+    var ret = "";
+    for ( var i = 0; i < bytes.length; i += 8192 )
+    {
+        ret += String.fromCharCode.apply( null, bytes.subarray( i, i + 8192 ) );
+    }
+
+    return decodeURIComponent( escape( ret ) );
+};
+
+/**
+ * @param {GeometryTriMesh} mesh
+ * @param {GeometrySkin=} skin
+ */
+GDecodeWorker.prototype.onNewMeshAvailable = function ( mesh, skin )
+{
+    this.meshes.push( mesh );
+    this.skins.push( skin );
+};
+
+/**
+ * @param {string} name
+ */
+GDecodeWorker.prototype.onMtlLibReferenced = function ( name )
+{
+    this.mtlLibs.push( name );
+};
+
+( function ()
+{
+    if ( typeof GDecodeWorkerPort !== "undefined" )
+    {
+        var nodeWorker = new GDecodeWorker( GDecodeWorkerPort );
+        GDecodeWorkerPort.on( "message", function ( request ) { nodeWorker.onMessage( request ); } );
+    }
+    else
+    {
+        var worker = new GDecodeWorker( self );
+        self.onmessage = function ( e ) { worker.onMessage( e.data ); };
+    }
+} )();
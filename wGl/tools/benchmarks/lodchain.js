@@ -0,0 +1,79 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Level of detail generation for the meshes of an obj file.
+//
+// usage: node tools/benchmarks/lodchain.js [file.obj]
+//
+// Without a file assets/3d/stylus/object.obj is used.
+//
+// Every mesh with at least GMeshSimplifier.MIN_LOD_TRIANGLES triangles gets 
+// its chain built, the triangle count of each level and the time it took are
+// reported per mesh along with the totals for the file.
+
+var fs = require( "fs" );
+var path = require( "path" );
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/proxy/gmeshsimplifier.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js" ] );
+
+var meshes = [];
+var reader = new ctx.GObjReader( "", null, null,
+{
+    onNewMeshAvailable: function ( mesh ) { meshes.push( mesh ); },
+    onMtlLibReferenced: function ( name ) {}
+} );
+
+var file = process.argv[2] || path.join( __dirname, "..", "..", "assets", "3d", "stylus", "object.obj" );
+
+reader.read( new Uint8Array( fs.readFileSync( file ) ) );
+reader.finish();
+
+var totals = [];
+var totalTime = 0;
+
+for ( var i = 0; i < meshes.length; ++i )
+{
+    if ( meshes[i].getIndexCount() / 3 < ctx.GMeshSimplifier.MIN_LOD_TRIANGLES )
+    {
+        continue;
+    }
+
+    var start = Date.now();
+    var levels = ctx.GMeshSimplifier.buildLodChain( meshes[i] );
+    var time = Date.now() - start;
+    var counts = [];
+
+    for ( var j = 0; j < levels.length; ++j )
+    {
+        counts.push( levels[j].getIndexCount() / 3 );
+        totals[j] = ( totals[j] || 0 ) + counts[j];
+    }
+
+    totalTime += time;
+    console.log( meshes[i].getName() + "\t" + counts.join( " / " ) + " triangles\t" + time + " ms" );
+}
+
+console.log( "total\t" + totals.join( " / " ) + " triangles\t" + totalTime + " ms" );
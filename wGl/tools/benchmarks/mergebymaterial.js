@@ -0,0 +1,251 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Merge by material for many small groups.
+//
+// usage: node tools/benchmarks/mergebymaterial.js [groupCount]
+//
+// Small quads spread over a few materials are merged the way deferMeshForMerge
+// used to do it, by growing the first mesh of each material on every merge,
+// and through GMeshMergePlanner which copies every group once into an
+// exactly sized mesh.  Both results are compared along with the bytes held
+// by the merged meshes.
+//
+// The script runs itself again with --expose-gc when it was started without
+// it, garbage is collected before every timed run so neither approach pays
+// for the garbage of the other.  Both are warmed up first, the runs 
+// alternate which one goes first and the median of each is reported.
+
+var childProcess = require( "child_process" );
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/proxy/gmeshmergeplanner.js" ] );
+
+var MATERIAL_COUNT = 4;
+var GROUP_VERT_COUNT = 24;
+var WARMUP_RUNS = 3;
+var RUNS = 15;
+
+/**
+ * Build groups of GROUP_VERT_COUNT vertices cycling through the materials
+ * @param {number} groupCount
+ * @return {Array.<GeometryTriMesh>}
+ */
+function makeGroups( groupCount )
+{
+    var meshes = [];
+
+    for ( var i = 0; i < groupCount; ++i )
+    {
+        var mesh = new ctx.GeometryTriMesh( "g" + i );
+        mesh.setMtlName( "mtl" + (i % MATERIAL_COUNT) );
+
+        for ( var j = 0; j < GROUP_VERT_COUNT; j += 4 )
+        {
+            for ( var k = 0; k < 4; ++k )
+            {
+                mesh.addVertex( i + (k & 1), j, k >> 1, 0, 1, 0, k & 1, k >> 1 );
+            }
+
+            mesh.addIndex( j ); mesh.addIndex( j+1 ); mesh.addIndex( j+2 );
+            mesh.addIndex( j+2 ); mesh.addIndex( j+1 ); mesh.addIndex( j+3 );
+        }
+
+        mesh.prepareToClose();
+        meshes.push( mesh );
+    }
+
+    return meshes;
+}
+
+/**
+ * Previous approach, every group is merged into the first mesh with room
+ * @param {Array.<GeometryTriMesh>} meshes
+ * @return {Array.<GeometryTriMesh>}
+ */
+function mergeIncremental( meshes )
+{
+    var byMaterial = {};
+    var merged = [];
+
+    for ( var i = 0; i < meshes.length; ++i )
+    {
+        var candidates = byMaterial[meshes[i].getMtlName()] || [];
+        byMaterial[meshes[i].getMtlName()] = candidates;
+
+        for ( var j = 0; j < candidates.length; ++j )
+        {
+            if ( candidates[j].canMerge( meshes[i] ) )
+            {
+                break;
+            }
+        }
+
+        if ( j < candidates.length )
+        {
+            candidates[j].merge( meshes[i] );
+        }
+        else
+        {
+            // copy so the source groups stay untouched for the next run
+            var target = new ctx.GeometryTriMesh( meshes[i].getName() );
+            target.setMtlName( meshes[i].getMtlName() );
+            target.merge( meshes[i] );
+            candidates.push( target );
+            merged.push( target );
+        }
+    }
+
+    return merged;
+}
+
+/**
+ * @param {Array.<GeometryTriMesh>} a
+ * @param {Array.<GeometryTriMesh>} b
+ * @return {boolean}
+ */
+function sameMeshes( a, b )
+{
+    if ( a.length !== b.length )
+    {
+        return false;
+    }
+
+    for ( var i = 0; i < a.length; ++i )
+    {
+        var pairs = [ [ a[i].getVertBuffer(), b[i].getVertBuffer() ],
+                      [ a[i].getNormBuffer(), b[i].getNormBuffer() ],
+                      [ a[i].getTVerBuffer(), b[i].getTVerBuffer() ],
+                      [ a[i].getIndexBuffer(), b[i].getIndexBuffer() ] ];
+
+        for ( var p = 0; p < pairs.length; ++p )
+        {
+            if ( pairs[p][0].length !== pairs[p][1].length )
+            {
+                return false;
+            }
+
+            for ( var j = 0; j < pairs[p][0].length; ++j )
+            {
+                if ( pairs[p][0][j] !== pairs[p][1][j] )
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Bytes held by the backing stores of the provided meshes
+ * @param {Array.<GeometryTriMesh>} meshes
+ * @return {number}
+ */
+function allocatedBytes( meshes )
+{
+    var bytes = 0;
+
+    for ( var i = 0; i < meshes.length; ++i )
+    {
+        bytes += meshes[i].gVerts.data.byteLength + meshes[i].nVerts.data.byteLength +
+                 meshes[i].tVerts.data.byteLength + meshes[i].indices.data.byteLength;
+    }
+
+    return bytes;
+}
+
+/**
+ * Time one merge, garbage is collected first and the result is dropped
+ * before the next run
+ * @param {function(Array.<GeometryTriMesh>):Array.<GeometryTriMesh>} merge
+ * @param {Array.<GeometryTriMesh>} groups
+ * @return {number} Milliseconds
+ */
+function timeMerge( merge, groups )
+{
+    global.gc();
+    var start = process.hrtime();
+    merge( groups );
+    var elapsed = process.hrtime( start );
+
+    return elapsed[0] * 1000 + elapsed[1] / 1e6;
+}
+
+/**
+ * @param {Array.<number>} values
+ * @return {number}
+ */
+function median( values )
+{
+    var sorted = values.slice().sort( function ( a, b ) { return a - b; } );
+    return sorted[ sorted.length >> 1 ];
+}
+
+/**
+ * Run the two merges and report the timings
+ * @param {number} groupCount
+ */
+function run( groupCount )
+{
+    var groups = makeGroups( groupCount );
+    var variants = [ { name: "incremental\t", merge: mergeIncremental, times: [] },
+                     { name: "planned\t\t", merge: ctx.GeometryTriMesh.mergeByMaterial, times: [] } ];
+    var i = 0;
+
+    for ( i = 0; i < WARMUP_RUNS; ++i )
+    {
+        timeMerge( variants[0].merge, groups );
+        timeMerge( variants[1].merge, groups );
+    }
+
+    for ( i = 0; i < RUNS; ++i )
+    {
+        var first = i & 1;
+        variants[first].times.push( timeMerge( variants[first].merge, groups ) );
+        variants[1-first].times.push( timeMerge( variants[1-first].merge, groups ) );
+    }
+
+    var incremental = mergeIncremental( groups );
+    var planned = ctx.GeometryTriMesh.mergeByMaterial( groups );
+
+    console.log( groupCount + " groups -> " + planned.length + " meshes, median of " + RUNS + " runs" );
+    console.log( variants[0].name + median( variants[0].times ).toFixed( 1 ) + " ms\t" + 
+                 allocatedBytes( incremental ) + " bytes" );
+    console.log( variants[1].name + median( variants[1].times ).toFixed( 1 ) + " ms\t" + 
+                 allocatedBytes( planned ) + " bytes" );
+    console.log( sameMeshes( incremental, planned ) ? "results match" : "RESULTS DIFFER" );
+}
+
+if ( typeof global.gc !== "function" )
+{
+    // the timings are meaningless without collecting between the runs
+    var result = childProcess.spawnSync( process.execPath, [ "--expose-gc", __filename ].concat( process.argv.slice( 2 ) ),
+                                         { stdio: "inherit" } );
+    process.exitCode = result.status;
+}
+else
+{
+    run( parseInt( process.argv[2] || "40000", 10 ) );
+}
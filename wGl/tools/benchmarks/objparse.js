@@ -0,0 +1,208 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Obj parse throughput.
+//
+// usage: node tools/benchmarks/objparse.js [file.obj]
+//
+// Without a file a textured and lit grid is generated.  The file is streamed
+// through GObjTokenizer and GObjReader in the chunks node hands out, and the
+// same bytes are also parsed the way the loader used to: decode to a string,
+// split on lines and spaces and parseFloat every token.
+
+var fs = require( "fs" );
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js" ] );
+
+var RUNS = 3;
+
+/**
+ * Generate a grid obj with per vertex texture coordinates and normals
+ * @param {number} gridSize
+ * @return {Buffer}
+ */
+function makeObj( gridSize )
+{
+    var lines = [ "g bench" ];
+    var x = 0;
+    var z = 0;
+
+    for ( z = 0; z <= gridSize; ++z )
+    {
+        for ( x = 0; x <= gridSize; ++x )
+        {
+            lines.push( "v " + (x / gridSize).toFixed( 6 ) + " " +
+                        (0.1 * Math.sin( x * 0.3 )).toFixed( 6 ) + " " +
+                        (z / gridSize).toFixed( 6 ) );
+            lines.push( "vt " + (x / gridSize).toFixed( 6 ) + " " + (z / gridSize).toFixed( 6 ) );
+            lines.push( "vn 0.000000 1.000000 0.000000" );
+        }
+    }
+
+    for ( z = 0; z < gridSize; ++z )
+    {
+        for ( x = 0; x < gridSize; ++x )
+        {
+            var a = z * (gridSize + 1) + x + 1;
+            var b = a + 1;
+            var c = a + gridSize + 1;
+            var d = c + 1;
+            lines.push( "f " + a + "/" + a + "/" + a + " " + c + "/" + c + "/" + c + " " +
+                        d + "/" + d + "/" + d + " " + b + "/" + b + "/" + b );
+        }
+    }
+
+    return Buffer.from( lines.join( "\n" ) );
+}
+
+/**
+ * String based parse, the way the loader worked before the tokenizer
+ * @param {Buffer} bytes
+ * @return {number} Number of tokens parsed
+ */
+function parseStrings( bytes )
+{
+    var lines = bytes.toString( "utf8" ).split( "\n" );
+    var sum = 0;
+
+    for ( var i = 0; i < lines.length; ++i )
+    {
+        var tokens = lines[i].split( " " );
+        for ( var j = 1; j < tokens.length; ++j )
+        {
+            var parts = tokens[j].split( "/" );
+            for ( var k = 0; k < parts.length; ++k )
+            {
+                sum += parseFloat( parts[k] ) || 0;
+            }
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * Run only the tokenizer over the provided chunks
+ * @param {Array.<Buffer>} chunks
+ */
+function tokenize( chunks )
+{
+    var noop = function () {};
+    var tokenizer = new ctx.GObjTokenizer( { onVertex: noop, onTexVertex: noop, onNormal: noop,
+                                             onFace: noop, onGroup: noop, onSmooth: noop,
+                                             onUseMtl: noop, onMtlLib: noop,
+                                             onInvertNormals: noop, onEndOfFile: noop } );
+
+    for ( var i = 0; i < chunks.length; ++i )
+    {
+        tokenizer.push( new Uint8Array( chunks[i].buffer, chunks[i].byteOffset, chunks[i].length ) );
+    }
+    tokenizer.finish();
+}
+
+/**
+ * Run the reader over the provided chunks
+ * @param {Array.<Buffer>} chunks
+ * @return {Array.<GeometryTriMesh>}
+ */
+function parseBytes( chunks )
+{
+    var meshes = [];
+    var reader = new ctx.GObjReader( "", null, null,
+                                     { onNewMeshAvailable: function ( mesh ) { meshes.push( mesh ); },
+                                       onMtlLibReferenced: function ( name ) {} } );
+
+    for ( var i = 0; i < chunks.length; ++i )
+    {
+        reader.read( new Uint8Array( chunks[i].buffer, chunks[i].byteOffset, chunks[i].length ) );
+    }
+    reader.finish();
+
+    return meshes;
+}
+
+/**
+ * @param {string} label
+ * @param {number} bytes
+ * @param {function()} fn
+ */
+function time( label, bytes, fn )
+{
+    var best = Infinity;
+
+    for ( var i = 0; i < RUNS; ++i )
+    {
+        var start = process.hrtime();
+        fn();
+        var delta = process.hrtime( start );
+        best = Math.min( best, delta[0] * 1e3 + delta[1] / 1e6 );
+    }
+
+    console.log( label + "\t" + best.toFixed( 1 ) + " ms\t" +
+                 (bytes / 1048576 / (best / 1000)).toFixed( 1 ) + " MB/s" );
+}
+
+/**
+ * Run the benchmarks on the collected chunks
+ * @param {Array.<Buffer>} chunks
+ */
+function report( chunks )
+{
+    var all = Buffer.concat( chunks );
+    var meshes = parseBytes( chunks );
+    var verts = 0;
+    var tris = 0;
+
+    for ( var i = 0; i < meshes.length; ++i )
+    {
+        verts += meshes[i].getVertCount();
+        tris += meshes[i].getIndexCount() / 3;
+    }
+
+    console.log( (all.length / 1048576).toFixed( 1 ) + " MB in " + chunks.length + " chunks, " +
+                 meshes.length + " meshes, " + verts + " welded verts, " + tris + " tris" );
+
+    time( "strings", all.length, function () { parseStrings( all ); } );
+    time( "tokenizer", all.length, function () { tokenize( chunks ); } );
+    time( "reader", all.length, function () { parseBytes( chunks ); } );
+}
+
+if ( process.argv[2] )
+{
+    var chunks = [];
+    fs.createReadStream( process.argv[2] )
+      .on( "data", function ( chunk ) { chunks.push( chunk ); } )
+      .on( "end", function () { report( chunks ); } );
+}
+else
+{
+    var obj = makeObj( 512 );
+    var generated = [];
+    for ( var offset = 0; offset < obj.length; offset += 65536 )
+    {
+        generated.push( obj.slice( offset, offset + 65536 ) );
+    }
+    report( generated );
+}
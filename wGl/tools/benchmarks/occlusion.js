@@ -0,0 +1,161 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Occlusion culling against a quad occluder.
+//
+// usage: node tools/benchmarks/occlusion.js [boxCount]
+//
+// A wall is rasterized into a GOcclusionBuffer and boxes around it are 
+// tested: the one behind the wall has to be culled, the ones beside it, 
+// across its edge and in front of it have to stay visible.  A floor that 
+// reaches behind the camera goes through the near plane clipping, a box 
+// under it has to be culled and one above it has to stay visible.  Then the
+// rasterization of the wall and the test of boxCount boxes spread over the
+// screen behind it are timed, best of RUNS.
+
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/core/gbounds.js",
+                      "graphics/core/gocclusionbuffer.js" ] );
+
+var mat4 = ctx.mat4;
+var RUNS = 20;
+
+// 2 by 2 quad facing the camera 5 units away and a floor one unit below
+// the camera from 10 units behind it to 50 units in front
+var WALL_VERTS = [ -2, -2, -5,   2, -2, -5,   2, 2, -5,   -2, 2, -5 ];
+var FLOOR_VERTS = [ -50, -1, 10,   50, -1, 10,   50, -1, -50,   -50, -1, -50 ];
+var QUAD_INDICES = [ 0, 1, 2,   0, 2, 3 ];
+
+var unitBox = ctx.GBounds.fromVertices( [ -0.5, -0.5, -0.5,   0.5, 0.5, 0.5 ] );
+var identity = mat4.create();
+var viewProjection = mat4.create();
+var world = mat4.create();
+
+// the camera is at the origin looking down -z with the aspect of the buffer
+mat4.perspective( viewProjection, Math.PI / 3, 
+                  ctx.GOcclusionBuffer.WIDTH / ctx.GOcclusionBuffer.HEIGHT, 0.1, 100 );
+
+var clippedCount = 0;
+var rasterizeClipped = ctx.GOcclusionBuffer.prototype.rasterizeClipped;
+
+ctx.GOcclusionBuffer.prototype.rasterizeClipped = function ( triangle )
+{
+    clippedCount += 1;
+    rasterizeClipped.call( this, triangle );
+};
+
+/**
+ * Start a buffer and rasterize an occluder with the identity world matrix
+ * @param {GOcclusionBuffer} buffer
+ * @param {Array.<number>} verts
+ */
+function rasterize( buffer, verts )
+{
+    buffer.begin( viewProjection );
+    buffer.rasterizeMesh( verts, QUAD_INDICES, identity );
+    buffer.end();
+}
+
+/**
+ * @param {GOcclusionBuffer} buffer
+ * @param {number} x
+ * @param {number} y
+ * @param {number} z
+ * @return {boolean} True if a unit box at the provided position is visible
+ */
+function isBoxVisible( buffer, x, y, z )
+{
+    world[12] = x;
+    world[13] = y;
+    world[14] = z;
+    return buffer.isVisible( unitBox, world );
+}
+
+var failures = 0;
+
+/**
+ * @param {string} label
+ * @param {boolean} expected
+ * @param {boolean} visible
+ */
+function check( label, expected, visible )
+{
+    var ok = ( expected === visible );
+    failures += ok ? 0 : 1;
+
+    console.log( ( ok ? "ok     " : "FAILED " ) + label + "\t" + ( visible ? "visible" : "culled" ) );
+}
+
+var buffer = new ctx.GOcclusionBuffer();
+
+rasterize( buffer, WALL_VERTS );
+check( "behind the wall", false, isBoxVisible( buffer, 0, 0, -10 ) );
+check( "beside the wall", true, isBoxVisible( buffer, 6, 0, -10 ) );
+check( "across the edge", true, isBoxVisible( buffer, 4, 0, -10 ) );
+check( "in front of the wall", true, isBoxVisible( buffer, 0, 0, -3 ) );
+
+rasterize( buffer, FLOOR_VERTS );
+check( "under the floor", false, isBoxVisible( buffer, 0, -3, -10 ) );
+check( "above the floor", true, isBoxVisible( buffer, 0, 0, -10 ) );
+
+failures += ( clippedCount > 0 ) ? 0 : 1;
+console.log( ( clippedCount > 0 ? "ok     " : "FAILED " ) + "near plane clipping	" + clippedCount + " clipped triangles" );
+
+var boxCount = parseInt( process.argv[2] || "10000", 10 );
+var positions = new Float32Array( 3 * boxCount );
+var seed = 1;
+
+for ( var i = 0; i < positions.length; ++i )
+{
+    // boxes up to twice as far out as the wall reaches, behind it
+    seed = ( seed * 16807 ) % 2147483647;
+    positions[i] = ( 2 === i % 3 ) ? -6 - 10 * seed / 2147483647 : 8 * seed / 2147483647 - 4;
+}
+
+var rasterizeTime = Infinity;
+var testTime = Infinity;
+var occluded = 0;
+
+for ( var run = 0; run < RUNS; ++run )
+{
+    var start = process.hrtime();
+    rasterize( buffer, WALL_VERTS );
+    var delta = process.hrtime( start );
+    rasterizeTime = Math.min( rasterizeTime, delta[0] * 1e3 + delta[1] / 1e6 );
+
+    occluded = 0;
+    start = process.hrtime();
+
+    for ( i = 0; i < boxCount; ++i )
+    {
+        occluded += isBoxVisible( buffer, positions[3*i], positions[3*i+1], positions[3*i+2] ) ? 0 : 1;
+    }
+
+    delta = process.hrtime( start );
+    testTime = Math.min( testTime, delta[0] * 1e3 + delta[1] / 1e6 );
+}
+
+console.log( "rasterize wall\t" + rasterizeTime.toFixed( 3 ) + " ms\t" + 
+             ctx.GOcclusionBuffer.WIDTH + "x" + ctx.GOcclusionBuffer.HEIGHT );
+console.log( "test " + boxCount + " boxes\t" + testTime.toFixed( 3 ) + " ms\t" + occluded + " culled" );
+
+process.exitCode = ( 0 === failures ) ? 0 : 1;
@@ -0,0 +1,190 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Load time of a smoothed ("s 1") obj group against its vertex count.
+//
+// usage: node tools/benchmarks/smoothnormals.js [maxGridSize]
+//
+// A height field without normals is generated for every grid size and pushed
+// through GObjReader, which computes flat normals and then smooths them.  For
+// the smaller sizes the old all-pairs smoothing is timed as well and its
+// result is compared against the spatial hash version.
+
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js" ] );
+
+var BRUTE_FORCE_LIMIT = 25000;
+
+/**
+ * Previous O(n^2) implementation, kept here as the reference
+ * @param {GeometryTriMesh} mesh
+ */
+function bruteForceSmooth( mesh )
+{
+    var sigma = .000005;
+    var hyp = 2;
+    var g = mesh.getVertBuffer();
+    var n = mesh.getNormBuffer();
+    var vertCount = mesh.getVertCount();
+    var visitedVerts = [];
+    var i = 0;
+    var j = 0;
+
+    /**
+     * @param {Float32Array} a
+     * @param {number} i
+     * @param {number} j
+     * @return {number}
+     */
+    function sqrDist( a, i, j )
+    {
+        var x = a[3*i] - a[3*j], y = a[3*i+1] - a[3*j+1], z = a[3*i+2] - a[3*j+2];
+        return x*x + y*y + z*z;
+    }
+
+    for ( i = 0; i < vertCount; ++i )
+    {
+        visitedVerts[i] = false;
+    }
+
+    for ( i = 0; i < vertCount; ++i )
+    {
+        if ( false === visitedVerts[i] )
+        {
+            var vertsToVisit = [];
+            for ( j = 0; j < vertCount; ++j )
+            {
+                if ( false == visitedVerts[j] &&
+                     sqrDist( g, i, j ) < sigma &&
+                     sqrDist( n, i, j ) < hyp )
+                {
+                    vertsToVisit.push(j);
+                    visitedVerts[j] = true;
+                }
+            }
+
+            var avgNorm = ctx.vec3.create();
+            for ( j = 0; j < vertsToVisit.length; ++j )
+            {
+                var k = 3*vertsToVisit[j];
+                avgNorm[0] += n[k]; avgNorm[1] += n[k+1]; avgNorm[2] += n[k+2];
+            }
+            ctx.vec3.normalize( avgNorm, avgNorm );
+            for ( j = 0; j < vertsToVisit.length; ++j )
+            {
+                n.set( avgNorm, 3*vertsToVisit[j] );
+            }
+        }
+    }
+}
+
+/**
+ * Build the lines of a height field obj with gridSize^2 quads
+ * @param {number} gridSize
+ * @param {boolean} smooth
+ * @return {Array.<string>}
+ */
+function makeObjLines( gridSize, smooth )
+{
+    var lines = [ "g bench", smooth ? "s 1" : "s off" ];
+    var x = 0;
+    var z = 0;
+
+    for ( z = 0; z <= gridSize; ++z )
+    {
+        for ( x = 0; x <= gridSize; ++x )
+        {
+            var y = 0.1 * Math.sin( x * 0.3 ) * Math.cos( z * 0.2 );
+            lines.push( "v " + (x / gridSize) + " " + y + " " + (z / gridSize) );
+        }
+    }
+
+    for ( z = 0; z < gridSize; ++z )
+    {
+        for ( x = 0; x < gridSize; ++x )
+        {
+            var a = z * (gridSize + 1) + x + 1;
+            var b = a + 1;
+            var c = a + gridSize + 1;
+            var d = c + 1;
+            lines.push( "f " + a + " " + c + " " + d + " " + b );
+        }
+    }
+
+    return lines;
+}
+
+/**
+ * Run the reader over the provided lines
+ * @param {Array.<string>} lines
+ * @return {GeometryTriMesh}
+ */
+function read( lines )
+{
+    var result = undefined;
+    var reader = new ctx.GObjReader( "", null, null,
+                                     { onNewMeshAvailable: function ( mesh ) { result = mesh; } } );
+
+    reader.read( new Uint8Array( Buffer.from( lines.join( "\n" ) ) ) );
+    reader.finish();
+
+    return result;
+}
+
+var maxGridSize = parseInt( process.argv[2] || "256", 10 );
+
+console.log( "verts\thash ms\tall-pairs ms\tmax normal diff" );
+
+for ( var gridSize = 16; gridSize <= maxGridSize; gridSize *= 2 )
+{
+    var start = Date.now();
+    var mesh = read( makeObjLines( gridSize, true ) );
+    var hashTime = Date.now() - start;
+    var row = mesh.getVertCount() + "\t" + hashTime;
+
+    if ( mesh.getVertCount() <= BRUTE_FORCE_LIMIT )
+    {
+        start = Date.now();
+        var refMesh = read( makeObjLines( gridSize, false ) );
+        bruteForceSmooth( refMesh );
+        var bruteTime = Date.now() - start;
+
+        var maxDiff = 0;
+        var normals = mesh.getNormBuffer();
+        var refNormals = refMesh.getNormBuffer();
+        for ( var i = 0; i < normals.length; ++i )
+        {
+            maxDiff = Math.max( maxDiff, Math.abs( normals[i] - refNormals[i] ) );
+        }
+
+        row += "\t" + bruteTime + "\t" + maxDiff.toExponential( 2 );
+    }
+    else
+    {
+        row += "\t-\t-";
+    }
+
+    console.log( row );
+}
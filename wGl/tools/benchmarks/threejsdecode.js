@@ -0,0 +1,202 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// three.js json decode time.
+//
+// usage: node tools/benchmarks/threejsdecode.js [gridSize]
+//
+// A skinned grid of quads is written both as a format 3 face stream and as
+// an indexed BufferGeometry.  Each one is parsed and decoded with ThreejsReader.readAll
+// and the two results are compared.
+
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometryskin.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/threejs/reader/threejsreader.js" ] );
+
+var RUNS = 3;
+
+/**
+ * Build the face stream json of a skinned grid
+ * @param {number} gridSize
+ * @return {Object}
+ */
+function makeFaceJson( gridSize )
+{
+    var json = { vertices: [], normals: [ 0, 1, 0 ], uvs: [ [] ], faces: [],
+                 skinIndices: [], skinWeights: [] };
+    var x = 0;
+    var z = 0;
+
+    for ( z = 0; z <= gridSize; ++z )
+    {
+        for ( x = 0; x <= gridSize; ++x )
+        {
+            json.vertices.push( x / gridSize, 0, z / gridSize );
+            json.uvs[0].push( x / gridSize, z / gridSize );
+            json.skinIndices.push( x % 8, z % 8 );
+            json.skinWeights.push( 0.75, 0.25 );
+        }
+    }
+
+    for ( z = 0; z < gridSize; ++z )
+    {
+        for ( x = 0; x < gridSize; ++x )
+        {
+            var a = z * (gridSize + 1) + x;
+            var b = a + gridSize + 1;
+
+            // quad with material, vertex uvs and vertex normals
+            json.faces.push( 43, a, b, b+1, a+1, 0, a, b, b+1, a+1, 0, 0, 0, 0 );
+        }
+    }
+
+    return json;
+}
+
+/**
+ * Build the same grid as an indexed BufferGeometry
+ * @param {Object} faceJson
+ * @return {Object}
+ */
+function makeBufferJson( faceJson )
+{
+    var vertCount = faceJson.vertices.length / 3;
+    var normal = [];
+    var skinIndex = [];
+    var skinWeight = [];
+    var index = [];
+    var i = 0;
+
+    for ( i = 0; i < vertCount; ++i )
+    {
+        normal.push( 0, 1, 0 );
+        skinIndex.push( faceJson.skinIndices[2*i], faceJson.skinIndices[2*i+1], 0, 0 );
+        skinWeight.push( faceJson.skinWeights[2*i], faceJson.skinWeights[2*i+1], 0, 0 );
+    }
+
+    for ( i = 0; i < faceJson.faces.length; i += 14 )
+    {
+        var f = faceJson.faces;
+        index.push( f[i+1], f[i+2], f[i+3], f[i+3], f[i+4], f[i+1] );
+    }
+
+    return { metadata: { type: "BufferGeometry" },
+             data: { attributes: { position: { itemSize: 3, array: faceJson.vertices },
+                                   normal: { itemSize: 3, array: normal },
+                                   uv: { itemSize: 2, array: faceJson.uvs[0] },
+                                   skinIndex: { itemSize: 4, array: skinIndex },
+                                   skinWeight: { itemSize: 4, array: skinWeight } },
+                     index: { array: index } } };
+}
+
+/**
+ * Expand an indexed attribute buffer into one entry per index
+ * @param {ArrayBufferView} values
+ * @param {number} size Values per vertex
+ * @param {ArrayBufferView} indices
+ * @return {Float32Array}
+ */
+function expand( values, size, indices )
+{
+    var ret = new Float32Array( size * indices.length );
+
+    for ( var i = 0; i < indices.length; ++i )
+    {
+        for ( var j = 0; j < size; ++j )
+        {
+            ret[size*i+j] = values[size*indices[i]+j];
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Parse and decode a json string, keeping the best time of RUNS
+ * @param {string} text
+ * @return {Object} time and the decoded mesh and skin
+ */
+function decode( text )
+{
+    var best = { time: Infinity };
+
+    for ( var run = 0; run < RUNS; ++run )
+    {
+        var start = Date.now();
+        var result = {};
+        var reader = new ctx.ThreejsReader( "", JSON.parse( text ), null, null,
+        {
+            onNewMeshAvailable: function ( mesh, skin ) { result.mesh = mesh; result.skin = skin; }
+        } );
+
+        reader.readAll();
+        result.time = Date.now() - start;
+
+        if ( result.time < best.time )
+        {
+            best = result;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @param {ArrayBufferView} a
+ * @param {ArrayBufferView} b
+ * @return {boolean}
+ */
+function same( a, b )
+{
+    if ( a.length !== b.length )
+    {
+        return false;
+    }
+
+    for ( var i = 0; i < a.length; ++i )
+    {
+        if ( a[i] !== b[i] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+var gridSize = parseInt( process.argv[2] || "256", 10 );
+var faceJson = makeFaceJson( gridSize );
+var faceText = JSON.stringify( faceJson );
+var bufferText = JSON.stringify( makeBufferJson( faceJson ) );
+var faces = decode( faceText );
+var buffer = decode( bufferText );
+var bufferIndices = buffer.mesh.getIndexBuffer();
+
+console.log( gridSize * gridSize + " quads, " + faces.mesh.getVertCount() + " verts, best of " + RUNS );
+console.log( "faces\t\t" + faces.time + " ms\t" + faceText.length + " bytes" );
+console.log( "BufferGeometry\t" + buffer.time + " ms\t" + bufferText.length + " bytes" );
+console.log( same( faces.mesh.getVertBuffer(), expand( buffer.mesh.getVertBuffer(), 3, bufferIndices ) ) &&
+             same( faces.mesh.getTVerBuffer(), expand( buffer.mesh.getTVerBuffer(), 2, bufferIndices ) ) &&
+             same( faces.skin.getSkinBuffer(), expand( buffer.skin.getSkinBuffer(), 4, bufferIndices ) ) ? 
+             "results match" : "RESULTS DIFFER" );
@@ -0,0 +1,109 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Vertex cache efficiency of the meshes of an obj file before and after
+// GMeshOptimizer.
+//
+// usage: node tools/benchmarks/vertexcache.js [file.obj] [--merge]
+//
+// Without a file assets/3d/stylus/object.obj is used.
+//
+// ACMR is the average number of cache misses per triangle (0.5 is the best
+// a regular grid can do, 3 the worst) and ATVR the misses per vertex (1 is
+// the best).  Both come from simulating a FIFO cache of 
+// GMeshOptimizer.CACHE_SIZE entries.  The optimizer welds identical vertices,
+// so ATVR can rise while the misses per triangle drop, the vertex counts are
+// listed to tell the two apart.  With --merge the meshes are merged by
+// material first, the way the loaders do it.
+
+var fs = require( "fs" );
+var path = require( "path" );
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/proxy/gmeshmergeplanner.js",
+                      "graphics/assetloader/proxy/gmeshoptimizer.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js" ] );
+
+var meshes = [];
+var reader = new ctx.GObjReader( "", null, null,
+{
+    onNewMeshAvailable: function ( mesh ) { meshes.push( mesh ); },
+    onMtlLibReferenced: function ( name ) {}
+} );
+
+var args = process.argv.slice( 2 );
+var merge = ( -1 !== args.indexOf( "--merge" ) );
+var files = args.filter( function ( arg ) { return "--merge" !== arg; } );
+var file = files[0] || path.join( __dirname, "..", "..", "assets", "3d", "stylus", "object.obj" );
+
+reader.read( new Uint8Array( fs.readFileSync( file ) ) );
+reader.finish();
+
+if ( merge )
+{
+    meshes = ctx.GeometryTriMesh.mergeByMaterial( meshes );
+}
+
+/**
+ * @param {GeometryTriMesh} mesh
+ * @return {{acmr: number, atvr: number}}
+ */
+function analyze( mesh )
+{
+    return ctx.GMeshOptimizer.analyzeVertexCache( mesh.indices.view(), mesh.getVertCount(),
+                                                  ctx.GMeshOptimizer.CACHE_SIZE );
+}
+
+var triCount = 0;
+var before = { acmr: 0, atvr: 0 };
+var after = { acmr: 0, atvr: 0 };
+var time = 0;
+
+for ( var i = 0; i < meshes.length; ++i )
+{
+    var tris = meshes[i].getIndexCount() / 3;
+    var verts = meshes[i].getVertCount();
+    var a = analyze( meshes[i] );
+
+    var start = Date.now();
+    ctx.GMeshOptimizer.optimize( meshes[i] );
+    time += Date.now() - start;
+
+    var b = analyze( meshes[i] );
+
+    console.log( meshes[i].getName() + "\t" + tris + " triangles\t" + verts + " -> " + 
+                 meshes[i].getVertCount() + " vertices\tACMR " + a.acmr.toFixed( 3 ) + 
+                 " -> " + b.acmr.toFixed( 3 ) + "\tATVR " + a.atvr.toFixed( 3 ) + " -> " + b.atvr.toFixed( 3 ) );
+
+    // weighted by triangles so the totals match a single draw of everything
+    triCount += tris;
+    before.acmr += a.acmr * tris;
+    after.acmr += b.acmr * tris;
+    before.atvr += a.atvr * tris;
+    after.atvr += b.atvr * tris;
+}
+
+console.log( "total\t" + triCount + " triangles\tACMR " + ( before.acmr / triCount ).toFixed( 3 ) + 
+             " -> " + ( after.acmr / triCount ).toFixed( 3 ) + "\tATVR " + ( before.atvr / triCount ).toFixed( 3 ) + 
+             " -> " + ( after.atvr / triCount ).toFixed( 3 ) + "\t" + time + " ms" );
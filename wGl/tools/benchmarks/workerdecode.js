@@ -0,0 +1,200 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Decodes obj and three.js files with GDecodeWorkerPool running on node
+// worker_threads and checks the result against decoding on this thread.
+//
+// usage: node tools/benchmarks/workerdecode.js [workers] [file ...]
+//
+// Without files every object.obj and object.js under assets/3d is used.
+
+var fs = require( "fs" );
+var path = require( "path" );
+var threads = require( "worker_threads" );
+var wgl = require( "../wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometryskin.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/proxy/gmeshmergeplanner.js",
+                      "graphics/assetloader/proxy/gmeshoptimizer.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js",
+                      "graphics/assetloader/threejs/reader/threejsreader.js",
+                      "graphics/assetloader/worker/gdecodeworkerpool.js" ] );
+
+/**
+ * Wrap a worker_threads worker so it looks like a browser worker to the pool
+ * @return {Object}
+ */
+function createNodeWorker()
+{
+    var thread = new threads.Worker( path.join( __dirname, "..", "decodeworker-node.js" ) );
+    var worker = 
+    {
+        onmessage: undefined,
+        onerror: undefined,
+        postMessage: function ( message, transferList ) { thread.postMessage( message, transferList ); },
+        terminate: function () { thread.terminate(); }
+    };
+
+    thread.on( "message", function ( message ) { worker.onmessage( message ); } );
+    thread.on( "error", function ( e ) { worker.onerror( e ); } );
+
+    return worker;
+}
+
+/**
+ * Decode a file on this thread the same way the worker does
+ * @param {string} file
+ * @return {Array.<GeometryTriMesh>}
+ */
+function decodeHere( file )
+{
+    var meshes = [];
+    var observer = { onNewMeshAvailable: function ( mesh ) { meshes.push( mesh ); },
+                     onMtlLibReferenced: function ( name ) {} };
+
+    if ( /\.obj$/.test( file ) )
+    {
+        var reader = new ctx.GObjReader( "", null, null, observer );
+        reader.read( new Uint8Array( fs.readFileSync( file ) ) );
+        reader.finish();
+
+        for ( var i = 0; i < meshes.length; ++i )
+        {
+            ctx.GMeshOptimizer.optimize( meshes[i] );
+        }
+    }
+    else
+    {
+        var tjsReader = new ctx.ThreejsReader( "", JSON.parse( fs.readFileSync( file, "utf8" ) ),
+                                               null, null, observer );
+        while ( !tjsReader.isComplete() )
+        {
+            tjsReader.update( 0 );
+        }
+    }
+
+    return meshes;
+}
+
+/**
+ * Compare the meshes decoded here with the ones sent back by a worker
+ * @param {Array.<GeometryTriMesh>} expected
+ * @param {Array.<Object>} packed
+ * @return {boolean}
+ */
+function matches( expected, packed )
+{
+    if ( expected.length !== packed.length )
+    {
+        return false;
+    }
+
+    for ( var i = 0; i < expected.length; ++i )
+    {
+        var verts = expected[i].getVertBuffer();
+        var indices = expected[i].getIndexBuffer();
+
+        if ( verts.length !== packed[i]['verts'].length ||
+             indices.length !== packed[i]['indices'].length )
+        {
+            return false;
+        }
+
+        for ( var j = 0; j < indices.length; ++j )
+        {
+            if ( indices[j] !== packed[i]['indices'][j] )
+            {
+                return false;
+            }
+        }
+
+        for ( j = 0; j < verts.length; ++j )
+        {
+            if ( Math.fround( verts[j] ) !== packed[i]['verts'][j] )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * List the sample assets
+ * @return {Array.<string>}
+ */
+function findAssets()
+{
+    var root = path.join( __dirname, "..", "..", "assets", "3d" );
+    var files = [];
+
+    fs.readdirSync( root ).forEach( function ( dir )
+    {
+        [ "object.obj", "object.js" ].forEach( function ( name )
+        {
+            var file = path.join( root, dir, name );
+            if ( fs.existsSync( file ) )
+            {
+                files.push( file );
+            }
+        } );
+    } );
+
+    return files;
+}
+
+var workerCount = parseInt( process.argv[2] || "2", 10 );
+var files = ( process.argv.length > 3 ) ? process.argv.slice( 3 ) : findAssets();
+var pool = new ctx.GDecodeWorkerPool( createNodeWorker, workerCount );
+var remaining = files.length;
+var failures = 0;
+var start = Date.now();
+
+files.forEach( function ( file )
+{
+    var bytes = fs.readFileSync( file );
+    var buffer = bytes.buffer.slice( bytes.byteOffset, bytes.byteOffset + bytes.length );
+    var kind = /\.obj$/.test( file ) ? "obj" : "threejs";
+
+    pool.decode( { 'kind': kind, 'buffer': buffer },
+    {
+        onDecodeJobCompleted: function ( result )
+        {
+            var ok = ( undefined === result['error'] ) && matches( decodeHere( file ), result['meshes'] );
+            failures += ok ? 0 : 1;
+
+            console.log( ( ok ? "ok     " : "FAILED " ) + path.relative( process.cwd(), file ) + "\t" +
+                         ( result['meshes'] ? result['meshes'].length : 0 ) + " meshes" );
+
+            if ( 0 === --remaining )
+            {
+                console.log( files.length + " files on " + workerCount + " workers in " +
+                             ( Date.now() - start ) + " ms" );
+                pool.terminate();
+                process.exitCode = ( 0 === failures ) ? 0 : 1;
+            }
+        }
+    } );
+} );
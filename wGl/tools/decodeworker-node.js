@@ -0,0 +1,44 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Node version of the decode worker.  Start it with worker_threads:
+//
+//     new Worker( require.resolve( "./decodeworker-node.js" ) )
+//
+// The readers are loaded from wGl/src and the worker entry point posts its
+// results back through the parent port.
+
+var threads = require( "worker_threads" );
+var wgl = require( "./wglsources.js" );
+
+global.GDecodeWorkerPort = threads.parentPort;
+
+wgl.load( [ "graphics/core/glmatrix.js",
+            "graphics/assetloader/proxy/gtypedarraybuilder.js",
+            "graphics/assetloader/proxy/geometryskin.js",
+            "graphics/assetloader/proxy/geometrytrimesh.js",
+            "graphics/assetloader/proxy/gmeshmergeplanner.js",
+            "graphics/assetloader/proxy/gmeshsimplifier.js",
+            "graphics/assetloader/proxy/gmeshoptimizer.js",
+            "graphics/assetloader/proxy/ginstancedetector.js",
+            "graphics/assetloader/obj/reader/gobjtokenizer.js",
+            "graphics/assetloader/obj/reader/gobjreader.js",
+            "graphics/assetloader/threejs/reader/threejsreader.js",
+            "workers/gdecodeworker.js" ] );
@@ -0,0 +1,104 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Writes the binary mesh container read by GBinaryMeshReader, see
+// src/graphics/assetloader/binary/reader/gbinarymeshreader.js for the layout.
+
+var HEADER_SIZE = 8;
+var RECORD_SIZE = 12;
+var MAGIC = 0x4D4C4757;
+var VERSION = 1;
+
+/**
+ * @param {number} value
+ * @return {number} value rounded up to a multiple of 4
+ */
+function align4( value )
+{
+    return ( value + 3 ) & ~3;
+}
+
+/**
+ * Build a container
+ * @param {Array.<Object>} meshes Objects with name, mtlName, verts, tverts,
+ *                         normals, indices and an optional skin
+ * @param {Object} extras Extra metadata (mtlLibs, bones, animations, materials)
+ * @return {Buffer}
+ */
+function write( meshes, extras )
+{
+    var meta = { meshes: [] };
+    var streams = [];
+    var offset = 4 * ( HEADER_SIZE + RECORD_SIZE * meshes.length );
+    var records = new Uint32Array( RECORD_SIZE * meshes.length );
+    var i = 0;
+
+    function addStream( array )
+    {
+        var at = offset;
+        streams.push( { offset: at, array: array } );
+        offset = align4( offset + array.byteLength );
+        return at;
+    }
+
+    for ( var key in extras )
+    {
+        meta[key] = extras[key];
+    }
+
+    for ( i = 0; i < meshes.length; ++i )
+    {
+        var mesh = meshes[i];
+        var vertCount = mesh.verts.length / 3;
+        var indices = ( vertCount <= 65536 ) ? new Uint16Array( mesh.indices ) : new Uint32Array( mesh.indices );
+        var r = i * RECORD_SIZE;
+
+        meta.meshes.push( { name: mesh.name, mtlName: mesh.mtlName } );
+
+        records[r] = vertCount;
+        records[r+1] = indices.length;
+        records[r+2] = indices.BYTES_PER_ELEMENT;
+        records[r+3] = addStream( new Float32Array( mesh.verts ) );
+        records[r+4] = addStream( new Float32Array( mesh.tverts ) );
+        records[r+5] = addStream( new Float32Array( mesh.normals ) );
+        records[r+6] = addStream( indices );
+        records[r+7] = ( undefined !== mesh.skin ) ? addStream( new Float32Array( mesh.skin ) ) : 0;
+    }
+
+    var metaBytes = Buffer.from( JSON.stringify( meta ), "utf8" );
+    var metaOffset = offset;
+    var out = Buffer.alloc( metaOffset + metaBytes.length );
+    var header = new Uint32Array( [ MAGIC, VERSION, meshes.length, metaOffset, metaBytes.length, 0, 0, 0 ] );
+
+    Buffer.from( header.buffer ).copy( out, 0 );
+    Buffer.from( records.buffer ).copy( out, 4 * HEADER_SIZE );
+
+    for ( i = 0; i < streams.length; ++i )
+    {
+        var array = streams[i].array;
+        Buffer.from( array.buffer, array.byteOffset, array.byteLength ).copy( out, streams[i].offset );
+    }
+
+    metaBytes.copy( out, metaOffset );
+
+    return out;
+}
+
+module.exports = { write: write };
@@ -0,0 +1,513 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Block encoders for the texture transcoder. The encoders aim for a good
+// quality per second ratio rather than the best possible quality, they are
+// meant to run over a whole asset folder in seconds.
+//
+// dxt1: end points along the principal axis of the block, refined once with
+//       a least squares fit of the chosen indices, always in 4 color mode
+// dxt5: dxt1 colors in 4 color mode plus 8 alpha values between the extremes
+// etc1: average colors of both split directions, differential mode when the
+//       averages are close enough, best modifier table per sub block
+
+var ETC1_MODIFIERS = [ [ 2, 8 ], [ 5, 17 ], [ 9, 29 ], [ 13, 42 ], 
+                       [ 18, 60 ], [ 24, 80 ], [ 33, 106 ], [ 47, 183 ] ];
+
+/**
+ * Copy a 4x4 block out of an image, clamping at the borders
+ * @param {Object} image { width, height, data }
+ * @param {number} bx
+ * @param {number} by
+ * @param {Uint8Array} block Receives 16 RGBA pixels in row order
+ */
+function fetchBlock( image, bx, by, block )
+{
+    for ( var y = 0; y < 4; ++y )
+    {
+        for ( var x = 0; x < 4; ++x )
+        {
+            var sx = Math.min( 4*bx + x, image.width - 1 );
+            var sy = Math.min( 4*by + y, image.height - 1 );
+            var o = 4 * ( sy * image.width + sx );
+            var p = 4 * ( 4*y + x );
+
+            block[p]   = image.data[o];
+            block[p+1] = image.data[o+1];
+            block[p+2] = image.data[o+2];
+            block[p+3] = image.data[o+3];
+        }
+    }
+}
+
+/**
+ * @param {number} r
+ * @param {number} g
+ * @param {number} b
+ * @return {number}
+ */
+function pack565( r, g, b )
+{
+    r = Math.max( 0, Math.min( 31, Math.round( r * 31 / 255 ) ) );
+    g = Math.max( 0, Math.min( 63, Math.round( g * 63 / 255 ) ) );
+    b = Math.max( 0, Math.min( 31, Math.round( b * 31 / 255 ) ) );
+
+    return ( r << 11 ) | ( g << 5 ) | b;
+}
+
+/**
+ * @param {number} c
+ * @return {Array.<number>}
+ */
+function unpack565( c )
+{
+    var r = ( c >> 11 ) & 31;
+    var g = ( c >> 5 ) & 63;
+    var b = c & 31;
+
+    return [ ( r << 3 ) | ( r >> 2 ), ( g << 2 ) | ( g >> 4 ), ( b << 3 ) | ( b >> 2 ) ];
+}
+
+/**
+ * Choose the closest of the 4 palette entries for every pixel
+ * @param {Uint8Array} block
+ * @param {number} c0
+ * @param {number} c1
+ * @param {Uint8Array} indices Receives 16 indices
+ * @return {number} Squared error
+ */
+function fitDxtIndices( block, c0, c1, indices )
+{
+    var e0 = unpack565( c0 );
+    var e1 = unpack565( c1 );
+    var palette = [ e0, e1, [], [] ];
+    var error = 0;
+
+    for ( var k = 0; k < 3; ++k )
+    {
+        palette[2][k] = ( 2 * e0[k] + e1[k] + 1 ) / 3 | 0;
+        palette[3][k] = ( e0[k] + 2 * e1[k] + 1 ) / 3 | 0;
+    }
+
+    for ( var i = 0; i < 16; ++i )
+    {
+        var best = Infinity;
+
+        for ( var j = 0; j < 4; ++j )
+        {
+            var dr = block[4*i] - palette[j][0];
+            var dg = block[4*i+1] - palette[j][1];
+            var db = block[4*i+2] - palette[j][2];
+            var d = dr*dr + dg*dg + db*db;
+
+            if ( d < best )
+            {
+                best = d;
+                indices[i] = j;
+            }
+        }
+
+        error += best;
+    }
+
+    return error;
+}
+
+/**
+ * Encode the colors of a block as a dxt color block in 4 color mode
+ * @param {Uint8Array} block
+ * @param {Uint8Array} out
+ * @param {number} offset
+ */
+function encodeDxtColor( block, out, offset )
+{
+    var mean = [ 0, 0, 0 ];
+    var i, k;
+
+    for ( i = 0; i < 16; ++i )
+    {
+        for ( k = 0; k < 3; ++k )
+        {
+            mean[k] += block[4*i+k] / 16;
+        }
+    }
+
+    // principal axis by power iteration on the covariance
+    var cov = [ 0, 0, 0, 0, 0, 0 ];
+    for ( i = 0; i < 16; ++i )
+    {
+        var r = block[4*i] - mean[0];
+        var g = block[4*i+1] - mean[1];
+        var b = block[4*i+2] - mean[2];
+
+        cov[0] += r*r; cov[1] += r*g; cov[2] += r*b;
+        cov[3] += g*g; cov[4] += g*b; cov[5] += b*b;
+    }
+
+    var axis = [ 1, 1, 1 ];
+    for ( var iter = 0; iter < 8; ++iter )
+    {
+        var nx = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        var ny = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        var nz = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        var len = Math.sqrt( nx*nx + ny*ny + nz*nz );
+
+        if ( len < 1e-9 )
+        {
+            break;
+        }
+
+        axis = [ nx / len, ny / len, nz / len ];
+    }
+
+    var minT = Infinity;
+    var maxT = -Infinity;
+    for ( i = 0; i < 16; ++i )
+    {
+        var t = ( block[4*i] - mean[0] ) * axis[0] + ( block[4*i+1] - mean[1] ) * axis[1] + 
+                ( block[4*i+2] - mean[2] ) * axis[2];
+        minT = Math.min( minT, t );
+        maxT = Math.max( maxT, t );
+    }
+
+    var c0 = pack565( mean[0] + maxT * axis[0], mean[1] + maxT * axis[1], mean[2] + maxT * axis[2] );
+    var c1 = pack565( mean[0] + minT * axis[0], mean[1] + minT * axis[1], mean[2] + minT * axis[2] );
+    var indices = new Uint8Array( 16 );
+    var error = fitDxtIndices( block, c0, c1, indices );
+
+    // least squares refinement of the end points for the chosen indices
+    var weights = [ 1, 0, 2/3, 1/3 ];
+    var aa = 0, bb = 0, ab = 0;
+    var ax = [ 0, 0, 0 ];
+    var bx = [ 0, 0, 0 ];
+
+    for ( i = 0; i < 16; ++i )
+    {
+        var w = weights[indices[i]];
+
+        aa += w * w;
+        bb += ( 1 - w ) * ( 1 - w );
+        ab += w * ( 1 - w );
+
+        for ( k = 0; k < 3; ++k )
+        {
+            ax[k] += w * block[4*i+k];
+            bx[k] += ( 1 - w ) * block[4*i+k];
+        }
+    }
+
+    var det = aa * bb - ab * ab;
+    if ( Math.abs( det ) > 1e-6 )
+    {
+        var e0 = [];
+        var e1 = [];
+
+        for ( k = 0; k < 3; ++k )
+        {
+            e0[k] = ( ax[k] * bb - bx[k] * ab ) / det;
+            e1[k] = ( bx[k] * aa - ax[k] * ab ) / det;
+        }
+
+        var r0 = pack565( e0[0], e0[1], e0[2] );
+        var r1 = pack565( e1[0], e1[1], e1[2] );
+        var refined = new Uint8Array( 16 );
+        var refinedError = fitDxtIndices( block, r0, r1, refined );
+
+        if ( refinedError < error )
+        {
+            c0 = r0;
+            c1 = r1;
+            indices = refined;
+        }
+    }
+
+    // 4 color mode needs c0 > c1, swapping the end points swaps the indices
+    if ( c0 < c1 )
+    {
+        var swap = c0; c0 = c1; c1 = swap;
+
+        for ( i = 0; i < 16; ++i )
+        {
+            indices[i] = [ 1, 0, 3, 2 ][indices[i]];
+        }
+    }
+    else if ( c0 === c1 )
+    {
+        indices.fill( 0 );
+    }
+
+    out[offset]   = c0 & 255;
+    out[offset+1] = c0 >> 8;
+    out[offset+2] = c1 & 255;
+    out[offset+3] = c1 >> 8;
+
+    for ( i = 0; i < 4; ++i )
+    {
+        out[offset+4+i] = indices[4*i] | ( indices[4*i+1] << 2 ) | ( indices[4*i+2] << 4 ) | ( indices[4*i+3] << 6 );
+    }
+}
+
+/**
+ * Encode the alpha of a block as a dxt5 alpha block in 8 value mode
+ * @param {Uint8Array} block
+ * @param {Uint8Array} out
+ * @param {number} offset
+ */
+function encodeDxt5Alpha( block, out, offset )
+{
+    var a0 = 0;
+    var a1 = 255;
+    var i;
+
+    for ( i = 0; i < 16; ++i )
+    {
+        a0 = Math.max( a0, block[4*i+3] );
+        a1 = Math.min( a1, block[4*i+3] );
+    }
+
+    var palette = [ a0, a1 ];
+    for ( i = 1; i < 7; ++i )
+    {
+        palette.push( ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7 | 0 );
+    }
+
+    out[offset]   = a0;
+    out[offset+1] = a1;
+
+    for ( var half = 0; half < 2; ++half )
+    {
+        var bits = 0;
+
+        for ( i = 0; i < 8; ++i )
+        {
+            var a = block[4 * ( 8*half + i ) + 3];
+            var index = 0;
+
+            for ( var j = 1; j < 8 && a0 !== a1; ++j )
+            {
+                if ( Math.abs( palette[j] - a ) < Math.abs( palette[index] - a ) )
+                {
+                    index = j;
+                }
+            }
+
+            bits |= index << ( 3*i );
+        }
+
+        out[offset + 2 + 3*half] = bits & 255;
+        out[offset + 3 + 3*half] = ( bits >> 8 ) & 255;
+        out[offset + 4 + 3*half] = ( bits >> 16 ) & 255;
+    }
+}
+
+/**
+ * Best modifier table and indices of an etc1 sub block for a base color
+ * @param {Uint8Array} block
+ * @param {Array.<number>} pixels Pixel numbers of the sub block
+ * @param {Array.<number>} base
+ * @return {Object} { table, error, indices }
+ */
+function fitEtc1SubBlock( block, pixels, base )
+{
+    var best = { table: 0, error: Infinity, indices: [] };
+
+    for ( var t = 0; t < 8; ++t )
+    {
+        var modifiers = [ ETC1_MODIFIERS[t][0], ETC1_MODIFIERS[t][1], -ETC1_MODIFIERS[t][0], -ETC1_MODIFIERS[t][1] ];
+        var error = 0;
+        var indices = [];
+
+        for ( var p = 0; p < pixels.length && error < best.error; ++p )
+        {
+            var i = pixels[p];
+            var pixelBest = Infinity;
+
+            for ( var m = 0; m < 4; ++m )
+            {
+                var d = 0;
+
+                for ( var k = 0; k < 3; ++k )
+                {
+                    var v = Math.max( 0, Math.min( 255, base[k] + modifiers[m] ) ) - block[4*i+k];
+                    d += v * v;
+                }
+
+                if ( d < pixelBest )
+                {
+                    pixelBest = d;
+                    indices[p] = m;
+                }
+            }
+
+            error += pixelBest;
+        }
+
+        if ( error < best.error )
+        {
+            best = { table: t, error: error, indices: indices };
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Encode a block as etc1
+ * @param {Uint8Array} block
+ * @param {Uint8Array} out
+ * @param {number} offset
+ */
+function encodeEtc1( block, out, offset )
+{
+    var best = undefined;
+
+    for ( var flip = 0; flip < 2; ++flip )
+    {
+        var subPixels = [ [], [] ];
+        var x, y, k;
+
+        for ( y = 0; y < 4; ++y )
+        {
+            for ( x = 0; x < 4; ++x )
+            {
+                subPixels[flip ? ( y >> 1 ) : ( x >> 1 )].push( 4*y + x );
+            }
+        }
+
+        var averages = subPixels.map( function ( pixels )
+        {
+            var sum = [ 0, 0, 0 ];
+            pixels.forEach( function ( i ) { for ( var c = 0; c < 3; ++c ) { sum[c] += block[4*i+c]; } } );
+            return sum.map( function ( s ) { return s / pixels.length; } );
+        } );
+
+        // differential mode when the 5 bit averages are within the delta range
+        var q0 = averages[0].map( function ( v ) { return Math.round( v * 31 / 255 ); } );
+        var q1 = averages[1].map( function ( v ) { return Math.round( v * 31 / 255 ); } );
+        var diff = true;
+        var bytes = [ 0, 0, 0 ];
+        var bases = [ [], [] ];
+
+        for ( k = 0; k < 3; ++k )
+        {
+            var d = q1[k] - q0[k];
+            diff = diff && d >= -4 && d <= 3;
+        }
+
+        for ( k = 0; k < 3; ++k )
+        {
+            if ( diff )
+            {
+                bytes[k] = ( q0[k] << 3 ) | ( ( q1[k] - q0[k] ) & 7 );
+                bases[0][k] = ( q0[k] << 3 ) | ( q0[k] >> 2 );
+                bases[1][k] = ( q1[k] << 3 ) | ( q1[k] >> 2 );
+            }
+            else
+            {
+                var n0 = Math.round( averages[0][k] * 15 / 255 );
+                var n1 = Math.round( averages[1][k] * 15 / 255 );
+
+                bytes[k] = ( n0 << 4 ) | n1;
+                bases[0][k] = n0 * 17;
+                bases[1][k] = n1 * 17;
+            }
+        }
+
+        var fits = [ fitEtc1SubBlock( block, subPixels[0], bases[0] ), 
+                     fitEtc1SubBlock( block, subPixels[1], bases[1] ) ];
+        var error = fits[0].error + fits[1].error;
+
+        if ( undefined === best || error < best.error )
+        {
+            best = { error: error, flip: flip, diff: diff, bytes: bytes, fits: fits, subPixels: subPixels };
+        }
+    }
+
+    var msb = 0;
+    var lsb = 0;
+
+    for ( var s = 0; s < 2; ++s )
+    {
+        for ( var p = 0; p < best.subPixels[s].length; ++p )
+        {
+            var i = best.subPixels[s][p];
+            var bit = 4 * ( i & 3 ) + ( i >> 2 );
+            var m = best.fits[s].indices[p];
+
+            // modifier m is +small, +large, -small, -large, the stored index is
+            // the sign in the msb and small or large in the lsb
+            msb |= ( m >> 1 ) << bit;
+            lsb |= ( m & 1 ) << bit;
+        }
+    }
+
+    out[offset]   = best.bytes[0];
+    out[offset+1] = best.bytes[1];
+    out[offset+2] = best.bytes[2];
+    out[offset+3] = ( best.fits[0].table << 5 ) | ( best.fits[1].table << 2 ) | 
+                    ( best.diff ? 2 : 0 ) | best.flip;
+    out[offset+4] = msb >> 8;
+    out[offset+5] = msb & 255;
+    out[offset+6] = lsb >> 8;
+    out[offset+7] = lsb & 255;
+}
+
+/**
+ * Encode an image
+ * @param {string} format "dxt1", "dxt5" or "etc1"
+ * @param {Object} image { width, height, data }
+ * @return {Uint8Array} The blocks in row order
+ */
+function encode( format, image )
+{
+    var blocksX = ( image.width + 3 ) >> 2;
+    var blocksY = ( image.height + 3 ) >> 2;
+    var blockSize = ( "dxt5" === format ) ? 16 : 8;
+    var out = new Uint8Array( blockSize * blocksX * blocksY );
+    var block = new Uint8Array( 64 );
+
+    for ( var by = 0; by < blocksY; ++by )
+    {
+        for ( var bx = 0; bx < blocksX; ++bx )
+        {
+            var offset = blockSize * ( by * blocksX + bx );
+
+            fetchBlock( image, bx, by, block );
+
+            if ( "etc1" === format )
+            {
+                encodeEtc1( block, out, offset );
+            }
+            else if ( "dxt5" === format )
+            {
+                encodeDxt5Alpha( block, out, offset );
+                encodeDxtColor( block, out, offset + 8 );
+            }
+            else
+            {
+                encodeDxtColor( block, out, offset );
+            }
+        }
+    }
+
+    return out;
+}
+
+module.exports = { encode: encode };
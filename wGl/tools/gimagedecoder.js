@@ -0,0 +1,764 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Image decoders for the texture transcoder, every decoder returns
+// { width, height, data } with data holding RGBA8 pixels in row order from
+// the top left corner.
+//
+// jpeg: baseline huffman (SOF0/SOF1) with any sampling factors, progressive
+//       files are rejected
+// png:  every color type at 1 to 16 bits per channel, not interlaced
+// tga:  uncompressed and run length encoded true color and gray scale
+
+var zlib = require( "zlib" );
+
+var ZIGZAG = [  0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+               12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+               35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+               58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 ];
+
+var IDCT_COS = ( function ()
+{
+    var table = new Float64Array( 64 );
+
+    for ( var x = 0; x < 8; ++x )
+    {
+        for ( var u = 0; u < 8; ++u )
+        {
+            var c = ( 0 === u ) ? Math.SQRT1_2 : 1;
+            table[8*x + u] = c * Math.cos( ( 2*x + 1 ) * u * Math.PI / 16 ) / 2;
+        }
+    }
+
+    return table;
+} )();
+
+/**
+ * Build the canonical huffman decoding tables
+ * @param {Uint8Array} counts Number of codes of each length, 1 to 16
+ * @param {Uint8Array} symbols
+ * @return {Object}
+ */
+function buildHuffmanTable( counts, symbols )
+{
+    var maxCode = new Int32Array( 18 );
+    var valPtr = new Int32Array( 17 );
+    var minCode = new Int32Array( 17 );
+    var code = 0;
+    var k = 0;
+
+    for ( var len = 1; len <= 16; ++len )
+    {
+        valPtr[len] = k;
+        minCode[len] = code;
+        code += counts[len-1];
+        k += counts[len-1];
+        maxCode[len] = ( counts[len-1] > 0 ) ? code - 1 : -1;
+        code <<= 1;
+    }
+
+    maxCode[17] = 0x7FFFFFFF;
+
+    return { maxCode: maxCode, valPtr: valPtr, minCode: minCode, symbols: symbols };
+}
+
+/**
+ * Decode a baseline jpeg
+ * @param {Buffer} buf
+ * @return {Object}
+ */
+function decodeJpeg( buf )
+{
+    var pos = 2;
+    var quant = [];
+    var dcTables = [];
+    var acTables = [];
+    var frame = undefined;
+    var restartInterval = 0;
+
+    if ( 0xFF !== buf[0] || 0xD8 !== buf[1] )
+    {
+        throw new Error( "not a jpeg file" );
+    }
+
+    function readUint16()
+    {
+        var v = ( buf[pos] << 8 ) | buf[pos+1];
+        pos += 2;
+        return v;
+    }
+
+    while ( pos < buf.length )
+    {
+        if ( 0xFF !== buf[pos] )
+        {
+            throw new Error( "jpeg marker expected at " + pos );
+        }
+
+        var marker = buf[pos+1];
+        pos += 2;
+
+        if ( 0xFF === marker || 0x01 === marker || ( marker >= 0xD0 && marker <= 0xD7 ) )
+        {
+            // fill bytes and markers without a payload
+            if ( 0xFF === marker ) { --pos; }
+            continue;
+        }
+
+        if ( 0xD9 === marker )
+        {
+            break;
+        }
+
+        var length = readUint16();
+        var end = pos + length - 2;
+
+        if ( 0xDB === marker )
+        {
+            while ( pos < end )
+            {
+                var pq = buf[pos] >> 4;
+                var tq = buf[pos] & 15;
+                var table = new Int32Array( 64 );
+                ++pos;
+
+                for ( var i = 0; i < 64; ++i )
+                {
+                    table[ZIGZAG[i]] = pq ? readUint16() : buf[pos++];
+                }
+
+                quant[tq] = table;
+            }
+        }
+        else if ( 0xC0 === marker || 0xC1 === marker )
+        {
+            frame = { height: ( buf[pos+1] << 8 ) | buf[pos+2], 
+                      width: ( buf[pos+3] << 8 ) | buf[pos+4],
+                      components: [], hMax: 1, vMax: 1 };
+
+            for ( i = 0; i < buf[pos+5]; ++i )
+            {
+                var c = pos + 6 + 3*i;
+                frame.components.push( { id: buf[c], h: buf[c+1] >> 4, v: buf[c+1] & 15, tq: buf[c+2] } );
+                frame.hMax = Math.max( frame.hMax, buf[c+1] >> 4 );
+                frame.vMax = Math.max( frame.vMax, buf[c+1] & 15 );
+            }
+
+            prepareComponents( frame );
+        }
+        else if ( marker >= 0xC2 && marker <= 0xCF && 0xC4 !== marker && 0xC8 !== marker && 0xCC !== marker )
+        {
+            throw new Error( "only baseline jpeg files are supported" );
+        }
+        else if ( 0xC4 === marker )
+        {
+            while ( pos < end )
+            {
+                var tc = buf[pos] >> 4;
+                var th = buf[pos] & 15;
+                var counts = buf.subarray( pos + 1, pos + 17 );
+                var total = 0;
+
+                for ( i = 0; i < 16; ++i )
+                {
+                    total += counts[i];
+                }
+
+                var huffman = buildHuffmanTable( counts, buf.subarray( pos + 17, pos + 17 + total ) );
+                ( tc ? acTables : dcTables )[th] = huffman;
+                pos += 17 + total;
+            }
+        }
+        else if ( 0xDD === marker )
+        {
+            restartInterval = readUint16();
+        }
+        else if ( 0xDA === marker )
+        {
+            var scan = [];
+
+            for ( i = 0; i < buf[pos]; ++i )
+            {
+                var id = buf[pos + 1 + 2*i];
+                var tables = buf[pos + 2 + 2*i];
+
+                for ( var j = 0; j < frame.components.length; ++j )
+                {
+                    if ( frame.components[j].id === id )
+                    {
+                        frame.components[j].dc = dcTables[tables >> 4];
+                        frame.components[j].ac = acTables[tables & 15];
+                        scan.push( frame.components[j] );
+                    }
+                }
+            }
+
+            pos = decodeScan( buf, end, frame, scan, quant, restartInterval );
+            continue;
+        }
+
+        pos = end;
+    }
+
+    if ( undefined === frame )
+    {
+        throw new Error( "jpeg without a frame" );
+    }
+
+    return convertJpegColors( frame );
+}
+
+/**
+ * Allocate the planes of every component, padded to whole MCUs
+ * @param {Object} frame
+ */
+function prepareComponents( frame )
+{
+    frame.mcusX = Math.ceil( frame.width / ( 8 * frame.hMax ) );
+    frame.mcusY = Math.ceil( frame.height / ( 8 * frame.vMax ) );
+
+    frame.components.forEach( function ( c )
+    {
+        c.blocksX = Math.ceil( Math.ceil( frame.width * c.h / frame.hMax ) / 8 );
+        c.blocksY = Math.ceil( Math.ceil( frame.height * c.v / frame.vMax ) / 8 );
+        c.stride = 8 * frame.mcusX * c.h;
+        c.plane = new Uint8Array( c.stride * 8 * frame.mcusY * c.v );
+        c.pred = 0;
+    } );
+}
+
+/**
+ * Decode the entropy coded data of a scan
+ * @param {Buffer} buf
+ * @param {number} pos First byte of the entropy coded data
+ * @param {Object} frame
+ * @param {Array.<Object>} scan Components in the scan
+ * @param {Array.<Int32Array>} quant
+ * @param {number} restartInterval
+ * @return {number} Position of the marker that ends the scan
+ */
+function decodeScan( buf, pos, frame, scan, quant, restartInterval )
+{
+    var bitBuffer = 0;
+    var bitCount = 0;
+    var coefs = new Float64Array( 64 );
+    var temp = new Float64Array( 64 );
+
+    function readBit()
+    {
+        if ( 0 === bitCount )
+        {
+            var b = buf[pos++];
+
+            if ( 0xFF === b )
+            {
+                // stuffed zero after a 0xFF data byte
+                if ( 0 !== buf[pos] )
+                {
+                    throw new Error( "unexpected jpeg marker in the scan" );
+                }
+
+                ++pos;
+            }
+
+            bitBuffer = b;
+            bitCount = 8;
+        }
+
+        --bitCount;
+        return ( bitBuffer >> bitCount ) & 1;
+    }
+
+    function receive( length )
+    {
+        var v = 0;
+
+        while ( length-- > 0 )
+        {
+            v = ( v << 1 ) | readBit();
+        }
+
+        return v;
+    }
+
+    function extend( v, length )
+    {
+        return ( v < ( 1 << ( length - 1 ) ) ) ? v - ( 1 << length ) + 1 : v;
+    }
+
+    function decodeHuffman( table )
+    {
+        var code = 0;
+
+        for ( var len = 1; len <= 16; ++len )
+        {
+            code = ( code << 1 ) | readBit();
+
+            if ( code <= table.maxCode[len] )
+            {
+                return table.symbols[table.valPtr[len] + code - table.minCode[len]];
+            }
+        }
+
+        throw new Error( "bad huffman code" );
+    }
+
+    function decodeBlock( c, bx, by )
+    {
+        var q = quant[c.tq];
+        var t = decodeHuffman( c.dc );
+
+        coefs.fill( 0 );
+        c.pred += t ? extend( receive( t ), t ) : 0;
+        coefs[0] = c.pred * q[0];
+
+        for ( var k = 1; k < 64; )
+        {
+            var rs = decodeHuffman( c.ac );
+            var s = rs & 15;
+            var r = rs >> 4;
+
+            if ( 0 === s )
+            {
+                if ( 15 !== r )
+                {
+                    break;
+                }
+
+                k += 16;
+                continue;
+            }
+
+            k += r;
+            coefs[ZIGZAG[k]] = extend( receive( s ), s ) * q[ZIGZAG[k]];
+            ++k;
+        }
+
+        idctBlock( coefs, temp, c.plane, 8 * by * c.stride + 8 * bx, c.stride );
+    }
+
+    var single = ( 1 === scan.length );
+    var mcuCount = single ? scan[0].blocksX * scan[0].blocksY : frame.mcusX * frame.mcusY;
+
+    for ( var mcu = 0; mcu < mcuCount; ++mcu )
+    {
+        if ( restartInterval > 0 && mcu > 0 && 0 === mcu % restartInterval )
+        {
+            // skip to the restart marker and reset the predictions
+            bitCount = 0;
+
+            while ( pos < buf.length && !( 0xFF === buf[pos] && buf[pos+1] >= 0xD0 && buf[pos+1] <= 0xD7 ) )
+            {
+                ++pos;
+            }
+
+            pos += 2;
+            scan.forEach( function ( c ) { c.pred = 0; } );
+        }
+
+        if ( single )
+        {
+            var c = scan[0];
+            decodeBlock( c, mcu % c.blocksX, ( mcu / c.blocksX ) | 0 );
+            continue;
+        }
+
+        var mx = mcu % frame.mcusX;
+        var my = ( mcu / frame.mcusX ) | 0;
+
+        for ( var i = 0; i < scan.length; ++i )
+        {
+            for ( var v = 0; v < scan[i].v; ++v )
+            {
+                for ( var h = 0; h < scan[i].h; ++h )
+                {
+                    decodeBlock( scan[i], mx * scan[i].h + h, my * scan[i].v + v );
+                }
+            }
+        }
+    }
+
+    // find the next marker
+    while ( pos < buf.length && !( 0xFF === buf[pos] && 0 !== buf[pos+1] && 0xFF !== buf[pos+1] &&
+                                   !( buf[pos+1] >= 0xD0 && buf[pos+1] <= 0xD7 ) ) )
+    {
+        ++pos;
+    }
+
+    return pos;
+}
+
+/**
+ * Inverse dct of one block into a plane, separable with a cosine table
+ * @param {Float64Array} coefs Dequantized coefficients in natural order
+ * @param {Float64Array} temp
+ * @param {Uint8Array} plane
+ * @param {number} offset
+ * @param {number} stride
+ */
+function idctBlock( coefs, temp, plane, offset, stride )
+{
+    var x, y, u, sum;
+
+    for ( y = 0; y < 8; ++y )
+    {
+        for ( x = 0; x < 8; ++x )
+        {
+            sum = 0;
+            for ( u = 0; u < 8; ++u )
+            {
+                sum += IDCT_COS[8*x + u] * coefs[8*y + u];
+            }
+            temp[8*y + x] = sum;
+        }
+    }
+
+    for ( x = 0; x < 8; ++x )
+    {
+        for ( y = 0; y < 8; ++y )
+        {
+            sum = 0;
+            for ( u = 0; u < 8; ++u )
+            {
+                sum += IDCT_COS[8*y + u] * temp[8*u + x];
+            }
+
+            var value = Math.round( sum + 128 );
+            plane[offset + y * stride + x] = ( value < 0 ) ? 0 : ( ( value > 255 ) ? 255 : value );
+        }
+    }
+}
+
+/**
+ * Upsample the components and convert them to RGBA
+ * @param {Object} frame
+ * @return {Object}
+ */
+function convertJpegColors( frame )
+{
+    var width = frame.width;
+    var height = frame.height;
+    var data = new Uint8Array( 4 * width * height );
+    var comps = frame.components;
+
+    for ( var y = 0; y < height; ++y )
+    {
+        for ( var x = 0; x < width; ++x )
+        {
+            var values = [];
+
+            for ( var i = 0; i < comps.length; ++i )
+            {
+                var sx = ( x * comps[i].h / frame.hMax ) | 0;
+                var sy = ( y * comps[i].v / frame.vMax ) | 0;
+                values.push( comps[i].plane[sy * comps[i].stride + sx] );
+            }
+
+            var o = 4 * ( y * width + x );
+
+            if ( 3 === comps.length )
+            {
+                var cb = values[1] - 128;
+                var cr = values[2] - 128;
+
+                data[o]   = clampByte( values[0] + 1.402 * cr );
+                data[o+1] = clampByte( values[0] - 0.344136 * cb - 0.714136 * cr );
+                data[o+2] = clampByte( values[0] + 1.772 * cb );
+            }
+            else
+            {
+                data[o] = data[o+1] = data[o+2] = values[0];
+            }
+
+            data[o+3] = 255;
+        }
+    }
+
+    return { width: width, height: height, data: data };
+}
+
+/**
+ * @param {number} v
+ * @return {number}
+ */
+function clampByte( v )
+{
+    v = Math.round( v );
+    return ( v < 0 ) ? 0 : ( ( v > 255 ) ? 255 : v );
+}
+
+/**
+ * Decode a png
+ * @param {Buffer} buf
+ * @return {Object}
+ */
+function decodePng( buf )
+{
+    var pos = 8;
+    var header = undefined;
+    var palette = undefined;
+    var transparency = undefined;
+    var idat = [];
+
+    if ( 0x89 !== buf[0] || 0x50 !== buf[1] || 0x4E !== buf[2] || 0x47 !== buf[3] )
+    {
+        throw new Error( "not a png file" );
+    }
+
+    while ( pos < buf.length )
+    {
+        var length = buf.readUInt32BE( pos );
+        var type = buf.toString( "ascii", pos + 4, pos + 8 );
+        var chunk = buf.subarray( pos + 8, pos + 8 + length );
+
+        if ( "IHDR" === type )
+        {
+            header = { width: chunk.readUInt32BE( 0 ), height: chunk.readUInt32BE( 4 ),
+                       depth: chunk[8], colorType: chunk[9], interlace: chunk[12] };
+        }
+        else if ( "PLTE" === type )
+        {
+            palette = chunk;
+        }
+        else if ( "tRNS" === type )
+        {
+            transparency = chunk;
+        }
+        else if ( "IDAT" === type )
+        {
+            idat.push( chunk );
+        }
+        else if ( "IEND" === type )
+        {
+            break;
+        }
+
+        pos += 12 + length;
+    }
+
+    if ( undefined === header || 0 !== header.interlace )
+    {
+        throw new Error( "only non interlaced png files are supported" );
+    }
+
+    var channels = { 0: 1, 2: 3, 3: 1, 4: 2, 6: 4 }[header.colorType];
+    var bitsPerPixel = channels * header.depth;
+    var bpp = Math.max( 1, bitsPerPixel >> 3 );
+    var rowBytes = ( header.width * bitsPerPixel + 7 ) >> 3;
+    var raw = zlib.inflateSync( Buffer.concat( idat ) );
+    var rows = Buffer.alloc( rowBytes * header.height );
+    var width = header.width;
+    var height = header.height;
+    var data = new Uint8Array( 4 * width * height );
+    var x = 0;
+    var y = 0;
+
+    // undo the filter of every row
+    for ( y = 0; y < height; ++y )
+    {
+        var filter = raw[y * ( rowBytes + 1 )];
+        var src = y * ( rowBytes + 1 ) + 1;
+        var dst = y * rowBytes;
+        var prev = dst - rowBytes;
+
+        for ( x = 0; x < rowBytes; ++x )
+        {
+            var a = ( x >= bpp ) ? rows[dst + x - bpp] : 0;
+            var b = ( y > 0 ) ? rows[prev + x] : 0;
+            var c = ( y > 0 && x >= bpp ) ? rows[prev + x - bpp] : 0;
+            var value = raw[src + x];
+
+            if ( 1 === filter ) { value += a; }
+            else if ( 2 === filter ) { value += b; }
+            else if ( 3 === filter ) { value += ( a + b ) >> 1; }
+            else if ( 4 === filter )
+            {
+                var p = a + b - c;
+                var pa = Math.abs( p - a ), pb = Math.abs( p - b ), pc = Math.abs( p - c );
+                value += ( pa <= pb && pa <= pc ) ? a : ( ( pb <= pc ) ? b : c );
+            }
+
+            rows[dst + x] = value & 255;
+        }
+    }
+
+    // read a sample at 8 bits
+    function sample( row, index )
+    {
+        if ( 16 === header.depth )
+        {
+            return rows[row * rowBytes + 2*index];
+        }
+
+        if ( 8 === header.depth )
+        {
+            return rows[row * rowBytes + index];
+        }
+
+        var bit = index * header.depth;
+        var v = ( rows[row * rowBytes + ( bit >> 3 )] >> ( 8 - header.depth - ( bit & 7 ) ) ) & ( ( 1 << header.depth ) - 1 );
+        return ( 3 === header.colorType ) ? v : ( v * 255 / ( ( 1 << header.depth ) - 1 ) ) | 0;
+    }
+
+    for ( y = 0; y < height; ++y )
+    {
+        for ( x = 0; x < width; ++x )
+        {
+            var o = 4 * ( y * width + x );
+            var s = x * channels;
+
+            if ( 3 === header.colorType )
+            {
+                var index = sample( y, x );
+                data[o]   = palette[3*index];
+                data[o+1] = palette[3*index+1];
+                data[o+2] = palette[3*index+2];
+                data[o+3] = ( transparency && index < transparency.length ) ? transparency[index] : 255;
+            }
+            else if ( channels < 3 )
+            {
+                data[o] = data[o+1] = data[o+2] = sample( y, s );
+                data[o+3] = ( 2 === channels ) ? sample( y, s + 1 ) : 255;
+            }
+            else
+            {
+                data[o]   = sample( y, s );
+                data[o+1] = sample( y, s + 1 );
+                data[o+2] = sample( y, s + 2 );
+                data[o+3] = ( 4 === channels ) ? sample( y, s + 3 ) : 255;
+            }
+        }
+    }
+
+    return { width: width, height: height, data: data };
+}
+
+/**
+ * Decode a tga
+ * @param {Buffer} buf
+ * @return {Object}
+ */
+function decodeTga( buf )
+{
+    var imageType = buf[2];
+    var width = buf.readUInt16LE( 12 );
+    var height = buf.readUInt16LE( 14 );
+    var depth = buf[16];
+    var topDown = 0 !== ( buf[17] & 0x20 );
+    var pos = 18 + buf[0] + ( buf[1] ? buf.readUInt16LE( 5 ) * ( ( buf[7] + 7 ) >> 3 ) : 0 );
+    var gray = ( 3 === imageType || 11 === imageType );
+    var rle = ( imageType >= 9 );
+    var bytes = depth >> 3;
+    var data = new Uint8Array( 4 * width * height );
+    var pixel = [ 0, 0, 0, 255 ];
+    var count = 0;
+    var repeat = false;
+
+    if ( [ 2, 3, 10, 11 ].indexOf( imageType ) === -1 || ( !gray && bytes < 3 ) )
+    {
+        throw new Error( "unsupported tga type " + imageType + " at " + depth + " bits" );
+    }
+
+    function readPixel()
+    {
+        if ( gray )
+        {
+            pixel[0] = pixel[1] = pixel[2] = buf[pos];
+            pixel[3] = ( 2 === bytes ) ? buf[pos+1] : 255;
+        }
+        else
+        {
+            pixel[0] = buf[pos+2];
+            pixel[1] = buf[pos+1];
+            pixel[2] = buf[pos];
+            pixel[3] = ( 4 === bytes ) ? buf[pos+3] : 255;
+        }
+
+        pos += bytes;
+    }
+
+    for ( var i = 0; i < width * height; ++i )
+    {
+        if ( rle )
+        {
+            if ( 0 === count )
+            {
+                count = ( buf[pos] & 0x7F ) + 1;
+                repeat = 0 !== ( buf[pos] & 0x80 );
+                ++pos;
+
+                if ( repeat )
+                {
+                    readPixel();
+                }
+            }
+
+            if ( !repeat )
+            {
+                readPixel();
+            }
+
+            --count;
+        }
+        else
+        {
+            readPixel();
+        }
+
+        var x = i % width;
+        var y = ( i / width ) | 0;
+        var o = 4 * ( ( topDown ? y : height - 1 - y ) * width + x );
+
+        data[o]   = pixel[0];
+        data[o+1] = pixel[1];
+        data[o+2] = pixel[2];
+        data[o+3] = pixel[3];
+    }
+
+    return { width: width, height: height, data: data };
+}
+
+/**
+ * Decode an image by its extension
+ * @param {Buffer} buf
+ * @param {string} name
+ * @return {Object}
+ */
+function decode( buf, name )
+{
+    if ( /\.jpe?g$/i.test( name ) )
+    {
+        return decodeJpeg( buf );
+    }
+
+    if ( /\.png$/i.test( name ) )
+    {
+        return decodePng( buf );
+    }
+
+    if ( /\.tga$/i.test( name ) )
+    {
+        return decodeTga( buf );
+    }
+
+    throw new Error( "unsupported image type" );
+}
+
+module.exports = { decode: decode, decodeJpeg: decodeJpeg, decodePng: decodePng, decodeTga: decodeTga };
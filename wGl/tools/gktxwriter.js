@@ -0,0 +1,71 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Writes the KTX 1.1 containers read by GKtxReader, see
+// src/graphics/assetloader/ktx/reader/gktxreader.js for the layout.
+
+var IDENTIFIER = [ 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A ];
+var HEADER_SIZE = 64;
+var ENDIANNESS = 0x04030201;
+
+var GL_RGB = 0x1907;
+var GL_RGBA = 0x1908;
+
+/**
+ * Build a container of a compressed 2d texture
+ * @param {number} internalFormat
+ * @param {boolean} hasAlpha
+ * @param {Array.<Object>} levels Mip levels { width, height, data } starting
+ *                         with the full size level
+ * @return {Buffer}
+ */
+function write( internalFormat, hasAlpha, levels )
+{
+    var size = HEADER_SIZE;
+    var i = 0;
+
+    for ( i = 0; i < levels.length; ++i )
+    {
+        size += 4 + ( ( levels[i].data.length + 3 ) & ~3 );
+    }
+
+    var out = Buffer.alloc( size );
+    var header = [ ENDIANNESS, 0, 1, 0, internalFormat, hasAlpha ? GL_RGBA : GL_RGB,
+                   levels[0].width, levels[0].height, 0, 0, 1, levels.length, 0 ];
+
+    Buffer.from( IDENTIFIER ).copy( out, 0 );
+
+    for ( i = 0; i < header.length; ++i )
+    {
+        out.writeUInt32LE( header[i], 12 + 4*i );
+    }
+
+    var offset = HEADER_SIZE;
+    for ( i = 0; i < levels.length; ++i )
+    {
+        out.writeUInt32LE( levels[i].data.length, offset );
+        Buffer.from( levels[i].data.buffer, levels[i].data.byteOffset, levels[i].data.length ).copy( out, offset + 4 );
+        offset += 4 + ( ( levels[i].data.length + 3 ) & ~3 );
+    }
+
+    return out;
+}
+
+module.exports = { write: write };
@@ -0,0 +1,163 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Converts obj and three.js json files into the binary mesh container loaded
+// by GBinaryMeshLoader.
+//
+// usage: node tools/wglmesh.js [--merge] input.obj|input.js [output.wglm]
+//        node tools/wglmesh.js [--merge] --all
+//
+// --all converts every assets/3d/*/object.obj and object.js into an
+// object.wglm next to it.  --merge joins the meshes that share a material the
+// same way GObjLoader.enableAutoMergeByMaterial does.
+
+var fs = require( "fs" );
+var path = require( "path" );
+var wgl = require( "./wglsources.js" );
+var writer = require( "./gbinarymeshwriter.js" );
+
+var ctx = wgl.load( [ "graphics/core/glmatrix.js",
+                      "graphics/assetloader/proxy/gtypedarraybuilder.js",
+                      "graphics/assetloader/proxy/geometryskin.js",
+                      "graphics/assetloader/proxy/geometrytrimesh.js",
+                      "graphics/assetloader/proxy/gmeshmergeplanner.js",
+                      "graphics/assetloader/proxy/gmeshoptimizer.js",
+                      "graphics/assetloader/obj/reader/gobjtokenizer.js",
+                      "graphics/assetloader/obj/reader/gobjreader.js",
+                      "graphics/assetloader/threejs/reader/threejsreader.js" ] );
+
+/**
+ * Flatten a proxy mesh for the writer
+ * @param {GeometryTriMesh} mesh
+ * @param {GeometrySkin=} skin
+ * @param {string=} mtlName Material name override
+ * @return {Object}
+ */
+function pack( mesh, skin, mtlName )
+{
+    return { name: mesh.getName(),
+             mtlName: ( undefined !== mtlName ) ? mtlName : mesh.getMtlName(),
+             verts: mesh.getVertBuffer(),
+             tverts: mesh.getTVerBuffer(),
+             normals: mesh.getNormBuffer(),
+             indices: mesh.getIndexBuffer(),
+             skin: ( undefined !== skin ) ? skin.getSkinBuffer() : undefined };
+}
+
+/**
+ * Convert an obj file
+ * @param {string} input
+ * @param {boolean} merge
+ * @return {Buffer}
+ */
+function convertObj( input, merge )
+{
+    var meshes = [];
+    var mtlLibs = [];
+    var reader = new ctx.GObjReader( "", null, null,
+    {
+        onNewMeshAvailable: function ( mesh ) { meshes.push( mesh ); },
+        onMtlLibReferenced: function ( name ) { mtlLibs.push( name ); }
+    } );
+
+    reader.read( new Uint8Array( fs.readFileSync( input ) ) );
+    reader.finish();
+
+    if ( merge )
+    {
+        meshes = ctx.GeometryTriMesh.mergeByMaterial( meshes );
+    }
+
+    meshes.forEach( function ( mesh ) { ctx.GMeshOptimizer.optimize( mesh ); } );
+
+    return writer.write( meshes.map( function ( mesh ) { return pack( mesh ); } ),
+                         { mtlLibs: mtlLibs } );
+}
+
+/**
+ * Convert a three.js json file
+ * @param {string} input
+ * @return {Buffer}
+ */
+function convertThreejs( input )
+{
+    var json = JSON.parse( fs.readFileSync( input, "utf8" ) );
+    var packed = [];
+    var reader = new ctx.ThreejsReader( "", json, null, null,
+    {
+        onNewMeshAvailable: function ( mesh, skin )
+        {
+            packed.push( pack( mesh, skin, path.basename( input ) ) );
+        }
+    } );
+
+    reader.readAll();
+
+    return writer.write( packed, { bones: json['bones'],
+                                   animations: json['animations'],
+                                   materials: json['materials'] } );
+}
+
+/**
+ * Convert one file
+ * @param {string} input
+ * @param {string} output
+ * @param {boolean} merge
+ */
+function convert( input, output, merge )
+{
+    var start = Date.now();
+    var out = /\.obj$/i.test( input ) ? convertObj( input, merge ) : convertThreejs( input );
+
+    fs.writeFileSync( output, out );
+    console.log( input + " -> " + output + "\t" + fs.statSync( input ).size + " -> " +
+                 out.length + " bytes in " + ( Date.now() - start ) + " ms" );
+}
+
+var args = process.argv.slice( 2 );
+var merge = args.indexOf( "--merge" ) !== -1;
+args = args.filter( function ( a ) { return "--merge" !== a; } );
+
+if ( "--all" === args[0] )
+{
+    var root = path.join( __dirname, "..", "assets", "3d" );
+
+    fs.readdirSync( root ).forEach( function ( dir )
+    {
+        [ "object.obj", "object.js" ].forEach( function ( name )
+        {
+            var input = path.join( root, dir, name );
+            if ( fs.existsSync( input ) )
+            {
+                convert( input, path.join( root, dir, "object.wglm" ), merge );
+            }
+        } );
+    } );
+}
+else if ( args.length > 0 )
+{
+    convert( args[0], args[1] || args[0].replace( /\.[^.\/\\]*$/, "" ) + ".wglm", merge );
+}
+else
+{
+    console.log( "usage: node tools/wglmesh.js [--merge] input.obj|input.js [output.wglm]" );
+    console.log( "       node tools/wglmesh.js [--merge] --all" );
+    process.exitCode = 1;
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Packs the shader sources into the bundle downloaded by GShaderBundle so 
+// the render strategies get all of them in a single request.
+//
+// usage: node tools/wglshaders.js [shader directory]
+//
+// Every *.c file of assets/shaders (or the given directory) is added to
+// shaders.json in the same directory.  Comments, indentation and empty lines
+// are removed, every other line is kept as is so preprocessor directives
+// stay on their own line.  The sources are loaded one by one when the bundle
+// is missing, delete it while editing the shaders.
+
+var fs = require( "fs" );
+var path = require( "path" );
+
+/**
+ * Strip a shader source down to what the compiler needs
+ * @param {string} source
+ * @return {string}
+ */
+function preprocess( source )
+{
+    var lines = source.replace( /\/\*[\s\S]*?\*\//g, "" ).split( /\r?\n/ );
+    var out = [];
+
+    for ( var i = 0; i < lines.length; ++i )
+    {
+        var line = lines[i].replace( /\/\/.*$/, "" ).replace( /[ \t]+/g, " " ).trim();
+
+        if ( line.length > 0 )
+        {
+            out.push( line );
+        }
+    }
+
+    return out.join( "\n" ) + "\n";
+}
+
+var dir = process.argv[2] || path.join( __dirname, "..", "assets", "shaders" );
+var shaders = {};
+var before = 0;
+var after = 0;
+
+fs.readdirSync( dir ).sort().forEach( function ( name )
+{
+    if ( !/\.c$/.test( name ) )
+    {
+        return;
+    }
+
+    var source = fs.readFileSync( path.join( dir, name ), "utf8" );
+    shaders[name] = preprocess( source );
+    before += source.length;
+    after += shaders[name].length;
+} );
+
+var output = path.join( dir, "shaders.json" );
+fs.writeFileSync( output, JSON.stringify( { shaders: shaders } ) );
+
+console.log( output + "\t" + Object.keys( shaders ).length + " shaders, " + before + " -> " +
+             after + " bytes" );
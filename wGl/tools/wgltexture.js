@@ -0,0 +1,307 @@
+// Copyright (C) 2014 Arturo Mayorga
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files (the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
+
+// Transcodes the textures referenced by mtl files into block compressed KTX
+// variants loaded by GTexture when the context supports them.
+//
+// usage: node tools/wgltexture.js input.mtl
+//        node tools/wgltexture.js --all
+//
+// For every map_Kd and bump texture <name>.<ext> this writes
+//     <name>.dxt.ktx   DXT1, or DXT5 when the image has alpha
+//     <name>.etc1.ktx  ETC1, skipped when the image has alpha
+// with a full mip chain, and a <mtl>.ktx.json manifest next to the mtl file
+// that lists the variants of every texture.  Images that are not a power of
+// two are resized first.  An existing <name>.astc.ktx made by an external
+// encoder is listed in the manifest as well, this tool does not encode astc.
+//
+// --all transcodes every mtl file under assets/3d.
+
+var fs = require( "fs" );
+var path = require( "path" );
+var images = require( "./gimagedecoder.js" );
+var encoder = require( "./gblockencoder.js" );
+var ktx = require( "./gktxwriter.js" );
+var wgl = require( "./wglsources.js" );
+
+var ctx = wgl.load( [ "graphics/assetloader/ktx/reader/gtextureblockdecoder.js" ] );
+
+var MAX_SIZE = 2048;
+var FORMATS = { dxt1: ctx.GTextureBlockDecoder.COMPRESSED_RGB_S3TC_DXT1,
+                dxt5: ctx.GTextureBlockDecoder.COMPRESSED_RGBA_S3TC_DXT5,
+                etc1: ctx.GTextureBlockDecoder.ETC1_RGB8 };
+
+/**
+ * @param {number} value
+ * @return {number} Closest power of two, capped at MAX_SIZE
+ */
+function nearestPowerOfTwo( value )
+{
+    return Math.min( MAX_SIZE, Math.pow( 2, Math.round( Math.log( value ) / Math.LN2 ) ) );
+}
+
+/**
+ * Bilinear resize
+ * @param {Object} image
+ * @param {number} width
+ * @param {number} height
+ * @return {Object}
+ */
+function resize( image, width, height )
+{
+    var data = new Uint8Array( 4 * width * height );
+
+    for ( var y = 0; y < height; ++y )
+    {
+        var fy = Math.max( 0, ( y + 0.5 ) * image.height / height - 0.5 );
+        var y0 = Math.min( fy | 0, image.height - 1 );
+        var y1 = Math.min( y0 + 1, image.height - 1 );
+        var ty = fy - y0;
+
+        for ( var x = 0; x < width; ++x )
+        {
+            var fx = Math.max( 0, ( x + 0.5 ) * image.width / width - 0.5 );
+            var x0 = Math.min( fx | 0, image.width - 1 );
+            var x1 = Math.min( x0 + 1, image.width - 1 );
+            var tx = fx - x0;
+
+            for ( var k = 0; k < 4; ++k )
+            {
+                var top = image.data[4 * ( y0 * image.width + x0 ) + k] * ( 1 - tx ) + 
+                          image.data[4 * ( y0 * image.width + x1 ) + k] * tx;
+                var bottom = image.data[4 * ( y1 * image.width + x0 ) + k] * ( 1 - tx ) + 
+                             image.data[4 * ( y1 * image.width + x1 ) + k] * tx;
+
+                data[4 * ( y * width + x ) + k] = Math.round( top * ( 1 - ty ) + bottom * ty );
+            }
+        }
+    }
+
+    return { width: width, height: height, data: data };
+}
+
+/**
+ * Build the mip chain with a box filter
+ * @param {Object} image Power of two image
+ * @return {Array.<Object>}
+ */
+function buildMipChain( image )
+{
+    var levels = [ image ];
+
+    while ( image.width > 1 || image.height > 1 )
+    {
+        var width = Math.max( 1, image.width >> 1 );
+        var height = Math.max( 1, image.height >> 1 );
+        var data = new Uint8Array( 4 * width * height );
+
+        for ( var y = 0; y < height; ++y )
+        {
+            for ( var x = 0; x < width; ++x )
+            {
+                var x0 = Math.min( 2*x, image.width - 1 ), x1 = Math.min( 2*x + 1, image.width - 1 );
+                var y0 = Math.min( 2*y, image.height - 1 ), y1 = Math.min( 2*y + 1, image.height - 1 );
+
+                for ( var k = 0; k < 4; ++k )
+                {
+                    data[4 * ( y * width + x ) + k] = ( image.data[4 * ( y0 * image.width + x0 ) + k] +
+                                                        image.data[4 * ( y0 * image.width + x1 ) + k] +
+                                                        image.data[4 * ( y1 * image.width + x0 ) + k] +
+                                                        image.data[4 * ( y1 * image.width + x1 ) + k] + 2 ) >> 2;
+                }
+            }
+        }
+
+        image = { width: width, height: height, data: data };
+        levels.push( image );
+    }
+
+    return levels;
+}
+
+/**
+ * Peak signal to noise ratio of the rgb channels
+ * @param {Uint8Array} a
+ * @param {Uint8Array} b
+ * @return {number}
+ */
+function psnr( a, b )
+{
+    var sum = 0;
+    var count = 0;
+
+    for ( var i = 0; i < a.length; i += 4 )
+    {
+        for ( var k = 0; k < 3; ++k )
+        {
+            var d = a[i+k] - b[i+k];
+            sum += d * d;
+        }
+
+        count += 3;
+    }
+
+    return ( 0 === sum ) ? Infinity : 10 * Math.log( 255 * 255 * count / sum ) / Math.LN10;
+}
+
+/**
+ * Transcode one texture
+ * @param {string} dir Directory of the mtl file
+ * @param {string} name Texture name as referenced by the mtl file
+ * @return {Array.<string>} The variants available for the texture
+ */
+function transcodeTexture( dir, name )
+{
+    var input = path.join( dir, name );
+    var base = input.replace( /\.[^.\/\\]*$/, "" );
+    var start = Date.now();
+    var variants = [];
+    var image = undefined;
+
+    try
+    {
+        image = images.decode( fs.readFileSync( input ), input );
+    }
+    catch ( e )
+    {
+        console.log( input + "\tskipped: " + e.message );
+        return variants;
+    }
+
+    var width = nearestPowerOfTwo( image.width );
+    var height = nearestPowerOfTwo( image.height );
+
+    if ( width !== image.width || height !== image.height )
+    {
+        image = resize( image, width, height );
+    }
+
+    var hasAlpha = false;
+    for ( var i = 3; i < image.data.length && !hasAlpha; i += 4 )
+    {
+        hasAlpha = image.data[i] < 255;
+    }
+
+    var mips = buildMipChain( image );
+    var report = [];
+    var formats = hasAlpha ? [ [ "dxt", "dxt5" ] ] : [ [ "dxt", "dxt1" ], [ "etc1", "etc1" ] ];
+
+    formats.forEach( function ( format )
+    {
+        var levels = mips.map( function ( mip )
+        {
+            return { width: mip.width, height: mip.height, data: encoder.encode( format[1], mip ) };
+        } );
+        var out = ktx.write( FORMATS[format[1]], hasAlpha, levels );
+        var decoded = ctx.GTextureBlockDecoder.decode( FORMATS[format[1]], levels[0].data, width, height );
+
+        fs.writeFileSync( base + "." + format[0] + ".ktx", out );
+        variants.push( format[0] );
+        report.push( format[1] + " " + out.length + " bytes " + psnr( image.data, decoded ).toFixed( 2 ) + " dB" );
+    } );
+
+    if ( fs.existsSync( base + ".astc.ktx" ) )
+    {
+        variants.unshift( "astc" );
+        report.push( "astc (existing)" );
+    }
+
+    var rgbaBytes = 0;
+    mips.forEach( function ( mip ) { rgbaBytes += mip.data.length; } );
+
+    console.log( input + "\t" + width + "x" + height + " rgba8 " + rgbaBytes + " bytes, " + 
+                 report.join( ", " ) + " in " + ( Date.now() - start ) + " ms" );
+
+    return variants;
+}
+
+/**
+ * Transcode the textures of an mtl file and write its manifest
+ * @param {string} mtl
+ */
+function transcodeMtl( mtl )
+{
+    var dir = path.dirname( mtl );
+    var manifest = {};
+
+    fs.readFileSync( mtl, "utf8" ).split( "\n" ).forEach( function ( line )
+    {
+        var tokens = line.trim().split( /\s+/ );
+        var key = tokens[0].toLowerCase();
+
+        if ( "map_kd" !== key && "map_bump" !== key && "bump" !== key )
+        {
+            return;
+        }
+
+        // the texture name is the last argument, the others are options
+        var name = tokens[tokens.length - 1];
+
+        if ( undefined === manifest[name] && fs.existsSync( path.join( dir, name ) ) )
+        {
+            manifest[name] = transcodeTexture( dir, name );
+        }
+    } );
+
+    fs.writeFileSync( mtl + ".ktx.json", JSON.stringify( manifest, null, 1 ) );
+    console.log( mtl + ".ktx.json\t" + Object.keys( manifest ).length + " textures" );
+}
+
+/**
+ * Find the mtl files under a directory
+ * @param {string} dir
+ * @param {Array.<string>} out
+ * @return {Array.<string>}
+ */
+function findMtls( dir, out )
+{
+    fs.readdirSync( dir ).forEach( function ( entry )
+    {
+        var full = path.join( dir, entry );
+
+        if ( fs.statSync( full ).isDirectory() )
+        {
+            findMtls( full, out );
+        }
+        else if ( /\.mtl$/i.test( entry ) )
+        {
+            out.push( full );
+        }
+    } );
+
+    return out;
+}
+
+var args = process.argv.slice( 2 );
+
+if ( "--all" === args[0] )
+{
+    findMtls( path.join( __dirname, "..", "assets", "3d" ), [] ).forEach( transcodeMtl );
+}
+else if ( args.length > 0 )
+{
+    transcodeMtl( args[0] );
+}
+else
+{
+    console.log( "usage: node tools/wgltexture.js input.mtl" );
+    console.log( "       node tools/wgltexture.js --all" );
+    process.exitCode = 1;
+}